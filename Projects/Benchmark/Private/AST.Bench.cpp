@@ -0,0 +1,111 @@
+#include "./Common.hpp"
+
+#include <vector>
+
+import Jet.Parser;
+import Jet.Comp.PEG;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+/// The previous layout of an AST entry (64-bit fields), kept for comparison.
+struct WideEntry
+{
+  peg::CustomRuleRef rule_id;
+
+  usize next_id_same_nesting = 0;
+  usize num_children         = 0;
+  usize start_pos            = 0;
+  usize end_pos              = 0;
+};
+
+/// @returns A module with the given number of functions.
+static auto make_ast_source(usize num_functions) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    source += fmt::format(
+      "fn function_{} {{\n  let x = {} + 2 * (3 - {});\n  if (x > 2) {{\n    println(\"Hello\");\n  }}\n}}\n\n", i, i, i
+    );
+  }
+  return source;
+}
+
+/// @returns The ID of the next entry at the same nesting level.
+static auto next_sibling(peg::AST::Entry const& entry) -> usize
+{
+  return entry.next_id_same_nesting.id;
+}
+
+static auto next_sibling(WideEntry const& entry) -> usize
+{
+  return entry.next_id_same_nesting;
+}
+
+/// Visits every entry, as consumers of the whole AST do.
+/// @returns The sum of the lengths of the entries.
+template <typename TEntry>
+static auto scan_entries(DynArray<TEntry> const& entries) -> usize
+{
+  auto total = usize(0);
+  for (auto& entry : entries) {
+    total += entry.end_pos - entry.start_pos;
+  }
+  return total;
+}
+
+/// Jumps over the subtrees of the top-level entries and their direct children.
+/// @returns The number of visited entries.
+template <typename TEntry>
+static auto walk_siblings(DynArray<TEntry> const& entries) -> usize
+{
+  auto visited = usize(0);
+  for (auto e = usize(0); e < entries.size(); e = next_sibling(entries[e])) {
+    auto const end = next_sibling(entries[e]);
+    for (auto c = e + 1; c < end; c = next_sibling(entries[c])) {
+      ++visited;
+    }
+    ++visited;
+  }
+  return visited;
+}
+
+/// Compares the compact AST entry layout with the previous (wide) one.
+auto bench_ast() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = make_ast_source(16 * 1024);
+  auto parsed = jet::parser::parse(source);
+  if (!parsed.is_ok()) {
+    fmt::println("ast: failed to parse the benchmark source");
+    return;
+  }
+  auto& ast = parsed.get_unchecked().ast;
+
+  auto compact = DynArray<peg::AST::Entry>(ast.entries.begin(), ast.entries.end());
+  auto wide    = DynArray<WideEntry>();
+  wide.reserve(compact.size());
+  for (auto& entry : compact) {
+    wide.push_back({entry.rule_id(), entry.next_id_same_nesting.id, entry.num_children, entry.start_pos, entry.end_pos});
+  }
+
+  fmt::println(
+    "ast: {} entries, compact: {} B/entry ({} KiB), wide: {} B/entry ({} KiB)",
+    compact.size(),
+    sizeof(peg::AST::Entry),
+    compact.size() * sizeof(peg::AST::Entry) / 1024,
+    sizeof(WideEntry),
+    wide.size() * sizeof(WideEntry) / 1024
+  );
+
+  run_benchmark("ast/scan/compact", [&] { return scan_entries(compact); }, compact.size() * sizeof(peg::AST::Entry));
+  run_benchmark("ast/scan/wide", [&] { return scan_entries(wide); }, wide.size() * sizeof(WideEntry));
+
+  run_benchmark("ast/walk_siblings/compact", [&] { return walk_siblings(compact); });
+  run_benchmark("ast/walk_siblings/wide", [&] { return walk_siblings(wide); });
+}
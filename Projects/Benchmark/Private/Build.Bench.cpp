@@ -0,0 +1,85 @@
+#include "./Common.hpp"
+
+#include <filesystem>
+#include <thread>
+
+import Jet.Compiler.BuildProcess;
+import Jet.Core.File;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace fs = std::filesystem;
+
+/// Writes a project of modules that use each other as a binary tree (`module_0` uses `module_1` and `module_2`, ...).
+/// @returns The total size of the modules.
+static auto make_synthetic_project(Path const& root, usize num_modules, usize num_functions) -> usize
+{
+  namespace fmt = jet::comp::fmt;
+
+  fs::remove_all(root);
+  fs::create_directories(root);
+
+  auto total_size = usize(0);
+  for (auto m = usize(0); m < num_modules; ++m) {
+    auto source = String();
+    for (auto child : {2 * m + 1, 2 * m + 2}) {
+      if (child < num_modules) {
+        source += fmt::format("use module_{}::*;\n", child);
+      }
+    }
+    for (auto i = usize(0); i < num_functions; ++i) {
+      source += fmt::format(
+        "\nfn function_{}(a: i32, b: i32 = 2): i32 {{\n"
+        "  var x = a * {} + b;\n"
+        "  for (let i = 0; i < 10; i++) {{\n"
+        "    if (x > i) {{ x -= function_{}(i, 3); }} else {{ x += 1; }}\n"
+        "  }}\n"
+        "  ret x;\n"
+        "}}\n",
+        i,
+        m,
+        i / 2
+      );
+    }
+    if (m == 0) {
+      source += "\nfn main {\n  println(\"{}\", function_0(1));\n}\n";
+    }
+    total_size += source.size();
+    jet::core::overwrite_file(root / fmt::format("module_{}.jet", m), source);
+  }
+  return total_size;
+}
+
+/// Measures the build of a project with hundreds of modules (discovery, parsing, lowering and emission of the IR,
+/// without linking) with a single thread and with every hardware thread.
+auto bench_build() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto const root       = fs::temp_directory_path() / "jet_bench_build";
+  auto const total_size = make_synthetic_project(root, 512, 16);
+
+  auto thread_counts = DynArray<usize>{1};
+  if (auto const num_threads = usize(std::thread::hardware_concurrency()); num_threads > 1) {
+    thread_counts.push_back(num_threads);
+  }
+
+  for (auto num_jobs : thread_counts) {
+    run_benchmark(
+      fmt::format("build/512_modules/{}_threads", num_jobs),
+      [&] {
+        auto state                      = jet::compiler::BuildState();
+        state.settings.root_module_name = (root / "module_0").string();
+        state.settings.num_jobs         = num_jobs;
+
+        auto const built = jet::compiler::begin_build(state);
+        return built.is_ok() ? state.graph.size() : usize(0);
+      },
+      total_size
+    );
+  }
+
+  fs::remove_all(root);
+}
@@ -0,0 +1,105 @@
+#include "./Common.hpp"
+
+import Jet.Parser.JetGrammar;
+import Jet.Comp.PEG;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+/// @returns A module made mostly of line comments.
+static auto make_comment_heavy_source(usize num_functions) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    for (auto line = 0; line < 8; ++line) {
+      source += "// Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.\n";
+    }
+    source += fmt::format("fn function_{} {{\n  // Prints a message.\n  println(\"Hello, World!\");\n}}\n\n", i);
+  }
+  return source;
+}
+
+/// @returns A module made mostly of indentation and empty lines.
+static auto make_whitespace_heavy_source(usize num_functions) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto indent = String(64, ' ');
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    source += fmt::format("fn function_{} {{\n", i);
+    for (auto line = 0; line < 8; ++line) {
+      source += indent + "\t\n";
+    }
+    source += indent + "println(\"Hello, World!\");\n" + indent + "\n}\n\n";
+  }
+  return source;
+}
+
+static auto supported_kernels() -> DynArray<peg::ScanKernel>
+{
+  auto kernels = DynArray<peg::ScanKernel>{peg::ScanKernel::Scalar};
+  if (peg::best_scan_kernel() != peg::ScanKernel::Scalar) {
+    kernels.push_back(peg::ScanKernel::SSE2);
+  }
+  if (peg::best_scan_kernel() == peg::ScanKernel::AVX2) {
+    kernels.push_back(peg::ScanKernel::AVX2);
+  }
+  return kernels;
+}
+
+auto bench_char_scan() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto const sources = {
+    std::pair{"comment_heavy", make_comment_heavy_source(256)},
+    std::pair{"whitespace_heavy", make_whitespace_heavy_source(256)},
+  };
+
+  // Raw throughput of the kernels on the typical runs of the sources.
+  for (auto kernel : supported_kernels()) {
+    auto& comments = sources.begin()->second;
+    run_benchmark(
+      fmt::format("char_scan/find_char/comment_heavy/{}", peg::to_string(kernel)),
+      [&] {
+        auto num_lines = usize(0);
+        for (auto pos = usize(0); pos < comments.size(); ++num_lines) {
+          pos = peg::find_char(kernel, comments, pos, '\n') + 1;
+        }
+        return num_lines;
+      },
+      comments.size()
+    );
+
+    auto& whitespace = (sources.begin() + 1)->second;
+    run_benchmark(
+      fmt::format("char_scan/scan_class_run/whitespace_heavy/{}", peg::to_string(kernel)),
+      [&] {
+        auto num_runs = usize(0);
+        for (auto pos = usize(0); pos < whitespace.size(); ++num_runs) {
+          auto run = peg::scan_class_run(kernel, peg::CharClass::Whitespace, whitespace, pos);
+          pos += run != 0 ? run : 1;
+        }
+        return num_runs;
+      },
+      whitespace.size()
+    );
+  }
+
+  // Throughput of the parser on the same sources (using the fastest kernel).
+  for (auto& [name, source] : sources) {
+    run_benchmark(
+      fmt::format("char_scan/analyze/{}", name),
+      [&] {
+        auto& grammar = jet::parser::use_grammar();
+        return peg::analyze(grammar.peg, source).is_ok() ? usize(1) : usize(0);
+      },
+      source.size()
+    );
+  }
+}
@@ -0,0 +1,28 @@
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+/// A single benchmark iteration. Returns a value derived from the work done,
+/// so the compiler cannot optimize the work away.
+using BenchmarkFn = std::function<std::size_t()>;
+
+/// Runs the function repeatedly (for at least the minimal duration) and prints
+/// the average time of a single iteration.
+/// If @p bytes_per_iteration is not zero, the throughput is printed as well.
+/// @note Skipped if the name does not contain the filter passed in the command line.
+auto run_benchmark(std::string_view name, BenchmarkFn const& fn, std::size_t bytes_per_iteration = 0) -> void;
+
+/// Reads a file from the `Projects/Test/cases` folder. Aborts if the file cannot be read.
+auto read_bench_case(std::filesystem::path const& rel_path) -> std::string;
+
+// Benchmark suites:
+auto bench_parser() -> void;
+auto bench_char_scan() -> void;
+auto bench_ast() -> void;
+auto bench_file() -> void;
+auto bench_utf8() -> void;
+auto bench_hir() -> void;
+auto bench_interner() -> void;
+auto bench_build() -> void;
@@ -0,0 +1,89 @@
+#include "./Common.hpp"
+
+#include <filesystem>
+#include <vector>
+
+import Jet.Parser;
+import Jet.Core.File;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+
+/// Writes a tree of modules (a few hundred bytes each) into a temporary directory.
+/// @returns The paths of the modules.
+static auto make_source_tree(usize num_modules) -> DynArray<Path>
+{
+  namespace fmt = jet::comp::fmt;
+  namespace fs  = std::filesystem;
+
+  auto const root = fs::temp_directory_path() / "jet_bench_sources";
+  fs::remove_all(root);
+
+  auto paths = DynArray<Path>();
+  paths.reserve(num_modules);
+  for (auto i = usize(0); i < num_modules; ++i) {
+    auto dir = root / fmt::format("dir_{}", i / 64);
+    fs::create_directories(dir);
+
+    auto source = String();
+    for (auto f = usize(0); f < 4; ++f) {
+      source += fmt::format(
+        "fn function_{}_{} {{\n  let x = {} + 2;\n  if (x > 2) {{\n    println(\"Hello\");\n  }}\n}}\n\n", i, f, f
+      );
+    }
+
+    auto path = dir / fmt::format("module_{}.jet", i);
+    jet::core::overwrite_file(path, source);
+    paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+/// Measures loading and parsing many small modules: every file read just before its parse,
+/// and the files loaded on worker threads while the loaded ones are parsed.
+/// @note The files stay in the page cache between the iterations, so this measures the overlap
+/// of the parses with the system calls and page faults rather than with the disk.
+auto bench_file() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto const paths = make_source_tree(4096);
+
+  auto total_size = usize(0);
+  for (auto& path : paths) {
+    total_size += usize(std::filesystem::file_size(path));
+  }
+
+  run_benchmark(
+    "file/load+parse/4096_modules/sequential",
+    [&] {
+      auto num_parsed = usize(0);
+      for (auto& path : paths) {
+        auto file = jet::core::MappedFile::open(path);
+        num_parsed += file && jet::parser::parse(file->content()).is_ok() ? 1 : 0;
+      }
+      return num_parsed;
+    },
+    total_size
+  );
+
+  for (auto num_threads : {1, 2, 4, 8}) {
+    run_benchmark(
+      fmt::format("file/load+parse/4096_modules/{}_loader_threads", num_threads),
+      [&] {
+        auto loader = jet::core::SourceLoader(usize(num_threads));
+        loader.load(paths);
+
+        auto num_parsed = usize(0);
+        while (auto source = loader.next()) {
+          num_parsed += source->file && jet::parser::parse(source->file->content()).is_ok() ? 1 : 0;
+        }
+        return num_parsed;
+      },
+      total_size
+    );
+  }
+
+  std::filesystem::remove_all(paths.front().parent_path().parent_path());
+}
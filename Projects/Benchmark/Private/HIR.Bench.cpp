@@ -0,0 +1,142 @@
+#include "./Common.hpp"
+
+#include <filesystem>
+#include <thread>
+
+import Jet.Parser;
+import Jet.Compiler.HIR;
+import Jet.Compiler.IR;
+import Jet.Core.File;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace hir = jet::compiler::hir;
+
+/// @returns A module with the given number of functions, each with parameters, variables, loops and calls.
+static auto make_synthetic_module(usize num_functions) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    source += fmt::format(
+      "fn function_{}(a: i32, b: i32 = 2): i32 {{\n"
+      "  var x = a * {} + b;\n"
+      "  for (let i = 0; i < 10; i++) {{\n"
+      "    if (x > i) {{ x -= function_{}(i, 3); }} else {{ x += 1; }}\n"
+      "  }}\n"
+      "  println(\"{{}}\", x);\n"
+      "  ret x;\n"
+      "}}\n\n",
+      i,
+      i,
+      i / 2
+    );
+  }
+  return source;
+}
+
+/// Measures the lowering of large modules to the HIR, with the arena reused between the iterations,
+/// and the emission of their IR to a file.
+auto bench_hir() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  for (auto num_functions : {256, 4096}) {
+    auto const source = make_synthetic_module(usize(num_functions));
+    auto const parsed = jet::parser::parse(source);
+    if (!parsed.is_ok()) {
+      fmt::println("hir: the synthetic module was not parsed");
+      return;
+    }
+
+    auto arena = Arena();
+    run_benchmark(
+      fmt::format("hir/lower/{}_functions", num_functions),
+      [&] {
+        arena.reset();
+        auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+        return lowered.is_ok() ? lowered.get_unchecked().exprs.size() : usize(0);
+      },
+      source.size()
+    );
+
+    run_benchmark(
+      fmt::format("hir/parse+lower/{}_functions", num_functions),
+      [&] {
+        arena.reset();
+        auto reparsed = jet::parser::parse(source);
+        if (!reparsed.is_ok()) {
+          return usize(0);
+        }
+        auto lowered = hir::lower_module(reparsed.get_unchecked(), arena);
+        return lowered.is_ok() ? lowered.get_unchecked().exprs.size() : usize(0);
+      },
+      source.size()
+    );
+
+    auto ir_arena = Arena();
+    auto lowered  = hir::lower_module(parsed.get_unchecked(), ir_arena);
+    if (!lowered.is_ok()) {
+      fmt::println("hir: the synthetic module was not lowered");
+      return;
+    }
+
+    auto const ir_path = std::filesystem::temp_directory_path() / "jet_bench_ir.ll";
+    run_benchmark(
+      fmt::format("ir/emit/{}_functions", num_functions),
+      [&] {
+        auto writer = jet::core::FileWriter::create(ir_path);
+        if (!writer || !jet::compiler::ir::emit_llvm_ir(lowered.get_unchecked(), *writer).is_ok()) {
+          return usize(0);
+        }
+        writer->close();
+        return writer->num_bytes_written();
+      },
+      source.size()
+    );
+    std::filesystem::remove(ir_path);
+  }
+}
+
+/// Measures the interning of identifiers that were seen before (the common case), from several threads at once.
+auto bench_interner() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto names = DynArray<String>();
+  auto bytes = usize(0);
+  for (auto i = 0; i < 10'000; ++i) {
+    names.push_back(fmt::format("identifier_{}", i));
+    bytes += names.back().size();
+  }
+
+  auto interner = Interner();
+  for (auto& name : names) {
+    (void)interner.intern(name);
+  }
+
+  for (auto num_threads : {1, 4}) {
+    run_benchmark(
+      fmt::format("interner/lookup/{}_threads", num_threads),
+      [&] {
+        auto threads = DynArray<std::thread>();
+        auto sums    = DynArray<usize>(usize(num_threads));
+        for (auto t = 0; t < num_threads; ++t) {
+          threads.emplace_back([&, t] {
+            for (auto& name : names) {
+              sums[usize(t)] += interner.intern(name).id;
+            }
+          });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+        return sums[0];
+      },
+      bytes * usize(num_threads)
+    );
+  }
+}
@@ -0,0 +1,95 @@
+#include "./Common.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+import Jet.Core.File;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+static auto benchmark_filter = StringView();
+
+/// Accumulates the values returned by the benchmarks.
+static auto volatile benchmark_sink = usize(0);
+
+auto main(int argc, char* argv[]) -> int
+{
+  namespace fmt = jet::comp::fmt;
+
+  if (argc > 1) {
+    benchmark_filter = argv[1];
+  }
+
+  fmt::println("{:<72} {:>12} {:>16} {:>14}", "Benchmark", "Iterations", "Time/iteration", "Throughput");
+  bench_parser();
+  bench_char_scan();
+  bench_ast();
+  bench_file();
+  bench_utf8();
+  bench_hir();
+  bench_interner();
+  bench_build();
+}
+
+auto run_benchmark(StringView name, BenchmarkFn const& fn, usize bytes_per_iteration) -> void
+{
+  namespace fmt = jet::comp::fmt;
+  using Clock   = std::chrono::steady_clock;
+  using std::chrono::duration;
+
+  auto constexpr MIN_DURATION = duration<double>(0.5);
+
+  if (name.find(benchmark_filter) == StringView::npos) {
+    return;
+  }
+
+  // Warm-up: lazily initialized state and caches.
+  benchmark_sink = benchmark_sink + fn();
+
+  auto iterations = usize(0);
+  auto batch      = usize(1);
+  auto elapsed    = duration<double>(0);
+  while (elapsed < MIN_DURATION) {
+    auto start = Clock::now();
+    for (auto i = usize(0); i < batch; ++i) {
+      benchmark_sink = benchmark_sink + fn();
+    }
+    elapsed += Clock::now() - start;
+    iterations += batch;
+    batch *= 2;
+  }
+
+  auto ns_per_iteration = elapsed.count() * 1e9 / double(iterations);
+
+  auto time = String();
+  if (ns_per_iteration >= 1e6) {
+    time = fmt::format("{:.3f} ms", ns_per_iteration / 1e6);
+  }
+  else if (ns_per_iteration >= 1e3) {
+    time = fmt::format("{:.3f} us", ns_per_iteration / 1e3);
+  }
+  else {
+    time = fmt::format("{:.3f} ns", ns_per_iteration);
+  }
+
+  auto throughput = String();
+  if (bytes_per_iteration != 0) {
+    // bytes per nanosecond == GB/s
+    throughput = fmt::format("{:.3f} GB/s", double(bytes_per_iteration) / ns_per_iteration);
+  }
+
+  fmt::println("{:<72} {:>12} {:>16} {:>14}", name, iterations, time, throughput);
+}
+
+auto read_bench_case(Path const& rel_path) -> String
+{
+  auto content = jet::core::read_file(Path("Projects/Test/cases") / rel_path);
+  if (!content) {
+    std::cerr << "Failed to read benchmark case file: " << rel_path.string() << '\n';
+    std::exit(1);
+  }
+  return std::move(*content);
+}
@@ -0,0 +1,180 @@
+#include "./Common.hpp"
+
+import Jet.Parser;
+import Jet.Parser.JetGrammar;
+import Jet.Comp.PEG;
+import Jet.Comp.Format;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+static auto const PARSER_CASES = {
+  "HelloWorld.jet",
+  "expressions/CompoundExpr.jet",
+  "control_flow/if_else_if_else.jet",
+  "modules/Submodule-WithFunction-WithGlobalAlias.jet",
+};
+
+/// @returns A module with the given number of functions.
+static auto make_large_module(usize num_functions) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    source += fmt::format("fn function_{} {{\n  let x = {} + 2;\n  if (x > 2) {{\n    println(\"Hello\");\n  }}\n}}\n\n", i, i);
+  }
+  return source;
+}
+
+/// Measures a single-byte edit in the middle of modules of growing size:
+/// a full analysis scales with the module, a reanalysis with the edited block.
+static auto bench_reanalyze() -> void
+{
+  namespace fmt = jet::comp::fmt;
+  using RT      = jet::parser::JetGrammarRuleType;
+
+  auto& grammar      = jet::parser::use_grammar();
+  auto const anchors = Array<peg::CustomRuleRef, 2>{grammar.rules[RT::CodeBlock], grammar.rules[RT::DeclFunction]};
+
+  for (auto num_functions : {16, 256, 4096}) {
+    auto source   = make_large_module(usize(num_functions));
+    auto previous = peg::analyze(grammar.peg, source);
+
+    // Change "Hello" to "Jello" in the middle function.
+    auto pos    = source.find("Hello", source.size() / 2);
+    auto edited = source;
+    edited[pos] = 'J';
+    auto edit   = peg::TextEdit{pos, pos + 1, pos + 1};
+
+    run_benchmark(fmt::format("parser/edit/analyze/{}_functions", num_functions), [&] {
+      return peg::analyze(grammar.peg, edited).is_ok() ? usize(1) : usize(0);
+    });
+
+    run_benchmark(fmt::format("parser/edit/reanalyze/{}_functions", num_functions), [&] {
+      auto& ast = previous.get_unchecked().ast;
+      return peg::reanalyze(grammar.peg, ast, edited, edit, {anchors}).is_ok() ? usize(1) : usize(0);
+    });
+  }
+}
+
+/// Runs the recursive analyzer and the parsing machine side by side on the same inputs.
+static auto bench_machine() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto& grammar      = jet::parser::use_grammar();
+  auto const program = peg::compile_grammar(grammar.peg);
+
+  run_benchmark("parser/machine/compile_grammar", [&] { return peg::compile_grammar(grammar.peg).code.size(); });
+
+  auto inputs = DynArray<std::pair<String, String>>();
+  for (auto rel_path : PARSER_CASES) {
+    inputs.emplace_back(rel_path, read_bench_case(rel_path));
+  }
+  inputs.emplace_back("256_functions", make_large_module(256));
+
+  for (auto const& [name, content] : inputs) {
+    run_benchmark(
+      fmt::format("parser/engine/recursive/{}", name),
+      [&] { return peg::analyze(grammar.peg, content).is_ok() ? usize(1) : usize(0); },
+      content.size()
+    );
+
+    run_benchmark(
+      fmt::format("parser/engine/machine/{}", name),
+      [&] { return peg::analyze(program, content).is_ok() ? usize(1) : usize(0); },
+      content.size()
+    );
+  }
+}
+
+/// Measures the parse of a large module with the top-level items analyzed on multiple threads.
+static auto bench_parallel_parse() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = make_large_module(4096);
+  for (auto num_threads : {1, 2, 4, 8}) {
+    run_benchmark(
+      fmt::format("parser/parse/4096_functions/{}_threads", num_threads),
+      [&] {
+        auto options        = jet::parser::ParseOptions();
+        options.num_threads = usize(num_threads);
+        return jet::parser::parse(source, options).is_ok() ? usize(1) : usize(0);
+      },
+      source.size()
+    );
+  }
+}
+
+/// Measures the mapping of many byte offsets (every token of long, non-ASCII lines) to lines and columns.
+static auto bench_positions() -> void
+{
+  auto source = String();
+  for (auto line = 0; line < 256; ++line) {
+    for (auto token = 0; token < 64; ++token) {
+      source += "za\xC5\xBC\xC3\xB3\xC5\x82\xC4\x87 + ";
+    }
+    source += "\n";
+  }
+
+  auto offsets = DynArray<usize>();
+  for (auto pos = source.find(' '); pos != String::npos; pos = source.find(' ', pos + 1)) {
+    offsets.push_back(pos);
+  }
+
+  auto unindexed = jet::parser::FileLines{source};
+  unindexed.push_line_start(0);
+  (void)index_utf8_lines(source, unindexed.line_starts);
+  unindexed.num_bytes = source.size();
+
+  auto indexed = unindexed;
+  indexed.build_index();
+
+  for (auto [name, lines] : {std::pair{"unindexed", &unindexed}, std::pair{"indexed", &indexed}}) {
+    run_benchmark(jet::comp::fmt::format("parser/positions/column_at/{}", name), [&] {
+      auto sum = usize(0);
+      for (auto offset : offsets) {
+        sum += lines->line_at(offset) + lines->column_at(offset);
+      }
+      return sum;
+    });
+
+    run_benchmark(jet::comp::fmt::format("parser/positions/positions_at/{}", name), [&] {
+      return lines->positions_at(offsets).back().column;
+    });
+  }
+}
+
+auto bench_parser() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  run_benchmark("parser/build_grammar", [] {
+    auto grammar = jet::parser::build_grammar();
+    return grammar.peg.rule_registry.data.size();
+  });
+
+  for (auto rel_path : PARSER_CASES) {
+    auto content = read_bench_case(rel_path);
+
+    // Cost of a module parse when the grammar is rebuilt for every module.
+    run_benchmark(fmt::format("parser/build_grammar+analyze/{}", rel_path), [&] {
+      auto grammar = jet::parser::build_grammar();
+      return peg::analyze(grammar.peg, content).is_ok() ? usize(1) : usize(0);
+    });
+
+    // Cost of a module parse with the shared grammar.
+    run_benchmark(fmt::format("parser/analyze/{}", rel_path), [&] {
+      auto& grammar = jet::parser::use_grammar();
+      return peg::analyze(grammar.peg, content).is_ok() ? usize(1) : usize(0);
+    });
+  }
+
+  bench_machine();
+  bench_reanalyze();
+  bench_parallel_parse();
+  bench_positions();
+}
@@ -0,0 +1,60 @@
+#include "./Common.hpp"
+
+import Jet.Comp.Format;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+
+/// @returns A module of ASCII code, with a non-ASCII comment in every function if @p with_non_ascii is set.
+static auto make_source(usize num_functions, bool with_non_ascii) -> String
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto source = String();
+  for (auto i = usize(0); i < num_functions; ++i) {
+    if (with_non_ascii) {
+      source += "// Zażółć gęślą jaźń – € 😀\n";
+    }
+    source += fmt::format(
+      "fn function_{} {{\n  let x = {} + 2;\n  if (x > 2) {{\n    println(\"Hello, World!\");\n  }}\n}}\n\n", i, i
+    );
+  }
+  return source;
+}
+
+static auto supported_kernels() -> DynArray<UTF8Kernel>
+{
+  auto kernels = DynArray<UTF8Kernel>{UTF8Kernel::Scalar};
+  if (best_utf8_kernel() != UTF8Kernel::Scalar) {
+    kernels.push_back(UTF8Kernel::SSE2);
+  }
+  if (best_utf8_kernel() == UTF8Kernel::AVX2) {
+    kernels.push_back(UTF8Kernel::AVX2);
+  }
+  return kernels;
+}
+
+auto bench_utf8() -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  auto const sources = {
+    std::pair{"ascii", make_source(4096, false)},
+    std::pair{"mixed", make_source(4096, true)},
+  };
+
+  for (auto& [name, source] : sources) {
+    for (auto kernel : supported_kernels()) {
+      run_benchmark(
+        fmt::format("utf8/index_lines/{}/{}", name, to_string(kernel)),
+        [&] {
+          auto line_starts = DynArray<usize>();
+          auto invalid     = index_utf8_lines(kernel, source, line_starts);
+          return invalid ? usize(0) : line_starts.size();
+        },
+        source.size()
+      );
+    }
+  }
+}
@@ -1,8 +1,17 @@
 module;
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <utility>
 #include <variant>
-#include <cassert>
+#include <vector>
 
 module Jet.Compiler.BuildProcess;
 
@@ -10,11 +19,161 @@ import Jet.Compiler.Compile;
 import Jet.Parser;
 import Jet.Core.Module;
 import Jet.Core.File;
+import Jet.Core.Task;
 
 import Jet.Comp.Format;
 
 namespace jet::compiler
 {
+using Clock = std::chrono::steady_clock;
+
+/// Measures a stage of the build over every module that goes through it, from any thread.
+class StageClock
+{
+public:
+  explicit StageClock(StringView name)
+    : name(name)
+  {
+  }
+
+  /// Runs the stage of a single module and adds its time to the stage.
+  /// @returns The result of the stage.
+  template <typename Fn>
+  auto measure(Fn&& fn) -> decltype(fn())
+  {
+    auto const start  = Clock::now();
+    auto       result = fn();
+    this->add(start, Clock::now());
+    return result;
+  }
+
+  /// Adds the time of a single module, measured elsewhere, to the stage.
+  auto add(Clock::time_point start, Clock::time_point end) -> void
+  {
+    auto lock   = std::scoped_lock(mutex);
+    first_start = std::min(first_start, start);
+    last_end    = std::max(last_end, end);
+    busy += end - start;
+    ++num_modules;
+  }
+
+  [[nodiscard]]
+  auto timing() const -> StageTiming
+  {
+    auto const wall = num_modules == 0 ? Clock::duration(0) : last_end - first_start;
+    return StageTiming{name, num_modules, wall, busy};
+  }
+
+private:
+  String     name;
+  std::mutex mutex;
+
+  Clock::time_point first_start = Clock::time_point::max();
+  Clock::time_point last_end    = Clock::time_point::min();
+  Clock::duration   busy        = Clock::duration(0);
+  usize             num_modules = 0;
+};
+
+/// Schedules the stages of every module of the build on a pool of workers.
+///
+/// The modules are discovered from the root: the files are read by a @c core::SourceLoader, driven by the thread
+/// that runs the build, and every file is parsed and lowered on the pool as soon as it is loaded. Then the modules
+/// that it uses are queued for the same. The later stages run in the topological order of the module graph,
+/// each module as soon as all of its dependencies are done.
+struct BuildScheduler
+{
+  BuildState&     state;
+  core::TaskPool& pool;
+
+  /// Indexes the directory of the root module, which the paths of `use` statements are relative to.
+  Path                 source_root;
+  core::ModuleResolver resolver;
+
+  StageClock read_clock{"read"};
+  StageClock parse_clock{"parse"};
+  StageClock lower_clock{"lower"};
+  StageClock emit_clock{"emit"};
+  StageClock link_clock{"link"};
+
+  /// The IR files of the modules.
+  DynArray<Path> units;
+
+  /// The number of dependencies of every module that were not emitted yet.
+  DynArray<std::atomic<usize>> num_pending_dependencies;
+
+  std::mutex      error_mutex;
+  Opt<BuildError> first_error;
+
+  /// Set with the first error, so that the modules that are still queued are skipped.
+  std::atomic<bool> failed = false;
+
+  /// Guards the modules to read and the number of unfinished ones, signalled by @c discovered.
+  std::mutex              discovery_mutex;
+  std::condition_variable discovered;
+
+  /// The modules that were discovered but not queued in the loader yet.
+  DynArray<usize> to_read;
+
+  /// The number of discovered modules that were not parsed, lowered and searched for dependencies yet.
+  usize num_unfinished = 0;
+
+  auto fail(String details) -> void
+  {
+    {
+      auto lock = std::scoped_lock(error_mutex);
+      if (first_error) {
+        return;
+      }
+      first_error = BuildError{1, std::move(details)};
+      failed      = true;
+    }
+    {
+      // Taken, so that the reading thread cannot miss the failure between checking and waiting.
+      auto lock = std::scoped_lock(discovery_mutex);
+    }
+    discovered.notify_all();
+  }
+
+  /// Queues the module to be read.
+  auto queue_read(usize index) -> void
+  {
+    {
+      auto lock = std::scoped_lock(discovery_mutex);
+      to_read.push_back(index);
+      ++num_unfinished;
+    }
+    discovered.notify_all();
+  }
+
+  /// Marks a module that was queued to be read as done (successfully or not).
+  auto finish() -> void
+  {
+    {
+      auto lock = std::scoped_lock(discovery_mutex);
+      --num_unfinished;
+    }
+    discovered.notify_all();
+  }
+
+  auto read_modules(core::SourceLoader& loader) -> void;
+  auto discover(usize index) -> void;
+  auto discover_dependencies(usize index) -> void;
+  auto emit(usize index) -> void;
+
+  /// @returns The module file named by the longest prefix of the path or @c std::nullopt if none of them does.
+  [[nodiscard]]
+  auto resolve(Span<StringView const> path) const -> Opt<Path>;
+};
+
+static auto collect_use_paths(
+  hir::Module const&              module,
+  hir::UseItem const&             item,
+  DynArray<StringView>&           prefix,
+  DynArray<DynArray<StringView>>& paths
+) -> void;
+static auto report_timings(BuildState const& state, usize num_threads) -> void;
+static auto module_name_of(Path const& file, Path const& source_root) -> String;
+
 auto run_build(ProgramArgs const& args) -> BuildResult
 {
   static auto constexpr NOT_READY_ERROR = StringView(
@@ -22,8 +181,13 @@ auto run_build(ProgramArgs const& args) -> BuildResult
     "after being configured using specified program arguments"
   );
 
+  auto settings = make_settings_from_args(args);
+  if (auto invalid = settings.err()) {
+    return error(BuildError{1, std::move(invalid->details)});
+  }
+
   auto build_state     = BuildState();
-  build_state.settings = make_settings_from_args(args);
+  build_state.settings = std::move(settings.get_unchecked());
 
   if (!build_state.can_start()) {
     return error(BuildError{1, String(NOT_READY_ERROR)});
@@ -35,9 +199,7 @@ auto run_build(ProgramArgs const& args) -> BuildResult
 auto begin_build(BuildState& state) -> BuildResult
 {
   namespace fmt = jet::comp::fmt;
-  using core::read_file, core::find_module;
-  using parser::parse;
-  using compiler::compile;
+  using core::overwrite_file, core::find_module;
 
   assert(state.can_start() && "begin_build() called on a state that is not ready.");
 
@@ -48,27 +210,360 @@ auto begin_build(BuildState& state) -> BuildResult
     return error(BuildError{1, "cannot find module file"});
   }
 
-  auto file_content = read_file(*module_path);
-  if (!file_content) {
-    return error(BuildError{1, "cannot open module file"});
+  auto const build_start = Clock::now();
+
+  auto source_root = module_path->parent_path();
+  if (source_root.empty()) {
+    source_root = ".";
+  }
+  auto const roots = Array<Path, 1>{source_root};
+
+  auto pool      = core::TaskPool(state.settings.num_jobs);
+  auto scheduler = BuildScheduler{state, pool, source_root, core::ModuleResolver(roots)};
+
+  // Read, parse and lower the modules, as they are discovered.
+  (void)state.graph.add(*module_path);
+  scheduler.queue_read(0);
+  {
+    auto loader = core::SourceLoader(state.settings.num_jobs);
+    scheduler.read_modules(loader);
+  }
+  pool.wait();
+
+  auto const num_modules = state.graph.size();
+  if (state.settings.should_dump_parse()) {
+    auto parse_dump = String();
+    for (auto i = usize(0); i < num_modules; ++i) {
+      parse_dump += state.graph[i].parse_dump;
+    }
+    overwrite_file(Path(*state.settings.output.parse_dump_file_name), parse_dump);
+  }
+  if (scheduler.first_error) {
+    return error(std::move(*scheduler.first_error));
+  }
+
+  auto sorted = state.graph.sort();
+  if (auto cycle = sorted.err()) {
+    auto details = String("modules depend on each other: ");
+    for (auto index : *cycle) {
+      details += fmt::format("{} -> ", state.graph[index].path.generic_string());
+    }
+    details += state.graph[cycle->front()].path.generic_string();
+    return error(BuildError{1, std::move(details)});
   }
 
-  if (file_content->empty()) {
-    return error(BuildError{1, "module file is empty"});
+  // Emit the IR of every module once its dependencies are done.
+  auto const intermediate_directory = prepare_intermediate_directory(state.settings);
+
+  scheduler.units.reserve(num_modules);
+  scheduler.num_pending_dependencies = DynArray<std::atomic<usize>>(num_modules);
+  for (auto i = usize(0); i < num_modules; ++i) {
+    auto& module = state.graph[i];
+    module.name  = i == 0 ? String() : module_name_of(module.path, source_root);
+    scheduler.units.push_back(intermediate_directory / fmt::format("{}_{}.ll", i, module.path.stem().string()));
+    scheduler.num_pending_dependencies[i] = module.dependencies.size();
+  }
+  for (auto i = usize(0); i < num_modules; ++i) {
+    if (state.graph[i].dependencies.empty()) {
+      pool.submit([&, i] { scheduler.emit(i); });
+    }
+  }
+  pool.wait();
+  if (scheduler.first_error) {
+    return error(std::move(*scheduler.first_error));
   }
 
-  auto maybe_parsed = parse(*file_content);
-  if (auto failed_parse = maybe_parsed.err()) {
-    auto msg = fmt::format("module parse failed, details: {}", failed_parse->details);
-    return error(BuildError{1, msg});
+  // Compile every unit and link them into the program.
+  if (state.settings.should_output_binary()) {
+    auto linked = scheduler.link_clock.measure([&] {
+      return link_units(intermediate_directory, scheduler.units, state.settings);
+    });
+    if (auto err = linked.err()) {
+      return error(BuildError{1, err->details});
+    }
   }
-  auto compile_result = compile(maybe_parsed.get_unchecked(), state.settings);
 
-  if (auto err = compile_result.err()) {
-    return error(BuildError{1, err->details});
+  if (state.settings.should_cleanup_intermediate()) {
+    cleanup_intermediate_directory(state.settings);
   }
 
+  for (auto clock : {&scheduler.read_clock,
+                     &scheduler.parse_clock,
+                     &scheduler.lower_clock,
+                     &scheduler.emit_clock,
+                     &scheduler.link_clock}) {
+    state.timings.push_back(clock->timing());
+  }
+  auto const build_time = Clock::now() - build_start;
+  state.timings.push_back(StageTiming{"total", num_modules, build_time, build_time});
+
+  if (state.settings.report_timings) {
+    report_timings(state, pool.num_threads());
+  }
   return success(std::monostate{});
 }
 
-} // namespace jet::compiler
\ No newline at end of file
+/// Queues the discovered modules in the loader and submits every loaded one to the pool, until every module
+/// was loaded or the build failed. The read stage of a module lasts from its queueing to its handover.
+/// @note Runs on the thread that runs the build, the only one that uses the loader.
+auto BuildScheduler::read_modules(core::SourceLoader& loader) -> void
+{
+  // The module and the queueing time of every file queued in the loader.
+  auto queued    = DynArray<std::pair<usize, Clock::time_point>>();
+  auto num_taken = usize(0);
+  auto paths     = DynArray<Path>();
+
+  while (!failed) {
+    {
+      // While files are being loaded, the next of them is taken first, the new modules are queued afterwards.
+      auto lock = std::unique_lock(discovery_mutex);
+      if (num_taken == queued.size()) {
+        discovered.wait(lock, [&] { return !to_read.empty() || num_unfinished == 0 || failed; });
+      }
+
+      auto const now = Clock::now();
+      for (auto index : to_read) {
+        queued.emplace_back(index, now);
+        paths.push_back(state.graph[index].path);
+      }
+      to_read.clear();
+    }
+
+    if (!paths.empty()) {
+      (void)loader.load(paths);
+      paths.clear();
+    }
+    if (num_taken == queued.size()) {
+      // Nothing left to read and every module was processed (or the build failed).
+      break;
+    }
+
+    auto source = loader.next();
+    ++num_taken;
+
+    auto const [index, queued_at] = queued[source->index];
+    read_clock.add(queued_at, Clock::now());
+
+    // The module is parsed straight from the mapped file, which outlives the parse.
+    state.graph[index].file = std::move(source->file);
+    pool.submit([this, index] {
+      this->discover(index);
+      this->finish();
+    });
+  }
+}
+
+auto BuildScheduler::discover(usize index) -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  if (failed) {
+    return;
+  }
+
+  auto& module = state.graph[index];
+  auto  name   = module.path.generic_string();
+
+  if (!module.file) {
+    return this->fail(fmt::format("cannot open module file {}", name));
+  }
+
+  auto const file_content = module.file->content();
+  if (file_content.empty()) {
+    return this->fail(fmt::format("module file {} is empty", name));
+  }
+
+  auto const is_parsed = parse_clock.measure([&] {
+    // Parser dumps are collected in memory and written to the file at once.
+    auto parse_log     = comp::log::Log(module.parse_dump);
+    auto parse_options = parser::ParseOptions();
+    if (state.settings.should_dump_parse()) {
+      parse_options.verbosity   = parser::ParseVerbosity::All;
+      parse_options.diagnostics = &parse_log;
+    }
+
+    auto maybe_parsed = parser::parse(file_content, parse_options);
+    if (auto failed_parse = maybe_parsed.err()) {
+      this->fail(fmt::format("module {} parse failed, details: {}", name, failed_parse->details));
+      return false;
+    }
+    module.parse = std::move(maybe_parsed.get_unchecked());
+    return true;
+  });
+  if (!is_parsed) {
+    return;
+  }
+
+  auto const is_lowered = lower_clock.measure([&] {
+    auto maybe_hir = hir::lower_module(*module.parse, module.arena);
+    if (auto err = maybe_hir.err()) {
+      this->fail(fmt::format("module {} lowering failed at byte {}: {}", name, err->pos, err->details));
+      return false;
+    }
+    module.hir = std::move(maybe_hir.get_unchecked());
+    return true;
+  });
+  if (!is_lowered) {
+    return;
+  }
+
+  this->discover_dependencies(index);
+}
+
+auto BuildScheduler::discover_dependencies(usize index) -> void
+{
+  auto& module = state.graph[index];
+  auto& hir    = *module.hir;
+
+  // A `use` of an item of a submodule defined in the module itself is not a dependency.
+  auto submodules = DynArray<StringView>();
+  for (auto item : hir.get(hir.items)) {
+    auto& stmt = hir.get(item);
+    if (stmt.kind == hir::StmtKind::Submodule) {
+      auto path = hir.get(hir.submodules[stmt.index].path);
+      if (!path.empty()) {
+        submodules.push_back(hir.get(path.front()));
+      }
+    }
+  }
+
+  // Every `use` statement (including the local ones) is in the table of statements.
+  auto paths  = DynArray<DynArray<StringView>>();
+  auto prefix = DynArray<StringView>();
+  for (auto& stmt : hir.stmts) {
+    if (stmt.kind != hir::StmtKind::Use) {
+      continue;
+    }
+    for (auto& item : Span<hir::UseItem const>(hir.use_items).subspan(stmt.index, stmt.count)) {
+      collect_use_paths(hir, item, prefix, paths);
+    }
+  }
+
+  for (auto& path : paths) {
+    if (path.empty() || std::find(submodules.begin(), submodules.end(), path.front()) != submodules.end()) {
+      continue;
+    }
+
+    // Paths that name no module file are left to the name resolution (e.g. the standard library).
+    auto file = this->resolve(path);
+    if (!file) {
+      continue;
+    }
+
+    auto const [dependency, is_added] = state.graph.add(*file);
+    if (dependency == index) {
+      continue;
+    }
+    if (std::find(module.dependencies.begin(), module.dependencies.end(), dependency) == module.dependencies.end()) {
+      module.dependencies.push_back(dependency);
+    }
+    if (is_added) {
+      this->queue_read(dependency);
+    }
+  }
+}
+
+auto BuildScheduler::emit(usize index) -> void
+{
+  namespace fmt = jet::comp::fmt;
+
+  if (failed) {
+    return;
+  }
+
+  auto& module = state.graph[index];
+
+  // The functions of the used modules are declared in the IR of the module, so it can call them.
+  auto used = DynArray<ir::UsedModule>();
+  used.reserve(module.dependencies.size());
+  for (auto dependency : module.dependencies) {
+    auto const& used_module = state.graph[dependency];
+    used.push_back(ir::UsedModule{used_module.name, &*used_module.hir});
+  }
+
+  auto const context = ir::EmitContext{module.name, used};
+  auto       emitted = emit_clock.measure([&] { return emit_unit(*module.hir, units[index], context); });
+  if (auto err = emitted.err()) {
+    return this->fail(fmt::format("module {}: {}", module.path.generic_string(), err->details));
+  }
+
+  for (auto dependent : module.dependents) {
+    if (--num_pending_dependencies[dependent] == 0) {
+      pool.submit([this, dependent] { this->emit(dependent); });
+    }
+  }
+}
+
+auto BuildScheduler::resolve(Span<StringView const> path) const -> Opt<Path>
+{
+  // `use a::b::c` refers to `a/b/c.jet`, `a/b.jet` or `a.jet` (whichever exists, in that order).
+  for (auto length = path.size(); length > 0; --length) {
+    auto file = source_root;
+    for (auto& name : path.first(length)) {
+      file /= Path(name);
+    }
+    file += ".jet";
+
+    if (auto found = resolver.find(file)) {
+      return found;
+    }
+  }
+  return std::nullopt;
+}
+
+/// Appends the full paths of the item, or of the items of its group, to the paths.
+static auto collect_use_paths(
+  hir::Module const&              module,
+  hir::UseItem const&             item,
+  DynArray<StringView>&           prefix,
+  DynArray<DynArray<StringView>>& paths
+) -> void
+{
+  auto const base = prefix.size();
+  for (auto symbol : module.get(item.path)) {
+    prefix.push_back(module.get(symbol));
+  }
+
+  if (item.group.count == 0) {
+    paths.push_back(prefix);
+  }
+  for (auto& nested : module.get(item.group)) {
+    collect_use_paths(module, nested, prefix, paths);
+  }
+  prefix.resize(base);
+}
+
+/// @returns The path of the module in the `use` statements (`util/math.jet` - `util::math`).
+static auto module_name_of(Path const& file, Path const& source_root) -> String
+{
+  auto relative = file.lexically_relative(source_root.lexically_normal());
+  relative.replace_extension();
+
+  auto name = String();
+  for (auto const& part : relative) {
+    if (!name.empty()) {
+      name += "::";
+    }
+    name += part.string();
+  }
+  return name;
+}
+
+static auto report_timings(BuildState const& state, usize num_threads) -> void
+{
+  namespace fmt = jet::comp::fmt;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+
+  fmt::println("Build timings ({} modules, {} threads):", state.graph.size(), num_threads);
+  for (auto& timing : state.timings) {
+    fmt::println(
+      "  {:<6} {:>6} modules {:>10.3f} ms wall {:>10.3f} ms busy",
+      timing.name,
+      timing.num_modules,
+      Milliseconds(timing.wall).count(),
+      Milliseconds(timing.busy).count()
+    );
+  }
+}
+
+} // namespace jet::compiler
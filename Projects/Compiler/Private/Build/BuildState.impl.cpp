@@ -1,3 +1,12 @@
+module;
+
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 module Jet.Compiler.BuildState;
 
 namespace jet::compiler
@@ -9,4 +18,89 @@ auto BuildState::can_start() const -> bool
   return true;
 }
 
-} // namespace jet::compiler
\ No newline at end of file
+auto ModuleGraph::add(Path const& path) -> std::pair<usize, bool>
+{
+  auto key = std::filesystem::absolute(path).lexically_normal().generic_string();
+
+  auto lock           = std::scoped_lock(mutex);
+  auto [it, is_added] = indices.try_emplace(std::move(key), modules.size());
+  if (is_added) {
+    modules.emplace_back().path = path.lexically_normal();
+  }
+  return {it->second, is_added};
+}
+
+auto ModuleGraph::operator[](usize index) -> BuildModule&
+{
+  auto lock = std::scoped_lock(mutex);
+  return modules[index];
+}
+
+auto ModuleGraph::operator[](usize index) const -> BuildModule const&
+{
+  auto lock = std::scoped_lock(mutex);
+  return modules[index];
+}
+
+auto ModuleGraph::size() const -> usize
+{
+  auto lock = std::scoped_lock(mutex);
+  return modules.size();
+}
+
+auto ModuleGraph::sort() -> Result<DynArray<usize>, DynArray<usize>>
+{
+  auto lock = std::scoped_lock(mutex);
+
+  auto num_pending = DynArray<usize>(modules.size());
+  for (auto i = usize(0); i < modules.size(); ++i) {
+    modules[i].dependents.clear();
+  }
+  for (auto i = usize(0); i < modules.size(); ++i) {
+    num_pending[i] = modules[i].dependencies.size();
+    for (auto dependency : modules[i].dependencies) {
+      modules[dependency].dependents.push_back(i);
+    }
+  }
+
+  // Every module is ordered once all of its dependencies are (Kahn's algorithm).
+  auto order = DynArray<usize>();
+  order.reserve(modules.size());
+  for (auto i = usize(0); i < modules.size(); ++i) {
+    if (num_pending[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  for (auto next = usize(0); next < order.size(); ++next) {
+    for (auto dependent : modules[order[next]].dependents) {
+      if (--num_pending[dependent] == 0) {
+        order.push_back(dependent);
+      }
+    }
+  }
+  if (order.size() == modules.size()) {
+    return success(std::move(order));
+  }
+
+  // Every module that was not ordered depends on another one that was not, so following them ends in a cycle.
+  auto visited_at = DynArray<usize>(modules.size(), usize(-1));
+  auto path       = DynArray<usize>();
+  auto current    = usize(0);
+  while (num_pending[current] == 0) {
+    ++current;
+  }
+  while (visited_at[current] == usize(-1)) {
+    visited_at[current] = path.size();
+    path.push_back(current);
+    for (auto dependency : modules[current].dependencies) {
+      if (num_pending[dependency] != 0) {
+        current = dependency;
+        break;
+      }
+    }
+  }
+  path.erase(path.begin(), path.begin() + isize(visited_at[current]));
+  return error(std::move(path));
+}
+
+} // namespace jet::compiler
@@ -1,67 +1,27 @@
 module;
 
-#include <iostream>
-#include <fstream>
 #include <filesystem>
-#include <cstdlib>
 
 module Jet.Compiler.Compile;
 
 import Jet.Core.File;
-
-using jet::parser::ModuleParse;
-using LLVMGenError = String;
+import Jet.Core.Process;
+import Jet.Compiler.IR;
+import Jet.Comp.Format;
 
 namespace jet::compiler
 {
 
-static auto generate_llvm_ir(ModuleParse const& parse_result, Settings const& settings) -> Result<String, LLVMGenError>;
 static auto ensure_exists(Path const& directory_path) -> void;
-static auto cleanup_intermediate_directory(Settings const& settings) -> void;
 static auto determine_intermediate_directory(Settings const& settings) -> Path;
-static auto generate_intermediate_content(Path const& dir_path, StringView content) -> void;
-static auto run_llvm_compilation(Path const& directory) -> void;
 
-auto compile(ModuleParse parse_result, Settings settings) -> Result<int, CompileError>
+auto prepare_intermediate_directory(Settings const& settings) -> Path
 {
-  auto maybe_ir = generate_llvm_ir(parse_result, settings);
-
-  if (auto err = maybe_ir.err()) {
-    std::cerr << "Could not generate LLVM IR, details:\n    " << *err << '\n';
-    return error("LLVM IR generation failed");
-  }
-
-  auto intermediate_directory = determine_intermediate_directory(settings);
-  ensure_exists(intermediate_directory);
-
-  generate_intermediate_content(intermediate_directory, maybe_ir.get_unchecked());
-
-  if (settings.should_cleanup_intermediate()) {
-    cleanup_intermediate_directory(settings);
-  }
-
-  return success(0);
+  auto directory = determine_intermediate_directory(settings);
+  ensure_exists(directory);
+  return directory;
 }
 
-static auto generate_llvm_ir(ModuleParse const& parse_result, Settings const& settings) -> Result<String, LLVMGenError>
-{
-  // A sample program that prints "Hello, World from Jet".
-  static auto constexpr MOCK_IR_CONTENT =
-    "@.str = private unnamed_addr constant [22 x i8] c\"Hello, World from Jet\\00\"\n"
-    "\n"
-    "declare i32 @puts(i8* nocapture) nounwind\n"
-    "\n"
-    "define i32 @main() {\n"
-    "    %1 = call i32 @puts(i8* getelementptr inbounds ([22 x i8], [22 x i8]* @.str, i32 0, i32 0))\n"
-    "    ret i32 0\n"
-    "}";
-
-  // TODO: implement this.
-
-  return success(MOCK_IR_CONTENT);
-}
-
-
 static auto determine_intermediate_directory(Settings const& settings) -> Path
 {
   static auto constexpr DEFAULT_INTERMEDIATE_DIRECTORY = StringView(".jetc-intermediate");
@@ -79,7 +39,7 @@ static auto ensure_exists(Path const& directory_path) -> void
   fs::create_directories(directory_path);
 }
 
-static auto cleanup_intermediate_directory(Settings const& settings) -> void
+auto cleanup_intermediate_directory(Settings const& settings) -> void
 {
   namespace fs = std::filesystem;
 
@@ -90,29 +50,88 @@ static auto cleanup_intermediate_directory(Settings const& settings) -> void
   fs::remove_all(path);
 }
 
-static auto run_llvm_compilation(Path const& directory) -> void
+/// @returns The error with the command and its standard error, if the process could not be started or failed.
+static auto check_process(core::Command const& command, core::ProcessResult const& result) -> Opt<CompileError>
 {
-  namespace fs = std::filesystem;
-  // TODO: make this configurable.
+  namespace fmt = jet::comp::fmt;
 
-  auto cwd = fs::current_path();
-  fs::current_path(directory);
+  if (auto err = result.err()) {
+    return CompileError{err->details};
+  }
 
-  // TODO: use proper process spawning and error handling.
-  std::system("clang++ main.ll -o main.exe");
+  auto& output = result.get_unchecked();
+  if (output.succeeded()) {
+    return std::nullopt;
+  }
 
-  fs::current_path(cwd);
+  auto invocation = command.program;
+  for (auto& arg : command.args) {
+    invocation += ' ';
+    invocation += arg;
+  }
+  auto const reason =
+    output.timed_out ? String("timed out") : fmt::format("failed with exit code {}", output.exit_code);
+  return CompileError{fmt::format("`{}` {}:\n{}", invocation, reason, output.err)};
 }
 
-static auto generate_intermediate_content(Path const& dir_path, StringView content) -> void
+auto link_units(Path const& directory, Span<Path const> units, Settings const& settings) -> Result<int, CompileError>
 {
-  // Save the IR file.
+  namespace fs = std::filesystem;
   // TODO: make this configurable.
-  auto const ir_file = dir_path / "main.ll";
-  core::overwrite_file(ir_file, content);
+  static auto constexpr CLANG = StringView("clang++");
+
+  // The paths are absolute, so the working directory of the compiler is never changed.
+  auto const absolute_directory = fs::absolute(directory);
+
+  // Every unit is compiled to an object file at once (up to the number of jobs), then they are linked.
+  auto queue    = core::JobQueue(settings.num_jobs);
+  auto compiles = DynArray<core::Command>();
+  auto objects  = DynArray<String>();
+  for (auto& unit : units) {
+    auto const source = fs::absolute(unit);
+    auto       object = source;
+    object.replace_extension(".o");
+
+    compiles.push_back(core::Command{String(CLANG), {"-c", source.string(), "-o", object.string()}});
+    objects.push_back(object.string());
+    (void)queue.push(compiles.back());
+  }
+
+  auto const compiled = queue.run();
+  for (auto i = usize(0); i < compiled.size(); ++i) {
+    if (auto err = check_process(compiles[i], compiled[i])) {
+      return error(std::move(*err));
+    }
+  }
+
+  auto link = core::Command{String(CLANG), std::move(objects)};
+  link.args.push_back("-o");
+  link.args.push_back((absolute_directory / "main.exe").string());
+  if (auto err = check_process(link, core::run_process(link))) {
+    return error(std::move(*err));
+  }
+  return success(0);
+}
+
+auto emit_unit(hir::Module const& module, Path const& ir_file, ir::EmitContext const& context)
+  -> Result<int, CompileError>
+{
+  namespace fmt = jet::comp::fmt;
+
+  // The IR is streamed to the file while it is emitted.
+  auto writer = core::FileWriter::create(ir_file);
+  if (!writer) {
+    return error(CompileError{fmt::format("cannot create {}", ir_file.string())});
+  }
 
-  // Run the compilation
-  run_llvm_compilation(dir_path);
+  auto emitted = ir::emit_llvm_ir(module, *writer, context);
+  if (auto err = emitted.err()) {
+    return error(CompileError{fmt::format("LLVM IR generation failed at byte {}: {}", err->pos, err->details)});
+  }
+  if (!writer->close()) {
+    return error(CompileError{fmt::format("cannot write {}", ir_file.string())});
+  }
+  return success(0);
 }
 
 } // namespace jet::compiler
\ No newline at end of file
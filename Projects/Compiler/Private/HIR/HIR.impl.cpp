@@ -0,0 +1,729 @@
+module;
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+#include <memory_resource>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+module Jet.Compiler.HIR;
+
+import Jet.Parser.JetGrammar;
+import Jet.Comp.Format;
+
+namespace jet::compiler::hir
+{
+
+using RT    = parser::JetGrammarRuleType;
+using AST   = comp::peg::AST;
+using Entry = AST::Entry;
+
+/// Maps the offsets of the captured rules to their types.
+struct RuleTypes
+{
+  DynArray<RT> by_offset;
+
+  [[nodiscard]]
+  auto of(Entry const& entry) const -> RT
+  {
+    return entry.rule_offset < by_offset.size() ? by_offset[entry.rule_offset] : RT::MAX;
+  }
+};
+
+/// Upper bounds of the number of nodes of every type, counted from the entries of the AST.
+struct NodeBounds
+{
+  usize exprs      = 0;
+  usize stmts      = 0;
+  usize variables  = 0;
+  usize functions  = 0;
+  usize use_items  = 0;
+  usize submodules = 0;
+  usize symbols    = 0;
+  usize arguments  = 0;
+};
+
+/// Walks the entries of the AST (in their pre-order) and builds the nodes.
+/// The children of a node are lowered before the node, so the elements of a list are gathered
+/// on a stack and copied to the list table at once, which keeps every list contiguous.
+struct Lowering
+{
+  AST const&       ast;
+  StringView       source;
+  RuleTypes const& rules;
+  Module&          hir;
+  Interner&        interner;
+
+  Table<ExprID> expr_stack;
+  Table<StmtID> stmt_stack;
+  Table<Index>  entry_stack;
+
+  Opt<LoweringError> error;
+
+  [[nodiscard]]
+  auto type_of(Index entry_id) const -> RT
+  {
+    return rules.of(ast.entries[entry_id]);
+  }
+
+  /// @returns Whether the entry is the condition of an `IfMust` rule (e.g. the `fn` of a `DeclFunction`).
+  /// The parser captures it as a childless entry of the rule, followed by the entry of the rest of the rule.
+  [[nodiscard]]
+  auto is_condition(Index entry_id) const -> bool
+  {
+    if (entry_id >= ast.entries.size() || ast.entries[entry_id].num_children != 0) {
+      return false;
+    }
+    switch (type_of(entry_id)) {
+    case RT::DeclVariable:
+    case RT::DeclFunction:
+    case RT::ElseStatement:
+    case RT::IfStatement:
+    case RT::LoopStatement:
+    case RT::WhileLoopStatement:
+    case RT::ForLoopStatement:
+    case RT::UseStatement:
+    case RT::SubmoduleDefinition: return true;
+    default: return false;
+    }
+  }
+
+  /// @returns The entry, or the entry of the rest of the rule if it is the condition of an `IfMust` rule.
+  [[nodiscard]]
+  auto skip_condition(Index entry_id) const -> Index
+  {
+    return is_condition(entry_id) ? ast.entries[entry_id].next_id_same_nesting.id : entry_id;
+  }
+
+  /// @note The children are walked until the next sibling of the parent, as the `num_children` of an entry
+  /// counts the conditions of its `IfMust` children as well.
+  [[nodiscard]]
+  auto first_child(Index entry_id) const -> Index
+  {
+    return skip_condition(entry_id + 1);
+  }
+
+  [[nodiscard]]
+  auto next_sibling(Index entry_id) const -> Index
+  {
+    return skip_condition(ast.entries[entry_id].next_id_same_nesting.id);
+  }
+
+  /// @returns The start of the entry, including the condition of its rule.
+  [[nodiscard]]
+  auto start_of(Index entry_id) const -> usize
+  {
+    auto const previous = entry_id - 1;
+    if (entry_id != 0 && is_condition(previous) && ast.entries[previous].next_id_same_nesting.id == entry_id) {
+      return ast.entries[previous].start_pos;
+    }
+    return ast.entries[entry_id].start_pos;
+  }
+
+  [[nodiscard]]
+  auto text_of(Index entry_id) const -> StringView
+  {
+    auto& entry = ast.entries[entry_id];
+    return source.substr(entry.start_pos, entry.end_pos - entry.start_pos);
+  }
+
+  auto fail(Index entry_id, StringView details) -> void
+  {
+    if (!error) {
+      error = LoweringError{ast.entries[entry_id].start_pos, String(details)};
+    }
+  }
+
+  auto add(Expr expr) -> ExprID
+  {
+    hir.exprs.push_back(expr);
+    return ExprID{Index(hir.exprs.size() - 1)};
+  }
+
+  auto add(Stmt stmt) -> StmtID
+  {
+    hir.stmts.push_back(stmt);
+    return StmtID{Index(hir.stmts.size() - 1)};
+  }
+
+  /// Moves the elements above @p base from the stack to the list table.
+  template <typename T>
+  auto pop_list(Table<T>& stack, usize base, Table<T>& lists) -> List<T>
+  {
+    auto list = List<T>{Index(lists.size()), Index(stack.size() - base)};
+    lists.insert(lists.end(), stack.begin() + isize(base), stack.end());
+    stack.resize(base);
+    return list;
+  }
+
+  auto lower_items(Index entry_id) -> List<StmtID>;
+  auto lower_statements(Index entry_id) -> List<StmtID>;
+  auto lower_statement(Index entry_id) -> StmtID;
+  auto lower_function(Index entry_id) -> StmtID;
+  auto lower_variable(Index entry_id, Index end, Index variable) -> void;
+  auto lower_use(Index entry_id) -> StmtID;
+  auto lower_use_item(Index entry_id, Index item) -> void;
+  auto lower_submodule(Index entry_id) -> StmtID;
+  auto lower_path(Index& entry_id, Index end) -> List<Symbol>;
+  auto lower_type(Index explicit_type_id) -> Symbol;
+
+  auto lower_expression(Index entry_id) -> ExprID;
+  auto lower_operand(Index& entry_id, Index end) -> ExprID;
+  auto lower_primary(Index entry_id) -> ExprID;
+  auto lower_postfix(Index entry_id, ExprID operand) -> ExprID;
+  auto lower_literal(Index entry_id, ExprKind kind) -> ExprID;
+};
+
+static auto use_rule_types() -> RuleTypes const&;
+static auto count_nodes(AST const& ast, RuleTypes const& rules) -> NodeBounds;
+
+Module::Module(Arena& arena)
+  : exprs(arena.resource())
+  , stmts(arena.resource())
+  , variables(arena.resource())
+  , functions(arena.resource())
+  , use_items(arena.resource())
+  , submodules(arena.resource())
+  , expr_lists(arena.resource())
+  , stmt_lists(arena.resource())
+  , symbol_lists(arena.resource())
+{
+}
+
+auto lower_module(ModuleParse const& parse, Arena& arena, Interner& interner) -> Result<Module, LoweringError>
+{
+  auto& rules = use_rule_types();
+  auto& ast   = parse.ast;
+  if (ast.entries.empty() || rules.of(ast.entries[0]) != RT::ModuleLevelStatements) {
+    return error(LoweringError{0, "the module was not parsed"});
+  }
+
+  auto const bounds = count_nodes(ast, rules);
+
+  auto hir     = Module(arena);
+  hir.interner = &interner;
+  hir.exprs.reserve(bounds.exprs);
+  hir.stmts.reserve(bounds.stmts);
+  hir.variables.reserve(bounds.variables);
+  hir.functions.reserve(bounds.functions);
+  hir.use_items.reserve(bounds.use_items);
+  hir.submodules.reserve(bounds.submodules);
+  hir.expr_lists.reserve(bounds.arguments);
+  hir.stmt_lists.reserve(bounds.stmts);
+  hir.symbol_lists.reserve(bounds.symbols);
+
+  auto lowering = Lowering{
+    .ast         = ast,
+    .source      = parse.content,
+    .rules       = rules,
+    .hir         = hir,
+    .interner    = interner,
+    .expr_stack  = Table<ExprID>(arena.resource()),
+    .stmt_stack  = Table<StmtID>(arena.resource()),
+    .entry_stack = Table<Index>(arena.resource()),
+  };
+  lowering.expr_stack.reserve(bounds.arguments);
+  lowering.stmt_stack.reserve(bounds.stmts);
+  lowering.entry_stack.reserve(bounds.exprs);
+
+  hir.items = lowering.lower_items(0);
+  if (lowering.error) {
+    return error(std::move(*lowering.error));
+  }
+  return success(std::move(hir));
+}
+
+/// Lowers the children of a `ModuleLevelStatements` entry.
+auto Lowering::lower_items(Index entry_id) -> List<StmtID>
+{
+  auto const base = stmt_stack.size();
+
+  auto const end = next_sibling(entry_id);
+  for (auto child = first_child(entry_id); child != end; child = next_sibling(child)) {
+    switch (type_of(child)) {
+    case RT::DeclFunction: stmt_stack.push_back(lower_function(child)); break;
+    case RT::UseStatement: stmt_stack.push_back(lower_use(child)); break;
+    case RT::SubmoduleDefinition: stmt_stack.push_back(lower_submodule(child)); break;
+    default: fail(child, "unexpected module-level entry"); break;
+    }
+  }
+  return pop_list(stmt_stack, base, hir.stmt_lists);
+}
+
+/// Lowers the `Statement` children of a `CodeBlock` entry.
+auto Lowering::lower_statements(Index entry_id) -> List<StmtID>
+{
+  auto const base = stmt_stack.size();
+
+  auto const end = next_sibling(entry_id);
+  for (auto child = first_child(entry_id); child != end; child = next_sibling(child)) {
+    stmt_stack.push_back(lower_statement(child));
+  }
+  return pop_list(stmt_stack, base, hir.stmt_lists);
+}
+
+/// Lowers a `Statement` entry.
+auto Lowering::lower_statement(Index entry_id) -> StmtID
+{
+  auto const entry_type = type_of(entry_id);
+  if (entry_type != RT::Statement && entry_type != RT::ElseStatement) {
+    fail(entry_id, "expected a statement");
+    return {};
+  }
+
+  auto const inner = first_child(entry_id);
+  auto const pos   = start_of(inner);
+  if (entry_type == RT::ElseStatement) {
+    // `else` wraps a statement.
+    return lower_statement(inner);
+  }
+
+  switch (type_of(inner)) {
+  case RT::DeclVariable: {
+    hir.variables.push_back(Variable{.is_mutable = text_of(entry_id).starts_with("var")});
+    auto const index = Index(hir.variables.size() - 1);
+    lower_variable(first_child(inner), next_sibling(inner), index);
+    return add(Stmt{.kind = StmtKind::Variable, .pos = pos, .index = index});
+  }
+  case RT::DeclFunction: return lower_function(inner);
+  case RT::UseStatement: return lower_use(inner);
+  case RT::ReturnStatement: {
+    auto value = ExprID();
+    if (ast.entries[inner].num_children != 0) {
+      value = lower_expression(first_child(inner));
+    }
+    return add(Stmt{.kind = StmtKind::Return, .pos = pos, .expr = value});
+  }
+  case RT::IfStatement: {
+    auto const condition = first_child(inner);
+    auto const then_body = next_sibling(condition);
+
+    auto stmt = Stmt{.kind = StmtKind::If, .pos = pos};
+    stmt.expr = lower_expression(condition);
+    stmt.body = lower_statement(then_body);
+    if (ast.entries[inner].num_children > 2) {
+      stmt.else_body = lower_statement(next_sibling(then_body));
+    }
+    return add(stmt);
+  }
+  case RT::LoopStatement: {
+    auto stmt = Stmt{.kind = StmtKind::Loop, .pos = pos};
+    stmt.body = lower_statement(first_child(inner));
+    return add(stmt);
+  }
+  case RT::WhileLoopStatement: {
+    auto const condition = first_child(inner);
+
+    auto stmt = Stmt{.kind = StmtKind::While, .pos = pos};
+    stmt.expr = lower_expression(condition);
+    stmt.body = lower_statement(next_sibling(condition));
+    return add(stmt);
+  }
+  case RT::ForLoopStatement: {
+    auto const init      = first_child(inner);
+    auto const condition = next_sibling(init);
+    auto const step      = next_sibling(condition);
+
+    auto stmt = Stmt{.kind = StmtKind::For, .pos = pos};
+    stmt.init = lower_statement(init);
+    stmt.expr = lower_expression(condition);
+    stmt.step = lower_expression(step);
+    stmt.body = lower_statement(next_sibling(step));
+    return add(stmt);
+  }
+  case RT::CodeBlock: {
+    auto stmt       = Stmt{.kind = StmtKind::Block, .pos = pos};
+    stmt.statements = lower_statements(inner);
+    return add(stmt);
+  }
+  case RT::Expression: {
+    auto stmt = Stmt{.kind = StmtKind::Expression, .pos = pos};
+    stmt.expr = lower_expression(inner);
+    return add(stmt);
+  }
+  default: fail(inner, "unexpected statement"); return {};
+  }
+}
+
+/// Lowers a `DeclFunction` entry: `Name`, optional `FunctionParameters` and `ExplicitType`, then `CodeBlock`.
+auto Lowering::lower_function(Index entry_id) -> StmtID
+{
+  // The slot is taken before the body, which may declare nested functions.
+  hir.functions.emplace_back();
+  auto const index = Index(hir.functions.size() - 1);
+
+  auto function = Function();
+  auto child    = first_child(entry_id);
+  function.name = interner.intern(text_of(child));
+  child         = next_sibling(child);
+
+  if (type_of(child) == RT::FunctionParameters) {
+    // Every parameter starts with its name. The slots are taken first, so the parameters stay consecutive
+    // even if their default values declare variables.
+    auto const params_end = next_sibling(child);
+    auto       num_params = Index(0);
+    for (auto param = first_child(child); param != params_end; param = next_sibling(param)) {
+      num_params += type_of(param) == RT::Name ? 1 : 0;
+    }
+
+    function.parameters = List<Variable>{Index(hir.variables.size()), num_params};
+    hir.variables.resize(hir.variables.size() + num_params);
+
+    auto param_index = function.parameters.first;
+    for (auto param = first_child(child); param != params_end; param = next_sibling(param)) {
+      if (type_of(param) != RT::Name) {
+        continue;
+      }
+
+      // The parameter spans its name and the entries that follow it.
+      auto param_end = next_sibling(param);
+      while (param_end != params_end && type_of(param_end) != RT::Name) {
+        param_end = next_sibling(param_end);
+      }
+      lower_variable(param, param_end, param_index++);
+    }
+    child = params_end;
+  }
+
+  if (type_of(child) == RT::ExplicitType) {
+    function.return_type = lower_type(child);
+    child                = next_sibling(child);
+  }
+
+  if (type_of(child) != RT::CodeBlock) {
+    fail(child, "expected the body of the function");
+    return {};
+  }
+  function.body        = lower_statements(child);
+  hir.functions[index] = function;
+
+  return add(Stmt{.kind = StmtKind::Function, .pos = start_of(entry_id), .index = index});
+}
+
+/// Lowers a variable or a function parameter: `Name`, optional `ExplicitType` and `Initializer`.
+/// @param entry_id The `Name` entry.
+/// @param end The entry after the variable.
+/// @param variable The index of the variable, taken before its initializer is lowered.
+auto Lowering::lower_variable(Index entry_id, Index end, Index variable) -> void
+{
+  auto result = hir.variables[variable];
+  result.name = interner.intern(text_of(entry_id));
+  auto child  = next_sibling(entry_id);
+
+  if (child != end && type_of(child) == RT::ExplicitType) {
+    result.type = lower_type(child);
+    child       = next_sibling(child);
+  }
+  if (child != end && type_of(child) == RT::Initializer) {
+    result.initializer = lower_expression(first_child(child));
+  }
+  hir.variables[variable] = result;
+}
+
+/// Lowers a `UseStatement` entry. Its items (and the items of their groups) are consecutive.
+auto Lowering::lower_use(Index entry_id) -> StmtID
+{
+  auto const first = Index(hir.use_items.size());
+  auto const count = ast.entries[entry_id].num_children;
+  hir.use_items.resize(hir.use_items.size() + count);
+
+  auto child = first_child(entry_id);
+  for (auto i = Index(0); i < count; ++i, child = next_sibling(child)) {
+    lower_use_item(child, first + i);
+  }
+  return add(Stmt{.kind = StmtKind::Use, .pos = start_of(entry_id), .index = first, .count = count});
+}
+
+/// Lowers a `UseIdentifierSeq` entry: the names of the path, then an alias, a group or nothing.
+auto Lowering::lower_use_item(Index entry_id, Index item) -> void
+{
+  auto const end = next_sibling(entry_id);
+
+  auto result    = UseItem();
+  auto child     = first_child(entry_id);
+  result.path    = lower_path(child, end);
+  result.is_glob = text_of(entry_id).ends_with('*');
+
+  if (child != end && type_of(child) == RT::Name) {
+    result.alias = interner.intern(text_of(child));
+  }
+  else if (child != end) {
+    auto const first = Index(hir.use_items.size());
+    auto       count = Index(0);
+    for (auto nested = child; nested != end; nested = next_sibling(nested)) {
+      ++count;
+    }
+
+    result.group = List<UseItem>{first, count};
+    hir.use_items.resize(hir.use_items.size() + count);
+    for (auto i = Index(0); i < count; ++i, child = next_sibling(child)) {
+      lower_use_item(child, first + i);
+    }
+  }
+  hir.use_items[item] = result;
+}
+
+/// Lowers a `SubmoduleDefinition` entry: the names of the path, then optional `ModuleLevelStatements`.
+auto Lowering::lower_submodule(Index entry_id) -> StmtID
+{
+  hir.submodules.emplace_back();
+  auto const index = Index(hir.submodules.size() - 1);
+  auto const end   = next_sibling(entry_id);
+
+  auto submodule = Submodule();
+  auto child     = first_child(entry_id);
+  submodule.path = lower_path(child, end);
+  if (child != end && type_of(child) == RT::ModuleLevelStatements) {
+    submodule.items = lower_items(child);
+  }
+  hir.submodules[index] = submodule;
+
+  return add(Stmt{.kind = StmtKind::Submodule, .pos = start_of(entry_id), .index = index});
+}
+
+/// Lowers consecutive `Name` entries separated with `::`. Stops before a name that is not separated with `::`
+/// (an alias) or before an entry that is not a name.
+auto Lowering::lower_path(Index& entry_id, Index end) -> List<Symbol>
+{
+  auto path     = List<Symbol>{Index(hir.symbol_lists.size()), 0};
+  auto prev_end = usize(0);
+  while (entry_id != end && type_of(entry_id) == RT::Name) {
+    auto const& entry = ast.entries[entry_id];
+    if (path.count != 0 && source.substr(prev_end, entry.start_pos - prev_end).find("::") == StringView::npos) {
+      break;
+    }
+
+    hir.symbol_lists.push_back(interner.intern(text_of(entry_id)));
+    ++path.count;
+    prev_end = entry.end_pos;
+    entry_id = next_sibling(entry_id);
+  }
+  return path;
+}
+
+/// Lowers an `ExplicitType` entry (`Type` with a `Name`).
+auto Lowering::lower_type(Index explicit_type_id) -> Symbol
+{
+  auto const type = first_child(explicit_type_id);
+  return interner.intern(text_of(type));
+}
+
+/// Lowers an `Expression` entry: a single operand, or an operator entry that nests the others.
+auto Lowering::lower_expression(Index entry_id) -> ExprID
+{
+  if (type_of(entry_id) != RT::Expression) {
+    fail(entry_id, "expected an expression");
+    return {};
+  }
+
+  auto child = first_child(entry_id);
+  return lower_operand(child, next_sibling(entry_id));
+}
+
+/// Lowers a single operand: `PrefixOperator*`, a primary entry, then `PostfixOperator*`.
+/// @param entry_id The first entry of the operand. Moved past the operand.
+auto Lowering::lower_operand(Index& entry_id, Index end) -> ExprID
+{
+  auto const prefixes_base = entry_stack.size();
+  while (entry_id != end && type_of(entry_id) == RT::PrefixOperator) {
+    entry_stack.push_back(entry_id);
+    entry_id = next_sibling(entry_id);
+  }
+
+  if (entry_id == end) {
+    fail(entry_id - 1, "expected an operand");
+    entry_stack.resize(prefixes_base);
+    return {};
+  }
+
+  auto operand = lower_primary(entry_id);
+  entry_id     = next_sibling(entry_id);
+  while (entry_id != end && type_of(entry_id) == RT::PostfixOperator) {
+    operand  = lower_postfix(entry_id, operand);
+    entry_id = next_sibling(entry_id);
+  }
+
+  // The innermost prefix binds first.
+  while (entry_stack.size() > prefixes_base) {
+    auto const prefix = entry_stack.back();
+    entry_stack.pop_back();
+
+    auto const text = text_of(prefix);
+    auto       op   = UnaryOp::Not;
+    if (text.starts_with("++")) {
+      op = UnaryOp::PreIncrement;
+    }
+    else if (text.starts_with("--")) {
+      op = UnaryOp::PreDecrement;
+    }
+    else if (text.starts_with("&")) {
+      op = UnaryOp::AddressOf;
+    }
+    else if (text.starts_with("*")) {
+      op = UnaryOp::Deref;
+    }
+    operand = add(Expr{.kind = ExprKind::Unary, .unary_op = op, .pos = ast.entries[prefix].start_pos, .lhs = operand});
+  }
+  return operand;
+}
+
+/// Lowers a name, a literal, a code block, an expression in parentheses or an operator entry.
+auto Lowering::lower_primary(Index entry_id) -> ExprID
+{
+  static auto constexpr BINARY_OPS = Array<std::pair<RT, BinaryOp>, 19>{{
+    {RT::MemberAccess, BinaryOp::MemberAccess},
+    {RT::ScopeResolution, BinaryOp::ScopeResolution},
+    {RT::Equal, BinaryOp::Equal},
+    {RT::NotEqual, BinaryOp::NotEqual},
+    {RT::LessEqual, BinaryOp::LessEqual},
+    {RT::GreaterEqual, BinaryOp::GreaterEqual},
+    {RT::Less, BinaryOp::Less},
+    {RT::Greater, BinaryOp::Greater},
+    {RT::AddAssign, BinaryOp::AddAssign},
+    {RT::SubAssign, BinaryOp::SubAssign},
+    {RT::MulAssign, BinaryOp::MulAssign},
+    {RT::DivAssign, BinaryOp::DivAssign},
+    {RT::ModAssign, BinaryOp::ModAssign},
+    {RT::Assign, BinaryOp::Assign},
+    {RT::Add, BinaryOp::Add},
+    {RT::Sub, BinaryOp::Sub},
+    {RT::Mul, BinaryOp::Mul},
+    {RT::Div, BinaryOp::Div},
+    {RT::Mod, BinaryOp::Mod},
+  }};
+
+  auto const pos = ast.entries[entry_id].start_pos;
+  switch (auto const entry_type = type_of(entry_id)) {
+  case RT::Name: return add(Expr{.kind = ExprKind::Name, .pos = pos, .symbol = interner.intern(text_of(entry_id))});
+  case RT::IntegerLiteral: return lower_literal(entry_id, ExprKind::Integer);
+  case RT::RealLiteral: return lower_literal(entry_id, ExprKind::Real);
+  case RT::StringLiteral: {
+    auto const text    = text_of(entry_id);
+    auto const content = text.substr(1, text.size() - 2);
+    return add(Expr{.kind = ExprKind::String, .pos = pos, .symbol = interner.intern(content)});
+  }
+  case RT::CodeBlock: return add(Expr{.kind = ExprKind::Block, .pos = pos, .statements = lower_statements(entry_id)});
+  case RT::Expression: return lower_expression(entry_id);
+  default: {
+    for (auto [rule_type, op] : BINARY_OPS) {
+      if (rule_type != entry_type) {
+        continue;
+      }
+
+      // Both operands are nested in the operator entry.
+      auto const end   = next_sibling(entry_id);
+      auto       child = first_child(entry_id);
+      auto const lhs   = lower_operand(child, end);
+      auto const rhs   = lower_operand(child, end);
+      return add(Expr{.kind = ExprKind::Binary, .binary_op = op, .pos = pos, .lhs = lhs, .rhs = rhs});
+    }
+
+    fail(entry_id, "unexpected expression");
+    return {};
+  }
+  }
+}
+
+/// Lowers a `PostfixOperator` entry: `++`, `--`, or a call or subscript with the arguments nested.
+auto Lowering::lower_postfix(Index entry_id, ExprID operand) -> ExprID
+{
+  auto const text = text_of(entry_id);
+  auto const pos  = ast.entries[entry_id].start_pos;
+  if (text.starts_with("++") || text.starts_with("--")) {
+    auto const op = text[0] == '+' ? UnaryOp::PostIncrement : UnaryOp::PostDecrement;
+    return add(Expr{.kind = ExprKind::Unary, .unary_op = op, .pos = pos, .lhs = operand});
+  }
+
+  auto const base = expr_stack.size();
+  auto       arg  = first_child(entry_id);
+  for (auto i = Index(0); i < ast.entries[entry_id].num_children; ++i, arg = next_sibling(arg)) {
+    expr_stack.push_back(lower_expression(arg));
+  }
+
+  auto const kind = text.starts_with("(") ? ExprKind::Call : ExprKind::Subscript;
+  return add(Expr{.kind = kind, .pos = pos, .lhs = operand, .arguments = pop_list(expr_stack, base, hir.expr_lists)});
+}
+
+/// Lowers an `IntegerLiteral` or a `RealLiteral` entry.
+auto Lowering::lower_literal(Index entry_id, ExprKind kind) -> ExprID
+{
+  auto const text = text_of(entry_id);
+  auto       expr = Expr{.kind = kind, .pos = ast.entries[entry_id].start_pos};
+
+  auto result = std::from_chars_result();
+  if (kind == ExprKind::Integer) {
+    result = std::from_chars(text.data(), text.data() + text.size(), expr.integer);
+  }
+  else {
+    result = std::from_chars(text.data(), text.data() + text.size(), expr.real);
+  }
+
+  if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+    fail(entry_id, comp::fmt::format("invalid literal `{}`", text));
+  }
+  else if (kind == ExprKind::Integer && expr.integer > u64(std::numeric_limits<i64>::max())) {
+    // The integers are signed, up to `i64`.
+    fail(entry_id, comp::fmt::format("integer literal out of range `{}`", text));
+  }
+  return add(expr);
+}
+
+/// @returns The types of the rules of the grammar (built once).
+static auto use_rule_types() -> RuleTypes const&
+{
+  static auto const rule_types = [] {
+    auto& rules = parser::use_grammar().rules;
+
+    auto result   = RuleTypes();
+    auto max_rule = usize(0);
+    for (auto i = usize(0); i < usize(RT::MAX); ++i) {
+      max_rule = std::max(max_rule, rules[RT(i)].offset);
+    }
+
+    result.by_offset.resize(max_rule + 1, RT::MAX);
+    for (auto i = usize(0); i < usize(RT::MAX); ++i) {
+      result.by_offset[rules[RT(i)].offset] = RT(i);
+    }
+    return result;
+  }();
+  return rule_types;
+}
+
+/// @returns The upper bounds of the number of nodes, in a single pass over the entries.
+static auto count_nodes(AST const& ast, RuleTypes const& rules) -> NodeBounds
+{
+  auto counts = Array<usize, usize(RT::MAX) + 1>();
+  for (auto& entry : ast.entries) {
+    ++counts[usize(rules.of(entry))];
+  }
+
+  auto const count = [&](RT type) {
+    return counts[usize(type)];
+  };
+
+  auto num_operators = usize(0);
+  for (auto type = usize(RT::MemberAccess); type <= usize(RT::Mod); ++type) {
+    num_operators += counts[type];
+  }
+
+  auto const num_literals = count(RT::IntegerLiteral) + count(RT::RealLiteral) + count(RT::StringLiteral);
+  auto const num_unary    = count(RT::PrefixOperator) + count(RT::PostfixOperator);
+  auto const num_items    = count(RT::DeclFunction) + count(RT::UseStatement) + count(RT::SubmoduleDefinition);
+
+  // Names count as expressions and as parameters, even those that are neither.
+  auto bounds       = NodeBounds();
+  bounds.exprs      = count(RT::Name) + num_literals + count(RT::CodeBlock) + num_unary + num_operators;
+  bounds.stmts      = count(RT::Statement) + num_items;
+  bounds.variables  = count(RT::DeclVariable) + count(RT::Name);
+  bounds.functions  = count(RT::DeclFunction);
+  bounds.use_items  = count(RT::UseIdentifierSeq);
+  bounds.submodules = count(RT::SubmoduleDefinition);
+  bounds.symbols    = count(RT::Name) + count(RT::StringLiteral);
+  bounds.arguments  = count(RT::Expression);
+  return bounds;
+}
+
+} // namespace jet::compiler::hir
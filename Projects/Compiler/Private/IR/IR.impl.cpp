@@ -0,0 +1,1303 @@
+module;
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+module Jet.Compiler.IR;
+
+import Jet.Core.File;
+import Jet.Comp.Format;
+
+namespace jet::compiler::ir
+{
+
+namespace fmt = comp::fmt;
+
+using hir::Expr;
+using hir::ExprID;
+using hir::ExprKind;
+using hir::Stmt;
+using hir::StmtID;
+using hir::StmtKind;
+using hir::Symbol;
+
+/// The types of the values, ordered by their rank in the arithmetic conversions
+/// (an unsigned type comes after the signed one of the same width, like in C).
+enum class Type : u8
+{
+  Void,
+  Bool,
+  I8,
+  U8,
+  I16,
+  U16,
+  I32,
+  U32,
+  I64,
+  U64,
+  F32,
+  F64,
+  Ptr,
+};
+
+enum class ValueKind : u8
+{
+  /// No value (e.g. the result of a call to a `void` function).
+  None,
+
+  /// A register (`%v<bits>`).
+  Register,
+
+  /// An integer constant (`bits` is the value, sign-extended for the signed types).
+  Integer,
+
+  /// A floating-point constant (`bits` holds the `f64`).
+  Real,
+
+  /// A string constant (`@.str.<bits>`).
+  String,
+};
+
+struct Value
+{
+  Type      type = Type::Void;
+  ValueKind kind = ValueKind::None;
+  u64       bits = 0;
+};
+
+/// The text of an operand, formatted without allocations.
+struct Operand
+{
+  Array<char, 32> chars = {};
+  usize           size  = 0;
+
+  [[nodiscard]]
+  auto view() const -> StringView
+  {
+    return StringView(chars.data(), size);
+  }
+};
+
+/// A variable in scope.
+struct Local
+{
+  Symbol name;
+  Type   type = Type::I32;
+
+  /// The register that holds the address of the variable.
+  u32 slot = 0;
+};
+
+/// The labels that `break` and `continue` jump to.
+struct LoopTargets
+{
+  u32 break_label    = 0;
+  u32 continue_label = 0;
+};
+
+static auto is_integer(Type type) -> bool
+{
+  return type >= Type::Bool && type <= Type::U64;
+}
+
+static auto is_unsigned(Type type) -> bool
+{
+  return type == Type::U8 || type == Type::U16 || type == Type::U32 || type == Type::U64;
+}
+
+static auto is_real(Type type) -> bool
+{
+  return type == Type::F32 || type == Type::F64;
+}
+
+static auto type_name(Type type) -> StringView
+{
+  // LLVM does not tell the signed integers from the unsigned ones, the instructions do.
+  static auto constexpr NAMES = Array<StringView, 13>{
+    "void", "i1", "i8", "i8", "i16", "i16", "i32", "i32", "i64", "i64", "float", "double", "ptr",
+  };
+  return NAMES[usize(type)];
+}
+
+static auto is_literal(Expr const& expr) -> bool
+{
+  return expr.kind == ExprKind::Integer || expr.kind == ExprKind::Real || expr.kind == ExprKind::String;
+}
+
+static auto width_of(Type type) -> u32
+{
+  static auto constexpr WIDTHS = Array<u32, 13>{0, 1, 8, 8, 16, 16, 32, 32, 64, 64, 32, 64, 64};
+  return WIDTHS[usize(type)];
+}
+
+/// @returns The bits of an integer constant converted to the integer type (truncated, then extended).
+static auto wrap_integer(u64 bits, Type type) -> u64
+{
+  auto const width = width_of(type);
+  if (width >= 64) {
+    return bits;
+  }
+
+  auto const mask  = (u64(1) << width) - 1;
+  auto const value = bits & mask;
+  auto const sign  = u64(1) << (width - 1);
+  return !is_unsigned(type) && (value & sign) != 0 ? value | ~mask : value;
+}
+
+/// A top-level function of a used module.
+struct ImportedFunction
+{
+  UsedModule const* module = nullptr;
+
+  /// The index in the functions of its module.
+  u32 index = 0;
+
+  /// No function of the same name comes before it in its module, so its name in the IR is not made unique.
+  bool is_first_of_name = true;
+
+  /// The next imported function of the same name (@c hir::NONE - none).
+  u32 next_of_name = hir::NONE;
+
+  /// Set once the function is declared (when it is called for the first time).
+  String ir_name;
+  Type   result_type = Type::Void;
+};
+
+/// Emits a single module. The text of the current function is gathered in reused buffers:
+/// the `alloca`s of the variables go to the entry block, the rest to the body.
+/// The string constants are written directly to the output, before the function that uses them.
+struct Emitter
+{
+  hir::Module const& module;
+  core::FileWriter&  out;
+  EmitContext const& context;
+
+  DynArray<String> ir_names;
+  DynArray<Type>   result_types;
+  UMap<u32, u32>   functions_by_name;
+  UMap<u32, u32>   strings_by_symbol;
+
+  /// The functions of the used modules. Those of the same name are chained from the last one.
+  DynArray<ImportedFunction> imports;
+  UMap<u32, u32>             imports_by_name;
+
+  /// The declarations of the called functions of the used modules, written after the functions.
+  String declarations;
+
+  /// The path that qualifies the name of a called function (`a::b` of `a::b::f`).
+  String qualifier;
+
+  String header;
+  String allocas;
+  String body;
+
+  /// The decoded content of a string literal.
+  String scratch;
+
+  /// The format string of a `printf` call.
+  String printf_format;
+
+  DynArray<Local>       locals;
+  DynArray<LoopTargets> loops;
+  DynArray<Value>       value_stack;
+
+  Type result_type = Type::Void;
+  u32  next_value  = 0;
+  u32  next_label  = 0;
+  u32  next_string = 0;
+  bool terminated  = false;
+  bool uses_printf = false;
+
+  Opt<IRError> error;
+
+  auto fail(usize pos, StringView details) -> void
+  {
+    if (!error) {
+      error = IRError{pos, String(details)};
+    }
+  }
+
+  /// Appends a formatted line to the body, in the current block.
+  template <typename... Args>
+  auto emit(fmt::format_string<Args...> format, Args&&... args) -> void
+  {
+    this->ensure_block();
+    body += "  ";
+    fmt::format_to(std::back_inserter(body), format, std::forward<Args>(args)...);
+    body += '\n';
+  }
+
+  /// Appends an instruction that produces a value of the given type.
+  template <typename... Args>
+  auto emit_value(Type type, fmt::format_string<Args...> format, Args&&... args) -> Value
+  {
+    this->ensure_block();
+    auto const value = Value{type, ValueKind::Register, next_value++};
+    fmt::format_to(std::back_inserter(body), "  %v{} = ", value.bits);
+    fmt::format_to(std::back_inserter(body), format, std::forward<Args>(args)...);
+    body += '\n';
+    return value;
+  }
+
+  /// Appends an instruction that ends the current block.
+  template <typename... Args>
+  auto emit_terminator(fmt::format_string<Args...> format, Args&&... args) -> void
+  {
+    this->emit(format, std::forward<Args>(args)...);
+    terminated = true;
+  }
+
+  auto emit_label(u32 label) -> void
+  {
+    if (!terminated) {
+      this->emit_terminator("br label %bb{}", label);
+    }
+    fmt::format_to(std::back_inserter(body), "bb{}:\n", label);
+    terminated = false;
+  }
+
+  /// Starts a new (unreachable) block if the current one has ended, e.g. for the statements after `ret`.
+  auto ensure_block() -> void
+  {
+    if (terminated) {
+      terminated = false;
+      fmt::format_to(std::back_inserter(body), "bb{}:\n", next_label++);
+    }
+  }
+
+  auto operand(Value const& value) const -> Operand;
+  auto parse_type(Symbol symbol, usize pos) -> Type;
+  auto find_local(Symbol name) const -> Local const*;
+  auto declare_local(Symbol name, Type type) -> Local const&;
+
+  auto result_type_of(hir::Function const& function) -> Type;
+  auto collect_imports() -> void;
+  auto find_import(Symbol name, usize pos) -> ImportedFunction*;
+  auto declare_import(ImportedFunction& import) -> void;
+
+  auto emit_module() -> void;
+  auto emit_function(u32 index) -> void;
+  auto emit_statements(hir::List<StmtID> statements) -> void;
+  auto emit_statement(StmtID id) -> void;
+  auto emit_variable(hir::Variable const& variable, usize pos) -> void;
+
+  auto emit_expr(ExprID id) -> Value;
+  auto emit_binary(Expr const& expr) -> Value;
+  auto emit_assignment(Expr const& expr) -> Value;
+  auto emit_unary(Expr const& expr) -> Value;
+  auto emit_literal(hir::Module const& owner, Expr const& expr) -> Value;
+  auto emit_call(Expr const& expr) -> Value;
+  auto emit_call_of(
+    Expr const& expr, hir::Module const& owner, hir::Function const& function, StringView ir_name, Type type
+  ) -> Value;
+  auto emit_print(Expr const& expr, bool new_line) -> Value;
+  auto emit_string(StringView bytes) -> Value;
+
+  auto arithmetic(hir::BinaryOp op, Value lhs, Value rhs, usize pos) -> Value;
+  auto convert(Value value, Type type, usize pos) -> Value;
+  auto to_bool(Value value, usize pos) -> Value;
+};
+
+static auto decode_string(StringView content, String& result) -> void;
+static auto append_path(hir::Module const& module, Expr const& expr, String& path) -> bool;
+
+auto emit_llvm_ir(hir::Module const& module, core::FileWriter& out, EmitContext const& context) -> IRResult
+{
+  auto emitter = Emitter{.module = module, .out = out, .context = context};
+  emitter.emit_module();
+  if (emitter.error) {
+    return error(std::move(*emitter.error));
+  }
+  return success(std::monostate{});
+}
+
+auto Emitter::operand(Value const& value) const -> Operand
+{
+  auto result = Operand();
+  auto format = [&]<typename... Args>(fmt::format_string<Args...> text, Args&&... args) {
+    auto const written = fmt::format_to_n(result.chars.data(), result.chars.size(), text, std::forward<Args>(args)...);
+    result.size        = std::min(written.size, result.chars.size());
+  };
+
+  switch (value.kind) {
+  case ValueKind::Register: format("%v{}", value.bits); break;
+  case ValueKind::String: format("@.str.{}", value.bits); break;
+  case ValueKind::Integer:
+    if (value.type == Type::Bool) {
+      format("{}", value.bits != 0);
+    }
+    else if (value.type == Type::Ptr) {
+      format("null");
+    }
+    else if (is_unsigned(value.type)) {
+      format("{}", value.bits);
+    }
+    else {
+      format("{}", i64(value.bits));
+    }
+    break;
+  case ValueKind::Real: {
+    // LLVM reads the constants of both types as the hexadecimal representation of a double.
+    auto real = std::bit_cast<f64>(value.bits);
+    if (value.type == Type::F32) {
+      real = f64(f32(real));
+    }
+    format("0x{:016X}", std::bit_cast<u64>(real));
+    break;
+  }
+  case ValueKind::None: format("undef"); break;
+  }
+  return result;
+}
+
+/// @returns The type named by the symbol.
+auto Emitter::parse_type(Symbol symbol, usize pos) -> Type
+{
+  static auto constexpr TYPES = Array<std::pair<StringView, Type>, 13>{{
+    {"void", Type::Void},
+    {"bool", Type::Bool},
+    {"i8", Type::I8},
+    {"i16", Type::I16},
+    {"i32", Type::I32},
+    {"i64", Type::I64},
+    {"u8", Type::U8},
+    {"u16", Type::U16},
+    {"u32", Type::U32},
+    {"u64", Type::U64},
+    {"f32", Type::F32},
+    {"f64", Type::F64},
+    {"str", Type::Ptr},
+  }};
+
+  auto const name = module.get(symbol);
+  for (auto [type_text, type] : TYPES) {
+    if (type_text == name) {
+      return type;
+    }
+  }
+
+  fail(pos, fmt::format("unknown type `{}`", name));
+  return Type::I32;
+}
+
+auto Emitter::find_local(Symbol name) const -> Local const*
+{
+  // The innermost declaration shadows the others.
+  for (auto it = locals.rbegin(); it != locals.rend(); ++it) {
+    if (it->name == name) {
+      return &*it;
+    }
+  }
+  return nullptr;
+}
+
+auto Emitter::declare_local(Symbol name, Type type) -> Local const&
+{
+  auto const slot = next_value++;
+  fmt::format_to(std::back_inserter(allocas), "  %v{} = alloca {}\n", slot, type_name(type));
+  return locals.emplace_back(Local{name, type, slot});
+}
+
+/// @returns The name of the function in the IR. The first function of a name in its module is called by that name,
+/// the others (e.g. nested functions that are declared in several functions) get unique names. The functions of
+/// the modules other than the root one are qualified by the path of their module (`util::math` - `util.math.add`).
+static auto make_ir_name(StringView module_name, StringView name, u32 index, bool is_first_of_name) -> String
+{
+  auto result = String();
+  for (auto pos = usize(0); pos < module_name.size();) {
+    auto const end = std::min(module_name.find("::", pos), module_name.size());
+    result += module_name.substr(pos, end - pos);
+    result += '.';
+    pos = end + 2;
+  }
+
+  result += name;
+  if (!is_first_of_name) {
+    fmt::format_to(std::back_inserter(result), ".{}", index);
+  }
+  return result;
+}
+
+auto Emitter::result_type_of(hir::Function const& function) -> Type
+{
+  if (function.return_type.is_valid()) {
+    return parse_type(function.return_type, 0);
+  }
+
+  // `main` is the entry point of the program, so it returns the exit code.
+  return module.get(function.name) == "main" ? Type::I32 : Type::Void;
+}
+
+auto Emitter::emit_module() -> void
+{
+  auto const& functions = module.functions;
+
+  ir_names.reserve(functions.size());
+  result_types.reserve(functions.size());
+  for (auto i = u32(0); i < functions.size(); ++i) {
+    auto const& function = functions[i];
+    auto const  inserted = functions_by_name.try_emplace(function.name.id, i).second;
+    ir_names.push_back(make_ir_name(context.module_name, module.get(function.name), i, inserted));
+    result_types.push_back(result_type_of(function));
+  }
+  this->collect_imports();
+
+  for (auto i = u32(0); i < functions.size() && !error; ++i) {
+    this->emit_function(i);
+  }
+
+  out.write(declarations);
+  if (uses_printf) {
+    out.write("declare i32 @printf(ptr noundef, ...)\n");
+  }
+}
+
+/// @returns @c true if the path ends with the other one (`util::math` ends with `math` and with `util::math`).
+static auto ends_with_path(StringView path, StringView suffix) -> bool
+{
+  if (!path.ends_with(suffix)) {
+    return false;
+  }
+
+  auto const rest = path.substr(0, path.size() - suffix.size());
+  return rest.empty() || rest.ends_with("::");
+}
+
+/// Collects the top-level functions of the used modules, so that they can be called.
+/// The names are interned in the table shared by the modules of a build, so they are compared by their symbols.
+auto Emitter::collect_imports() -> void
+{
+  auto first_of_name = UMap<u32, u32>();
+  for (auto const& used : context.used_modules) {
+    auto const& functions = used.hir->functions;
+
+    first_of_name.clear();
+    for (auto i = u32(0); i < functions.size(); ++i) {
+      (void)first_of_name.try_emplace(functions[i].name.id, i);
+    }
+
+    for (auto item : used.hir->get(used.hir->items)) {
+      auto const& stmt = used.hir->get(item);
+      if (stmt.kind != StmtKind::Function) {
+        continue;
+      }
+
+      auto const index = u32(stmt.index);
+      auto const name  = functions[index].name.id;
+      auto&      added = imports.emplace_back(ImportedFunction{&used, index, first_of_name[name] == index});
+
+      auto const [last, inserted] = imports_by_name.try_emplace(name, u32(imports.size() - 1));
+      if (!inserted) {
+        added.next_of_name = last->second;
+        last->second       = u32(imports.size() - 1);
+      }
+    }
+  }
+}
+
+/// Finds the function of a used module called by the name and the @c qualifier (if any).
+/// @returns The function or @c nullptr if there is none or the call is ambiguous (reported).
+auto Emitter::find_import(Symbol name, usize pos) -> ImportedFunction*
+{
+  auto const it = imports_by_name.find(name.id);
+  if (it == imports_by_name.end()) {
+    return nullptr;
+  }
+
+  // `math::add` calls the `add` of a used module whose path ends with `math`.
+  auto found = static_cast<ImportedFunction*>(nullptr);
+  for (auto i = it->second; i != hir::NONE; i = imports[i].next_of_name) {
+    auto const module_name = imports[i].module->name;
+    if (!qualifier.empty() && !ends_with_path(module_name, qualifier)) {
+      continue;
+    }
+    if (found != nullptr) {
+      fail(
+        pos,
+        fmt::format("`{}` is defined in `{}` and in `{}`", module.get(name), found->module->name, module_name)
+      );
+      return nullptr;
+    }
+    found = &imports[i];
+  }
+  return found;
+}
+
+/// Declares the function of a used module, when it is called for the first time.
+auto Emitter::declare_import(ImportedFunction& import) -> void
+{
+  auto const& owner    = *import.module->hir;
+  auto const& function = owner.functions[import.index];
+
+  auto const name    = owner.get(function.name);
+  import.ir_name     = make_ir_name(import.module->name, name, import.index, import.is_first_of_name);
+  import.result_type = result_type_of(function);
+
+  fmt::format_to(std::back_inserter(declarations), "declare {} @{}(", type_name(import.result_type), import.ir_name);
+  auto const params = owner.get(function.parameters);
+  for (auto i = usize(0); i < params.size(); ++i) {
+    auto const type = params[i].type.is_valid() ? parse_type(params[i].type, 0) : Type::I32;
+    fmt::format_to(std::back_inserter(declarations), "{}{}", i == 0 ? "" : ", ", type_name(type));
+  }
+  declarations += ")\n";
+}
+
+auto Emitter::emit_function(u32 index) -> void
+{
+  auto const& function = module.functions[index];
+
+  header.clear();
+  allocas.clear();
+  body.clear();
+  locals.clear();
+  loops.clear();
+  result_type = result_types[index];
+  next_value  = 0;
+  next_label  = 0;
+  terminated  = false;
+
+  fmt::format_to(std::back_inserter(header), "define {} @{}(", type_name(result_type), ir_names[index]);
+
+  // The parameters are copied to variables, so they can be assigned.
+  auto const params = module.get(function.parameters);
+  for (auto i = usize(0); i < params.size(); ++i) {
+    auto const type = params[i].type.is_valid() ? parse_type(params[i].type, 0) : Type::I32;
+    fmt::format_to(std::back_inserter(header), "{}{} %p{}", i == 0 ? "" : ", ", type_name(type), i);
+
+    auto const& local = declare_local(params[i].name, type);
+    this->emit("store {} %p{}, ptr %v{}", type_name(type), i, local.slot);
+  }
+  header += ") {\nentry:\n";
+
+  this->emit_statements(function.body);
+  if (!terminated) {
+    if (result_type == Type::Void) {
+      this->emit_terminator("ret void");
+    }
+    else {
+      auto const zero = convert(Value{Type::I32, ValueKind::Integer, 0}, result_type, 0);
+      this->emit_terminator("ret {} {}", type_name(result_type), operand(zero).view());
+    }
+  }
+
+  out.write(header);
+  out.write(allocas);
+  out.write(body);
+  out.write("}\n\n");
+}
+
+auto Emitter::emit_statements(hir::List<StmtID> statements) -> void
+{
+  // The variables declared in the block go out of scope at its end.
+  auto const num_locals = locals.size();
+  for (auto id : module.get(statements)) {
+    this->emit_statement(id);
+  }
+  locals.resize(num_locals);
+}
+
+auto Emitter::emit_statement(StmtID id) -> void
+{
+  if (!id.is_valid()) {
+    return;
+  }
+
+  auto const& stmt = module.get(id);
+  switch (stmt.kind) {
+  case StmtKind::Expression: {
+    // `break` and `continue` are not keywords of the parser yet, so they come as names.
+    auto const& expr = module.get(stmt.expr);
+    if (expr.kind == ExprKind::Name && (module.get(expr.symbol) == "break" || module.get(expr.symbol) == "continue")) {
+      if (loops.empty()) {
+        fail(stmt.pos, fmt::format("`{}` outside of a loop", module.get(expr.symbol)));
+        return;
+      }
+
+      auto const target = module.get(expr.symbol) == "break" ? loops.back().break_label : loops.back().continue_label;
+      this->emit_terminator("br label %bb{}", target);
+      return;
+    }
+    (void)emit_expr(stmt.expr);
+    break;
+  }
+  case StmtKind::Variable: emit_variable(module.variables[stmt.index], stmt.pos); break;
+  case StmtKind::Return: {
+    auto value = Value{Type::I32, ValueKind::Integer, 0};
+    if (stmt.expr.is_valid()) {
+      value = emit_expr(stmt.expr);
+    }
+
+    if (result_type == Type::Void) {
+      this->emit_terminator("ret void");
+      break;
+    }
+    value = convert(value, result_type, stmt.pos);
+    this->emit_terminator("ret {} {}", type_name(result_type), operand(value).view());
+    break;
+  }
+  case StmtKind::If: {
+    auto const condition  = to_bool(emit_expr(stmt.expr), stmt.pos);
+    auto const then_label = next_label++;
+    auto const else_label = stmt.else_body.is_valid() ? next_label++ : 0;
+    auto const end_label  = next_label++;
+
+    auto const false_label = stmt.else_body.is_valid() ? else_label : end_label;
+    this->emit_terminator("br i1 {}, label %bb{}, label %bb{}", operand(condition).view(), then_label, false_label);
+
+    this->emit_label(then_label);
+    this->emit_statement(stmt.body);
+    if (stmt.else_body.is_valid()) {
+      if (!terminated) {
+        this->emit_terminator("br label %bb{}", end_label);
+      }
+      this->emit_label(else_label);
+      this->emit_statement(stmt.else_body);
+    }
+    this->emit_label(end_label);
+    break;
+  }
+  case StmtKind::Loop: {
+    auto const body_label = next_label++;
+    auto const end_label  = next_label++;
+
+    this->emit_label(body_label);
+    loops.push_back(LoopTargets{end_label, body_label});
+    this->emit_statement(stmt.body);
+    loops.pop_back();
+    if (!terminated) {
+      this->emit_terminator("br label %bb{}", body_label);
+    }
+    this->emit_label(end_label);
+    break;
+  }
+  case StmtKind::While: {
+    auto const condition_label = next_label++;
+    auto const body_label      = next_label++;
+    auto const end_label       = next_label++;
+
+    this->emit_label(condition_label);
+    auto const condition = to_bool(emit_expr(stmt.expr), stmt.pos);
+    this->emit_terminator("br i1 {}, label %bb{}, label %bb{}", operand(condition).view(), body_label, end_label);
+
+    this->emit_label(body_label);
+    loops.push_back(LoopTargets{end_label, condition_label});
+    this->emit_statement(stmt.body);
+    loops.pop_back();
+    if (!terminated) {
+      this->emit_terminator("br label %bb{}", condition_label);
+    }
+    this->emit_label(end_label);
+    break;
+  }
+  case StmtKind::For: {
+    // The variable of the initializer is only visible in the loop.
+    auto const num_locals = locals.size();
+    this->emit_statement(stmt.init);
+
+    auto const condition_label = next_label++;
+    auto const body_label      = next_label++;
+    auto const step_label      = next_label++;
+    auto const end_label       = next_label++;
+
+    this->emit_label(condition_label);
+    auto const condition = to_bool(emit_expr(stmt.expr), stmt.pos);
+    this->emit_terminator("br i1 {}, label %bb{}, label %bb{}", operand(condition).view(), body_label, end_label);
+
+    this->emit_label(body_label);
+    loops.push_back(LoopTargets{end_label, step_label});
+    this->emit_statement(stmt.body);
+    loops.pop_back();
+
+    this->emit_label(step_label);
+    (void)emit_expr(stmt.step);
+    this->emit_terminator("br label %bb{}", condition_label);
+
+    this->emit_label(end_label);
+    locals.resize(num_locals);
+    break;
+  }
+  case StmtKind::Block: emit_statements(stmt.statements); break;
+
+  // Every function is emitted on its own, and the modules are resolved before.
+  case StmtKind::Function:
+  case StmtKind::Use:
+  case StmtKind::Submodule: break;
+  }
+}
+
+auto Emitter::emit_variable(hir::Variable const& variable, usize pos) -> void
+{
+  auto value = Value();
+  if (variable.initializer.is_valid()) {
+    value = emit_expr(variable.initializer);
+  }
+
+  auto type = value.type;
+  if (variable.type.is_valid()) {
+    type = parse_type(variable.type, pos);
+  }
+  if (type == Type::Void) {
+    fail(pos, fmt::format("cannot infer the type of `{}`", module.get(variable.name)));
+    return;
+  }
+
+  // The variable is declared after its initializer, which cannot refer to it.
+  auto const& local = declare_local(variable.name, type);
+  if (variable.initializer.is_valid()) {
+    value = convert(value, type, pos);
+    this->emit("store {} {}, ptr %v{}", type_name(type), operand(value).view(), local.slot);
+  }
+}
+
+auto Emitter::emit_expr(ExprID id) -> Value
+{
+  auto const& expr = module.get(id);
+  switch (expr.kind) {
+  case ExprKind::Name: {
+    auto const local = find_local(expr.symbol);
+    if (local == nullptr) {
+      fail(expr.pos, fmt::format("unknown variable `{}`", module.get(expr.symbol)));
+      return {};
+    }
+    return emit_value(local->type, "load {}, ptr %v{}", type_name(local->type), local->slot);
+  }
+  case ExprKind::Integer:
+  case ExprKind::Real:
+  case ExprKind::String: return emit_literal(module, expr);
+  case ExprKind::Block: emit_statements(expr.statements); return {};
+  case ExprKind::Binary: return emit_binary(expr);
+  case ExprKind::Unary: return emit_unary(expr);
+  case ExprKind::Call: qualifier.clear(); return emit_call(expr);
+  case ExprKind::Subscript: fail(expr.pos, "subscripts are not supported yet"); return {};
+  }
+  return {};
+}
+
+auto Emitter::emit_binary(Expr const& expr) -> Value
+{
+  using hir::BinaryOp;
+
+  switch (expr.binary_op) {
+  case BinaryOp::MemberAccess: fail(expr.pos, "member access is not supported yet"); return {};
+  case BinaryOp::ScopeResolution: {
+    // `a::b::f(x)` comes as `a::b` and the call `f(x)`.
+    auto const& call = module.get(expr.rhs);
+    qualifier.clear();
+    if (call.kind != ExprKind::Call || !append_path(module, module.get(expr.lhs), qualifier)) {
+      fail(expr.pos, "a path can only be called");
+      return {};
+    }
+    return emit_call(call);
+  }
+  case BinaryOp::Assign:
+  case BinaryOp::AddAssign:
+  case BinaryOp::SubAssign:
+  case BinaryOp::MulAssign:
+  case BinaryOp::DivAssign:
+  case BinaryOp::ModAssign: return emit_assignment(expr);
+  default: break;
+  }
+
+  auto const lhs = emit_expr(expr.lhs);
+  auto const rhs = emit_expr(expr.rhs);
+  return arithmetic(expr.binary_op, lhs, rhs, expr.pos);
+}
+
+auto Emitter::emit_assignment(Expr const& expr) -> Value
+{
+  using hir::BinaryOp;
+
+  auto const& target = module.get(expr.lhs);
+  auto const  local  = target.kind == ExprKind::Name ? find_local(target.symbol) : nullptr;
+  if (local == nullptr) {
+    fail(expr.pos, "only variables can be assigned");
+    return {};
+  }
+
+  // Copied, the value may declare variables (e.g. in a block).
+  auto const type = local->type;
+  auto const slot = local->slot;
+
+  auto value = emit_expr(expr.rhs);
+  if (expr.binary_op != BinaryOp::Assign) {
+    static auto constexpr OPS = Array<BinaryOp, 5>{
+      BinaryOp::Add, BinaryOp::Sub, BinaryOp::Mul, BinaryOp::Div, BinaryOp::Mod,
+    };
+
+    auto const current = emit_value(type, "load {}, ptr %v{}", type_name(type), slot);
+    auto const op      = OPS[usize(expr.binary_op) - usize(BinaryOp::AddAssign)];
+    value              = arithmetic(op, current, value, expr.pos);
+  }
+
+  value = convert(value, type, expr.pos);
+  this->emit("store {} {}, ptr %v{}", type_name(type), operand(value).view(), slot);
+  return value;
+}
+
+auto Emitter::emit_unary(Expr const& expr) -> Value
+{
+  using hir::UnaryOp;
+
+  switch (expr.unary_op) {
+  case UnaryOp::Not: {
+    auto const value = to_bool(emit_expr(expr.lhs), expr.pos);
+    return emit_value(Type::Bool, "xor i1 {}, true", operand(value).view());
+  }
+  case UnaryOp::AddressOf:
+  case UnaryOp::Deref: fail(expr.pos, "pointers are not supported yet"); return {};
+  default: break;
+  }
+
+  auto const& target = module.get(expr.lhs);
+  auto const  local  = target.kind == ExprKind::Name ? find_local(target.symbol) : nullptr;
+  if (local == nullptr) {
+    fail(expr.pos, "only variables can be incremented or decremented");
+    return {};
+  }
+
+  auto const is_increment = expr.unary_op == UnaryOp::PreIncrement || expr.unary_op == UnaryOp::PostIncrement;
+  auto const is_prefix    = expr.unary_op == UnaryOp::PreIncrement || expr.unary_op == UnaryOp::PreDecrement;
+  auto const type         = local->type;
+  auto const slot         = local->slot;
+
+  auto const current = emit_value(type, "load {}, ptr %v{}", type_name(type), slot);
+  auto const one     = Value{Type::I32, ValueKind::Integer, 1};
+  auto const updated = convert(
+    arithmetic(is_increment ? hir::BinaryOp::Add : hir::BinaryOp::Sub, current, one, expr.pos), type, expr.pos
+  );
+  this->emit("store {} {}, ptr %v{}", type_name(type), operand(updated).view(), slot);
+  return is_prefix ? updated : current;
+}
+
+/// @returns The value of a literal of the module or of a used one.
+auto Emitter::emit_literal(hir::Module const& owner, Expr const& expr) -> Value
+{
+  switch (expr.kind) {
+  case ExprKind::Integer: {
+    auto const fits_i32 = expr.integer <= u64(std::numeric_limits<i32>::max());
+    return Value{fits_i32 ? Type::I32 : Type::I64, ValueKind::Integer, expr.integer};
+  }
+  case ExprKind::Real: return Value{Type::F64, ValueKind::Real, std::bit_cast<u64>(expr.real)};
+  case ExprKind::String: {
+    auto const [it, inserted] = strings_by_symbol.try_emplace(expr.symbol.id, next_string);
+    if (!inserted) {
+      return Value{Type::Ptr, ValueKind::String, it->second};
+    }
+
+    decode_string(owner.get(expr.symbol), scratch);
+    return emit_string(scratch);
+  }
+  default: return {};
+  }
+}
+
+/// Emits a call, qualified by the @c qualifier (if any).
+auto Emitter::emit_call(Expr const& expr) -> Value
+{
+  // A path (`a::b::f`) calls the function by its last name, the rest of it may select a used module.
+  auto callee = &module.get(expr.lhs);
+  while (callee->kind == ExprKind::Binary && callee->binary_op == hir::BinaryOp::ScopeResolution) {
+    if (!qualifier.empty()) {
+      qualifier += "::";
+    }
+    if (!append_path(module, module.get(callee->lhs), qualifier)) {
+      break;
+    }
+    callee = &module.get(callee->rhs);
+  }
+  if (callee->kind != ExprKind::Name) {
+    fail(expr.pos, "only functions can be called");
+    return {};
+  }
+
+  // A name alone calls a function of the module itself first, a path calls a function of a used module first.
+  auto const local      = functions_by_name.find(callee->symbol.id);
+  auto const call_local = [&] {
+    auto const index = local->second;
+    return emit_call_of(expr, module, module.functions[index], ir_names[index], result_types[index]);
+  };
+  if (local != functions_by_name.end() && qualifier.empty()) {
+    return call_local();
+  }
+
+  if (auto const import = find_import(callee->symbol, expr.pos)) {
+    if (import->ir_name.empty()) {
+      this->declare_import(*import);
+    }
+    return emit_call_of(
+      expr, *import->module->hir, import->module->hir->functions[import->index], import->ir_name, import->result_type
+    );
+  }
+  if (error) {
+    return {};
+  }
+  if (local != functions_by_name.end()) {
+    return call_local();
+  }
+
+  auto const name = module.get(callee->symbol);
+  if (name == "print" || name == "println") {
+    return emit_print(expr, name == "println");
+  }
+
+  fail(expr.pos, fmt::format("unknown function `{}`", name));
+  return {};
+}
+
+/// Emits the call of a function of the module or of a used one (the @p owner).
+auto Emitter::emit_call_of(
+  Expr const& expr, hir::Module const& owner, hir::Function const& function, StringView ir_name, Type type
+) -> Value
+{
+  auto const params = owner.get(function.parameters);
+  auto const args   = module.get(expr.arguments);
+  if (args.size() > params.size()) {
+    fail(
+      expr.pos,
+      fmt::format("`{}` takes {} arguments, {} given", owner.get(function.name), params.size(), args.size())
+    );
+    return {};
+  }
+
+  // The missing arguments take the default values of the parameters.
+  auto const base = value_stack.size();
+  for (auto i = usize(0); i < params.size(); ++i) {
+    auto const initializer = params[i].initializer;
+    if (i >= args.size() && !initializer.is_valid()) {
+      fail(expr.pos, fmt::format("missing the argument `{}`", owner.get(params[i].name)));
+      value_stack.resize(base);
+      return {};
+    }
+
+    // The default values are emitted by the caller, so only literals are supported (the names would refer to
+    // the variables of the caller, and to the functions of the wrong module).
+    auto value = Value();
+    if (i < args.size()) {
+      value = emit_expr(args[i]);
+    }
+    else if (auto const& default_value = owner.get(initializer); is_literal(default_value)) {
+      value = emit_literal(owner, default_value);
+    }
+    else {
+      fail(
+        expr.pos,
+        fmt::format(
+          "the default value of `{}` of `{}` is not a literal, pass the argument",
+          owner.get(params[i].name),
+          owner.get(function.name)
+        )
+      );
+      value_stack.resize(base);
+      return {};
+    }
+
+    auto const param_type = params[i].type.is_valid() ? parse_type(params[i].type, expr.pos) : Type::I32;
+    value_stack.push_back(convert(value, param_type, expr.pos));
+  }
+
+  auto value = Value();
+  this->ensure_block();
+  if (type == Type::Void) {
+    body += "  call void ";
+  }
+  else {
+    value = Value{type, ValueKind::Register, next_value++};
+    fmt::format_to(std::back_inserter(body), "  %v{} = call {} ", value.bits, type_name(type));
+  }
+
+  fmt::format_to(std::back_inserter(body), "@{}(", ir_name);
+  for (auto i = base; i < value_stack.size(); ++i) {
+    auto const& argument = value_stack[i];
+    fmt::format_to(
+      std::back_inserter(body),
+      "{}{} noundef {}",
+      i == base ? "" : ", ",
+      type_name(argument.type),
+      operand(argument).view()
+    );
+  }
+  body += ")\n";
+
+  value_stack.resize(base);
+  return value;
+}
+
+/// Emits `print` and `println` as `printf`, with the `{}` of the format string replaced by the conversion
+/// of the type of every argument.
+auto Emitter::emit_print(Expr const& expr, bool new_line) -> Value
+{
+  auto const args = module.get(expr.arguments);
+  if (args.empty() || module.get(args[0]).kind != ExprKind::String) {
+    fail(expr.pos, "the first argument of `print` must be a string literal");
+    return {};
+  }
+
+  // The arguments are promoted like the variadic arguments of C.
+  auto const base = value_stack.size();
+  for (auto i = usize(1); i < args.size(); ++i) {
+    auto       value = emit_expr(args[i]);
+    auto const type  = is_integer(value.type) ? std::max(value.type, Type::I32)
+                     : is_real(value.type)    ? Type::F64
+                                              : value.type;
+    if (type == Type::Void) {
+      fail(module.get(args[i]).pos, "the argument has no value");
+      value_stack.resize(base);
+      return {};
+    }
+    value_stack.push_back(convert(value, type, expr.pos));
+  }
+
+  decode_string(module.get(module.get(args[0]).symbol), scratch);
+
+  printf_format.clear();
+  auto num_replaced = usize(0);
+  for (auto i = usize(0); i < scratch.size(); ++i) {
+    if (scratch[i] == '%') {
+      printf_format += "%%";
+    }
+    else if (scratch.compare(i, 2, "{}") == 0 && base + num_replaced < value_stack.size()) {
+      switch (value_stack[base + num_replaced].type) {
+      case Type::U32: printf_format += "%u"; break;
+      case Type::I64: printf_format += "%lld"; break;
+      case Type::U64: printf_format += "%llu"; break;
+      case Type::F64: printf_format += "%g"; break;
+      case Type::Ptr: printf_format += "%s"; break;
+      default: printf_format += "%d"; break;
+      }
+      ++num_replaced;
+      ++i;
+    }
+    else {
+      printf_format += scratch[i];
+    }
+  }
+  if (new_line) {
+    printf_format += '\n';
+  }
+
+  if (num_replaced != value_stack.size() - base) {
+    fail(expr.pos, fmt::format("the format string uses {} of {} arguments", num_replaced, value_stack.size() - base));
+    value_stack.resize(base);
+    return {};
+  }
+
+  uses_printf       = true;
+  auto const string = emit_string(printf_format);
+
+  this->ensure_block();
+  auto const result = Value{Type::I32, ValueKind::Register, next_value++};
+  fmt::format_to(
+    std::back_inserter(body),
+    "  %v{} = call i32 (ptr, ...) @printf(ptr noundef {}",
+    result.bits,
+    operand(string).view()
+  );
+  for (auto i = base; i < value_stack.size(); ++i) {
+    auto const& argument = value_stack[i];
+    fmt::format_to(std::back_inserter(body), ", {} noundef {}", type_name(argument.type), operand(argument).view());
+  }
+  body += ")\n";
+
+  value_stack.resize(base);
+  return result;
+}
+
+/// Writes a constant with the bytes of a string (and the terminating zero) to the output.
+auto Emitter::emit_string(StringView bytes) -> Value
+{
+  auto const id = next_string++;
+  fmt::format_to(out.out(), "@.str.{} = private unnamed_addr constant [{} x i8] c\"", id, bytes.size() + 1);
+  for (auto c : bytes) {
+    if (c >= ' ' && c <= '~' && c != '"' && c != '\\') {
+      *out.out() = c;
+    }
+    else {
+      fmt::format_to(out.out(), "\\{:02X}", u8(c));
+    }
+  }
+  out.write("\\00\"\n");
+  return Value{Type::Ptr, ValueKind::String, id};
+}
+
+/// Applies a binary operator (except the assignments) to the operands converted to their common type.
+auto Emitter::arithmetic(hir::BinaryOp op, Value lhs, Value rhs, usize pos) -> Value
+{
+  using hir::BinaryOp;
+
+  if (lhs.type == Type::Void || rhs.type == Type::Void) {
+    fail(pos, "the operand has no value");
+    return {};
+  }
+
+  auto const is_comparison = op >= BinaryOp::Equal && op <= BinaryOp::Greater;
+  if ((lhs.type == Type::Ptr || rhs.type == Type::Ptr) && !is_comparison) {
+    fail(pos, "strings cannot be used in arithmetic");
+    return {};
+  }
+
+  // Booleans are promoted in arithmetic, like in C.
+  auto type = std::max(lhs.type, rhs.type);
+  if (type == Type::Bool && !is_comparison) {
+    type = Type::I32;
+  }
+  lhs = convert(lhs, type, pos);
+  rhs = convert(rhs, type, pos);
+
+  auto const name  = type_name(type);
+  auto const left  = operand(lhs);
+  auto const right = operand(rhs);
+  if (is_comparison) {
+    // Indexed by `op - BinaryOp::Equal`.
+    static auto constexpr INTEGER  = Array<StringView, 6>{"eq", "ne", "sle", "sge", "slt", "sgt"};
+    static auto constexpr UNSIGNED = Array<StringView, 6>{"eq", "ne", "ule", "uge", "ult", "ugt"};
+    static auto constexpr REAL     = Array<StringView, 6>{"oeq", "une", "ole", "oge", "olt", "ogt"};
+
+    auto const index = usize(op) - usize(BinaryOp::Equal);
+    if (is_real(type)) {
+      return emit_value(Type::Bool, "fcmp {} {} {}, {}", REAL[index], name, left.view(), right.view());
+    }
+    auto const condition = is_unsigned(type) ? UNSIGNED[index] : INTEGER[index];
+    return emit_value(Type::Bool, "icmp {} {} {}, {}", condition, name, left.view(), right.view());
+  }
+
+  // Indexed by `op - BinaryOp::Add`.
+  static auto constexpr INTEGER  = Array<StringView, 5>{"add", "sub", "mul", "sdiv", "srem"};
+  static auto constexpr UNSIGNED = Array<StringView, 5>{"add", "sub", "mul", "udiv", "urem"};
+  static auto constexpr REAL     = Array<StringView, 5>{"fadd", "fsub", "fmul", "fdiv", "frem"};
+
+  auto const index       = usize(op) - usize(BinaryOp::Add);
+  auto const instruction = is_real(type) ? REAL[index] : is_unsigned(type) ? UNSIGNED[index] : INTEGER[index];
+  return emit_value(type, "{} {} {}, {}", instruction, name, left.view(), right.view());
+}
+
+auto Emitter::convert(Value value, Type type, usize pos) -> Value
+{
+  if (value.type == type) {
+    return value;
+  }
+  if (value.type == Type::Void) {
+    fail(pos, "the expression has no value");
+    return Value{type, ValueKind::Integer, 0};
+  }
+  if (value.type == Type::Ptr || type == Type::Ptr || type == Type::Void) {
+    fail(pos, fmt::format("cannot convert `{}` to `{}`", type_name(value.type), type_name(type)));
+    return Value{type, ValueKind::Integer, 0};
+  }
+  if (type == Type::Bool) {
+    return to_bool(value, pos);
+  }
+
+  // The constants are converted in place.
+  if (value.kind == ValueKind::Integer) {
+    if (is_real(type)) {
+      auto const real = is_unsigned(value.type) ? f64(value.bits) : f64(i64(value.bits));
+      return Value{type, ValueKind::Real, std::bit_cast<u64>(real)};
+    }
+    return Value{type, ValueKind::Integer, wrap_integer(value.bits, type)};
+  }
+  if (value.kind == ValueKind::Real) {
+    if (is_real(type)) {
+      return Value{type, ValueKind::Real, value.bits};
+    }
+    auto const real = std::bit_cast<f64>(value.bits);
+    auto const bits = is_unsigned(type) ? u64(real) : u64(i64(real));
+    return Value{type, ValueKind::Integer, wrap_integer(bits, type)};
+  }
+
+  // The integers of the same width only differ in the instructions that use them.
+  if (is_integer(value.type) && is_integer(type) && width_of(value.type) == width_of(type)) {
+    value.type = type;
+    return value;
+  }
+
+  auto const from = type_name(value.type);
+  auto const to   = type_name(type);
+  auto const text = operand(value);
+  if (is_integer(value.type) && is_integer(type)) {
+    auto const extend      = value.type == Type::Bool || is_unsigned(value.type) ? "zext" : "sext";
+    auto const instruction = width_of(type) > width_of(value.type) ? extend : "trunc";
+    return emit_value(type, "{} {} {} to {}", instruction, from, text.view(), to);
+  }
+  if (is_integer(value.type)) {
+    auto const instruction = value.type == Type::Bool || is_unsigned(value.type) ? "uitofp" : "sitofp";
+    return emit_value(type, "{} {} {} to {}", instruction, from, text.view(), to);
+  }
+  if (is_integer(type)) {
+    return emit_value(type, "{} {} {} to {}", is_unsigned(type) ? "fptoui" : "fptosi", from, text.view(), to);
+  }
+  auto const instruction = type == Type::F64 ? "fpext" : "fptrunc";
+  return emit_value(type, "{} {} {} to {}", instruction, from, text.view(), to);
+}
+
+auto Emitter::to_bool(Value value, usize pos) -> Value
+{
+  switch (value.type) {
+  case Type::Bool: return value;
+  case Type::Void: fail(pos, "the condition has no value"); return Value{Type::Bool, ValueKind::Integer, 0};
+  case Type::Ptr: return emit_value(Type::Bool, "icmp ne ptr {}, null", operand(value).view());
+  default: break;
+  }
+
+  if (value.kind == ValueKind::Integer) {
+    return Value{Type::Bool, ValueKind::Integer, u64(value.bits != 0)};
+  }
+  if (value.kind == ValueKind::Real) {
+    return Value{Type::Bool, ValueKind::Integer, u64(std::bit_cast<f64>(value.bits) != 0.0)};
+  }
+  if (is_real(value.type)) {
+    return emit_value(Type::Bool, "fcmp une {} {}, 0.0", type_name(value.type), operand(value).view());
+  }
+  return emit_value(Type::Bool, "icmp ne {} {}, 0", type_name(value.type), operand(value).view());
+}
+
+/// Replaces the escape sequences of the content of a string literal with the characters.
+static auto decode_string(StringView content, String& result) -> void
+{
+  result.clear();
+  for (auto i = usize(0); i < content.size(); ++i) {
+    if (content[i] != '\\' || i + 1 == content.size()) {
+      result += content[i];
+      continue;
+    }
+
+    switch (auto const c = content[++i]) {
+    case 'n': result += '\n'; break;
+    case 't': result += '\t'; break;
+    case 'r': result += '\r'; break;
+    case '0': result += '\0'; break;
+    case '\\':
+    case '"':
+    case '\'': result += c; break;
+    default:
+      result += '\\';
+      result += c;
+      break;
+    }
+  }
+}
+
+/// Appends the names of a path (`a` or `a::b`) to the path.
+/// @returns @c false if the expression is not a path.
+static auto append_path(hir::Module const& module, Expr const& expr, String& path) -> bool
+{
+  if (expr.kind == ExprKind::Name) {
+    path += module.get(expr.symbol);
+    return true;
+  }
+  if (expr.kind != ExprKind::Binary || expr.binary_op != hir::BinaryOp::ScopeResolution
+      || !append_path(module, module.get(expr.lhs), path)) {
+    return false;
+  }
+
+  path += "::";
+  return append_path(module, module.get(expr.rhs), path);
+}
+
+} // namespace jet::compiler::ir
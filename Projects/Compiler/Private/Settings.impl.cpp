@@ -1,8 +1,9 @@
 module;
 
-#include <iostream>
 #include <optional>
 #include <cassert>
+#include <charconv>
+#include <utility>
 
 module Jet.Compiler.Settings;
 
@@ -10,8 +11,10 @@ namespace jet::compiler
 {
 static auto parse_output_binary(ProgramArgs const& args, Settings& settings) -> void;
 static auto parse_output_llvm_ir(ProgramArgs const& args, Settings& settings) -> void;
+static auto parse_output_parse_dump(ProgramArgs const& args, Settings& settings) -> void;
+static auto parse_num_jobs(ProgramArgs const& args, Settings& settings) -> Opt<SettingsError>;
 
-auto make_settings_from_args(ProgramArgs const& args) -> Settings
+auto make_settings_from_args(ProgramArgs const& args) -> SettingsResult
 {
   // Examples:
   //
@@ -31,16 +34,42 @@ auto make_settings_from_args(ProgramArgs const& args) -> Settings
   // saves the generated LLVM intermediate representation to
   // a file of name "output_ir_name"
   // ---------------------
+  // #3
+  // ---------------------
+  // jetc main --parse-dump parse_dump_name
+  //
+  // Compiles module "main" and saves the AST and source
+  // dumps of the parser to a file of name "parse_dump_name"
+  // ---------------------
+  // #4
+  // ---------------------
+  // jetc main -o output_binary_name -j 8
+  //
+  // Compiles module "main" on 8 threads and runs at most
+  // 8 processes (e.g. compilations of LLVM IR units) at once
+  // ---------------------
+  // #5
+  // ---------------------
+  // jetc main --timings
+  //
+  // Compiles module "main" and prints how long every
+  // stage of the build took
+  // ---------------------
 
   auto result             = Settings();
   result.root_module_name = String(args.get_unchecked(1));
 
   parse_output_binary(args, result);
   parse_output_llvm_ir(args, result);
+  parse_output_parse_dump(args, result);
+  if (auto invalid = parse_num_jobs(args, result)) {
+    return error(std::move(*invalid));
+  }
 
   result.cleanup_intermediate = !args.contains("--keep-intermediate");
+  result.report_timings       = args.contains("--timings");
 
-  return result;
+  return success(std::move(result));
 }
 
 auto Settings::should_output_llvm_ir() const -> bool
@@ -53,6 +82,11 @@ auto Settings::should_output_binary() const -> bool
   return output.binary_name != std::nullopt;
 }
 
+auto Settings::should_dump_parse() const -> bool
+{
+  return output.parse_dump_file_name != std::nullopt;
+}
+
 auto Settings::should_cleanup_intermediate() const -> bool
 {
   return cleanup_intermediate;
@@ -79,4 +113,30 @@ static auto parse_output_llvm_ir(ProgramArgs const& args, Settings& settings) ->
   }
 }
 
+static auto parse_output_parse_dump(ProgramArgs const& args, Settings& settings) -> void
+{
+  auto dump_name = args.sequence("--parse-dump");
+
+  if (dump_name) {
+    settings.output.parse_dump_file_name = String(*dump_name);
+  }
+}
+
+/// @returns The error if the number of jobs is not a number.
+static auto parse_num_jobs(ProgramArgs const& args, Settings& settings) -> Opt<SettingsError>
+{
+  auto num_jobs = args.sequence("-j");
+  if (!num_jobs) {
+    return std::nullopt;
+  }
+
+  auto       value  = usize(0);
+  auto const result = std::from_chars(num_jobs->data(), num_jobs->data() + num_jobs->size(), value);
+  if (result.ec != std::errc() || result.ptr != num_jobs->data() + num_jobs->size()) {
+    return SettingsError{"invalid number of jobs \"" + String(*num_jobs) + "\" (expected -j <number>)"};
+  }
+  settings.num_jobs = value;
+  return std::nullopt;
+}
+
 } // namespace jet::compiler
@@ -1,12 +1,102 @@
 module;
 
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 export module Jet.Compiler.BuildState;
 
 export import Jet.Compiler.Settings;
+export import Jet.Compiler.HIR;
+export import Jet.Core.File;
+
+using namespace jet::comp::foundation;
 
 export namespace jet::compiler
 {
 
+/// A module of the build, a node of the @c ModuleGraph.
+struct BuildModule
+{
+  /// The module file.
+  Path path;
+
+  /// The path of the module in the `use` statements (e.g. `util::math`), empty for the root module.
+  /// Set once every module was discovered.
+  String name;
+
+  /// The content of the file, referred to by the parse.
+  Opt<core::MappedFile>    file;
+  Opt<parser::ModuleParse> parse;
+
+  /// Holds the nodes of the HIR.
+  Arena            arena;
+  Opt<hir::Module> hir;
+
+  /// The AST and source dumps of the parser (see @c Settings::should_dump_parse()).
+  String parse_dump;
+
+  /// The modules used by this module (their indices in the graph).
+  DynArray<usize> dependencies;
+
+  /// The modules that use this module. Filled by @c ModuleGraph::sort().
+  DynArray<usize> dependents;
+};
+
+/// The modules of the build and the dependencies between them, found in their `use` statements.
+/// Modules are added by several threads at once, while they are discovered.
+class ModuleGraph
+{
+public:
+  /// Adds the module of the file unless it is already in the graph.
+  /// @returns The index of the module and @c true if it was added.
+  auto add(Path const& path) -> std::pair<usize, bool>;
+
+  /// @returns The module. The reference stays valid while further modules are added.
+  [[nodiscard]]
+  auto operator[](usize index) -> BuildModule&;
+
+  [[nodiscard]]
+  auto operator[](usize index) const -> BuildModule const&;
+
+  /// @returns The number of modules.
+  [[nodiscard]]
+  auto size() const -> usize;
+
+  /// Fills the dependents of the modules and orders the modules, so that each of them comes after its dependencies.
+  /// @note Call once every module was added.
+  /// @returns The indices of the modules in that order or the indices of the modules of a dependency cycle.
+  [[nodiscard]]
+  auto sort() -> Result<DynArray<usize>, DynArray<usize>>;
+
+private:
+  mutable std::mutex mutex;
+
+  /// A deque never moves its elements, so the modules can be used without holding the lock.
+  std::deque<BuildModule> modules;
+
+  /// Maps the absolute, normalized paths of the files to the indices of their modules.
+  UMap<String, usize> indices;
+};
+
+/// How long a stage of the build took.
+struct StageTiming
+{
+  String name;
+
+  /// The number of modules that went through the stage.
+  usize num_modules = 0;
+
+  /// From the start of the first module to the end of the last one.
+  std::chrono::nanoseconds wall{0};
+
+  /// The sum of the times of every module, from every thread.
+  std::chrono::nanoseconds busy{0};
+};
+
 /// Stores the state of the current build process.
 /// This is incredibly important structure that is common
 /// for all build steps.
@@ -14,9 +104,15 @@ struct BuildState
 {
   Settings settings;
 
+  /// The root module and every module that it uses (directly or not). The root module is the first one.
+  ModuleGraph graph;
+
+  /// The timings of the stages, in their order. Filled by the build process.
+  DynArray<StageTiming> timings;
+
   /// Determines whether it is valid to start a build process
   /// using this instance of build state.
   auto can_start() const -> bool;
 };
 
-} // namespace jet::compiler
\ No newline at end of file
+} // namespace jet::compiler
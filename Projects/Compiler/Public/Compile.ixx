@@ -1,11 +1,11 @@
 export module Jet.Compiler.Compile;
 
-export import Jet.Parser;
+export import Jet.Compiler.HIR;
+export import Jet.Compiler.IR;
 export import Jet.Comp.Foundation;
 export import Jet.Compiler.Settings;
 
 using namespace jet::comp::foundation;
-using jet::parser::ModuleParse;
 
 export namespace jet::compiler
 {
@@ -15,6 +15,22 @@ struct CompileError
   String details;
 };
 
-auto compile(ModuleParse parse_result, Settings settings) -> Result<int, CompileError>;
+/// Creates the directory of the intermediate files (the IR and object files of the units and the binary).
+/// @returns Its path.
+auto prepare_intermediate_directory(Settings const& settings) -> Path;
+
+/// Removes the directory of the intermediate files.
+auto cleanup_intermediate_directory(Settings const& settings) -> void;
+
+/// Emits the IR of the module to the file, a unit of the program.
+/// The context names the module and the modules whose functions it calls (see @c ir::EmitContext).
+[[nodiscard]]
+auto emit_unit(hir::Module const& module, Path const& ir_file, ir::EmitContext const& context = {})
+  -> Result<int, CompileError>;
+
+/// Compiles every unit to an object file (up to @c Settings::num_jobs at once), then links them
+/// into `main.exe` in the directory.
+[[nodiscard]]
+auto link_units(Path const& directory, Span<Path const> units, Settings const& settings) -> Result<int, CompileError>;
 
 } // namespace jet::compiler
\ No newline at end of file
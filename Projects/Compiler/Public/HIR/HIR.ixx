@@ -0,0 +1,355 @@
+module;
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+export module Jet.Compiler.HIR;
+
+export import Jet.Parser;
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+using jet::parser::ModuleParse;
+
+/// The high-level intermediate representation (HIR) of a module: a typed tree lowered from the AST of the parser.
+/// Nodes are stored in tables (one per node type) and refer to each other by 32-bit indices.
+/// Every table is allocated from an arena, sized once before the lowering.
+export namespace jet::compiler::hir
+{
+
+/// Type of the indices stored in the HIR.
+using Index = u32;
+
+/// Marks a missing node (e.g. a variable without an initializer).
+inline auto constexpr NONE = ~Index(0);
+
+/// Type-safe handle to an expression.
+struct ExprID
+{
+  Index id = NONE;
+
+  [[nodiscard]]
+  auto is_valid() const -> bool
+  {
+    return id != NONE;
+  }
+
+  auto operator==(ExprID const&) const -> bool = default;
+};
+
+/// Type-safe handle to a statement.
+struct StmtID
+{
+  Index id = NONE;
+
+  [[nodiscard]]
+  auto is_valid() const -> bool
+  {
+    return id != NONE;
+  }
+
+  auto operator==(StmtID const&) const -> bool = default;
+};
+
+/// An interned identifier, type name or string literal (see @c Interner).
+using comp::foundation::Symbol;
+
+/// Consecutive elements of a table of the HIR (see @c Module::get()).
+/// The IDs and symbols are stored in list tables, the other nodes directly in their tables.
+template <typename T>
+struct List
+{
+  Index first = 0;
+  Index count = 0;
+};
+
+enum class BinaryOp : u8
+{
+  MemberAccess,
+  ScopeResolution,
+  Equal,
+  NotEqual,
+  LessEqual,
+  GreaterEqual,
+  Less,
+  Greater,
+  AddAssign,
+  SubAssign,
+  MulAssign,
+  DivAssign,
+  ModAssign,
+  Assign,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Mod,
+};
+
+enum class UnaryOp : u8
+{
+  Not,
+  AddressOf,
+  Deref,
+  PreIncrement,
+  PreDecrement,
+  PostIncrement,
+  PostDecrement,
+};
+
+enum class ExprKind : u8
+{
+  /// A name (`symbol`).
+  Name,
+
+  /// An integer literal (`integer`).
+  Integer,
+
+  /// A real literal (`real`).
+  Real,
+
+  /// A string literal (`symbol`, the content between the quotes, escape sequences are kept).
+  String,
+
+  /// A code block (`statements`).
+  Block,
+
+  /// A binary expression (`binary_op`, `lhs` and `rhs`).
+  Binary,
+
+  /// A prefix or postfix operator (`unary_op` and `lhs`).
+  Unary,
+
+  /// A function call (`lhs` is the callee, `arguments`).
+  Call,
+
+  /// A subscript (`lhs` is the subscripted value, `arguments`).
+  Subscript,
+};
+
+struct Expr
+{
+  ExprKind kind = ExprKind::Name;
+
+  BinaryOp binary_op = BinaryOp::Add;
+  UnaryOp  unary_op  = UnaryOp::Not;
+
+  /// The position of the expression in the source.
+  Index pos = 0;
+
+  ExprID lhs;
+  ExprID rhs;
+
+  Symbol symbol;
+
+  List<ExprID> arguments;
+  List<StmtID> statements;
+
+  u64 integer = 0;
+  f64 real    = 0.0;
+};
+
+/// A variable (`let` or `var`) or a function parameter.
+struct Variable
+{
+  Symbol name;
+
+  /// The explicit type, if any.
+  Symbol type;
+
+  /// The initializer (the default value of a parameter), if any.
+  ExprID initializer;
+
+  /// Declared with `var`.
+  bool is_mutable = false;
+};
+
+struct Function
+{
+  Symbol name;
+
+  List<Variable> parameters;
+
+  /// The explicit return type, if any.
+  Symbol return_type;
+
+  /// The statements of the body.
+  List<StmtID> body;
+};
+
+/// A single item of a `use` statement, e.g. `std::fs::read_file as read`, `std::io::*` or `std::{fs, io}`.
+struct UseItem
+{
+  List<Symbol> path;
+
+  /// `path as alias`
+  Symbol alias;
+
+  /// `path::*`
+  bool is_glob = false;
+
+  /// `path::{...}`
+  List<UseItem> group;
+};
+
+/// A submodule definition: `mod path { items }`.
+struct Submodule
+{
+  List<Symbol> path;
+  List<StmtID> items;
+};
+
+enum class StmtKind : u8
+{
+  /// An expression followed by `;` (`expr`).
+  Expression,
+
+  /// `let` or `var` (`index` in @c Module::variables).
+  Variable,
+
+  /// `fn` (`index` in @c Module::functions).
+  Function,
+
+  /// `use` (`index` and `count` of the items in @c Module::use_items).
+  Use,
+
+  /// `mod` (`index` in @c Module::submodules).
+  Submodule,
+
+  /// `ret` (the optional `expr`).
+  Return,
+
+  /// `if (expr) body else else_body`
+  If,
+
+  /// `loop body`
+  Loop,
+
+  /// `while (expr) body`
+  While,
+
+  /// `for (init expr; step) body`
+  For,
+
+  /// A code block (`statements`).
+  Block,
+};
+
+struct Stmt
+{
+  StmtKind kind = StmtKind::Expression;
+
+  /// The position of the statement in the source.
+  Index pos = 0;
+
+  Index index = NONE;
+  Index count = 0;
+
+  ExprID expr;
+  ExprID step;
+
+  StmtID init;
+  StmtID body;
+  StmtID else_body;
+
+  List<StmtID> statements;
+};
+
+/// A table of the HIR.
+template <typename T>
+using Table = std::pmr::vector<T>;
+
+/// The HIR of a single module. Valid as long as its arena and the interner of its symbols.
+struct Module
+{
+  /// Creates an empty module, with the tables allocated from the heap.
+  Module() = default;
+
+  /// Creates an empty module, with the tables allocated from the arena.
+  explicit Module(Arena& arena);
+
+  /// The module-level statements (functions, `use` statements and submodules).
+  List<StmtID> items;
+
+  Table<Expr>      exprs;
+  Table<Stmt>      stmts;
+  Table<Variable>  variables;
+  Table<Function>  functions;
+  Table<UseItem>   use_items;
+  Table<Submodule> submodules;
+
+  /// Holds the texts of the symbols.
+  Interner const* interner = nullptr;
+
+  /// The elements of the lists.
+  Table<ExprID> expr_lists;
+  Table<StmtID> stmt_lists;
+  Table<Symbol> symbol_lists;
+
+  [[nodiscard]]
+  auto get(ExprID id) const -> Expr const&
+  {
+    return exprs[id.id];
+  }
+
+  [[nodiscard]]
+  auto get(StmtID id) const -> Stmt const&
+  {
+    return stmts[id.id];
+  }
+
+  [[nodiscard]]
+  auto get(Symbol symbol) const -> StringView
+  {
+    return interner->get(symbol);
+  }
+
+  [[nodiscard]]
+  auto get(List<ExprID> list) const -> Span<ExprID const>
+  {
+    return Span<ExprID const>(expr_lists).subspan(list.first, list.count);
+  }
+
+  [[nodiscard]]
+  auto get(List<StmtID> list) const -> Span<StmtID const>
+  {
+    return Span<StmtID const>(stmt_lists).subspan(list.first, list.count);
+  }
+
+  [[nodiscard]]
+  auto get(List<Symbol> list) const -> Span<Symbol const>
+  {
+    return Span<Symbol const>(symbol_lists).subspan(list.first, list.count);
+  }
+
+  [[nodiscard]]
+  auto get(List<Variable> list) const -> Span<Variable const>
+  {
+    return Span<Variable const>(variables).subspan(list.first, list.count);
+  }
+
+  [[nodiscard]]
+  auto get(List<UseItem> list) const -> Span<UseItem const>
+  {
+    return Span<UseItem const>(use_items).subspan(list.first, list.count);
+  }
+};
+
+/// Describes why a module could not be lowered.
+struct LoweringError
+{
+  /// The position in the source.
+  usize  pos = 0;
+  String details;
+};
+
+/// Lowers the AST of a successfully parsed module to its HIR, in a single pass over the entries.
+/// The tables of the HIR are allocated from the arena. The number of nodes of every type is bounded
+/// before the lowering (from the entries of the AST), so the tables never grow while the nodes are added.
+/// The names, types and string literals are interned, so the modules of a build share their symbols.
+[[nodiscard]]
+auto lower_module(ModuleParse const& parse, Arena& arena, Interner& interner = use_interner())
+  -> Result<Module, LoweringError>;
+
+} // namespace jet::compiler::hir
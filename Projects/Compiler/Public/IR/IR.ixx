@@ -0,0 +1,62 @@
+module;
+
+#include <variant>
+
+export module Jet.Compiler.IR;
+
+export import Jet.Compiler.HIR;
+export import Jet.Comp.Foundation;
+
+import Jet.Core.File;
+
+using namespace jet::comp::foundation;
+
+/// Emits the LLVM IR (in its textual form) of the HIR of a module.
+/// Supports functions, `let` and `var`, arithmetic and comparisons, `if`, `while`, `for` and `loop`
+/// (with `break` and `continue`), `ret`, calls (also of the functions of the used modules)
+/// and `print`/`println` (lowered to `printf`).
+/// The default values of the parameters are passed by the callers, so they must be literals.
+export namespace jet::compiler::ir
+{
+
+/// Describes why the IR of a module could not be emitted.
+struct IRError
+{
+  /// The position in the source.
+  usize  pos = 0;
+  String details;
+};
+
+using IRResult = Result<std::monostate, IRError>;
+
+/// A module used by the emitted one.
+struct UsedModule
+{
+  /// The path of the module, e.g. `util::math`.
+  StringView name;
+
+  hir::Module const* hir = nullptr;
+};
+
+/// The place of the emitted module in the program.
+struct EmitContext
+{
+  /// The path of the module (e.g. `util::math`). It qualifies the names of its functions in the IR
+  /// (`util.math.add`), so that the functions of different modules never collide.
+  /// Empty for the root module, whose functions keep their names (`main` is the entry point of the program).
+  StringView module_name;
+
+  /// The top-level functions of these modules are declared in the IR once they are called.
+  /// A call by a path (`math::add`) selects the module whose path ends with the qualifier, and comes to
+  /// the used modules before the module itself (a call by a name alone comes to the module itself first).
+  Span<UsedModule const> used_modules;
+};
+
+/// Emits the IR of the module to the writer.
+/// Every function is formatted into buffers that are reused for the next ones, then written to the writer,
+/// so only a single function is held in memory at once (besides the buffer of the writer).
+/// @note The writer is not flushed. On error, it may contain a part of the IR.
+[[nodiscard]]
+auto emit_llvm_ir(hir::Module const& module, core::FileWriter& out, EmitContext const& context = {}) -> IRResult;
+
+} // namespace jet::compiler::ir
@@ -6,10 +6,6 @@ using namespace jet::comp::foundation;
 export namespace jet::compiler
 {
 
-struct Settings;
-
-auto make_settings_from_args(ProgramArgs const& args) -> Settings;
-
 struct Settings
 {
   // TODO: this should be optional.
@@ -19,14 +15,36 @@ struct Settings
   {
     Opt<String> llvm_ir_file_name;
     Opt<String> binary_name;
+
+    /// A file that receives the AST and source dumps of the parser.
+    Opt<String> parse_dump_file_name;
   };
 
   Output output;
   bool   cleanup_intermediate = true;
 
+  /// The number of jobs running at once (0 - one per hardware thread): the threads that read, parse, lower
+  /// and emit the modules, and the processes (e.g. compilations of units) started afterwards.
+  usize num_jobs = 0;
+
+  /// Prints the timings of the build stages at the end of the build.
+  bool report_timings = false;
+
   auto should_output_llvm_ir() const -> bool;
   auto should_output_binary() const -> bool;
+  auto should_dump_parse() const -> bool;
   auto should_cleanup_intermediate() const -> bool;
 };
 
+/// Describes an invalid program argument.
+struct SettingsError
+{
+  String details;
+};
+
+using SettingsResult = Result<Settings, SettingsError>;
+
+[[nodiscard]]
+auto make_settings_from_args(ProgramArgs const& args) -> SettingsResult;
+
 } // namespace jet::compiler
\ No newline at end of file
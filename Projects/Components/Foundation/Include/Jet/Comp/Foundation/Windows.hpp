@@ -0,0 +1,18 @@
+#pragma once
+
+/// Includes `<Windows.h>` without the `min` and `max` macros (which break `std::min` and `std::max`)
+/// and without the rarely used APIs. Include it instead of `<Windows.h>`, in the global module fragment.
+
+#ifdef WIN32
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <Windows.h>
+
+#endif
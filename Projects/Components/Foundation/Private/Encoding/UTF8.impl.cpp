@@ -1,7 +1,24 @@
 module;
 
-#ifdef WIN32
-#include <Windows.h>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#include <Jet/Comp/Foundation/Windows.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define JET_UTF8_X64 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define JET_UTF8_TARGET_AVX2
+  #else
+    #define JET_UTF8_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#else
+  #define JET_UTF8_X64 0
 #endif
 
 module Jet.Comp.Foundation.UTF8;
@@ -9,11 +26,7 @@ module Jet.Comp.Foundation.UTF8;
 namespace jet::comp::foundation
 {
 static auto is_continuation_byte(char ch) -> bool;
-static auto encoded_char_len(char leading_byte) -> u8;
-static auto decode_1(StringView text) -> Result<char32_t, UTF8DecodeError>;
-static auto decode_2(StringView text) -> Result<char32_t, UTF8DecodeError>;
-static auto decode_3(StringView text) -> Result<char32_t, UTF8DecodeError>;
-static auto decode_4(StringView text) -> Result<char32_t, UTF8DecodeError>;
+static auto check_sequence(u8 const* it, u8 const* end) -> Result<u8, UTF8DecodeError>;
 
 auto ensure_utf8_in_console() -> void
 {
@@ -35,83 +48,430 @@ auto next_utf8_pos(StringView text, usize after) -> usize
   return curr;
 }
 
-static auto encoded_char_len(char leading_byte) -> u8
+auto decode_utf8_char(StringView text) -> Result<char32_t, UTF8DecodeError>
+{
+  if (text.empty()) {
+    return error(UTF8DecodeError::NotEnoughRoom);
+  }
+
+  auto bytes  = reinterpret_cast<u8 const*>(text.data());
+  auto length = check_sequence(bytes, bytes + text.size());
+  if (auto err = length.err()) {
+    return error(*err);
+  }
+
+  switch (length.get_unchecked()) {
+  case 1: return success(char32_t(bytes[0]));
+  case 2: return success(char32_t(bytes[0] & 0x1f) << 6 | char32_t(bytes[1] & 0x3f));
+  case 3: return success(char32_t(bytes[0] & 0x0f) << 12 | char32_t(bytes[1] & 0x3f) << 6 | char32_t(bytes[2] & 0x3f));
+  default:
+    return success(
+      char32_t(bytes[0] & 0x07) << 18 | char32_t(bytes[1] & 0x3f) << 12 | char32_t(bytes[2] & 0x3f) << 6 |
+      char32_t(bytes[3] & 0x3f)
+    );
+  }
+}
+
+static auto is_continuation_byte(char ch) -> bool
+{
+  return (ch & 0b1100'0000) == 0b1000'0000;
+}
+
+/// Checks a single sequence against the well-formed byte sequences of Unicode (table 3-7):
+/// no overlong encodings, no surrogates and nothing above U+10FFFF.
+/// @returns The length of the sequence.
+static auto check_sequence(u8 const* it, u8 const* end) -> Result<u8, UTF8DecodeError>
 {
-  if ((leading_byte & 0b1000'0000) == 0b0000'0000) {
-    return 1;
+  auto const lead = it[0];
+  if (lead < 0x80) {
+    return success(u8(1));
+  }
+
+  // The range of the second byte depends on the lead, the other continuation bytes are always 80..BF.
+  auto length = u8(0);
+  auto low    = u8(0x80);
+  auto high   = u8(0xBF);
+  if (lead < 0xC2) {
+    return error(lead < 0xC0 ? UTF8DecodeError::InvalidLead : UTF8DecodeError::OverlongSequence);
+  }
+  else if (lead < 0xE0) {
+    length = 2;
+  }
+  else if (lead < 0xF0) {
+    length = 3;
+    low    = lead == 0xE0 ? u8(0xA0) : low;
+    high   = lead == 0xED ? u8(0x9F) : high;
+  }
+  else if (lead < 0xF5) {
+    length = 4;
+    low    = lead == 0xF0 ? u8(0x90) : low;
+    high   = lead == 0xF4 ? u8(0x8F) : high;
+  }
+  else {
+    return error(lead < 0xF8 ? UTF8DecodeError::InvalidCodePoint : UTF8DecodeError::InvalidLead);
   }
 
-  if ((leading_byte & 0b1110'0000) == 0b1100'0000) {
-    return 2;
+  if (end - it < length) {
+    return error(UTF8DecodeError::NotEnoughRoom);
   }
 
-  if ((leading_byte & 0b1111'0000) == 0b1110'0000) {
-    return 3;
+  if (it[1] < low || it[1] > high) {
+    if (it[1] < 0x80 || it[1] > 0xBF) {
+      return error(UTF8DecodeError::IncompleteSequence);
+    }
+    return error(lead == 0xE0 || lead == 0xF0 ? UTF8DecodeError::OverlongSequence : UTF8DecodeError::InvalidCodePoint);
   }
 
-  if ((leading_byte & 0b1111'1000) == 0b1111'0000) {
-    return 4;
+  for (auto i = 2; i < length; ++i) {
+    if (it[i] < 0x80 || it[i] > 0xBF) {
+      return error(UTF8DecodeError::IncompleteSequence);
+    }
   }
-  return 0;
+  return success(length);
 }
 
-auto decode_utf8_char(StringView text) -> Result<char32_t, UTF8DecodeError>
+/// Validates the text from the given position until the first sequence that ends at or after @p limit.
+/// @returns The position after the last validated sequence or the first error.
+static auto validate_scalar(u8 const* begin, u8 const* it, u8 const* limit, u8 const* end) -> Result<u8 const*, UTF8Error>
 {
-  auto len = encoded_char_len(text[0]);
-  switch (len) {
-  case 1: return decode_1(text);
-  case 2: return decode_2(text);
-  case 3: return decode_3(text);
-  case 4: return decode_4(text);
-  default: return error(UTF8DecodeError::InvalidLead);
+  while (it < limit) {
+    if (*it < 0x80) {
+      ++it;
+      continue;
+    }
+
+    auto length = check_sequence(it, end);
+    if (auto err = length.err()) {
+      return error(UTF8Error{usize(it - begin), *err});
+    }
+    it += length.get_unchecked();
   }
+  return success(it);
 }
 
-static auto is_continuation_byte(char ch) -> bool
+/// Appends the starts of the lines that follow the newlines among the bytes of the block.
+static auto push_newlines(u32 newlines, usize block_pos, DynArray<usize>& line_starts) -> void
 {
-  return (ch & 0b1100'0000) == 0b1000'0000;
+  while (newlines != 0) {
+    line_starts.push_back(block_pos + usize(std::countr_zero(newlines)) + 1);
+    newlines &= newlines - 1;
+  }
 }
 
-static auto decode_1(StringView text) -> Result<char32_t, UTF8DecodeError>
+static auto index_lines_scalar(StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>
 {
-  if (text.empty())
-    return error(UTF8DecodeError::NotEnoughRoom);
+  auto const begin = reinterpret_cast<u8 const*>(text.data());
+  auto const end   = begin + text.size();
 
-  return success(static_cast<char32_t>(text[0]));
+  auto result = Opt<UTF8Error>();
+  for (auto it = begin; it != end;) {
+    if (*it == '\n') {
+      line_starts.push_back(usize(it - begin) + 1);
+    }
+
+    if (*it < 0x80 || result) {
+      ++it;
+      continue;
+    }
+
+    // A newline byte never belongs to a multibyte sequence, so valid sequences are skipped at once.
+    auto length = check_sequence(it, end);
+    if (auto err = length.err()) {
+      result = UTF8Error{usize(it - begin), *err};
+      ++it;
+      continue;
+    }
+    it += length.get_unchecked();
+  }
+  return result;
 }
 
-static auto decode_2(StringView text) -> Result<char32_t, UTF8DecodeError>
+#if JET_UTF8_X64
+
+/// Indexes the lines of 16-byte blocks and skips the validation of the blocks that are pure ASCII.
+/// The other blocks are validated with the scalar code.
+static auto index_lines_sse2(StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>
 {
-  if (text.size() < 2)
-    return error(UTF8DecodeError::NotEnoughRoom);
+  auto const begin = reinterpret_cast<u8 const*>(text.data());
+  auto const end   = begin + text.size();
+
+  auto const newline = _mm_set1_epi8('\n');
+
+  auto result = Opt<UTF8Error>();
+
+  // Everything before this position was validated (it can be past the current block).
+  auto validated = begin;
+
+  auto it = begin;
+  for (; end - it >= 16; it += 16) {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    push_newlines(u32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline))), usize(it - begin), line_starts);
+
+    if (result || validated >= it + 16) {
+      continue;
+    }
+
+    if (_mm_movemask_epi8(bytes) == 0) {
+      validated = it + 16;
+      continue;
+    }
+
+    auto checked = validate_scalar(begin, validated, it + 16, end);
+    if (auto err = checked.err()) {
+      result = *err;
+      continue;
+    }
+    validated = checked.get_unchecked();
+  }
+
+  for (; it != end; ++it) {
+    if (*it == '\n') {
+      line_starts.push_back(usize(it - begin) + 1);
+    }
+  }
 
-  auto result = (char32_t(text[0]) << 6) & 0x7ff;
-  result += text[1] & 0x3f;
-  return success(result);
+  if (!result) {
+    auto checked = validate_scalar(begin, validated, end, end);
+    if (auto err = checked.err()) {
+      result = *err;
+    }
+  }
+  return result;
 }
 
-static auto decode_3(StringView text) -> Result<char32_t, UTF8DecodeError>
+// The AVX2 kernel validates whole blocks with the lookup algorithm of Keiser and Lemire
+// ("Validating UTF-8 In Less Than One Instruction Per Byte", 2021): every pair of adjacent bytes
+// is classified by three 16-entry tables (the high nibble of the first byte, its low nibble, and the
+// high nibble of the second byte). A bit that is set in all three classes marks an error.
+
+static auto constexpr TOO_SHORT      = u8(1 << 0); // 11______ 0_______ or 11______ 11______
+static auto constexpr TOO_LONG       = u8(1 << 1); // 0_______ 10______
+static auto constexpr OVERLONG_3     = u8(1 << 2); // 11100000 100_____
+static auto constexpr TOO_LARGE      = u8(1 << 3); // 11110100 1001____ (and above)
+static auto constexpr SURROGATE      = u8(1 << 4); // 11101101 101_____
+static auto constexpr OVERLONG_2     = u8(1 << 5); // 1100000_ 10______
+static auto constexpr TOO_LARGE_1000 = u8(1 << 6); // 11110101 1000____ (and above)
+static auto constexpr OVERLONG_4     = u8(1 << 6); // 11110000 1000____
+static auto constexpr TWO_CONTS      = u8(1 << 7); // 10______ 10______
+
+/// The errors that only depend on the high nibble of the first byte.
+static auto constexpr CARRY = u8(TOO_SHORT | TOO_LONG | TWO_CONTS);
+
+// clang-format off
+static auto constexpr BYTE_1_HIGH = Array<u8, 16>{
+  // 0_______ (ASCII)
+  TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+  // 10______ (continuation)
+  TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+  // 1100____, 1101____ (2-byte lead)
+  TOO_SHORT | OVERLONG_2, TOO_SHORT,
+  // 1110____ (3-byte lead)
+  TOO_SHORT | OVERLONG_3 | SURROGATE,
+  // 1111____ (4-byte lead)
+  TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+static auto constexpr BYTE_1_LOW = Array<u8, 16>{
+  CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,   // ____0000
+  CARRY | OVERLONG_2,                             // ____0001
+  CARRY,
+  CARRY,
+  CARRY | TOO_LARGE,                              // ____0100
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, // ____1101
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+  CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+static auto constexpr BYTE_2_HIGH = Array<u8, 16>{
+  // 0_______ (ASCII)
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+  // 1000____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+  // 1001____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+  // 101_____
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+  TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+  // 11______
+  TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+};
+// clang-format on
+
+/// Validates consecutive 32-byte blocks, carrying the state of the sequences that cross the blocks.
+struct AVX2Validator
 {
-  if (text.size() < 3)
-    return error(UTF8DecodeError::NotEnoughRoom);
+  __m256i previous_input;
+  __m256i previous_incomplete;
+
+  /// @returns @c true if the block (or a sequence that ends in it) is not valid.
+  JET_UTF8_TARGET_AVX2
+  auto check(__m256i input) -> bool
+  {
+    auto errors = __m256i();
+    if (_mm256_movemask_epi8(input) == 0) {
+      // An ASCII block only ends a sequence that was incomplete at the end of the previous block.
+      errors = previous_incomplete;
+    }
+    else {
+      auto prev1   = previous<1>(input);
+      auto special = _mm256_and_si256(
+        _mm256_and_si256(
+          _mm256_shuffle_epi8(make_table(BYTE_1_HIGH), high_nibbles(prev1)),
+          _mm256_shuffle_epi8(make_table(BYTE_1_LOW), _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))
+        ),
+        _mm256_shuffle_epi8(make_table(BYTE_2_HIGH), high_nibbles(input))
+      );
+
+      // Only the third and fourth bytes of sequences are continuations that follow a continuation.
+      auto is_third  = _mm256_subs_epu8(previous<2>(input), _mm256_set1_epi8(char(0xE0 - 0x80)));
+      auto is_fourth = _mm256_subs_epu8(previous<3>(input), _mm256_set1_epi8(char(0xF0 - 0x80)));
+      auto must_be_continuation = _mm256_and_si256(_mm256_or_si256(is_third, is_fourth), _mm256_set1_epi8(char(0x80)));
+
+      // The last byte of a block must be below a 2-byte lead, the one before it below a 3-byte lead
+      // and the one before it below a 4-byte lead, otherwise the sequence continues in the next block.
+      auto const max_block_end = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, char(0xF0 - 1), char(0xE0 - 1), char(0xC0 - 1)
+      );
+
+      errors              = _mm256_xor_si256(must_be_continuation, special);
+      previous_incomplete = _mm256_subs_epu8(input, max_block_end);
+    }
+
+    previous_input = input;
+    return !_mm256_testz_si256(errors, errors);
+  }
+
+  /// @returns The bytes of the input shifted by @p N bytes, with the last bytes of the previous input in front.
+  template <int N>
+  JET_UTF8_TARGET_AVX2 auto previous(__m256i input) const -> __m256i
+  {
+    return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous_input, input, 0x21), 16 - N);
+  }
+
+  JET_UTF8_TARGET_AVX2
+  static auto high_nibbles(__m256i bytes) -> __m256i
+  {
+    return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F));
+  }
+
+  /// @returns A table of 16 bytes repeated in both lanes, indexed by @c _mm256_shuffle_epi8().
+  JET_UTF8_TARGET_AVX2
+  static auto make_table(Array<u8, 16> const& table) -> __m256i
+  {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<__m128i const*>(table.data())));
+  }
+};
+
+JET_UTF8_TARGET_AVX2
+static auto index_lines_avx2(StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>
+{
+  auto const begin   = reinterpret_cast<u8 const*>(text.data());
+  auto const end     = begin + text.size();
+  auto const newline = _mm256_set1_epi8('\n');
+
+  // Initialized here, as the default member initializers would not be compiled for AVX2.
+  auto validator = AVX2Validator{_mm256_setzero_si256(), _mm256_setzero_si256()};
+  auto result    = Opt<UTF8Error>();
+
+  // Finds the first error with the scalar code. Every sequence that started before the block
+  // was valid, except the ones that cross into the block, which start at most 3 bytes earlier.
+  auto find_error = [&](u8 const* block) -> UTF8Error {
+    auto start = block - std::min(usize(block - begin), usize(3));
+    while (start > begin && is_continuation_byte(char(*start))) {
+      --start;
+    }
+
+    auto checked = validate_scalar(begin, start, end, end);
+    return checked.err() ? *checked.err() : UTF8Error{usize(block - begin), UTF8DecodeError::IncompleteSequence};
+  };
+
+  auto it = begin;
+  for (; end - it >= 32; it += 32) {
+    auto input = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    push_newlines(u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, newline))), usize(it - begin), line_starts);
+    if (!result && validator.check(input)) {
+      result = find_error(it);
+    }
+  }
+
+  // The last bytes are padded with zeros (ASCII), which end any incomplete sequence.
+  auto tail = Array<u8, 32>{};
+  std::memcpy(tail.data(), it, usize(end - it));
+
+  auto input = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tail.data()));
+  push_newlines(u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, newline))), usize(it - begin), line_starts);
+  if (!result && validator.check(input)) {
+    result = find_error(it);
+  }
 
-  auto result = (char32_t(text[0]) << 12) & 0xffff;
-  result += (char32_t(text[1]) << 6) & 0xfff;
-  result += text[2] & 0x3f;
-  return success(result);
+  return result;
 }
 
-static auto decode_4(StringView text) -> Result<char32_t, UTF8DecodeError>
+static auto cpu_supports_avx2() -> bool
 {
-  if (text.size() < 4)
-    return error(UTF8DecodeError::NotEnoughRoom);
+  #if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS has to save the YMM registers (OSXSAVE + XCR0).
+  __cpuid(info, 1);
+  auto os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+  __cpuidex(info, 7, 0);
+  return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+  #else
+  return __builtin_cpu_supports("avx2");
+  #endif
+}
+
+#endif
+
+auto best_utf8_kernel() -> UTF8Kernel
+{
+#if JET_UTF8_X64
+  static auto const kernel = cpu_supports_avx2() ? UTF8Kernel::AVX2 : UTF8Kernel::SSE2;
+  return kernel;
+#else
+  return UTF8Kernel::Scalar;
+#endif
+}
+
+auto to_string(UTF8Kernel kernel) -> StringView
+{
+  switch (kernel) {
+  case UTF8Kernel::Scalar: return "scalar";
+  case UTF8Kernel::SSE2: return "sse2";
+  case UTF8Kernel::AVX2: return "avx2";
+  }
+  return "<unknown>";
+}
 
-  auto result = (char32_t(text[0]) << 18) & 0x1fffff;
-  result += (char32_t(text[1]) << 12) & 0x3ffff;
-  result += (char32_t(text[2]) << 6) & 0xfff;
-  result += text[3] & 0x3f;
-  return success(result);
+auto index_utf8_lines(StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>
+{
+  return index_utf8_lines(best_utf8_kernel(), text, line_starts);
 }
 
+auto index_utf8_lines(UTF8Kernel kernel, StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>
+{
+  switch (kernel) {
+#if JET_UTF8_X64
+  case UTF8Kernel::AVX2: return index_lines_avx2(text, line_starts);
+  case UTF8Kernel::SSE2: return index_lines_sse2(text, line_starts);
+#endif
+  default: return index_lines_scalar(text, line_starts);
+  }
+}
 
-} // namespace jet::comp::foundation
\ No newline at end of file
+} // namespace jet::comp::foundation
@@ -0,0 +1,62 @@
+module;
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+module Jet.Comp.Foundation.Arena;
+
+namespace jet::comp::foundation
+{
+
+Arena::Arena(usize initial_size)
+{
+  if (initial_size != 0) {
+    buffer.resize(initial_size);
+    ++num_buffer_allocations;
+  }
+  this->start_cycle();
+}
+
+auto Arena::reset() -> void
+{
+  // Returns the additional blocks to the heap.
+  monotonic.reset();
+
+  if (upstream.num_bytes != 0) {
+    buffer = DynArray<std::byte>(buffer.size() + upstream.num_bytes);
+    ++num_buffer_allocations;
+    upstream.num_bytes = 0;
+  }
+
+  this->start_cycle();
+}
+
+auto Arena::start_cycle() -> void
+{
+  if (buffer.empty()) {
+    monotonic.emplace(&upstream);
+  }
+  else {
+    monotonic.emplace(buffer.data(), buffer.size(), &upstream);
+  }
+}
+
+auto Arena::Upstream::do_allocate(usize bytes, usize alignment) -> void*
+{
+  ++num_allocations;
+  num_bytes += bytes;
+  return ::operator new(bytes, std::align_val_t(alignment));
+}
+
+auto Arena::Upstream::do_deallocate(void* ptr, usize bytes, usize alignment) -> void
+{
+  ::operator delete(ptr, bytes, std::align_val_t(alignment));
+}
+
+auto Arena::Upstream::do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool
+{
+  return this == &other;
+}
+
+} // namespace jet::comp::foundation
@@ -0,0 +1,148 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+
+module Jet.Comp.Foundation.Interner;
+
+namespace jet::comp::foundation
+{
+
+auto Interner::intern(StringView text) -> Symbol
+{
+  auto const full_hash = std::hash<StringView>()(text);
+  auto const shard_id  = u32(full_hash % NUM_SHARDS);
+  auto const hash      = u32(full_hash >> SHARD_BITS);
+  auto&      shard     = shards[shard_id];
+
+  auto const symbol_of = [&](u32 index) {
+    return Symbol{(index << SHARD_BITS) | shard_id};
+  };
+
+  // Most strings are interned already: look them up without blocking the other readers.
+  {
+    auto lock = std::shared_lock(shard.mutex);
+    if (auto slot = shard.find(text, hash)) {
+      return symbol_of(slot->index);
+    }
+  }
+
+  auto lock = std::unique_lock(shard.mutex);
+  // Another thread may have interned the string in the meantime.
+  if (auto slot = shard.find(text, hash)) {
+    return symbol_of(slot->index);
+  }
+  return symbol_of(shard.insert(text, hash));
+}
+
+auto Interner::get(Symbol symbol) const -> StringView
+{
+  return shards[symbol.id % NUM_SHARDS].at(symbol.id >> SHARD_BITS);
+}
+
+auto Interner::size() const -> usize
+{
+  auto result = usize(0);
+  for (auto& shard : shards) {
+    result += shard.size.load(std::memory_order_relaxed);
+  }
+  return result;
+}
+
+auto Interner::locate(u32 index) -> Location
+{
+  // Bucket `b` holds the indices [2^(F+b) - 2^F, 2^(F+b+1) - 2^F), with F = FIRST_BUCKET_BITS.
+  auto const biased     = index + (1u << FIRST_BUCKET_BITS);
+  auto const bucket_bit = u32(std::bit_width(biased)) - 1;
+  return Location{bucket_bit - FIRST_BUCKET_BITS, biased - (1u << bucket_bit)};
+}
+
+auto Interner::Shard::at(u32 index) const -> StringView
+{
+  auto const location = locate(index);
+  return buckets[location.bucket].load(std::memory_order_acquire)[location.offset];
+}
+
+auto Interner::Shard::find(StringView text, u32 hash) const -> Slot const*
+{
+  if (slots.empty()) {
+    return nullptr;
+  }
+
+  auto const mask = slots.size() - 1;
+  for (auto pos = hash & mask;; pos = (pos + 1) & mask) {
+    auto& slot = slots[pos];
+    if (slot.index == Symbol::NONE) {
+      return nullptr;
+    }
+    if (slot.hash == hash && at(slot.index) == text) {
+      return &slot;
+    }
+  }
+}
+
+auto Interner::Shard::insert(StringView text, u32 hash) -> u32
+{
+  auto const index = size.load(std::memory_order_relaxed);
+  if (2 * (usize(index) + 1) > slots.size()) {
+    this->grow();
+  }
+
+  auto const location = locate(index);
+  auto*      bucket   = buckets[location.bucket].load(std::memory_order_relaxed);
+  if (bucket == nullptr) {
+    auto const bucket_size = usize(1) << (location.bucket + FIRST_BUCKET_BITS);
+    auto*      memory      = arena.resource()->allocate(bucket_size * sizeof(StringView), alignof(StringView));
+
+    bucket = static_cast<StringView*>(memory);
+    std::uninitialized_value_construct_n(bucket, bucket_size);
+    buckets[location.bucket].store(bucket, std::memory_order_release);
+  }
+
+  auto* bytes = static_cast<char*>(arena.resource()->allocate(std::max(text.size(), usize(1)), 1));
+  std::copy(text.begin(), text.end(), bytes);
+  bucket[location.offset] = StringView(bytes, text.size());
+
+  auto const mask = slots.size() - 1;
+  auto       pos  = hash & mask;
+  while (slots[pos].index != Symbol::NONE) {
+    pos = (pos + 1) & mask;
+  }
+  slots[pos] = Slot{hash, index};
+
+  size.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+auto Interner::Shard::grow() -> void
+{
+  auto old_slots = std::move(slots);
+  slots          = DynArray<Slot>(std::max(old_slots.size() * 2, usize(256)));
+
+  auto const mask = slots.size() - 1;
+  for (auto& slot : old_slots) {
+    if (slot.index == Symbol::NONE) {
+      continue;
+    }
+
+    auto pos = slot.hash & mask;
+    while (slots[pos].index != Symbol::NONE) {
+      pos = (pos + 1) & mask;
+    }
+    slots[pos] = slot;
+  }
+}
+
+auto use_interner() -> Interner&
+{
+  static auto interner = Interner();
+  return interner;
+}
+
+} // namespace jet::comp::foundation
@@ -1,6 +1,7 @@
 module;
 
 #include <string_view>
+#include <vector>
 
 export module Jet.Comp.Foundation.UTF8;
 
@@ -24,6 +25,44 @@ enum class UTF8DecodeError
   InvalidCodePoint,
 };
 
+/// Describes the first invalid sequence of a UTF-8 text.
+struct UTF8Error
+{
+  /// The position of the first byte of the sequence.
+  usize           pos = 0;
+  UTF8DecodeError reason;
+};
+
+/// Implementation of the UTF-8 validation.
+enum class UTF8Kernel
+{
+  Scalar,
+
+  /// 16-byte blocks of ASCII are skipped at once, other blocks are validated with the scalar code.
+  SSE2,
+
+  /// Every 32-byte block is validated with vector instructions (the lookup algorithm of Keiser and Lemire).
+  AVX2,
+};
+
+/// @returns The fastest kernel supported by the CPU (detected once).
+[[nodiscard]]
+auto best_utf8_kernel() -> UTF8Kernel;
+
+/// @returns The name of the kernel.
+[[nodiscard]]
+auto to_string(UTF8Kernel kernel) -> StringView;
+
+/// Validates a UTF-8 text and appends the starts of its lines (the positions after every `\n`)
+/// in a single pass. Only well-formed sequences are valid: overlong encodings, surrogates
+/// and code points above U+10FFFF are rejected.
+/// The lines are indexed through the whole text, even if it is not valid.
+/// @returns The first invalid sequence or @c std::nullopt if the text is valid.
+auto index_utf8_lines(StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>;
+
+/// Same as @c index_utf8_lines(), with the given kernel. The kernel must be supported by the CPU.
+auto index_utf8_lines(UTF8Kernel kernel, StringView text, DynArray<usize>& line_starts) -> Opt<UTF8Error>;
+
 /// @returns The next valid UTF-8 position after the given position.
 /// @param text The text to search in.
 /// @param after The position to start searching from.
@@ -31,6 +70,7 @@ auto next_utf8_pos(StringView text, usize after) -> usize;
 
 /// @returns Decoded UTF-8 character.
 /// @param text The text to decode. The character is assumed to start at index 0.
+/// Ill-formed sequences (see @c index_utf8_lines()) are rejected.
 auto decode_utf8_char(StringView text) -> Result<char32_t, UTF8DecodeError>;
 
 /// An entry inside a UTF-8 range.
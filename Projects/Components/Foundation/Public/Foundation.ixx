@@ -4,6 +4,8 @@ export import Jet.Comp.Foundation.StdTypes;
 export import Jet.Comp.Foundation.Result;
 export import Jet.Comp.Foundation.ProgramArgs;
 export import Jet.Comp.Foundation.UTF8;
+export import Jet.Comp.Foundation.Arena;
+export import Jet.Comp.Foundation.Interner;
 
 export namespace jet::comp::foundation
 {
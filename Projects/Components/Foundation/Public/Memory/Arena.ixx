@@ -0,0 +1,78 @@
+module;
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+export module Jet.Comp.Foundation.Arena;
+
+export import Jet.Comp.Foundation.StdTypes;
+
+export namespace jet::comp::foundation
+{
+
+/// A monotonic arena: allocations are bumped from large blocks and freed all at once by @c reset().
+/// The memory is kept after a reset. If the arena had to grow, its blocks are merged into a single one,
+/// so the next cycles that allocate the same amount of memory do not touch the heap.
+/// Use @c resource() to allocate standard containers from the arena (e.g. `std::pmr::vector`).
+/// @note The arena is not thread-safe.
+class Arena
+{
+public:
+  /// Creates an arena that holds @p initial_size bytes before it has to grow.
+  explicit Arena(usize initial_size = 64 * 1024);
+
+  Arena(Arena const&)                    = delete;
+  auto operator=(Arena const&) -> Arena& = delete;
+
+  /// Frees every allocation at once. Keeps the memory for the next allocations.
+  auto reset() -> void;
+
+  /// @returns The memory resource that allocates from the arena.
+  [[nodiscard]]
+  auto resource() -> std::pmr::memory_resource*
+  {
+    return &*monotonic;
+  }
+
+  /// @returns The number of bytes the arena can hold without growing.
+  [[nodiscard]]
+  auto capacity() const -> usize
+  {
+    return buffer.size();
+  }
+
+  /// @returns The number of heap allocations made by the arena since its creation.
+  [[nodiscard]]
+  auto num_heap_allocations() const -> usize
+  {
+    return num_buffer_allocations + upstream.num_allocations;
+  }
+
+private:
+  /// Starts allocating from the beginning of the buffer.
+  auto start_cycle() -> void;
+
+  /// Provides (and counts) the blocks that do not fit in the buffer.
+  struct Upstream final : std::pmr::memory_resource
+  {
+    usize num_allocations = 0;
+
+    /// Number of bytes allocated since the last reset.
+    usize num_bytes = 0;
+
+    auto do_allocate(usize bytes, usize alignment) -> void* override;
+    auto do_deallocate(void* ptr, usize bytes, usize alignment) -> void override;
+    auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override;
+  };
+
+  DynArray<std::byte> buffer;
+  Upstream            upstream;
+
+  Opt<std::pmr::monotonic_buffer_resource> monotonic;
+
+  usize num_buffer_allocations = 0;
+};
+
+} // namespace jet::comp::foundation
@@ -0,0 +1,110 @@
+module;
+
+#include <atomic>
+#include <shared_mutex>
+
+export module Jet.Comp.Foundation.Interner;
+
+export import Jet.Comp.Foundation.StdTypes;
+export import Jet.Comp.Foundation.Arena;
+
+export namespace jet::comp::foundation
+{
+
+/// An interned string. Equal strings interned in the same interner have equal symbols.
+struct Symbol
+{
+  static constexpr auto NONE = ~u32(0);
+
+  u32 id = NONE;
+
+  [[nodiscard]]
+  auto is_valid() const -> bool
+  {
+    return id != NONE;
+  }
+
+  auto operator==(Symbol const&) const -> bool = default;
+};
+
+/// Interns strings concurrently: every distinct string gets a stable 32-bit symbol and its bytes are stored once.
+/// The strings are split in shards (by their hash), each with its own lock, hash table and arena,
+/// so threads that intern different strings rarely wait for each other.
+/// The interned strings live as long as the interner.
+class Interner
+{
+public:
+  /// The low bits of a symbol select the shard, the others the string in the shard.
+  static constexpr auto SHARD_BITS = 4u;
+  static constexpr auto NUM_SHARDS = usize(1) << SHARD_BITS;
+
+  Interner() = default;
+
+  Interner(Interner const&)                    = delete;
+  auto operator=(Interner const&) -> Interner& = delete;
+
+  /// @returns The symbol of @p text, interned the first time it is seen. Thread-safe.
+  [[nodiscard]]
+  auto intern(StringView text) -> Symbol;
+
+  /// @returns The string of a symbol of this interner. Thread-safe and lock-free.
+  [[nodiscard]]
+  auto get(Symbol symbol) const -> StringView;
+
+  /// @returns The number of interned strings.
+  [[nodiscard]]
+  auto size() const -> usize;
+
+private:
+  /// The strings of a shard are stored in buckets of doubling sizes, so they never move
+  /// and can be read while other strings are added. A shard holds up to 2^28 - 2^8 strings.
+  static constexpr auto FIRST_BUCKET_BITS = 8u;
+  static constexpr auto NUM_BUCKETS       = 32u - SHARD_BITS - FIRST_BUCKET_BITS;
+
+  struct Slot
+  {
+    u32 hash  = 0;
+    u32 index = Symbol::NONE;
+  };
+
+  struct Shard
+  {
+    mutable std::shared_mutex mutex;
+
+    /// Open-addressing table of the indices of the strings, at most half full.
+    DynArray<Slot> slots;
+
+    Array<std::atomic<StringView*>, NUM_BUCKETS> buckets = {};
+    std::atomic<u32>                             size    = 0;
+
+    /// Holds the bytes of the strings and the buckets.
+    Arena arena = Arena(16 * 1024);
+
+    /// @returns The string at @p index, which was added before.
+    [[nodiscard]]
+    auto at(u32 index) const -> StringView;
+
+    [[nodiscard]]
+    auto find(StringView text, u32 hash) const -> Slot const*;
+    auto insert(StringView text, u32 hash) -> u32;
+    auto grow() -> void;
+  };
+
+  /// The position of a string in the buckets of its shard.
+  struct Location
+  {
+    u32 bucket = 0;
+    u32 offset = 0;
+  };
+
+  [[nodiscard]]
+  static auto locate(u32 index) -> Location;
+
+  Array<Shard, NUM_SHARDS> shards;
+};
+
+/// @returns The interner shared by every module of the process.
+[[nodiscard]]
+auto use_interner() -> Interner&;
+
+} // namespace jet::comp::foundation
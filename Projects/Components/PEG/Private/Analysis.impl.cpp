@@ -1,24 +1,94 @@
 module;
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 #include <string_view>
 #include <utility>
-#include <cctype>
 #include <optional>
+#include <unordered_map>
 #include <cassert>
 
 module Jet.Comp.PEG.Analysis;
 
 import Jet.Comp.PEG.Rule;
+import Jet.Comp.PEG.CharScan;
 
 namespace jet::comp::peg
 {
 
+/// Memo table of the packrat mode.
+/// Stores results of custom rule references keyed by (rule, position).
+struct PackratMemo
+{
+  struct MemoizedResult
+  {
+    bool  success = false;
+    usize end_pos = 0;
+
+    /// Offset of the produced AST entries within @c entry_pool.
+    usize entries_offset = 0;
+
+    /// Number of AST entries produced by the rule.
+    usize num_entries = 0;
+
+    /// Number of produced AST entries that are direct children of the enclosing entry.
+    usize num_top_level = 0;
+  };
+
+  /// Number of elements in the rule registry, used to build unique keys.
+  usize registry_size = 0;
+
+  usize max_results     = 0;
+  usize max_ast_entries = 0;
+
+  std::unordered_map<usize, MemoizedResult> results;
+
+  /// AST entries produced by the memoized rules.
+  /// @note @c next_id_same_nesting is stored relative to the first entry of a result.
+  DynArray<AST::Entry> entry_pool;
+
+  PackratStats stats;
+
+  [[nodiscard]]
+  auto make_key(CustomRuleRef rule, usize pos) const -> usize
+  {
+    return pos * registry_size + rule.offset;
+  }
+
+  /// Clears the table if any of the limits was exceeded.
+  auto enforce_limits() -> void
+  {
+    if (results.size() <= max_results && entry_pool.size() <= max_ast_entries) {
+      return;
+    }
+
+    results.clear();
+    entry_pool.clear();
+    ++stats.flushes;
+  }
+};
+
+/// Collects the counters of the named rules (see @c AnalysisOptions::profile).
+struct RuleProfiler
+{
+  RuleProfile& profile;
+
+  /// Time spent in the named rules tried by every profiled rule being matched (innermost last).
+  DynArray<std::chrono::nanoseconds> children_time;
+};
+
 struct MatcherContext
 {
   Grammar const& grammar;
   AnalysisState& state;
 
+  /// The memo table, or @c nullptr if packrat mode is disabled.
+  PackratMemo* memo = nullptr;
+
+  /// The profiler, or @c nullptr if profiling is disabled.
+  RuleProfiler* profiler = nullptr;
+
   auto get_rule_name(StructuralView rule) const -> StringView
   {
     return rule.get_name(grammar.text_registry);
@@ -50,6 +120,7 @@ static auto try_match_combinator_rule(MatcherContext ctx, StructuralView rule) -
 static auto try_match_structural_rule(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
 static auto try_match_builtin_rule(MatcherContext ctx, RuleRegistryView rule) -> RuleMatchResult;
 static auto try_match_rule_ref(MatcherContext ctx, CustomRuleRef rule) -> RuleMatchResult;
+static auto try_match_profiled_rule(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
 
 // Combinators
 
@@ -68,6 +139,10 @@ static auto try_match_combinator_plus(MatcherContext ctx, StructuralView rule) -
 static auto try_match_combinator_star(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
 static auto try_match_combinator_opt(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
 static auto try_match_combinator_one_if_not_at(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
+static auto try_match_combinator_precedence(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
+
+static auto try_match_operator_token(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
+static auto try_match_literal_set(MatcherContext ctx, StructuralView rule) -> RuleMatchResult;
 
 
 #ifndef NDEBUG
@@ -88,13 +163,13 @@ auto ASTBuilder::begin_entry(CustomRuleRef rule_id, usize start_pos) -> EntryID
     children_counter.back()++;
   }
 
-  auto entry_id = ast.entries.size();
+  auto entry_id = AST::Index(ast.entries.size());
   ast.entries.push_back({
-    rule_id,
+    AST::Index(rule_id.offset),
   });
 
   auto& entry = ast.entries.back();
-  entry.start_pos = start_pos;
+  entry.start_pos = AST::Index(start_pos);
   children_counter.push_back(0);
 
   return {entry_id};
@@ -103,9 +178,9 @@ auto ASTBuilder::begin_entry(CustomRuleRef rule_id, usize start_pos) -> EntryID
 auto ASTBuilder::finalize_entry(EntryID entry_id) -> void
 {
   auto& entry                = ast.get_entry(entry_id);
-  entry.next_id_same_nesting = EntryID(ast.entries.size());
-  entry.num_children         = children_counter.back();
-  entry.end_pos              = ast.current_pos;
+  entry.next_id_same_nesting = EntryID(AST::Index(ast.entries.size()));
+  entry.num_children         = AST::Index(children_counter.back());
+  entry.end_pos              = AST::Index(ast.current_pos);
   children_counter.pop_back();
 }
 
@@ -147,48 +222,284 @@ auto AnalysisState::restore(RestorePoint const& point) -> void
 
 auto analyze(Grammar const& grammar, StringView document) -> ASTAnalysisResult
 {
-  auto state    = AnalysisState();
-  state.content = document;
+  return analyze(grammar, document, AnalysisOptions{});
+}
+
+/// Creates the state of an analysis, using the memory of the workspace (if set).
+static auto make_analysis_state(StringView document, AnalysisOptions const& options) -> AnalysisState
+{
+  auto workspace = options.workspace;
+  auto allocator = workspace ? AST::EntryList::allocator_type(workspace->arena.resource())
+                             : AST::EntryList::allocator_type();
+
+  // The entries must be constructed with the allocator: assigning them later would copy into the heap.
+  auto state = AnalysisState{.content = document, .ast_builder = {.ast = {.entries = AST::EntryList(allocator)}}};
+
+  if (options.entries_per_byte > 0.0) {
+    state.ast_builder.ast.entries.reserve(usize(f64(document.size()) * options.entries_per_byte));
+  }
+
+  if (workspace) {
+    state.ast_builder.children_counter = std::move(workspace->children_counter);
+    state.ast_builder.children_counter.clear();
+  }
+
+  return state;
+}
+
+auto analyze(Grammar const& grammar, StringView document, AnalysisOptions const& options) -> ASTAnalysisResult
+{
+  // Positions of the entries would not fit in the AST.
+  if (document.size() > AST::MAX_DOCUMENT_SIZE) {
+    return error(FailedASTAnalysis{{document}});
+  }
 
-  auto context = MatcherContext{grammar, state};
+  auto state = make_analysis_state(document, options);
 
-  auto match_result = try_match_rule_ref(context, grammar.root_rule);
-  auto is_at_end    = state.ast_builder.ast.current_pos == document.size();
+  auto memo = Opt<PackratMemo>();
+  if (options.packrat) {
+    memo.emplace();
+    memo->registry_size   = grammar.rule_registry.data.size();
+    memo->max_results     = options.packrat_max_results;
+    memo->max_ast_entries = options.packrat_max_ast_entries;
+  }
+
+  auto profiler = Opt<RuleProfiler>();
+  if (PROFILING_ENABLED && options.profile) {
+    profiler.emplace(RuleProfiler{*options.profile});
+  }
+
+  auto context = MatcherContext{grammar, state, memo ? &*memo : nullptr, profiler ? &*profiler : nullptr};
+
+  auto match_result  = try_match_rule_ref(context, grammar.root_rule);
+  auto is_at_end     = state.ast_builder.ast.current_pos == document.size();
+  auto packrat_stats = memo ? memo->stats : PackratStats{};
+
+  if (options.workspace) {
+    options.workspace->children_counter = std::move(state.ast_builder.children_counter);
+  }
 
   if (state.parse_failed || !match_result.success || !is_at_end) {
-    return error(FailedASTAnalysis{document, std::move(state.ast_builder.ast), state.failed_rule});
+    auto failed          = FailedASTAnalysis{{document, std::move(state.ast_builder.ast)}, state.failed_rule};
+    failed.packrat_stats = packrat_stats;
+    return error(std::move(failed));
   }
 
-  return success(CompletedASTAnalysis{document, std::move(state.ast_builder.ast)});
+  auto completed          = CompletedASTAnalysis{{document, std::move(state.ast_builder.ast)}};
+  completed.packrat_stats = packrat_stats;
+  return success(std::move(completed));
 }
 
-static auto try_match_rule(MatcherContext ctx, RuleRegistryView rule) -> RuleMatchResult
+/// @returns IDs of the entries enclosing the edit, from the outermost to the innermost one.
+/// An entry encloses the edit if its first and last bytes are not affected by it.
+static auto find_entries_enclosing_edit(AST const& ast, TextEdit const& edit) -> DynArray<AST::EntryID>
 {
-  if (rule.at_end()) {
-    return {false};
+  auto enclosing = DynArray<AST::EntryID>();
+
+  auto e   = usize(0);
+  auto end = ast.entries.size();
+  while (e < end) {
+    auto& entry = ast.entries[e];
+
+    // Siblings are ordered by position, none of the next ones can enclose the edit.
+    if (entry.start_pos >= edit.start) {
+      break;
+    }
+
+    if (edit.old_end < entry.end_pos) {
+      enclosing.push_back({AST::Index(e)});
+
+      // Descend into the children.
+      end = entry.next_id_same_nesting.id;
+      e   = e + 1;
+      continue;
+    }
+
+    // Skip the entry together with its children.
+    e = entry.next_id_same_nesting.id;
   }
 
-  if (rule.at_structural()) {
+  return enclosing;
+}
 
-    // Add rule name to the stack for debug purposes:
-#ifndef NDEBUG
-    auto name = rule.as_structure().get_name(ctx.grammar.text_registry);
-    /// For debug purposes
-    if (!name.empty()) {
-      ctx.state.ast_builder.push_tested_rule(name);
+auto analyze_rule(Grammar const& grammar, CustomRuleRef rule, StringView document, usize start_pos)
+  -> ASTAnalysisResult
+{
+  if (document.size() > AST::MAX_DOCUMENT_SIZE) {
+    return error(FailedASTAnalysis{{document}});
+  }
+
+  auto state                        = AnalysisState();
+  state.content                     = document;
+  state.ast_builder.ast.current_pos = start_pos;
+
+  auto context      = MatcherContext{grammar, state};
+  auto match_result = try_match_rule_ref(context, rule);
+
+  if (state.parse_failed || !match_result.success) {
+    return error(FailedASTAnalysis{{document, std::move(state.ast_builder.ast)}, state.failed_rule});
+  }
+
+  return success(CompletedASTAnalysis{{document, std::move(state.ast_builder.ast)}});
+}
+
+/// @returns Whether the rule is an `IfMust` combinator. Its condition (e.g. a keyword) is captured
+/// in an entry of its own, right before the entry of the rest of the rule.
+static auto is_if_must_rule(Grammar const& grammar, CustomRuleRef rule) -> bool
+{
+  auto view = grammar.rule_registry.view_at(rule.offset);
+  if (!view.at_structural()) {
+    return false;
+  }
+  auto kind = view.as_structure().kind();
+  return kind.is_combinator() && kind.as_combinator() == CombinatorRule::IfMust;
+}
+
+/// Analyzes the entries of a rule of the previous AST in the new document.
+/// @param first The first entry of the rule.
+/// @param num_entries The number of entries that the rule captured at its level of nesting.
+/// @returns Entries of the reanalyzed rule or @c std::nullopt if it did not end where the edit moved it.
+static auto reanalyze_entry(
+  Grammar const& grammar, StringView document, AST::Entry const& first, usize num_entries, usize new_end_pos
+) -> Opt<AST::EntryList>
+{
+  auto result = analyze_rule(grammar, first.rule_id(), document, first.start_pos);
+  if (!result.is_ok()) {
+    return std::nullopt;
+  }
+
+  auto& ast = result.get_unchecked().ast;
+  if (ast.current_pos != new_end_pos || ast.entries.empty() || ast.entries.front().rule_offset != first.rule_offset) {
+    return std::nullopt;
+  }
+
+  // The rule must capture the same number of entries, the last one ending where the edit moved it.
+  auto last = usize(0);
+  for (auto i = usize(1); i < num_entries; ++i) {
+    last = ast.entries[last].next_id_same_nesting.id;
+    if (last >= ast.entries.size()) {
+      return std::nullopt;
     }
-#endif
+  }
+  auto const& last_entry = ast.entries[last];
+  if (last_entry.next_id_same_nesting.id != ast.entries.size() || last_entry.rule_offset != first.rule_offset ||
+      last_entry.end_pos != new_end_pos) {
+    return std::nullopt;
+  }
 
-    auto result = try_match_structural_rule(ctx, rule.as_structure());
+  return std::move(ast.entries);
+}
 
-    // Remove rule name from the stack:
-#ifndef NDEBUG
-    if (!name.empty()) {
-      ctx.state.ast_builder.pop_tested_rule();
+auto reanalyze(
+  Grammar const&           grammar,
+  AST const&               previous_ast,
+  StringView               document,
+  TextEdit const&          edit,
+  ReanalysisOptions const& options
+) -> ASTAnalysisResult
+{
+  assert(edit.start <= edit.old_end && edit.start <= edit.new_end && edit.new_end <= document.size());
+
+  auto is_anchor = [&](CustomRuleRef rule) {
+    for (auto anchor : options.anchor_rules) {
+      if (anchor == rule) {
+        return true;
+      }
     }
-#endif
+    return false;
+  };
 
-    return result;
+  // Shifts a position that follows the edit.
+  auto shift = [&](usize pos) { return AST::Index(pos - edit.old_end + edit.new_end); };
+
+  auto enclosing = find_entries_enclosing_edit(previous_ast, edit);
+
+  // Try the innermost anchor entry first, then the enclosing ones.
+  for (auto it = enclosing.rbegin(); it != enclosing.rend(); ++it) {
+    auto  entry_id = *it;
+    auto& entry    = previous_ast.get_entry(entry_id);
+    if (!is_anchor(entry.rule_id())) {
+      continue;
+    }
+
+    // An `IfMust` rule is analyzed again from its condition (e.g. from the `fn` of a function declaration),
+    // which replaces both of its entries.
+    auto first_id = entry_id;
+    if (entry_id.id != 0 && is_if_must_rule(grammar, entry.rule_id())) {
+      auto& condition = previous_ast.get_entry({AST::Index(entry_id.id - 1)});
+      if (condition.rule_offset == entry.rule_offset && condition.num_children == 0 &&
+          condition.next_id_same_nesting.id == entry_id.id) {
+        first_id = {AST::Index(entry_id.id - 1)};
+      }
+    }
+
+    auto& first       = previous_ast.get_entry(first_id);
+    auto  new_end_pos = shift(entry.end_pos);
+    auto  reanalyzed  = reanalyze_entry(grammar, document, first, entry_id.id - first_id.id + 1, new_end_pos);
+    if (!reanalyzed) {
+      continue;
+    }
+
+    auto const& old_entries = previous_ast.entries;
+    auto const  old_next    = entry.next_id_same_nesting.id;
+    auto const  new_next    = AST::Index(first_id.id + reanalyzed->size());
+
+    auto ast = AST();
+    ast.entries.reserve(old_entries.size() - (old_next - first_id.id) + reanalyzed->size());
+
+    // Entries before the reanalyzed ones: only the enclosing ones end after the edit.
+    for (auto i = usize(0); i < first_id.id; ++i) {
+      auto& copied = ast.entries.emplace_back(old_entries[i]);
+      if (copied.next_id_same_nesting.id > first_id.id) {
+        copied.next_id_same_nesting.id = copied.next_id_same_nesting.id - old_next + new_next;
+        copied.end_pos                 = shift(copied.end_pos);
+      }
+    }
+
+    for (auto& new_entry : *reanalyzed) {
+      auto& copied = ast.entries.emplace_back(new_entry);
+      copied.next_id_same_nesting.id += first_id.id;
+    }
+
+    // Entries after the reanalyzed ones.
+    for (auto i = old_next; i < old_entries.size(); ++i) {
+      auto& copied                   = ast.entries.emplace_back(old_entries[i]);
+      copied.next_id_same_nesting.id = copied.next_id_same_nesting.id - old_next + new_next;
+      copied.start_pos               = shift(copied.start_pos);
+      copied.end_pos                 = shift(copied.end_pos);
+    }
+
+    ast.current_pos = document.size();
+
+    auto completed                             = CompletedASTAnalysis{{document, std::move(ast)}};
+    completed.reanalysis_stats.reanalyzed_from = first.start_pos;
+    completed.reanalysis_stats.reanalyzed_to   = new_end_pos;
+    completed.reanalysis_stats.reused_entries  = old_entries.size() - (old_next - first_id.id);
+    return success(std::move(completed));
+  }
+
+  auto result = analyze(grammar, document);
+
+  auto& stats           = result.is_ok() ? result.get_unchecked().reanalysis_stats : result.err()->reanalysis_stats;
+  stats.full_reanalysis = true;
+  stats.reanalyzed_to   = document.size();
+  return result;
+}
+
+static auto try_match_rule(MatcherContext ctx, RuleRegistryView rule) -> RuleMatchResult
+{
+  if (rule.at_end()) {
+    return {false};
+  }
+
+  if (rule.at_structural()) {
+    if constexpr (PROFILING_ENABLED) {
+      if (ctx.profiler) {
+        return try_match_profiled_rule(ctx, rule.as_structure());
+      }
+    }
+
+    return try_match_structural_rule(ctx, rule.as_structure());
   }
 
   auto enc_rule = rule.as_rule();
@@ -203,6 +514,54 @@ static auto try_match_rule(MatcherContext ctx, RuleRegistryView rule) -> RuleMat
   return {};
 }
 
+/// Matches a structural rule and updates its counters (if it has a name).
+static auto try_match_profiled_rule(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
+{
+  using Clock = std::chrono::steady_clock;
+
+  auto name = ctx.get_rule_name(rule);
+  if (name.empty()) {
+    return try_match_structural_rule(ctx, rule);
+  }
+
+  auto& profiler = *ctx.profiler;
+  auto& state    = ctx.state;
+
+  // The counters can be moved by the nested rules, they are accessed by index.
+  auto const stats_index    = profiler.profile.stats_of(rule.get_ref(), name);
+  auto const start_pos      = state.current_pos();
+  auto const outer_furthest = state.furthest_pos;
+  state.furthest_pos        = start_pos;
+
+  profiler.children_time.emplace_back(0);
+  auto const start = Clock::now();
+
+  auto result = try_match_structural_rule(ctx, rule);
+
+  auto const elapsed       = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+  auto const children_time = profiler.children_time.back();
+  profiler.children_time.pop_back();
+  if (!profiler.children_time.empty()) {
+    profiler.children_time.back() += elapsed;
+  }
+
+  auto& stats = profiler.profile.rules[stats_index];
+  ++stats.calls;
+  stats.cumulative_time += elapsed;
+  stats.self_time += elapsed - children_time;
+  if (result.success) {
+    ++stats.successes;
+    stats.consumed_bytes += state.current_pos() - start_pos;
+  }
+  else {
+    ++stats.failures;
+    stats.backtracked_bytes += state.furthest_pos - start_pos;
+  }
+
+  state.furthest_pos = std::max(outer_furthest, state.furthest_pos);
+  return result;
+}
+
 static auto try_match_combinator_rule(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
 {
   using CR = CombinatorRule;
@@ -217,6 +576,8 @@ static auto try_match_combinator_rule(MatcherContext ctx, StructuralView rule) -
   case CR::Star: return try_match_combinator_star(ctx, rule);
   case CR::Opt: return try_match_combinator_opt(ctx, rule);
   case CR::OneIfNotAt: return try_match_combinator_one_if_not_at(ctx, rule);
+  case CR::Precedence: return try_match_combinator_precedence(ctx, rule);
+  default: break;
   }
 
   return {false};
@@ -240,135 +601,179 @@ static auto try_match_structural_rule(MatcherContext ctx, StructuralView rule) -
     return {success};
   }
 
+  if (rule.is_operator()) {
+    return try_match_operator_token(ctx, rule);
+  }
+
+  if (rule.is_literal_set()) {
+    return try_match_literal_set(ctx, rule);
+  }
+
   return {false};
 }
 
 static auto try_match_builtin_rule(MatcherContext ctx, RuleRegistryView rule) -> RuleMatchResult
 {
-  auto entire_str  = ctx.state.content;
-  auto current_str = ctx.state.current_str();
+  auto kind     = rule.as_rule().as_builtin();
+  auto consumed = match_builtin_rule(kind, ctx.state.content, ctx.state.current_pos());
+  if (!consumed) {
+    return {false};
+  }
 
-  auto kind = rule.as_rule().as_builtin();
+  if (*consumed != 0) {
+    ctx.state.consume(*consumed);
+  }
+  return {true};
+}
+
+auto match_builtin_rule(BuiltinRule kind, StringView content, usize pos) -> Opt<usize>
+{
+  auto current_str = content.substr(pos);
 
   if (current_str.empty()) {
     // Succeed only if the rule tests a WordBoundary:
-    return {kind == BuiltinRule::WordBoundary};
+    if (kind == BuiltinRule::WordBoundary) {
+      return usize(0);
+    }
+    return std::nullopt;
   }
 
-  auto consume_char_if = [](auto func, char c) -> usize { return func(c) ? 1 : 0; };
-
-  auto try_test_character = [&](BuiltinRule rule, char c) -> Opt<bool>
-  {
-    switch (rule) {
-    case BuiltinRule::Whitespace: return consume_char_if(std::isspace, c);
-    case BuiltinRule::Any: return 1; // always consume 1
-    case BuiltinRule::Alnum: return consume_char_if(std::isalnum, c);
-    case BuiltinRule::Alpha: return consume_char_if(std::isalpha, c);
-    case BuiltinRule::Digit: return consume_char_if(std::isdigit, c);
-    case BuiltinRule::IdentChar: return (c == '_' || std::isalnum(c));
-    case BuiltinRule::IdentFirstChar: return (c == '_' || std::isalpha(c));
-    default: return std::nullopt;
+  if (auto char_class = to_char_class(kind)) {
+    if (!is_in_class(*char_class, current_str.front())) {
+      return std::nullopt;
     }
-  };
+    return usize(1);
+  }
 
-  struct ConsumeResult
-  {
-    usize       count;
-    bool        success;
-    static auto count_based(usize count) -> ConsumeResult
-    {
-      return {count, count != 0};
+  switch (kind) {
+  case BuiltinRule::Any: return usize(1);
+  case BuiltinRule::Ident: {
+    if (!is_in_class(CharClass::IdentFirstChar, current_str.front())) {
+      return std::nullopt;
     }
-    static auto fail() -> ConsumeResult
-    {
-      return {0, false};
+    return 1 + scan_class_run(CharClass::IdentChar, content, pos + 1);
+  }
+  case BuiltinRule::UntilEOL: {
+    // Consumes the new line character as well.
+    auto eol = find_char(content, pos, '\n');
+    return eol == content.size() ? current_str.size() : eol - pos + 1;
+  }
+  case BuiltinRule::UntilEOF: {
+    return current_str.size();
+  }
+  case BuiltinRule::WordBoundary: {
+    if (pos == 0) {
+      return usize(0);
     }
-    static auto succeed(usize count = 1) -> ConsumeResult
-    {
-      return {count, true};
+
+    // TODO: make UTF8 aware
+    auto was_ident = is_in_class(CharClass::IdentChar, content[pos - 1]);
+    auto is_ident  = is_in_class(CharClass::IdentChar, current_str.front());
+    if (was_ident != is_ident) {
+      return usize(0);
     }
-  };
 
-  auto try_consume = [&]() -> ConsumeResult
-  {
-    auto single_char = try_test_character(kind, current_str[0]);
+    return std::nullopt;
+  }
+  default: return std::nullopt;
+  }
+}
 
-    if (single_char) {
-      return ConsumeResult::count_based(single_char.value() ? 1 : 0);
+auto repetition_run_class(StructuralView rule) -> Opt<CharClass>
+{
+  if (rule.num_children() != 1) {
+    return std::nullopt;
+  }
+
+  auto child = rule.first_child();
+  if (child.at_structural()) {
+    auto sor  = child.as_structure();
+    auto kind = sor.kind();
+    if (!kind.is_combinator() || kind.as_combinator() != CombinatorRule::Sor || kind.is_captured()) {
+      return std::nullopt;
+    }
+    if (sor.num_children() == 0) {
+      return std::nullopt;
     }
+    child = sor.first_child();
+  }
 
-    switch (kind) {
-    case BuiltinRule::Ident: {
-      auto test = try_test_character(BuiltinRule::IdentFirstChar, current_str[0]);
+  if (!child.at_rule_ref() || !child.as_rule().is_builtin()) {
+    return std::nullopt;
+  }
 
-      if (!test.value()) {
-        return ConsumeResult::fail();
-      }
+  return to_char_class(child.as_rule().as_builtin());
+}
 
-      auto consumed = usize(1);
-      auto rest     = current_str.substr(consumed);
-      for (auto c : rest) {
-        test = try_test_character(BuiltinRule::IdentChar, c);
-        if (!test.value()) {
-          break;
-        }
-        consumed += 1;
-      }
+static auto try_match_rule_ref(MatcherContext ctx, CustomRuleRef rule) -> RuleMatchResult
+{
+  auto view = ctx.grammar.rule_registry.view_at(rule.offset);
+
+  // Once the parse failed, nothing is worth memoizing.
+  if (ctx.memo == nullptr || ctx.state.parse_failed) {
+    return try_match_rule(ctx, view);
+  }
+
+  auto& memo     = *ctx.memo;
+  auto& builder  = ctx.state.ast_builder;
+  auto& entries  = builder.ast.entries;
+  auto const key = memo.make_key(rule, ctx.state.current_pos());
+
+  if (auto it = memo.results.find(key); it != memo.results.end()) {
+    ++memo.stats.hits;
 
-      return ConsumeResult::count_based(consumed);
+    auto const& memoized = it->second;
+    if (!memoized.success) {
+      return {false};
     }
-    case BuiltinRule::UntilEOL: {
-      auto consumed = usize(0);
-      for (auto c : current_str) {
-        consumed += 1;
-        if (c == '\n') {
-          break;
-        }
-      }
 
-      return ConsumeResult::succeed(consumed);
+    // Splice the memoized entries back, rebasing the sibling links.
+    auto const base = AST::Index(entries.size());
+    for (auto i = usize(0); i < memoized.num_entries; ++i) {
+      auto& entry = entries.emplace_back(memo.entry_pool[memoized.entries_offset + i]);
+      entry.next_id_same_nesting.id += base;
     }
-    case BuiltinRule::UntilEOF: {
-      return ConsumeResult::succeed(current_str.size());
+
+    if (!builder.children_counter.empty()) {
+      builder.children_counter.back() += memoized.num_top_level;
     }
-    case BuiltinRule::WordBoundary: {
-      if (ctx.state.current_pos() == 0) {
-        return ConsumeResult::succeed(0);
-      }
 
-      // TODO: make UTF8 aware
-      auto prev_pos  = ctx.state.current_pos() - 1;
-      auto was_ident = try_test_character(BuiltinRule::IdentChar, entire_str[prev_pos]);
-      // we checked if there is another character at the beginning of the outer function
-      auto is_ident = try_test_character(BuiltinRule::IdentChar, current_str.front());
+    builder.ast.current_pos = memoized.end_pos;
+    return {true};
+  }
 
-      assert(was_ident.has_value() && is_ident.has_value() && "IdentChar rule should be handled by `try_test_character`");
+  ++memo.stats.misses;
 
-      if (was_ident.value() != is_ident.value()) {
-        return ConsumeResult::succeed(0);
-      }
+  auto const first_entry    = entries.size();
+  auto const depth          = builder.children_counter.size();
+  auto const children_start = depth == 0 ? usize(0) : builder.children_counter.back();
 
-      return ConsumeResult::fail();
-    }
-    default: return ConsumeResult::fail();
-    }
-  };
+  auto result = try_match_rule(ctx, view);
 
-  auto consume_result = try_consume();
-  if (!consume_result.success) {
-    return {false};
+  // A failed `Must` aborts the whole analysis, the state is not reliable anymore.
+  if (ctx.state.parse_failed) {
+    return result;
   }
 
-  if (consume_result.count != 0) {
-    ctx.state.consume(consume_result.count);
+  auto memoized    = PackratMemo::MemoizedResult();
+  memoized.success = result.success;
+  memoized.end_pos = ctx.state.current_pos();
+
+  if (result.success) {
+    memoized.entries_offset = memo.entry_pool.size();
+    memoized.num_entries    = entries.size() - first_entry;
+    memoized.num_top_level  = depth == 0 ? usize(0) : builder.children_counter.back() - children_start;
+
+    for (auto i = first_entry; i < entries.size(); ++i) {
+      auto& entry = memo.entry_pool.emplace_back(entries[i]);
+      entry.next_id_same_nesting.id -= AST::Index(first_entry);
+    }
   }
-  return {true};
-}
 
-static auto try_match_rule_ref(MatcherContext ctx, CustomRuleRef rule) -> RuleMatchResult
-{
-  auto view = ctx.grammar.rule_registry.view_at(rule.offset);
-  return try_match_rule(ctx, view);
+  memo.results.emplace(key, memoized);
+  memo.enforce_limits();
+
+  return result;
 }
 
 static auto try_match_combinator_must_base(MatcherContext ctx, StructuralView rule, ChildrenRange children_range)
@@ -449,6 +854,15 @@ static auto try_match_combinator_seq(MatcherContext ctx, StructuralView rule) ->
 
 static auto try_match_combinator_sor(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
 {
+  // First sets of the rule itself, then of every alternative (empty if unavailable).
+  auto const first_sets = ctx.grammar.sor_dispatch.find(rule);
+  auto const next_byte  = ctx.state.at_end() ? Opt<u8>() : Opt<u8>(u8(ctx.state.current_str().front()));
+
+  // None of the alternatives can start here.
+  if (!first_sets.empty() && !first_sets[0].may_match(next_byte)) {
+    return {false};
+  }
+
   auto restore_point = ctx.state.create_restore_point();
 
   auto should_capture = rule.kind().is_captured();
@@ -459,6 +873,11 @@ static auto try_match_combinator_sor(MatcherContext ctx, StructuralView rule) ->
 
   auto child = rule.first_child();
   for (auto c = usize(0); c < rule.num_children(); ++c) {
+    if (!first_sets.empty() && !first_sets[c + 1].may_match(next_byte)) {
+      child = child.next_sibling();
+      continue;
+    }
+
     auto match_result = try_match_rule(ctx, child);
 
     if (ctx.state.parse_failed) {
@@ -518,8 +937,16 @@ static auto try_match_combinator_repeat(MatcherContext ctx, StructuralView rule,
     entry = ctx.begin_entry(rule);
   }
 
+  auto run_class = max_num == 0 ? repetition_run_class(rule) : std::nullopt;
+
   auto num_matches = usize(0);
   while (num_matches < max_num || max_num == 0) {
+    if (run_class && !ctx.state.parse_failed) {
+      auto run = scan_class_run(*run_class, ctx.state.content, ctx.state.current_pos());
+      ctx.state.consume(run);
+      num_matches += run;
+    }
+
     auto child = rule.first_child();
 
     auto inner_restore_point = ctx.state.create_restore_point();
@@ -577,4 +1004,318 @@ static auto try_match_combinator_opt(MatcherContext ctx, StructuralView rule) ->
   return try_match_combinator_repeat(ctx, rule, 0, 1);
 }
 
-} // namespace jet::comp::peg
\ No newline at end of file
+static auto try_match_operator_token(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
+{
+  // The capture flag of an operator belongs to its binary expression (see `nest_operators()`).
+  auto restore_point = ctx.state.create_restore_point();
+
+  auto child = rule.first_child();
+  for (auto c = usize(0); c < rule.num_children(); ++c) {
+    if (!try_match_rule(ctx, child).success) {
+      ctx.state.restore(restore_point);
+      return {false};
+    }
+    child = child.next_sibling();
+  }
+
+  return {true};
+}
+
+static auto try_match_literal_set(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
+{
+  auto& literal_sets = ctx.grammar.literal_sets;
+  auto  trie         = literal_sets.find(rule);
+  assert(trie && "A LiteralSet rule without a trie");
+
+  auto matched = literal_sets.match(*trie, ctx.state.current_str());
+  if (!matched) {
+    return {false};
+  }
+
+  if (rule.kind().is_captured()) {
+    auto entry = ctx.begin_entry(rule);
+    ctx.state.consume(matched->length);
+    ctx.state.ast_builder.finalize_entry(entry);
+  }
+  else {
+    ctx.state.consume(matched->length);
+  }
+
+  return {true};
+}
+
+static auto try_match_combinator_precedence(MatcherContext ctx, StructuralView rule) -> RuleMatchResult
+{
+  auto restore_point = ctx.state.create_restore_point();
+
+  auto should_capture = rule.kind().is_captured();
+  auto entry          = AST::EntryID();
+  if (should_capture) {
+    entry = ctx.begin_entry(rule);
+  }
+
+  auto& builder     = ctx.state.ast_builder;
+  auto& operators   = ctx.state.operator_matches;
+  auto const base   = operators.size();
+  auto const first  = builder.ast.entries.size();
+  auto const start  = ctx.state.current_pos();
+  auto const operand = rule.first_child();
+
+  // The operators that start with a text are dispatched with a trie.
+  auto const trie = ctx.grammar.literal_sets.find(rule);
+
+  auto matched_all = try_match_rule(ctx, operand).success;
+  while (matched_all && !ctx.state.parse_failed) {
+    auto iteration_point = ctx.state.create_restore_point();
+
+    // Operators are tried in order, like the alternatives of a `Sor`.
+    // The ones before the operator found in the trie cannot match their leading text.
+    auto first_operator = usize(0);
+    if (trie) {
+      auto matched = ctx.grammar.literal_sets.match(*trie, ctx.state.current_str());
+      if (!matched) {
+        break;
+      }
+      first_operator = matched->literal;
+    }
+
+    auto matched_operator = Opt<OperatorInfo>();
+    auto op               = operand.next_sibling();
+    for (auto c = usize(0); c < first_operator; ++c) {
+      op = op.next_sibling();
+    }
+    for (auto c = first_operator + 1; c < rule.num_children(); ++c) {
+      auto match_result = try_match_rule(ctx, op);
+      if (ctx.state.parse_failed) {
+        break;
+      }
+      if (match_result.success) {
+        matched_operator = OperatorInfo::of(op.as_structure());
+        break;
+      }
+      op = op.next_sibling();
+    }
+
+    if (ctx.state.parse_failed) {
+      break;
+    }
+
+    if (!matched_operator) {
+      ctx.state.restore(iteration_point);
+      break;
+    }
+
+    operators.push_back(OperatorMatch{
+      .info                = *matched_operator,
+      .first_entry         = iteration_point.num_entries,
+      .start_pos           = iteration_point.pos,
+      .operand_first_entry = builder.ast.entries.size(),
+      .operand_start_pos   = ctx.state.current_pos(),
+    });
+
+    // The operator is not followed by an operand: it is not a part of the expression.
+    if (!try_match_rule(ctx, operand).success) {
+      operators.pop_back();
+      ctx.state.restore(iteration_point);
+      break;
+    }
+  }
+
+  if (!matched_all || ctx.state.parse_failed) {
+    operators.resize(base);
+    if (should_capture) {
+      builder.fail_current_entry();
+    }
+    ctx.state.restore(restore_point);
+    return {false};
+  }
+
+  nest_operators(builder, ctx.grammar.text_registry, first, start, Span<OperatorMatch const>(operators).subspan(base));
+  operators.resize(base);
+
+  if (should_capture) {
+    builder.finalize_entry(entry);
+  }
+
+  return {true};
+}
+
+auto nest_operators(
+  ASTBuilder&               builder,
+  [[maybe_unused]] StringView text_registry,
+  usize                     first_entry,
+  usize                     start_pos,
+  Span<OperatorMatch const> operators
+) -> void
+{
+  auto const num_operators = operators.size();
+  if (num_operators == 0) {
+    return;
+  }
+
+  auto& entries            = builder.ast.entries;
+  auto const num_operands  = num_operators + 1;
+  auto const num_segments  = num_operands + num_operators;
+  auto const end_entry     = entries.size();
+
+  // The entries are split into segments, in order of appearance:
+  // operand 0, operator 0, operand 1, ..., operator n-1, operand n.
+  auto segment_begin = [&](usize s) -> usize {
+    if (s == 0) {
+      return first_entry;
+    }
+    auto& op = operators[(s - 1) / 2];
+    return s % 2 == 1 ? op.first_entry : op.operand_first_entry;
+  };
+  auto segment_end = [&](usize s) -> usize {
+    return s + 1 < num_segments ? segment_begin(s + 1) : end_entry;
+  };
+  auto count_top_level = [&](usize s) -> usize {
+    auto count = usize(0);
+    for (auto e = segment_begin(s); e < segment_end(s); e = entries[e].next_id_same_nesting.id) {
+      ++count;
+    }
+    return count;
+  };
+
+  auto operand_start = [&](usize k) { return k == 0 ? start_pos : operators[k - 1].operand_start_pos; };
+  auto operand_end   = [&](usize k) { return k < num_operators ? operators[k].start_pos : builder.ast.current_pos; };
+
+  // Nodes of the expression tree: operands first, then the operators.
+  struct Node
+  {
+    /// The first and the last operand of the subtree.
+    usize first_operand = 0;
+    usize last_operand  = 0;
+
+    /// Number of the top-level entries of the subtree (1 for a captured operator).
+    usize num_top_level = 0;
+
+    /// Number of children of the operator entry.
+    usize num_children = 0;
+  };
+
+  auto nodes          = DynArray<Node>(num_operands + num_operators);
+  auto old_top_level  = usize(0);
+  for (auto k = usize(0); k < num_operands; ++k) {
+    nodes[k] = Node{k, k, count_top_level(2 * k), 0};
+    old_top_level += nodes[k].num_top_level;
+  }
+
+  // Shunting-yard: an operator on the stack is reduced before the incoming one
+  // if it binds tighter, or as tight and the incoming one is left-associative.
+  auto operands = DynArray<usize>{0};
+  auto pending  = DynArray<usize>();
+  auto reduced  = DynArray<usize>();
+  reduced.reserve(num_operators);
+
+  auto reduce = [&] {
+    auto const i = pending.back();
+    pending.pop_back();
+
+    auto const rhs       = operands.back();
+    operands.pop_back();
+    auto const lhs       = operands.back();
+    auto const num_token = count_top_level(2 * i + 1);
+    old_top_level += num_token;
+
+    auto& node         = nodes[num_operands + i];
+    node.first_operand = nodes[lhs].first_operand;
+    node.last_operand  = nodes[rhs].last_operand;
+    node.num_children  = nodes[lhs].num_top_level + num_token + nodes[rhs].num_top_level;
+    node.num_top_level = operators[i].info.captured ? 1 : node.num_children;
+
+    operands.back() = num_operands + i;
+    reduced.push_back(i);
+  };
+
+  for (auto i = usize(0); i < num_operators; ++i) {
+    auto const& incoming = operators[i].info;
+    while (!pending.empty()) {
+      auto const& top   = operators[pending.back()].info;
+      auto binds_before = top.binding_power > incoming.binding_power
+                       || (top.binding_power == incoming.binding_power && incoming.associativity == Associativity::Left);
+      if (!binds_before) {
+        break;
+      }
+      reduce();
+    }
+    pending.push_back(i);
+    operands.push_back(i + 1);
+  }
+  while (!pending.empty()) {
+    reduce();
+  }
+
+  // The entry of a captured operator is placed before its first operand.
+  // Operators that start at the same operand are nested: the outer one is reduced later, so it goes first.
+  auto opening_start = DynArray<usize>(num_operands + 1, 0);
+  for (auto i : reduced) {
+    if (operators[i].info.captured) {
+      ++opening_start[nodes[num_operands + i].first_operand + 1];
+    }
+  }
+  for (auto k = usize(0); k < num_operands; ++k) {
+    opening_start[k + 1] += opening_start[k];
+  }
+  auto const num_inserted = opening_start[num_operands];
+  if (num_inserted == 0) {
+    return;
+  }
+
+  auto opening = DynArray<usize>(num_inserted);
+  {
+    auto fill = DynArray<usize>(opening_start.begin(), opening_start.end() - 1);
+    for (auto it = reduced.rbegin(); it != reduced.rend(); ++it) {
+      if (operators[*it].info.captured) {
+        opening[fill[nodes[num_operands + *it].first_operand]++] = *it;
+      }
+    }
+  }
+
+  // Number of the entries inserted before every segment.
+  auto shift = [&](usize s) { return opening_start[s / 2 + 1]; };
+
+  // Move the segments (from the last one) to make room for the inserted entries.
+  entries.resize(end_entry + num_inserted);
+  for (auto s = num_segments; s-- > 0;) {
+    auto const begin = segment_begin(s);
+    auto const end   = segment_end(s);
+    auto const delta = AST::Index(shift(s));
+
+    std::move_backward(entries.begin() + begin, entries.begin() + end, entries.begin() + end + delta);
+    for (auto e = begin + delta; e < end + delta; ++e) {
+      entries[e].next_id_same_nesting.id += delta;
+    }
+
+    if (s % 2 == 1) {
+      continue;
+    }
+
+    // Entries of the operators that start at this operand.
+    auto const k = s / 2;
+    for (auto o = opening_start[k]; o < opening_start[k + 1]; ++o) {
+      auto const i     = opening[o];
+      auto const& node = nodes[num_operands + i];
+      auto const last  = 2 * node.last_operand;
+      auto const& info = operators[i].info;
+
+      auto& op_entry                   = entries[begin + o];
+      op_entry                         = AST::Entry{AST::Index(info.rule.offset)};
+      op_entry.next_id_same_nesting.id = AST::Index(segment_end(last) + shift(last));
+      op_entry.num_children            = AST::Index(node.num_children);
+      op_entry.start_pos               = AST::Index(operand_start(node.first_operand));
+      op_entry.end_pos                 = AST::Index(operand_end(node.last_operand));
+#ifndef NDEBUG
+      op_entry.rule_name = text_registry.substr(info.name_start, info.name_length);
+#endif
+    }
+  }
+
+  if (!builder.children_counter.empty()) {
+    auto& counter = builder.children_counter.back();
+    counter       = counter - old_top_level + nodes[operands.back()].num_top_level;
+  }
+}
+
+} // namespace jet::comp::peg
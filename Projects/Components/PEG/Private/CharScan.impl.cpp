@@ -0,0 +1,308 @@
+module;
+
+#include <bit>
+#include <cinttypes>
+#include <initializer_list>
+#include <optional>
+
+#if defined(__x86_64__) || defined(_M_X64)
+  #define JET_PEG_SCAN_X64 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define JET_PEG_TARGET_AVX2
+  #else
+    #define JET_PEG_TARGET_AVX2 __attribute__((target("avx2")))
+  #endif
+#else
+  #define JET_PEG_SCAN_X64 0
+#endif
+
+module Jet.Comp.PEG.CharScan;
+
+namespace jet::comp::peg
+{
+
+/// Describes a character class as (up to) four inclusive byte ranges.
+/// Unused slots repeat the first range, so kernels can always test all four.
+struct ClassRanges
+{
+  Array<u8, 4> first;
+  Array<u8, 4> last;
+};
+
+static constexpr auto make_ranges(std::initializer_list<Array<u8, 2>> ranges) -> ClassRanges
+{
+  auto result = ClassRanges();
+  auto slot   = usize(0);
+  for (auto range : ranges) {
+    result.first[slot] = range[0];
+    result.last[slot]  = range[1];
+    ++slot;
+  }
+  for (; slot < 4; ++slot) {
+    result.first[slot] = result.first[0];
+    result.last[slot]  = result.last[0];
+  }
+  return result;
+}
+
+// clang-format off
+static constexpr auto CLASS_RANGES = Array<ClassRanges, usize(CharClass::MAX)>{
+  /* Whitespace     */ make_ranges({{'\t', '\r'}, {' ', ' '}}),
+  /* Alpha          */ make_ranges({{'a', 'z'}, {'A', 'Z'}}),
+  /* AlphaL         */ make_ranges({{'a', 'z'}}),
+  /* AlphaU         */ make_ranges({{'A', 'Z'}}),
+  /* Digit          */ make_ranges({{'0', '9'}}),
+  /* Alnum          */ make_ranges({{'a', 'z'}, {'A', 'Z'}, {'0', '9'}}),
+  /* IdentChar      */ make_ranges({{'a', 'z'}, {'A', 'Z'}, {'0', '9'}, {'_', '_'}}),
+  /* IdentFirstChar */ make_ranges({{'a', 'z'}, {'A', 'Z'}, {'_', '_'}}),
+};
+// clang-format on
+
+/// A lookup table of every class: bit N of an entry is set if the byte belongs to class N.
+static constexpr auto CLASS_TABLE = [] {
+  static_assert(usize(CharClass::MAX) <= 8, "Every class must fit in a single bit of the table entry");
+
+  auto table = Array<u8, 256>{};
+  for (auto c = usize(0); c < usize(CharClass::MAX); ++c) {
+    auto& ranges = CLASS_RANGES[c];
+    for (auto r = usize(0); r < 4; ++r) {
+      for (auto b = usize(ranges.first[r]); b <= usize(ranges.last[r]); ++b) {
+        table[b] |= u8(1u << c);
+      }
+    }
+  }
+  return table;
+}();
+
+static auto in_class(CharClass char_class, char c) -> bool
+{
+  return (CLASS_TABLE[u8(c)] >> u8(char_class)) & 1;
+}
+
+static auto scan_run_scalar(CharClass char_class, char const* it, char const* end) -> char const*
+{
+  while (it != end && in_class(char_class, *it)) {
+    ++it;
+  }
+  return it;
+}
+
+static auto find_char_scalar(char c, char const* it, char const* end) -> char const*
+{
+  while (it != end && *it != c) {
+    ++it;
+  }
+  return it;
+}
+
+#if JET_PEG_SCAN_X64
+
+// A byte `b` is within [first, last] if `b - first <= last - first` (unsigned, wrapping).
+
+static auto scan_run_sse2(CharClass char_class, char const* it, char const* end) -> char const*
+{
+  auto& ranges = CLASS_RANGES[usize(char_class)];
+
+  __m128i first[4], span[4];
+  for (auto r = 0; r < 4; ++r) {
+    first[r] = _mm_set1_epi8(char(ranges.first[r]));
+    span[r]  = _mm_set1_epi8(char(ranges.last[r] - ranges.first[r]));
+  }
+
+  while (end - it >= 16) {
+    auto bytes  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    auto member = _mm_setzero_si128();
+    for (auto r = 0; r < 4; ++r) {
+      auto offset = _mm_sub_epi8(bytes, first[r]);
+      member      = _mm_or_si128(member, _mm_cmpeq_epi8(_mm_min_epu8(offset, span[r]), offset));
+    }
+
+    auto outside = u32(_mm_movemask_epi8(member)) ^ 0xFFFFu;
+    if (outside != 0) {
+      return it + std::countr_zero(outside);
+    }
+    it += 16;
+  }
+
+  return scan_run_scalar(char_class, it, end);
+}
+
+static auto find_char_sse2(char c, char const* it, char const* end) -> char const*
+{
+  auto needle = _mm_set1_epi8(c);
+
+  while (end - it >= 16) {
+    auto bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    auto found = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, needle)));
+    if (found != 0) {
+      return it + std::countr_zero(found);
+    }
+    it += 16;
+  }
+
+  return find_char_scalar(c, it, end);
+}
+
+JET_PEG_TARGET_AVX2
+static auto scan_run_avx2(CharClass char_class, char const* it, char const* end) -> char const*
+{
+  auto& ranges = CLASS_RANGES[usize(char_class)];
+
+  __m256i first[4], span[4];
+  for (auto r = 0; r < 4; ++r) {
+    first[r] = _mm256_set1_epi8(char(ranges.first[r]));
+    span[r]  = _mm256_set1_epi8(char(ranges.last[r] - ranges.first[r]));
+  }
+
+  while (end - it >= 32) {
+    auto bytes  = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    auto member = _mm256_setzero_si256();
+    for (auto r = 0; r < 4; ++r) {
+      auto offset = _mm256_sub_epi8(bytes, first[r]);
+      member      = _mm256_or_si256(member, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span[r]), offset));
+    }
+
+    auto outside = ~u32(_mm256_movemask_epi8(member));
+    if (outside != 0) {
+      return it + std::countr_zero(outside);
+    }
+    it += 32;
+  }
+
+  return scan_run_sse2(char_class, it, end);
+}
+
+JET_PEG_TARGET_AVX2
+static auto find_char_avx2(char c, char const* it, char const* end) -> char const*
+{
+  auto needle = _mm256_set1_epi8(c);
+
+  while (end - it >= 32) {
+    auto bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    auto found = u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, needle)));
+    if (found != 0) {
+      return it + std::countr_zero(found);
+    }
+    it += 32;
+  }
+
+  return find_char_sse2(c, it, end);
+}
+
+static auto cpu_supports_avx2() -> bool
+{
+  #if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // The OS has to save the YMM registers (OSXSAVE + XCR0).
+  __cpuid(info, 1);
+  auto os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+  __cpuidex(info, 7, 0);
+  return os_saves_ymm && (info[1] & (1 << 5)) != 0;
+  #else
+  return __builtin_cpu_supports("avx2");
+  #endif
+}
+
+#endif
+
+auto to_char_class(BuiltinRule rule) -> Opt<CharClass>
+{
+  using R = BuiltinRule;
+  switch (rule) {
+  case R::Whitespace: return CharClass::Whitespace;
+  case R::Alpha: return CharClass::Alpha;
+  case R::AlphaL: return CharClass::AlphaL;
+  case R::AlphaU: return CharClass::AlphaU;
+  case R::Digit: return CharClass::Digit;
+  case R::Alnum: return CharClass::Alnum;
+  case R::IdentChar: return CharClass::IdentChar;
+  case R::IdentFirstChar: return CharClass::IdentFirstChar;
+  default: return std::nullopt;
+  }
+}
+
+auto is_in_class(CharClass char_class, char c) -> bool
+{
+  return in_class(char_class, c);
+}
+
+auto best_scan_kernel() -> ScanKernel
+{
+#if JET_PEG_SCAN_X64
+  static auto const kernel = cpu_supports_avx2() ? ScanKernel::AVX2 : ScanKernel::SSE2;
+  return kernel;
+#else
+  return ScanKernel::Scalar;
+#endif
+}
+
+auto to_string(ScanKernel kernel) -> StringView
+{
+  switch (kernel) {
+  case ScanKernel::Scalar: return "scalar";
+  case ScanKernel::SSE2: return "sse2";
+  case ScanKernel::AVX2: return "avx2";
+  }
+  return "<unknown>";
+}
+
+auto scan_class_run(CharClass char_class, StringView content, usize pos) -> usize
+{
+  return scan_class_run(best_scan_kernel(), char_class, content, pos);
+}
+
+auto find_char(StringView content, usize pos, char c) -> usize
+{
+  return find_char(best_scan_kernel(), content, pos, c);
+}
+
+auto scan_class_run(ScanKernel kernel, CharClass char_class, StringView content, usize pos) -> usize
+{
+  if (pos >= content.size()) {
+    return 0;
+  }
+
+  auto begin = content.data() + pos;
+  auto end   = content.data() + content.size();
+
+  // Most runs are short, so the first byte is tested before entering a kernel.
+  if (!in_class(char_class, *begin)) {
+    return 0;
+  }
+
+  switch (kernel) {
+#if JET_PEG_SCAN_X64
+  case ScanKernel::AVX2: return usize(scan_run_avx2(char_class, begin + 1, end) - begin);
+  case ScanKernel::SSE2: return usize(scan_run_sse2(char_class, begin + 1, end) - begin);
+#endif
+  default: return usize(scan_run_scalar(char_class, begin + 1, end) - begin);
+  }
+}
+
+auto find_char(ScanKernel kernel, StringView content, usize pos, char c) -> usize
+{
+  if (pos >= content.size()) {
+    return content.size();
+  }
+
+  auto begin = content.data() + pos;
+  auto end   = content.data() + content.size();
+
+  switch (kernel) {
+#if JET_PEG_SCAN_X64
+  case ScanKernel::AVX2: return usize(find_char_avx2(c, begin, end) - content.data());
+  case ScanKernel::SSE2: return usize(find_char_sse2(c, begin, end) - content.data());
+#endif
+  default: return usize(find_char_scalar(c, begin, end) - content.data());
+  }
+}
+
+} // namespace jet::comp::peg
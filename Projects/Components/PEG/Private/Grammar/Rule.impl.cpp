@@ -15,6 +15,7 @@ auto to_string(CombinatorRule rule) -> StringView
   case R::Star: return "Star";
   case R::Plus: return "Plus";
   case R::OneIfNotAt: return "OneIfNotAt";
+  case R::Precedence: return "Precedence";
   }
   return "<Unknown>";
 }
@@ -24,6 +25,8 @@ auto to_string(StructureRule rule) -> StringView
   using R = StructureRule;
   switch (rule) {
   case R::Text: return "Text";
+  case R::Operator: return "Operator";
+  case R::LiteralSet: return "LiteralSet";
   default: return "<unknown>";
   }
 }
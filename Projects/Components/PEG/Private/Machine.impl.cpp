@@ -0,0 +1,737 @@
+module;
+
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <optional>
+#include <cassert>
+
+module Jet.Comp.PEG.Machine;
+
+namespace jet::comp::peg
+{
+
+/// Lowers the rules of a grammar into the instruction stream.
+///
+/// Every combinator is compiled into the same sequence of state operations
+/// that the recursive analyzer performs, so both engines produce identical ASTs:
+/// - a rule that creates a restore point pushes a backtrack frame,
+/// - a failure continues at the handler of the top-most backtrack frame,
+/// - the handler cleans up the frame and either recovers or fails further.
+struct ProgramCompiler
+{
+  using Flags = InstructionFlags;
+
+  Grammar const& grammar;
+  Program        program;
+
+  /// Addresses of compiled rules that are called through custom rule references.
+  std::unordered_map<usize, u32> procedures;
+
+  /// Indices of entry infos by the offset of the rule.
+  std::unordered_map<usize, u32> entry_infos;
+
+  /// Calls to rules that are not compiled yet: (instruction index, rule offset).
+  DynArray<std::pair<u32, usize>> pending_calls;
+
+  /// Rules to be compiled as procedures.
+  DynArray<usize> pending_procedures;
+
+  auto emit(OpCode op, u32 a = 0, u32 b = 0) -> u32
+  {
+    auto index = this->here();
+    program.code.push_back(Instruction{op, a, b});
+    return index;
+  }
+
+  [[nodiscard]]
+  auto here() const -> u32
+  {
+    return u32(program.code.size());
+  }
+
+  auto compile() -> void;
+
+  auto compile_rule(RuleRegistryView rule) -> void;
+  auto compile_structural(StructuralView rule) -> void;
+  auto compile_call(CustomRuleRef rule) -> void;
+
+  auto compile_seq(StructuralView rule, usize from, usize to, u32 extra_flags = 0) -> void;
+  auto compile_sor(StructuralView rule) -> void;
+  auto compile_repeat(StructuralView rule, usize min_num, usize max_num = 0) -> void;
+  auto compile_one_if_not_at(StructuralView rule) -> void;
+  auto compile_precedence(StructuralView rule) -> void;
+  auto compile_literal_set(StructuralView rule) -> void;
+
+  /// @returns The index of the entry info that describes the given rule.
+  auto entry_info_of(StructuralView rule) -> u32;
+
+  /// @returns The index of the operator info that describes the given `Operator` rule.
+  auto operator_info_of(StructuralView rule) -> u32;
+
+  /// @returns Flags that describe the capture behavior of the rule.
+  /// The capture flag of an operator belongs to its binary expression, not to the token.
+  [[nodiscard]]
+  static auto capture_flags(StructuralView rule) -> u32
+  {
+    return rule.kind().is_captured() && !rule.is_operator() ? Flags::CAPTURED : 0;
+  }
+};
+
+/// A frame on the machine stack.
+/// Either a call frame (return address) or a backtrack frame (restore point and failure handler).
+struct MachineFrame
+{
+  /// Return address of a call frame, or failure handler of a backtrack frame.
+  u32  address = 0;
+  bool is_call = false;
+
+  AnalysisState::RestorePoint restore_point;
+
+  /// The AST entry bound to the frame (captured rules only).
+  AST::EntryID entry = {0};
+
+  /// Number of successful iterations (repetitions only).
+  usize num_matches = 0;
+
+  /// The first recorded operator and the first entry of the first operand (`Precedence` only).
+  usize operators_base = 0;
+  usize first_entry    = 0;
+};
+
+/// Executes a program over a document.
+struct Machine
+{
+  using Flags = InstructionFlags;
+
+  Program const& program;
+  AnalysisState  state;
+
+  DynArray<MachineFrame> frames;
+
+  u32 pc = 0;
+
+  /// Runs the program until it halts.
+  /// @returns @c true if the root rule matched.
+  auto run() -> bool;
+
+  /// Continues at the failure handler of the top-most backtrack frame.
+  auto fail() -> void
+  {
+    while (frames.back().is_call) {
+      frames.pop_back();
+    }
+    pc = frames.back().address;
+  }
+
+  auto push_backtrack_frame(u32 handler) -> void
+  {
+    frames.push_back(MachineFrame{handler, false, state.create_restore_point()});
+  }
+
+  auto begin_entry(EntryInfo const& info) -> AST::EntryID
+  {
+#ifndef NDEBUG
+    auto name = StringView(program.text_registry).substr(info.name_start, info.name_length);
+    return state.ast_builder.begin_entry(info.rule, state.current_pos(), name);
+#else
+    return state.ast_builder.begin_entry(info.rule, state.current_pos());
+#endif
+  }
+
+  /// Finalizes the entry of the top-most frame (if captured) and pops it.
+  auto commit_frame(u32 flags) -> void
+  {
+    if (flags & Flags::CAPTURED) {
+      state.ast_builder.finalize_entry(frames.back().entry);
+    }
+    frames.pop_back();
+  }
+
+  /// Fails the entry of the top-most frame (if captured), restores the state and pops the frame.
+  auto unwind_frame(u32 flags) -> void
+  {
+    auto keep_entry = (flags & Flags::KEEP_ENTRY_ON_ABORT) && state.parse_failed;
+    if ((flags & Flags::CAPTURED) && !keep_entry) {
+      state.ast_builder.fail_current_entry();
+    }
+    state.restore(frames.back().restore_point);
+    frames.pop_back();
+  }
+
+  [[nodiscard]]
+  auto next_byte() const -> Opt<u8>
+  {
+    if (state.at_end()) {
+      return std::nullopt;
+    }
+    return u8(state.current_str().front());
+  }
+};
+
+auto compile_grammar(Grammar const& grammar) -> Program
+{
+  auto compiler                  = ProgramCompiler{grammar};
+  compiler.program.text_registry = grammar.text_registry;
+  compiler.program.first_sets    = grammar.sor_dispatch.first_sets;
+  compiler.program.literal_sets  = grammar.literal_sets;
+  compiler.compile();
+  return std::move(compiler.program);
+}
+
+auto analyze(Program const& program, StringView document) -> ASTAnalysisResult
+{
+  if (document.size() > AST::MAX_DOCUMENT_SIZE) {
+    return error(FailedASTAnalysis{{document}});
+  }
+
+  auto machine          = Machine{program};
+  machine.state.content = document;
+  machine.frames.reserve(256);
+
+  auto& state = machine.state;
+
+  auto match_success = machine.run();
+  auto is_at_end     = state.ast_builder.ast.current_pos == document.size();
+
+  if (state.parse_failed || !match_success || !is_at_end) {
+    return error(FailedASTAnalysis{{document, std::move(state.ast_builder.ast)}, state.failed_rule});
+  }
+
+  return success(CompletedASTAnalysis{{document, std::move(state.ast_builder.ast)}});
+}
+
+auto ProgramCompiler::compile() -> void
+{
+  // Entry point:
+  auto root_frame = this->emit(OpCode::PushFrame);
+  this->compile_call(grammar.root_rule);
+  (void)this->emit(OpCode::Halt, 1);
+  program.code[root_frame].a = this->emit(OpCode::Halt, 0);
+
+  while (!pending_procedures.empty()) {
+    auto offset = pending_procedures.back();
+    pending_procedures.pop_back();
+
+    if (procedures.contains(offset)) {
+      continue;
+    }
+
+    procedures[offset] = this->here();
+    this->compile_rule(grammar.rule_registry.view_at(offset));
+    (void)this->emit(OpCode::Return);
+  }
+
+  for (auto [instruction, offset] : pending_calls) {
+    program.code[instruction].a = procedures.at(offset);
+  }
+}
+
+auto ProgramCompiler::compile_rule(RuleRegistryView rule) -> void
+{
+  if (rule.at_end()) {
+    (void)this->emit(OpCode::Fail);
+    return;
+  }
+
+  if (rule.at_structural()) {
+    this->compile_structural(rule.as_structure());
+    return;
+  }
+
+  auto enc_rule = rule.as_rule();
+
+  if (enc_rule.is_builtin()) {
+    (void)this->emit(OpCode::Builtin, u32(enc_rule.as_builtin()));
+  }
+  else if (enc_rule.is_custom()) {
+    this->compile_call(enc_rule.to_custom());
+  }
+  else {
+    (void)this->emit(OpCode::Fail);
+  }
+}
+
+auto ProgramCompiler::compile_structural(StructuralView rule) -> void
+{
+  using CR = CombinatorRule;
+
+  if (rule.is_text()) {
+    auto text        = rule.get_text(grammar.text_registry);
+    auto text_offset = usize(text.data() - grammar.text_registry.data());
+    (void)this->emit(OpCode::Text, u32(text_offset), u32(text.size()));
+    return;
+  }
+
+  if (rule.is_operator()) {
+    this->compile_seq(rule, 0, rule.num_children());
+    return;
+  }
+
+  if (rule.is_literal_set()) {
+    this->compile_literal_set(rule);
+    return;
+  }
+
+  if (!rule.kind().is_combinator()) {
+    (void)this->emit(OpCode::Fail);
+    return;
+  }
+
+  switch (rule.kind().as_combinator()) {
+  case CR::Must: this->compile_seq(rule, 0, rule.num_children(), Flags::MUST); break;
+  case CR::IfMust:
+    this->compile_seq(rule, 0, 1);
+    this->compile_seq(rule, 1, rule.num_children(), Flags::MUST);
+    break;
+  case CR::Seq: this->compile_seq(rule, 0, rule.num_children()); break;
+  case CR::Sor: this->compile_sor(rule); break;
+  case CR::Plus: this->compile_repeat(rule, 1); break;
+  case CR::Star: this->compile_repeat(rule, 0); break;
+  case CR::Opt: this->compile_repeat(rule, 0, 1); break;
+  case CR::OneIfNotAt: this->compile_one_if_not_at(rule); break;
+  case CR::Precedence: this->compile_precedence(rule); break;
+  default: (void)this->emit(OpCode::Fail); break;
+  }
+}
+
+auto ProgramCompiler::compile_call(CustomRuleRef rule) -> void
+{
+  if (auto it = procedures.find(rule.offset); it != procedures.end()) {
+    (void)this->emit(OpCode::Call, it->second);
+    return;
+  }
+
+  pending_calls.emplace_back(this->emit(OpCode::Call), rule.offset);
+  pending_procedures.push_back(rule.offset);
+}
+
+auto ProgramCompiler::compile_seq(StructuralView rule, usize from, usize to, u32 extra_flags) -> void
+{
+  auto const flags = capture_flags(rule) | extra_flags;
+
+  auto frame = this->emit(OpCode::PushFrame);
+  if (flags & Flags::CAPTURED) {
+    (void)this->emit(OpCode::BeginEntry, this->entry_info_of(rule));
+  }
+
+  auto child = rule.first_child();
+  for (auto c = usize(0); c < to; ++c) {
+    if (c >= from) {
+      this->compile_rule(child);
+    }
+    child = child.next_sibling();
+  }
+
+  auto commit = this->emit(OpCode::Commit, flags);
+
+  program.code[frame].a  = this->emit(OpCode::Unwind, flags, u32(rule.current_offset));
+  program.code[commit].b = this->here();
+}
+
+auto ProgramCompiler::compile_sor(StructuralView rule) -> void
+{
+  auto const flags = capture_flags(rule) | Flags::KEEP_ENTRY_ON_ABORT;
+
+  // Index of the first set of the Sor itself, followed by the first sets of its alternatives.
+  auto dispatch = Opt<u32>();
+  if (!grammar.sor_dispatch.find(rule).empty()) {
+    dispatch = u32(grammar.sor_dispatch.index[rule.current_offset]);
+    (void)this->emit(OpCode::TestFirst, *dispatch);
+  }
+
+  auto frame = this->emit(OpCode::PushFrame);
+  if (flags & Flags::CAPTURED) {
+    (void)this->emit(OpCode::BeginEntry, this->entry_info_of(rule));
+  }
+
+  auto commits = DynArray<u32>();
+  auto aborts  = DynArray<u32>();
+
+  auto child = rule.first_child();
+  for (auto c = usize(0); c < rule.num_children(); ++c) {
+    auto skip = Opt<u32>();
+    if (dispatch) {
+      skip = this->emit(OpCode::SkipUnlessFirst, *dispatch + u32(c) + 1);
+    }
+
+    auto set_handler = this->emit(OpCode::SetHandler);
+    this->compile_rule(child);
+    commits.push_back(this->emit(OpCode::Commit, flags));
+
+    // The alternative failed: stop if aborted, otherwise try the next one.
+    program.code[set_handler].a = this->emit(OpCode::JumpIfAborted);
+    aborts.push_back(program.code[set_handler].a);
+
+    if (skip) {
+      program.code[*skip].b = this->here();
+    }
+
+    child = child.next_sibling();
+  }
+
+  auto unwind           = this->emit(OpCode::Unwind, flags, u32(rule.current_offset));
+  program.code[frame].a = unwind;
+
+  for (auto abort : aborts) {
+    program.code[abort].a = unwind;
+  }
+
+  for (auto commit : commits) {
+    program.code[commit].b = this->here();
+  }
+}
+
+auto ProgramCompiler::compile_repeat(StructuralView rule, usize min_num, usize max_num) -> void
+{
+  auto const flags = capture_flags(rule);
+
+  auto frame = this->emit(OpCode::PushFrame);
+  if (flags & Flags::CAPTURED) {
+    (void)this->emit(OpCode::BeginEntry, this->entry_info_of(rule));
+  }
+
+  auto loop      = this->here();
+  auto check_max = this->emit(OpCode::RepeatCheckMax, u32(max_num));
+
+  if (auto run_class = max_num == 0 ? repetition_run_class(rule) : std::nullopt) {
+    (void)this->emit(OpCode::ScanRun, u32(*run_class));
+  }
+
+  auto iteration = this->emit(OpCode::PushFrame);
+  auto child     = rule.first_child();
+  for (auto c = usize(0); c < rule.num_children(); ++c) {
+    this->compile_rule(child);
+    child = child.next_sibling();
+  }
+  (void)this->emit(OpCode::RepeatNext, loop);
+
+  auto stop                 = this->emit(OpCode::RepeatStop);
+  program.code[iteration].a = stop;
+
+  auto done                 = this->here();
+  program.code[check_max].b = done;
+  program.code[stop].a      = done;
+  program.code[frame].a     = done;
+
+  (void)this->emit(OpCode::RepeatEnd, flags, u32(min_num));
+}
+
+auto ProgramCompiler::compile_one_if_not_at(StructuralView rule) -> void
+{
+  (void)this->emit(OpCode::FailIfAtEnd);
+
+  auto frame = this->emit(OpCode::PushFrame);
+  this->compile_seq(rule, 0, rule.num_children());
+  (void)this->emit(OpCode::PeekMatched);
+
+  program.code[frame].a = this->emit(OpCode::PeekFailed);
+}
+
+auto ProgramCompiler::compile_precedence(StructuralView rule) -> void
+{
+  auto const flags = capture_flags(rule);
+
+  auto frame = this->emit(OpCode::PushFrame);
+  if (flags & Flags::CAPTURED) {
+    (void)this->emit(OpCode::BeginEntry, this->entry_info_of(rule));
+  }
+  (void)this->emit(OpCode::PrecedenceBegin);
+
+  auto const operand = rule.first_child();
+  this->compile_rule(operand);
+
+  // Every iteration: one of the operators (like a non-captured `Sor`), then the operand.
+  auto loop      = this->here();
+  auto iteration = this->emit(OpCode::PushFrame);
+
+  // The operators that start with a text are dispatched with a trie:
+  // jump_targets[table] is the target if none matched, then one target per operator.
+  auto table = Opt<usize>();
+  if (auto trie = grammar.literal_sets.find(rule)) {
+    table = program.jump_targets.size();
+    program.jump_targets.resize(*table + rule.num_children());
+    (void)this->emit(OpCode::DispatchLiteral, u32(*trie), u32(*table));
+  }
+
+  auto to_operand = DynArray<u32>();
+  auto to_stop    = DynArray<u32>();
+
+  auto op = operand.next_sibling();
+  for (auto c = usize(1); c < rule.num_children(); ++c) {
+    auto set_handler = this->emit(OpCode::SetHandler);
+    if (table) {
+      program.jump_targets[*table + c] = set_handler;
+    }
+    this->compile_rule(op);
+    (void)this->emit(OpCode::OperatorMatched, this->operator_info_of(op.as_structure()));
+    to_operand.push_back(this->emit(OpCode::Jump));
+
+    // The operator failed: stop if aborted, otherwise try the next one.
+    program.code[set_handler].a = this->emit(OpCode::JumpIfAborted);
+    to_stop.push_back(program.code[set_handler].a);
+
+    op = op.next_sibling();
+  }
+  to_stop.push_back(this->emit(OpCode::Jump));
+
+  for (auto jump : to_operand) {
+    program.code[jump].a = this->here();
+  }
+  auto operand_handler = this->emit(OpCode::SetHandler);
+  this->compile_rule(operand);
+  (void)this->emit(OpCode::RepeatNext, loop);
+
+  // The operator is not followed by an operand: it is not a part of the expression.
+  program.code[operand_handler].a = this->emit(OpCode::OperatorDrop);
+
+  auto stop                 = this->emit(OpCode::RepeatStop);
+  program.code[iteration].a = stop;
+  for (auto jump : to_stop) {
+    program.code[jump].a = stop;
+  }
+  if (table) {
+    program.jump_targets[*table] = stop;
+  }
+
+  auto end               = this->emit(OpCode::PrecedenceEnd, flags);
+  program.code[stop].a   = end;
+  program.code[frame].a  = this->emit(OpCode::Unwind, flags, u32(rule.current_offset));
+  program.code[end].b    = this->here();
+}
+
+auto ProgramCompiler::compile_literal_set(StructuralView rule) -> void
+{
+  auto const flags = capture_flags(rule);
+  auto const trie  = grammar.literal_sets.find(rule);
+  assert(trie && "A LiteralSet rule without a trie");
+
+  if (!(flags & Flags::CAPTURED)) {
+    (void)this->emit(OpCode::Literal, u32(*trie));
+    return;
+  }
+
+  auto frame = this->emit(OpCode::PushFrame);
+  (void)this->emit(OpCode::BeginEntry, this->entry_info_of(rule));
+  (void)this->emit(OpCode::Literal, u32(*trie));
+  auto commit = this->emit(OpCode::Commit, flags);
+
+  program.code[frame].a  = this->emit(OpCode::Unwind, flags, u32(rule.current_offset));
+  program.code[commit].b = this->here();
+}
+
+auto ProgramCompiler::operator_info_of(StructuralView rule) -> u32
+{
+  auto index = u32(program.operators.size());
+  program.operators.push_back(OperatorInfo::of(rule));
+  return index;
+}
+
+auto ProgramCompiler::entry_info_of(StructuralView rule) -> u32
+{
+  if (auto it = entry_infos.find(rule.current_offset); it != entry_infos.end()) {
+    return it->second;
+  }
+
+  using SV  = StructuralView;
+  auto info = EntryInfo{
+    .rule        = rule.get_ref(),
+    .name_start  = rule.context[rule.current_offset + SV::NAME_START_OFFSET],
+    .name_length = rule.context[rule.current_offset + SV::NAME_LENGTH_OFFSET],
+  };
+
+  auto index = u32(program.entries.size());
+  program.entries.push_back(info);
+  entry_infos[rule.current_offset] = index;
+  return index;
+}
+
+auto Machine::run() -> bool
+{
+  using OC = OpCode;
+
+  while (true) {
+    auto const& ins = program.code[pc];
+
+    switch (ins.op) {
+    case OC::Halt: return ins.a != 0;
+    case OC::Jump: pc = ins.a; continue;
+    case OC::Call: {
+      frames.push_back(MachineFrame{pc + 1, true});
+      pc = ins.a;
+      continue;
+    }
+    case OC::Return: {
+      pc = frames.back().address;
+      frames.pop_back();
+      continue;
+    }
+    case OC::Fail: this->fail(); continue;
+    case OC::Text: {
+      auto text = StringView(program.text_registry).substr(ins.a, ins.b);
+      if (!state.current_str().starts_with(text)) {
+        this->fail();
+        continue;
+      }
+      state.consume(text.size());
+      break;
+    }
+    case OC::Builtin: {
+      auto consumed = match_builtin_rule(BuiltinRule(ins.a), state.content, state.current_pos());
+      if (!consumed) {
+        this->fail();
+        continue;
+      }
+      state.consume(*consumed);
+      break;
+    }
+    case OC::Literal: {
+      auto matched = program.literal_sets.match(ins.a, state.current_str());
+      if (!matched) {
+        this->fail();
+        continue;
+      }
+      state.consume(matched->length);
+      break;
+    }
+    case OC::DispatchLiteral: {
+      auto matched = program.literal_sets.match(ins.a, state.current_str());
+      pc           = program.jump_targets[ins.b + (matched ? matched->literal + 1 : 0)];
+      continue;
+    }
+    case OC::PushFrame: this->push_backtrack_frame(ins.a); break;
+    case OC::SetHandler: frames.back().address = ins.a; break;
+    case OC::BeginEntry: frames.back().entry = this->begin_entry(program.entries[ins.a]); break;
+    case OC::Commit: {
+      this->commit_frame(ins.a);
+      pc = ins.b;
+      continue;
+    }
+    case OC::Unwind: {
+      this->unwind_frame(ins.a);
+      if (ins.a & Flags::MUST) {
+        state.failed_rule  = CustomRuleRef(ins.b);
+        state.parse_failed = true;
+      }
+      this->fail();
+      continue;
+    }
+    case OC::TestFirst: {
+      if (!program.first_sets[ins.a].may_match(this->next_byte())) {
+        this->fail();
+        continue;
+      }
+      break;
+    }
+    case OC::SkipUnlessFirst: {
+      if (!program.first_sets[ins.a].may_match(this->next_byte())) {
+        pc = ins.b;
+        continue;
+      }
+      break;
+    }
+    case OC::JumpIfAborted: {
+      if (state.parse_failed) {
+        pc = ins.a;
+        continue;
+      }
+      break;
+    }
+    case OC::RepeatCheckMax: {
+      if (ins.a != 0 && frames.back().num_matches >= ins.a) {
+        pc = ins.b;
+        continue;
+      }
+      break;
+    }
+    case OC::RepeatNext: {
+      frames.pop_back();
+      ++frames.back().num_matches;
+      pc = ins.a;
+      continue;
+    }
+    case OC::RepeatStop: {
+      state.restore(frames.back().restore_point);
+      frames.pop_back();
+      pc = ins.a;
+      continue;
+    }
+    case OC::RepeatEnd: {
+      if (frames.back().num_matches < ins.b || state.parse_failed) {
+        this->unwind_frame(ins.a);
+        this->fail();
+        continue;
+      }
+      this->commit_frame(ins.a);
+      break;
+    }
+    case OC::ScanRun: {
+      if (!state.parse_failed) {
+        auto run = scan_class_run(CharClass(ins.a), state.content, state.current_pos());
+        state.consume(run);
+        frames.back().num_matches += run;
+      }
+      break;
+    }
+    case OC::FailIfAtEnd: {
+      if (state.at_end()) {
+        this->fail();
+        continue;
+      }
+      break;
+    }
+    case OC::PeekMatched: {
+      state.force_restore(frames.back().restore_point);
+      frames.pop_back();
+      this->fail();
+      continue;
+    }
+    case OC::PeekFailed: {
+      state.force_restore(frames.back().restore_point);
+      frames.pop_back();
+      state.consume(1);
+      break;
+    }
+    case OC::PrecedenceBegin: {
+      frames.back().operators_base = state.operator_matches.size();
+      frames.back().first_entry    = state.ast_builder.ast.entries.size();
+      break;
+    }
+    case OC::OperatorMatched: {
+      auto const& iteration = frames.back().restore_point;
+      state.operator_matches.push_back(OperatorMatch{
+        .info                = program.operators[ins.a],
+        .first_entry         = iteration.num_entries,
+        .start_pos           = iteration.pos,
+        .operand_first_entry = state.ast_builder.ast.entries.size(),
+        .operand_start_pos   = state.current_pos(),
+      });
+      break;
+    }
+    case OC::OperatorDrop: state.operator_matches.pop_back(); break;
+    case OC::PrecedenceEnd: {
+      auto const& frame = frames.back();
+      auto const  base  = frame.operators_base;
+      if (state.parse_failed) {
+        state.operator_matches.resize(base);
+        this->unwind_frame(ins.a);
+        this->fail();
+        continue;
+      }
+
+      auto operators = Span<OperatorMatch const>(state.operator_matches).subspan(base);
+      nest_operators(state.ast_builder, program.text_registry, frame.first_entry, frame.restore_point.pos, operators);
+      state.operator_matches.resize(base);
+
+      this->commit_frame(ins.a);
+      pc = ins.b;
+      continue;
+    }
+    }
+
+    ++pc;
+  }
+}
+
+} // namespace jet::comp::peg
@@ -0,0 +1,125 @@
+module;
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+module Jet.Comp.PEG.Profiling;
+
+import Jet.Comp.Format;
+
+namespace jet::comp::peg
+{
+
+static auto sort_key(RuleStats const& stats, ProfileOrder order) -> i64
+{
+  switch (order) {
+  case ProfileOrder::CumulativeTime: return i64(stats.cumulative_time.count());
+  case ProfileOrder::SelfTime: return i64(stats.self_time.count());
+  case ProfileOrder::Calls: return i64(stats.calls);
+  case ProfileOrder::BacktrackedBytes: return i64(stats.backtracked_bytes);
+  }
+  return 0;
+}
+
+/// @returns The text escaped for a JSON string.
+static auto escape_json(StringView text) -> String
+{
+  auto result = String();
+  result.reserve(text.size());
+  for (auto c : text) {
+    switch (c) {
+    case '"': result += "\\\""; break;
+    case '\\': result += "\\\\"; break;
+    case '\n': result += "\\n"; break;
+    case '\t': result += "\\t"; break;
+    default:
+      if (u8(c) < 0x20) {
+        result += fmt::format("\\u{:04x}", u8(c));
+      }
+      else {
+        result += c;
+      }
+      break;
+    }
+  }
+  return result;
+}
+
+auto sorted_rule_stats(RuleProfile const& profile, ProfileOrder order) -> DynArray<RuleStats>
+{
+  auto result = profile.rules;
+  std::stable_sort(result.begin(), result.end(), [order](RuleStats const& a, RuleStats const& b) {
+    return sort_key(a, order) > sort_key(b, order);
+  });
+  return result;
+}
+
+auto format_profile_report(RuleProfile const& profile, ProfileOrder order, usize max_rules) -> String
+{
+  using Micros = std::chrono::duration<f64, std::micro>;
+
+  auto const sorted = sorted_rule_stats(profile, order);
+  auto const count  = max_rules == 0 ? sorted.size() : std::min(max_rules, sorted.size());
+
+  auto result = fmt::format(
+    "{:<32} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12} {:>12}\n",
+    "rule",
+    "calls",
+    "success",
+    "failure",
+    "consumed B",
+    "backtrack B",
+    "cumul. us",
+    "self us"
+  );
+
+  for (auto i = usize(0); i < count; ++i) {
+    auto& stats = sorted[i];
+    result += fmt::format(
+      "{:<32} {:>10} {:>10} {:>10} {:>12} {:>12} {:>12.1f} {:>12.1f}\n",
+      stats.name,
+      stats.calls,
+      stats.successes,
+      stats.failures,
+      stats.consumed_bytes,
+      stats.backtracked_bytes,
+      Micros(stats.cumulative_time).count(),
+      Micros(stats.self_time).count()
+    );
+  }
+
+  if (count < sorted.size()) {
+    result += fmt::format("... {} more rules\n", sorted.size() - count);
+  }
+  return result;
+}
+
+auto format_profile_json(RuleProfile const& profile) -> String
+{
+  auto result = String("[");
+  auto first  = true;
+  for (auto& stats : sorted_rule_stats(profile, ProfileOrder::CumulativeTime)) {
+    result += first ? "\n" : ",\n";
+    first = false;
+
+    result += fmt::format(
+      R"(  {{"rule": "{}", "offset": {}, "calls": {}, "successes": {}, "failures": {}, )"
+      R"("consumed_bytes": {}, "backtracked_bytes": {}, "cumulative_ns": {}, "self_ns": {}}})",
+      escape_json(stats.name),
+      stats.rule.offset,
+      stats.calls,
+      stats.successes,
+      stats.failures,
+      stats.consumed_bytes,
+      stats.backtracked_bytes,
+      stats.cumulative_time.count(),
+      stats.self_time.count()
+    );
+  }
+  result += first ? "]" : "\n]";
+  return result;
+}
+
+} // namespace jet::comp::peg
@@ -0,0 +1,184 @@
+module;
+
+#include <algorithm>
+#include <vector>
+
+module Jet.Comp.PEG.Stream;
+
+namespace jet::comp::peg
+{
+
+auto SlidingBuffer::read_chunk(usize size) -> usize
+{
+  // Released bytes are dropped only once they take more than half of the storage,
+  // so that the window is moved at most once per its size.
+  if (start > 0 && start >= data.size() - start) {
+    data.erase(0, start);
+    start = 0;
+  }
+
+  auto const old_size = data.size();
+  data.resize(old_size + size);
+
+  auto const num_read = reader.read(Span<char>(data.data() + old_size, size));
+  data.resize(old_size + num_read);
+
+  eof  = num_read == 0;
+  peak = std::max(peak, data.size());
+  return num_read;
+}
+
+auto SlidingBuffer::fill_to(usize pos) -> void
+{
+  while (!eof && end_pos() < pos) {
+    read_chunk(std::max(chunk_size, pos - end_pos()));
+  }
+}
+
+auto SlidingBuffer::grow() -> bool
+{
+  auto const size = std::max(chunk_size, data.size() - start);
+  while (!eof) {
+    if (read_chunk(size) > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto SlidingBuffer::release(usize pos) -> void
+{
+  if (pos <= released) {
+    return;
+  }
+
+  auto const count = std::min(pos - released, data.size() - start);
+  start += count;
+  released += count;
+}
+
+/// Matches a single rule at the given position of the stream.
+/// The match is accepted once the buffer holds the lookahead past its end (or the whole document),
+/// otherwise the buffer grows and the rule is matched again.
+/// @returns The analysis of the rule, with positions relative to the window of the buffer.
+static auto match_in_stream(
+  Grammar const& grammar, CustomRuleRef rule, SlidingBuffer& buffer, usize pos, StreamOptions const& options
+) -> ASTAnalysisResult
+{
+  buffer.fill_to(pos + options.lookahead);
+  while (true) {
+    auto const base   = buffer.base_pos();
+    auto       result = analyze_rule(grammar, rule, buffer.window(), pos - base);
+    if (buffer.at_eof()) {
+      return result;
+    }
+
+    if (result.is_ok() && buffer.end_pos() - (base + result.get_unchecked().ast.current_pos) >= options.lookahead) {
+      return result;
+    }
+    buffer.grow();
+  }
+}
+
+auto analyze_stream(Grammar const& grammar, StreamRules const& rules, InputReader& reader, StreamOptions const& options)
+  -> ASTAnalysisResult
+{
+  auto buffer = SlidingBuffer(reader, options.chunk_size);
+  auto stats  = StreamStats();
+
+  auto ast = AST();
+
+  ast.entries.emplace_back(AST::Entry{AST::Index(grammar.root_rule.offset)});
+#ifndef NDEBUG
+  auto root_rule                = grammar.rule_registry.view_at(grammar.root_rule.offset).as_structure();
+  ast.entries.front().rule_name = root_rule.get_name(grammar.text_registry);
+#endif
+
+  auto pos = usize(0);
+
+  auto fail = [&](CustomRuleRef rule) -> ASTAnalysisResult {
+    ast.current_pos = pos;
+    ast.entries.front().next_id_same_nesting.id = AST::Index(ast.entries.size());
+
+    stats.bytes_read       = buffer.end_pos();
+    stats.peak_buffer_size = buffer.peak_size();
+
+    auto failed         = FailedASTAnalysis{{StringView(), std::move(ast)}, rule};
+    failed.stream_stats = stats;
+    return error(std::move(failed));
+  };
+
+  // Appends the entries of a matched rule, with absolute positions.
+  auto append = [&](AST const& matched, usize base) {
+    auto const first = AST::Index(ast.entries.size());
+
+    for (auto e = usize(0); e < matched.entries.size(); e = matched.entries[e].next_id_same_nesting.id) {
+      ++ast.entries.front().num_children;
+    }
+
+    for (auto& entry : matched.entries) {
+      auto& copied = ast.entries.emplace_back(entry);
+      copied.next_id_same_nesting.id += first;
+      copied.start_pos += AST::Index(base);
+      copied.end_pos += AST::Index(base);
+    }
+  };
+
+  // Matches a rule at the current position and moves past it.
+  auto advance = [&](CustomRuleRef rule) -> bool {
+    auto result = match_in_stream(grammar, rule, buffer, pos, options);
+    if (!result.is_ok() || buffer.end_pos() > AST::MAX_DOCUMENT_SIZE) {
+      return false;
+    }
+
+    auto const  base    = buffer.base_pos();
+    auto const  first   = ast.entries.size();
+    auto const& matched = result.get_unchecked().ast;
+    append(matched, base);
+
+    auto const item_start = pos;
+    pos                   = base + matched.current_pos;
+    if (rule == rules.item && options.handler) {
+      options.handler->on_item(ast, first, buffer.window().substr(item_start - base, pos - item_start), item_start);
+    }
+
+    // Neither the rule nor the following ones can backtrack before its end.
+    buffer.release(pos);
+    return true;
+  };
+
+  while (true) {
+    if (!advance(rules.separator)) {
+      return fail(rules.separator);
+    }
+
+    buffer.fill_to(pos + 1);
+    if (buffer.at_eof() && pos == buffer.end_pos()) {
+      break;
+    }
+
+    if (!advance(rules.item)) {
+      return fail(rules.item);
+    }
+    ++stats.num_items;
+  }
+
+  if (stats.num_items < rules.min_items) {
+    return fail(rules.item);
+  }
+
+  ast.current_pos = pos;
+
+  auto& finished                   = ast.entries.front();
+  finished.next_id_same_nesting.id = AST::Index(ast.entries.size());
+  finished.end_pos                 = AST::Index(pos);
+
+  stats.bytes_read       = buffer.end_pos();
+  stats.peak_buffer_size = buffer.peak_size();
+
+  auto completed         = CompletedASTAnalysis{{StringView(), std::move(ast)}};
+  completed.stream_stats = stats;
+  return success(std::move(completed));
+}
+
+} // namespace jet::comp::peg
@@ -3,12 +3,16 @@
 /// Provides a set of functions to analyze a text input using a PEG grammar.
 module;
 
+#include <algorithm>
+#include <memory_resource>
 #include <vector>
 
 export module Jet.Comp.PEG.Analysis;
 
 export import Jet.Comp.PEG.Grammar;
 export import Jet.Comp.PEG.Rule;
+export import Jet.Comp.PEG.CharScan;
+export import Jet.Comp.PEG.Profiling;
 
 export import Jet.Comp.Foundation;
 
@@ -21,33 +25,49 @@ export namespace jet::comp::peg
 /// Contains the result of a syntactic analysis of a text input.
 struct AST
 {
+  /// Type of the positions and entry IDs stored in the AST.
+  /// 32 bits are enough for any document smaller than 4 GiB and keep the entries compact.
+  using Index = u32;
+
+  /// The largest document that can be analyzed.
+  inline static auto constexpr MAX_DOCUMENT_SIZE = usize(~Index(0));
+
   /// Type-safe handle to an entry in the AST.
   struct EntryID
   {
-    usize id;
+    Index id;
   };
 
   /// Describes a single entry in the AST.
+  /// The layout is compact (20 bytes in release builds), so three entries fit in a cache line.
   /// @note Rules that have unset capture flag won't be registered in the AST.
   struct Entry
   {
-    CustomRuleRef rule_id;
+    /// The offset of the rule in the rule registry (see @c rule_id()).
+    Index rule_offset = 0;
 
     /// The ID of the next entry at the same nesting level.
-    EntryID next_id_same_nesting;
+    EntryID next_id_same_nesting = {0};
 
     /// The number of direct children of this entry.
-    usize num_children = 0;
+    Index num_children = 0;
 
     /// The position in the input where the rule started.
-    usize start_pos = 0;
+    Index start_pos = 0;
 
     /// The position in the input where the rule ended.
-    usize end_pos = 0;
+    Index end_pos = 0;
 
 #ifndef NDEBUG
     StringView rule_name;
 #endif
+
+    /// @returns The rule that created the entry.
+    [[nodiscard]]
+    auto rule_id() const -> CustomRuleRef
+    {
+      return CustomRuleRef(rule_offset);
+    }
   };
 
   /// @returns The entry with the given ID.
@@ -64,8 +84,11 @@ struct AST
     return entries[entry_id.id];
   }
 
+  /// Entries are allocated from the heap, or from the arena of an @c AnalysisWorkspace.
+  using EntryList = DynArray<Entry, std::pmr::polymorphic_allocator<Entry>>;
+
   /// Stores every entry in the AST.
-  DynArray<Entry> entries;
+  EntryList entries;
 
   /// The current position in the input.
   /// After a complete analysis, this should be equal to the length of the input.
@@ -93,25 +116,76 @@ struct ASTBuilder
   /// Stores the number of children during the creation of the AST.
   DynArray<usize> children_counter;
 
-  /// This will be removed in the future:
 #ifndef NDEBUG
   /// Creates a new entry of the given rule at the given position.
   auto begin_entry(CustomRuleRef rule_id, usize start_pos, StringView rule_name) -> EntryID;
+#endif
+};
 
-  auto push_tested_rule(StringView rule_name) -> void
-  {
-    test_rule_stack.push_back(rule_name);
-  }
+/// Describes an infix operator of a `Precedence` rule (see @c CombinatorRule::Precedence).
+struct OperatorInfo
+{
+  /// The `Operator` rule.
+  CustomRuleRef rule;
+
+  /// Operators with a higher binding power bind tighter.
+  usize binding_power = 0;
 
-  auto pop_tested_rule() -> void
+  Associativity associativity = Associativity::Left;
+
+  /// Whether the binary expression created by the operator has an AST entry.
+  bool captured = false;
+
+  /// Position of the rule name in the text registry.
+  usize name_start  = 0;
+  usize name_length = 0;
+
+  /// @returns The description of the given `Operator` rule.
+  [[nodiscard]]
+  static auto of(StructuralView rule) -> OperatorInfo
   {
-    test_rule_stack.pop_back();
+    using SV = StructuralView;
+    return {
+      .rule          = rule.get_ref(),
+      .binding_power = rule.binding_power(),
+      .associativity = rule.associativity(),
+      .captured      = rule.kind().is_captured(),
+      .name_start    = rule.context[rule.current_offset + SV::NAME_START_OFFSET],
+      .name_length   = rule.context[rule.current_offset + SV::NAME_LENGTH_OFFSET],
+    };
   }
+};
 
-  DynArray<StringView> test_rule_stack;
-#endif
+/// An operator matched by a `Precedence` rule, followed by its right-hand operand.
+struct OperatorMatch
+{
+  OperatorInfo info;
+
+  /// The ID of the first AST entry and the position of the operator token.
+  usize first_entry = 0;
+  usize start_pos   = 0;
+
+  /// The ID of the first AST entry and the position of the right-hand operand.
+  usize operand_first_entry = 0;
+  usize operand_start_pos   = 0;
 };
 
+/// Nests the operands and operators matched by a `Precedence` rule according to the binding power
+/// and associativity of the operators, using the entries already in the AST (no operand is analyzed again).
+/// Every captured operator gets an entry that spans both of its operands, inserted before the entries
+/// of its left-hand operand. The number of children of the enclosing entry is updated.
+/// @param text_registry The text registry of the grammar (names of the rules).
+/// @param first_entry The ID of the first AST entry of the first operand.
+/// @param start_pos The position where the first operand started.
+/// @param operators The matched operators, in order of appearance. The last operand ends at the current position.
+auto nest_operators(
+  ASTBuilder&               builder,
+  StringView                text_registry,
+  usize                     first_entry,
+  usize                     start_pos,
+  Span<OperatorMatch const> operators
+) -> void;
+
 /// Contains the state of a text analysis.
 struct AnalysisState
 {
@@ -137,6 +211,12 @@ struct AnalysisState
   /// The rule that failed.
   CustomRuleRef failed_rule;
 
+  /// Operators matched by the `Precedence` rules being analyzed (nested rules push on top).
+  DynArray<OperatorMatch> operator_matches;
+
+  /// The furthest position reached since the current profiled rule was entered (profiling only).
+  usize furthest_pos = 0;
+
   /// Returns a restore point at the current state.
   [[nodiscard]]
   auto create_restore_point() const -> RestorePoint;
@@ -153,6 +233,9 @@ struct AnalysisState
   auto consume(usize n) -> void
   {
     ast_builder.ast.current_pos += n;
+    if constexpr (PROFILING_ENABLED) {
+      furthest_pos = std::max(furthest_pos, ast_builder.ast.current_pos);
+    }
   }
 
   /// Returns the current position in the input.
@@ -177,10 +260,135 @@ struct AnalysisState
   }
 };
 
+/// Memory reused by consecutive analyses (see @c AnalysisOptions::workspace).
+/// Entries of the ASTs produced with a workspace are allocated from its arena,
+/// so they stay valid only until @c reset() is called.
+struct AnalysisWorkspace
+{
+  /// Stores the AST entries.
+  Arena arena;
+
+  /// Counts the children of the entries being built.
+  DynArray<usize> children_counter;
+
+  /// Invalidates every AST produced with the workspace. Keeps the memory for the next analyses.
+  auto reset() -> void
+  {
+    arena.reset();
+  }
+};
+
+/// Configures optional behavior of @c analyze().
+struct AnalysisOptions
+{
+  /// Reuses the memory of the previous analyses. Not set - the AST is allocated from the heap.
+  /// @note A workspace must not be used by multiple analyses at once.
+  AnalysisWorkspace* workspace = nullptr;
+
+  /// Reserves space for `document size * entries_per_byte` AST entries before the analysis,
+  /// so the entries are not reallocated while the AST grows. 0 - disabled.
+  f64 entries_per_byte = 0.0;
+
+  /// Enables packrat memoization.
+  /// Every result of a custom rule reference is stored in a memo table keyed by
+  /// (rule, position), so a rule is never evaluated twice at the same position,
+  /// no matter how many alternatives backtrack over it.
+  bool packrat = false;
+
+  /// Maximum number of (rule, position) results kept in the memo table.
+  /// The table is flushed once this limit is exceeded.
+  usize packrat_max_results = 256 * 1024;
+
+  /// Maximum number of AST entries kept in the memo table (summed over all results).
+  /// The table is flushed once this limit is exceeded.
+  usize packrat_max_ast_entries = 1024 * 1024;
+
+  /// Collects the counters of every named rule tried by the analysis.
+  /// Ignored unless the analyzer was built with the `JET_PEG_PROFILING` CMake option (see @c PROFILING_ENABLED).
+  /// @note The parsing machine is not profiled.
+  RuleProfile* profile = nullptr;
+};
+
+/// Counters collected by the packrat memoization.
+/// All values are zero if packrat mode was disabled.
+struct PackratStats
+{
+  /// Number of rule matches answered from the memo table.
+  usize hits = 0;
+
+  /// Number of rule matches that had to be evaluated.
+  usize misses = 0;
+
+  /// Number of times the memo table exceeded its limits and was flushed.
+  usize flushes = 0;
+
+  /// @returns The ratio of hits to all memo table lookups (0 if there were none).
+  [[nodiscard]]
+  auto hit_rate() const -> f64
+  {
+    auto const total = hits + misses;
+    return total == 0 ? 0.0 : f64(hits) / f64(total);
+  }
+};
+
+/// Describes a change of a document: bytes in range `[start, old_end)` were replaced
+/// by the bytes in range `[start, new_end)` of the new document.
+struct TextEdit
+{
+  usize start   = 0;
+  usize old_end = 0;
+  usize new_end = 0;
+};
+
+/// Configures @c reanalyze().
+struct ReanalysisOptions
+{
+  /// Rules whose entries can be reanalyzed on their own, e.g. code blocks or function declarations.
+  /// The grammar must not look into such an entry from the outside: rules that are tried before it
+  /// (and fail) must not depend on its content. Rules delimited by brackets or keywords usually are.
+  Span<CustomRuleRef const> anchor_rules;
+};
+
+/// Describes how much of the previous AST was reused by @c reanalyze().
+struct ReanalysisStats
+{
+  /// The whole document was analyzed again (no anchor entry could be reused).
+  bool full_reanalysis = false;
+
+  /// The range of the new document that was analyzed again.
+  usize reanalyzed_from = 0;
+  usize reanalyzed_to   = 0;
+
+  /// Number of entries copied from the previous AST.
+  usize reused_entries = 0;
+};
+
+/// Describes how a document was read by @c analyze_stream().
+struct StreamStats
+{
+  /// Number of bytes supplied by the reader.
+  usize bytes_read = 0;
+
+  /// The largest number of bytes held in the buffer at once.
+  usize peak_buffer_size = 0;
+
+  /// Number of analyzed items.
+  usize num_items = 0;
+};
+
 struct ASTAnalysis
 {
   StringView document;
   AST        ast;
+
+  /// Packrat memoization counters (see @c AnalysisOptions::packrat).
+  PackratStats packrat_stats;
+
+  /// Incremental analysis info (see @c reanalyze()).
+  ReanalysisStats reanalysis_stats;
+
+  /// Streaming analysis info (see @c analyze_stream()).
+  StreamStats stream_stats;
 };
 
 struct CompletedASTAnalysis : ASTAnalysis
@@ -195,10 +403,56 @@ struct FailedASTAnalysis : ASTAnalysis
 
 using ASTAnalysisResult = Result<CompletedASTAnalysis, FailedASTAnalysis>;
 
+/// Matches a builtin rule against the content at the given position.
+/// @returns The number of consumed bytes or @c std::nullopt if the rule doesn't match.
+[[nodiscard]]
+auto match_builtin_rule(BuiltinRule rule, StringView content, usize pos) -> Opt<usize>;
+
+/// Checks whether every iteration of an unbounded repetition (`Star`, `Plus`) can start by
+/// consuming a single character of a class: the repeated rule is either a single-character
+/// builtin or a non-captured `Sor` whose first alternative is one.
+/// A whole run of such characters can be consumed at once, each byte counting as one iteration.
+/// @returns The character class of the run or @c std::nullopt.
+[[nodiscard]]
+auto repetition_run_class(StructuralView rule) -> Opt<CharClass>;
+
 /// Analyzes the given document using the given grammar.
 /// If the analysis fails you can still read the last state of it.
 /// @note The grammar must be finalized.
 [[nodiscard]]
 auto analyze(Grammar const& grammar, StringView document) -> ASTAnalysisResult;
 
+/// Analyzes the given document using the given grammar and analysis options.
+/// If the analysis fails you can still read the last state of it.
+/// @note The grammar must be finalized.
+[[nodiscard]]
+auto analyze(Grammar const& grammar, StringView document, AnalysisOptions const& options) -> ASTAnalysisResult;
+
+/// Analyzes a single rule at the given position of the document.
+/// Unlike @c analyze(), the rule does not have to consume the rest of the document:
+/// the analysis succeeds if the rule matched and @c AST::current_pos is where the match ended.
+/// @note The grammar must be finalized.
+[[nodiscard]]
+auto analyze_rule(Grammar const& grammar, CustomRuleRef rule, StringView document, usize start_pos)
+  -> ASTAnalysisResult;
+
+/// Analyzes an edited document, reusing the AST of the previous (completed) analysis.
+/// Only the smallest entry of an anchor rule that encloses the edit is analyzed again,
+/// the rest of the entries are copied (with positions after the edit shifted).
+/// An `IfMust` anchor is analyzed again from the entry of its condition (e.g. a keyword),
+/// captured right before the enclosing entry.
+/// Falls back to the enclosing anchor entries and finally to a full analysis
+/// if the reanalyzed entry does not end where the edit moved it.
+/// If the anchor rules meet the requirement described in @c ReanalysisOptions,
+/// the result is the same as the one of @c analyze() called with the new document.
+/// @note The grammar must be finalized.
+[[nodiscard]]
+auto reanalyze(
+  Grammar const&           grammar,
+  AST const&               previous_ast,
+  StringView               document,
+  TextEdit const&          edit,
+  ReanalysisOptions const& options
+) -> ASTAnalysisResult;
+
 } // namespace jet::comp::peg
\ No newline at end of file
@@ -0,0 +1,81 @@
+/// # Character scanning module
+///
+/// Classifies bytes into the character classes of the builtin rules and scans
+/// runs of them. Long runs are scanned with vectorized kernels (SSE2 or AVX2),
+/// chosen at runtime based on the capabilities of the CPU.
+///
+/// Classes follow the "C" locale: only ASCII bytes can belong to a class.
+module;
+
+#include <cinttypes>
+
+export module Jet.Comp.PEG.CharScan;
+
+export import Jet.Comp.PEG.Rule;
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+export namespace jet::comp::peg
+{
+
+/// Character classes tested by the single-character builtin rules.
+enum class CharClass : u8
+{
+  Whitespace,
+  Alpha,
+  AlphaL,
+  AlphaU,
+  Digit,
+  Alnum,
+  IdentChar,
+  IdentFirstChar,
+
+  MAX,
+};
+
+/// Implementation of the scanning functions.
+enum class ScanKernel : u8
+{
+  Scalar,
+  SSE2,
+  AVX2,
+};
+
+/// @returns The character class tested by the builtin rule,
+/// or @c std::nullopt if the rule is not a single-character class.
+[[nodiscard]]
+auto to_char_class(BuiltinRule rule) -> Opt<CharClass>;
+
+/// @returns @c true if the byte belongs to the character class.
+[[nodiscard]]
+auto is_in_class(CharClass char_class, char c) -> bool;
+
+/// @returns The fastest kernel supported by the CPU (detected once).
+[[nodiscard]]
+auto best_scan_kernel() -> ScanKernel;
+
+/// @returns The name of the kernel, e.g. "avx2".
+[[nodiscard]]
+auto to_string(ScanKernel kernel) -> StringView;
+
+/// @returns The number of consecutive bytes, starting at @p pos, that belong to the character class.
+[[nodiscard]]
+auto scan_class_run(CharClass char_class, StringView content, usize pos) -> usize;
+
+/// @returns The position of the first occurrence of @p c at or after @p pos,
+/// or the size of the content if there is none.
+[[nodiscard]]
+auto find_char(StringView content, usize pos, char c) -> usize;
+
+/// Same as @c scan_class_run(), but uses the given kernel.
+/// @note The kernel must be supported by the CPU (see @c best_scan_kernel()).
+[[nodiscard]]
+auto scan_class_run(ScanKernel kernel, CharClass char_class, StringView content, usize pos) -> usize;
+
+/// Same as @c find_char(), but uses the given kernel.
+/// @note The kernel must be supported by the CPU (see @c best_scan_kernel()).
+[[nodiscard]]
+auto find_char(ScanKernel kernel, StringView content, usize pos, char c) -> usize;
+
+} // namespace jet::comp::peg
@@ -1,6 +1,8 @@
 module;
 
 #include <vector>
+#include <optional>
+#include <cassert>
 
 export module Jet.Comp.PEG.Grammar;
 
@@ -36,6 +38,10 @@ struct StructuralView
   /// @endcode
   inline static auto constexpr WIDTH = usize(5);
 
+  /// Offsets of the payload of an `Operator` structure (placed right after the structure).
+  inline static auto constexpr BINDING_POWER_OFFSET = WIDTH;
+  inline static auto constexpr ASSOCIATIVITY_OFFSET = WIDTH + 1;
+
   /// The content of the rule registry.
   Span<usize const> context;
 
@@ -44,7 +50,7 @@ struct StructuralView
 
   /// @returns The encoded kind
   [[nodiscard]]
-  auto kind() const -> EncodedRule
+  constexpr auto kind() const -> EncodedRule
   {
     return EncodedRule(context[current_offset + KIND_OFFSET]);
   }
@@ -56,7 +62,7 @@ struct StructuralView
   /// @endcode
   /// returns 3.
   [[nodiscard]]
-  auto num_children() const -> usize
+  constexpr auto num_children() const -> usize
   {
     return context[current_offset + NUM_CHILDREN_OFFSET];
   }
@@ -68,43 +74,73 @@ struct StructuralView
   /// @endcode
   /// returns 4 + current_offset.
   [[nodiscard]]
-  auto next_sibling_pos() const -> usize
+  constexpr auto next_sibling_pos() const -> usize
   {
     return context[current_offset + NEXT_SIBLING_AT_OFFSET];
   }
 
   /// @returns @c true if this method describes a text.
   [[nodiscard]]
-  auto is_text() const -> bool
+  constexpr auto is_text() const -> bool
   {
     return kind().is_structure() && kind().as_structure() == StructureRule::Text;
   }
 
+  /// @returns @c true if this method describes an infix operator of a `Precedence` rule.
+  [[nodiscard]]
+  constexpr auto is_operator() const -> bool
+  {
+    return kind().is_structure() && kind().as_structure() == StructureRule::Operator;
+  }
+
+  /// @returns @c true if this method describes a set of texts matched with a trie.
+  [[nodiscard]]
+  constexpr auto is_literal_set() const -> bool
+  {
+    return kind().is_structure() && kind().as_structure() == StructureRule::LiteralSet;
+  }
+
+  /// @returns The binding power of an operator (higher binds tighter).
+  [[nodiscard]]
+  constexpr auto binding_power() const -> usize
+  {
+    assert(this->is_operator() && "Method is not of kind Operator");
+    return context[current_offset + BINDING_POWER_OFFSET];
+  }
+
+  /// @returns The associativity of an operator.
+  [[nodiscard]]
+  constexpr auto associativity() const -> Associativity
+  {
+    assert(this->is_operator() && "Method is not of kind Operator");
+    return static_cast<Associativity>(context[current_offset + ASSOCIATIVITY_OFFSET]);
+  }
+
   /// @returns The name of the rule (maybe empty);
   [[nodiscard]]
-  auto get_name(StringView text_registry) const -> StringView;
+  constexpr auto get_name(StringView text_registry) const -> StringView;
 
   /// @returns the contained text if this is a text rule.
   [[nodiscard]]
-  auto get_text(StringView text_registry) const -> StringView;
+  constexpr auto get_text(StringView text_registry) const -> StringView;
 
   /// @returns The width of this structural rule in the registry (without children).
   [[nodiscard]]
-  auto width() const -> usize
+  constexpr auto width() const -> usize
   {
-    return StructuralView::WIDTH + (this->is_text() ? 2 : 0);
+    return StructuralView::WIDTH + (this->is_text() || this->is_operator() ? 2 : 0);
   }
 
   /// @returns A reference to this rule.
   [[nodiscard]]
-  auto get_ref() const -> CustomRuleRef
+  constexpr auto get_ref() const -> CustomRuleRef
   {
     return CustomRuleRef(current_offset);
   }
 
   /// @returns A view over the first child rule.
   [[nodiscard]]
-  auto first_child() const -> RuleRegistryView;
+  constexpr auto first_child() const -> RuleRegistryView;
 };
 
 /// Provides a read-only view at a rule registry
@@ -125,14 +161,14 @@ struct RuleRegistryView
   /// Creates a new registry view over the given context
   /// offset by a given number of elements.
   [[nodiscard]]
-  auto offset(usize num) const -> RuleRegistryView
+  constexpr auto offset(usize num) const -> RuleRegistryView
   {
     return RuleRegistryView{context, current_offset + num};
   }
 
   /// @returns @c true if the current offset is at the end of the view.
   [[nodiscard]]
-  auto at_end() const -> bool
+  constexpr auto at_end() const -> bool
   {
     return current_offset >= context.size();
   }
@@ -140,7 +176,7 @@ struct RuleRegistryView
   /// @returns @c true if the view starts with a rule that is
   /// structural (either a structure or a combinator).
   [[nodiscard]]
-  auto at_structural() const -> bool
+  constexpr auto at_structural() const -> bool
   {
     if (this->at_end()) {
       return false;
@@ -151,7 +187,7 @@ struct RuleRegistryView
 
   /// @returns @c true if the view starts with a rule reference.
   [[nodiscard]]
-  auto at_rule_ref() const -> bool
+  constexpr auto at_rule_ref() const -> bool
   {
     if (this->at_end()) {
       return false;
@@ -163,31 +199,67 @@ struct RuleRegistryView
 
   /// @returns a rule view over the current data.
   [[nodiscard]]
-  auto as_rule() const -> EncodedRule
+  constexpr auto as_rule() const -> EncodedRule
   {
     return this->current_rule();
   }
 
   /// @returns a method view over the current data.
   [[nodiscard]]
-  auto as_structure() const -> StructuralView
+  constexpr auto as_structure() const -> StructuralView
   {
     return StructuralView(context, current_offset);
   }
 
   /// @returns A view over the next sibling rule.
   [[nodiscard]]
-  auto next_sibling() const -> RuleRegistryView;
+  constexpr auto next_sibling() const -> RuleRegistryView;
 
 private:
   /// @returns The encoded rule at the current offset.
   [[nodiscard]]
-  auto current_rule() const -> EncodedRule
+  constexpr auto current_rule() const -> EncodedRule
   {
     return EncodedRule(context[current_offset]);
   }
 };
 
+constexpr auto StructuralView::get_name(StringView text_registry) const -> StringView
+{
+  return text_registry.substr(context[current_offset + NAME_START_OFFSET], context[current_offset + NAME_LENGTH_OFFSET]);
+}
+
+constexpr auto StructuralView::get_text(StringView text_registry) const -> StringView
+{
+  assert(this->is_text() && "Method is not of kind Text");
+  assert(this->num_children() == 2 && "Method of kind Text must have exactly two children (start, size)");
+
+  auto start = context[current_offset + StructuralView::WIDTH];
+  auto len = context[current_offset + StructuralView::WIDTH + 1];
+
+  return text_registry.substr(start, len);
+}
+
+constexpr auto StructuralView::first_child() const -> RuleRegistryView
+{
+  return RuleRegistryView{context, current_offset + this->width()};
+}
+
+constexpr auto RuleRegistryView::next_sibling() const -> RuleRegistryView
+{
+  if (this->at_end()) {
+    return RuleRegistryView{Span<usize const>{}};
+  }
+
+  if (this->at_rule_ref()) {
+    // offset by a single element
+    return this->offset(1);
+  }
+
+  auto structural = this->as_structure();
+  return RuleRegistryView(context, structural.next_sibling_pos());
+}
+
 /// A registry of grammar rules.
 /// Provides read-only structured views over the rules.
 struct RuleRegistry
@@ -195,7 +267,7 @@ struct RuleRegistry
   DynArray<usize> data;
 
   [[nodiscard]]
-  auto view() const -> RuleRegistryView
+  constexpr auto view() const -> RuleRegistryView
   {
     return RuleRegistryView{
       .context = Span<usize const>(data),
@@ -204,12 +276,189 @@ struct RuleRegistry
   }
 
   [[nodiscard]]
-  auto view_at(usize index) const -> RuleRegistryView
+  constexpr auto view_at(usize index) const -> RuleRegistryView
   {
     return this->view().offset(index);
   }
 };
 
+/// A set of bytes, one bit per possible value.
+struct ByteSet
+{
+  Array<u64, 4> bits = {};
+
+  /// Adds a single byte to the set.
+  constexpr auto insert(u8 byte) -> void
+  {
+    bits[byte >> 6] |= u64(1) << (byte & 63);
+  }
+
+  /// Adds every byte from the inclusive range [first, last] to the set.
+  constexpr auto insert_range(u8 first, u8 last) -> void
+  {
+    for (auto b = usize(first); b <= usize(last); ++b) {
+      this->insert(u8(b));
+    }
+  }
+
+  /// @returns @c true if the byte belongs to the set.
+  [[nodiscard]]
+  constexpr auto contains(u8 byte) const -> bool
+  {
+    return (bits[byte >> 6] >> (byte & 63)) & 1;
+  }
+
+  /// Adds every byte of the other set to this set.
+  /// @returns @c true if this set has changed.
+  constexpr auto merge(ByteSet const& other) -> bool
+  {
+    auto changed = false;
+    for (auto i = usize(0); i < bits.size(); ++i) {
+      auto merged = bits[i] | other.bits[i];
+      changed     = changed || merged != bits[i];
+      bits[i]     = merged;
+    }
+    return changed;
+  }
+
+  /// @returns A set that contains every byte.
+  [[nodiscard]]
+  static constexpr auto full() -> ByteSet
+  {
+    auto result = ByteSet();
+    result.bits.fill(~u64(0));
+    return result;
+  }
+};
+
+/// Describes how a rule can begin (the FIRST set of the rule).
+/// It is always an over-approximation: a rule is never rejected
+/// by its first set if it could succeed.
+struct FirstSet
+{
+  /// Bytes that a successful, non-empty match of the rule can start with.
+  ByteSet bytes;
+
+  /// Whether the rule can succeed without consuming any input
+  /// (or has to be entered regardless of the input, e.g. a `Must`).
+  bool nullable = false;
+
+  /// @returns @c false if the rule certainly fails when the remaining input starts
+  /// with the given byte (@c std::nullopt denotes the end of input).
+  [[nodiscard]]
+  constexpr auto may_match(Opt<u8> next) const -> bool
+  {
+    return nullable || (next.has_value() && bytes.contains(*next));
+  }
+};
+
+/// First-character dispatch data of every `Sor` rule in a grammar.
+/// Computed during the grammar finalization.
+struct SorDispatchTable
+{
+  inline static auto constexpr NO_DISPATCH = ~usize(0);
+
+  /// Maps an offset of a rule in the registry to the index of its first set in @c first_sets,
+  /// or @c NO_DISPATCH if the rule is not a `Sor`.
+  DynArray<usize> index;
+
+  /// For every `Sor`: the first set of the `Sor` itself followed by the first sets
+  /// of each of its alternatives.
+  DynArray<FirstSet> first_sets;
+
+  /// @returns The first sets of the given `Sor` rule (the rule itself, then every alternative)
+  /// or an empty span if there is no dispatch data for the rule.
+  [[nodiscard]]
+  constexpr auto find(StructuralView sor) const -> Span<FirstSet const>
+  {
+    if (sor.current_offset >= index.size() || index[sor.current_offset] == NO_DISPATCH) {
+      return {};
+    }
+
+    return Span<FirstSet const>(first_sets).subspan(index[sor.current_offset], sor.num_children() + 1);
+  }
+};
+
+/// A node of a literal trie. Its edges are stored next to each other, sorted by the byte.
+struct LiteralTrieNode
+{
+  inline static auto constexpr NO_LITERAL = ~usize(0);
+
+  usize first_edge = 0;
+  usize num_edges  = 0;
+
+  /// Index of the literal that ends at this node, or @c NO_LITERAL.
+  usize literal = NO_LITERAL;
+};
+
+struct LiteralTrieEdge
+{
+  u8    byte   = 0;
+  usize target = 0;
+};
+
+/// The literal that was matched by a literal trie.
+struct LiteralMatch
+{
+  /// Index of the literal within its set.
+  usize literal = 0;
+  usize length  = 0;
+};
+
+/// Tries over the literals of every `LiteralSet` rule and of the operators of every `Precedence` rule
+/// (if each operator starts with a text). Computed during the grammar finalization.
+struct LiteralSetTable
+{
+  inline static auto constexpr NO_SET = ~usize(0);
+
+  /// Maps an offset of a rule in the registry to the root node of its trie in @c nodes,
+  /// or @c NO_SET if the rule has no trie.
+  DynArray<usize> index;
+
+  DynArray<LiteralTrieNode> nodes;
+  DynArray<LiteralTrieEdge> edges;
+
+  /// @returns The root node of the trie of the given rule (if it has one).
+  [[nodiscard]]
+  constexpr auto find(StructuralView rule) const -> Opt<usize>
+  {
+    if (rule.current_offset >= index.size() || index[rule.current_offset] == NO_SET) {
+      return std::nullopt;
+    }
+    return index[rule.current_offset];
+  }
+
+  /// @returns The longest literal of the trie that the input starts with.
+  [[nodiscard]]
+  constexpr auto match(usize root, StringView input) const -> Opt<LiteralMatch>
+  {
+    auto result = Opt<LiteralMatch>();
+    auto node   = root;
+    for (auto pos = usize(0);; ++pos) {
+      auto const& current = nodes[node];
+      if (current.literal != LiteralTrieNode::NO_LITERAL) {
+        result = LiteralMatch{current.literal, pos};
+      }
+      if (pos == input.size()) {
+        break;
+      }
+
+      auto byte = u8(input[pos]);
+      auto next = Opt<usize>();
+      for (auto e = current.first_edge; e < current.first_edge + current.num_edges && edges[e].byte <= byte; ++e) {
+        if (edges[e].byte == byte) {
+          next = edges[e].target;
+        }
+      }
+      if (!next) {
+        break;
+      }
+      node = *next;
+    }
+    return result;
+  }
+};
+
 /// Describes a grammar.
 /// Use the @c GrammarBuilder to create a grammar.
 struct Grammar
@@ -218,6 +467,13 @@ struct Grammar
   String       text_registry;
 
   CustomRuleRef root_rule;
+
+  /// First-character dispatch tables used to skip `Sor` alternatives
+  /// that cannot match the next input byte.
+  SorDispatchTable sor_dispatch;
+
+  /// Tries of the `LiteralSet` rules and of the operators of the `Precedence` rules.
+  LiteralSetTable literal_sets;
 };
 
 } // namespace jet::comp::peg
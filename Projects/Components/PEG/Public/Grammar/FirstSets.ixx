@@ -0,0 +1,307 @@
+/// # First sets module
+///
+/// Computes the FIRST sets of grammar rules, used to dispatch `Sor` alternatives
+/// on the next input byte. Usable in constant expressions, so that grammars
+/// can be built at compile time.
+module;
+
+#include <vector>
+#include <cassert>
+
+export module Jet.Comp.PEG.FirstSets;
+
+export import Jet.Comp.PEG.Grammar;
+
+using namespace jet::comp::foundation;
+
+namespace jet::comp::peg
+{
+
+/// Computes first sets of every structural rule in a registry.
+/// Recursive rules are handled by iterating until a fixed point is reached.
+struct FirstSetAnalysis
+{
+  Grammar const& grammar;
+
+  /// Offsets of every structural rule in the registry (in pre-order).
+  DynArray<usize> structural_offsets;
+
+  /// First sets indexed by the offset of a structural rule in the registry.
+  DynArray<FirstSet> sets;
+
+  constexpr auto collect_structural_offsets() -> void;
+  constexpr auto compute() -> void;
+
+  [[nodiscard]]
+  constexpr auto first_set_of(RuleRegistryView rule) const -> FirstSet;
+
+  [[nodiscard]]
+  constexpr auto first_set_of_structural(StructuralView rule) const -> FirstSet;
+
+  /// @returns The first set of a sequence of the rule's children.
+  [[nodiscard]]
+  constexpr auto first_set_of_sequence(StructuralView rule, usize num_children) const -> FirstSet;
+
+  /// @returns The first set of a choice between the rule's children.
+  [[nodiscard]]
+  constexpr auto first_set_of_alternatives(StructuralView rule) const -> FirstSet;
+};
+
+constexpr auto first_set_of_builtin(BuiltinRule rule) -> FirstSet;
+constexpr auto merge_first_set(FirstSet& into, FirstSet const& from) -> bool;
+
+constexpr auto FirstSetAnalysis::collect_structural_offsets() -> void
+{
+  auto registry = grammar.rule_registry.view();
+
+  // Rules are laid out in pre-order, so a linear walk over the registry
+  // visits every structural rule, as long as rule references are skipped one by one.
+  while (!registry.at_end()) {
+    if (!registry.at_structural()) {
+      registry = registry.offset(1);
+      continue;
+    }
+
+    auto rule = registry.as_structure();
+    structural_offsets.push_back(registry.current_offset);
+    registry = registry.offset(rule.width());
+  }
+
+  sets.resize(grammar.rule_registry.data.size());
+}
+
+constexpr auto FirstSetAnalysis::compute() -> void
+{
+  auto changed = true;
+  while (changed) {
+    changed = false;
+
+    // Nested rules are placed after their parents, so the reverse order
+    // computes the children first and converges faster.
+    for (auto it = structural_offsets.rbegin(); it != structural_offsets.rend(); ++it) {
+      auto rule    = grammar.rule_registry.view_at(*it).as_structure();
+      auto updated = this->first_set_of_structural(rule);
+      changed      = merge_first_set(sets[*it], updated) || changed;
+    }
+  }
+}
+
+constexpr auto FirstSetAnalysis::first_set_of(RuleRegistryView rule) const -> FirstSet
+{
+  if (rule.at_end()) {
+    return {};
+  }
+
+  if (rule.at_structural()) {
+    return sets[rule.current_offset];
+  }
+
+  auto enc_rule = rule.as_rule();
+  if (enc_rule.is_builtin()) {
+    return first_set_of_builtin(enc_rule.as_builtin());
+  }
+
+  if (enc_rule.is_custom()) {
+    return sets[enc_rule.to_custom().offset];
+  }
+
+  return {};
+}
+
+constexpr auto FirstSetAnalysis::first_set_of_structural(StructuralView rule) const -> FirstSet
+{
+  using CR = CombinatorRule;
+
+  if (rule.is_text()) {
+    auto text   = rule.get_text(grammar.text_registry);
+    auto result = FirstSet();
+    if (text.empty()) {
+      result.nullable = true;
+    }
+    else {
+      result.bytes.insert(u8(text.front()));
+    }
+    return result;
+  }
+
+  if (rule.is_operator()) {
+    return this->first_set_of_sequence(rule, rule.num_children());
+  }
+
+  if (rule.is_literal_set()) {
+    return this->first_set_of_alternatives(rule);
+  }
+
+  if (!rule.kind().is_combinator()) {
+    // Unknown structure, it must be always entered.
+    return FirstSet{ByteSet::full(), true};
+  }
+
+  switch (rule.kind().as_combinator()) {
+  case CR::Must: {
+    // A failing `Must` aborts the analysis, so it can never be skipped.
+    return FirstSet{ByteSet::full(), true};
+  }
+  case CR::IfMust: {
+    auto condition = this->first_set_of_sequence(rule, 1);
+    if (condition.nullable) {
+      // The `Must` part is reached without consuming input.
+      return FirstSet{ByteSet::full(), true};
+    }
+    return condition;
+  }
+  case CR::Precedence: {
+    // Starts with the operand.
+    return this->first_set_of_sequence(rule, 1);
+  }
+  case CR::Seq:
+  case CR::Plus: return this->first_set_of_sequence(rule, rule.num_children());
+  case CR::Opt:
+  case CR::Star: {
+    auto result     = this->first_set_of_sequence(rule, rule.num_children());
+    result.nullable = true;
+    return result;
+  }
+  case CR::Sor: return this->first_set_of_alternatives(rule);
+  case CR::OneIfNotAt: {
+    // Consumes any single character if the inner sequence fails.
+    return FirstSet{ByteSet::full(), false};
+  }
+  default: break;
+  }
+
+  return FirstSet{ByteSet::full(), true};
+}
+
+constexpr auto FirstSetAnalysis::first_set_of_alternatives(StructuralView rule) const -> FirstSet
+{
+  auto result = FirstSet();
+  auto child  = rule.first_child();
+  for (auto c = usize(0); c < rule.num_children(); ++c) {
+    merge_first_set(result, this->first_set_of(child));
+    child = child.next_sibling();
+  }
+  return result;
+}
+
+constexpr auto FirstSetAnalysis::first_set_of_sequence(StructuralView rule, usize num_children) const -> FirstSet
+{
+  assert(num_children <= rule.num_children() && "Sequence cannot be longer than the number of children");
+
+  auto result     = FirstSet();
+  result.nullable = true;
+
+  auto child = rule.first_child();
+  for (auto c = usize(0); c < num_children; ++c) {
+    auto child_set = this->first_set_of(child);
+    result.bytes.merge(child_set.bytes);
+
+    if (!child_set.nullable) {
+      result.nullable = false;
+      break;
+    }
+
+    child = child.next_sibling();
+  }
+
+  return result;
+}
+
+constexpr auto first_set_of_builtin(BuiltinRule rule) -> FirstSet
+{
+  auto result = FirstSet();
+  auto& bytes = result.bytes;
+
+  switch (rule) {
+  case BuiltinRule::Whitespace:
+    bytes.insert_range('\t', '\r');
+    bytes.insert(' ');
+    break;
+  case BuiltinRule::Any:
+  case BuiltinRule::UntilEOL:
+  case BuiltinRule::UntilEOF: bytes = ByteSet::full(); break;
+  case BuiltinRule::Alpha:
+    bytes.insert_range('a', 'z');
+    bytes.insert_range('A', 'Z');
+    break;
+  case BuiltinRule::AlphaL:
+    bytes.insert_range('a', 'z');
+    break;
+  case BuiltinRule::AlphaU:
+    bytes.insert_range('A', 'Z');
+    break;
+  case BuiltinRule::Digit:
+    bytes.insert_range('0', '9');
+    break;
+  case BuiltinRule::Alnum:
+    bytes.insert_range('a', 'z');
+    bytes.insert_range('A', 'Z');
+    bytes.insert_range('0', '9');
+    break;
+  case BuiltinRule::IdentChar:
+    bytes.insert_range('a', 'z');
+    bytes.insert_range('A', 'Z');
+    bytes.insert_range('0', '9');
+    bytes.insert('_');
+    break;
+  case BuiltinRule::IdentFirstChar:
+  case BuiltinRule::Ident:
+    bytes.insert_range('a', 'z');
+    bytes.insert_range('A', 'Z');
+    bytes.insert('_');
+    break;
+  case BuiltinRule::WordBoundary: result.nullable = true; break;
+  default: return FirstSet{ByteSet::full(), true};
+  }
+
+  return result;
+}
+
+constexpr auto merge_first_set(FirstSet& into, FirstSet const& from) -> bool
+{
+  auto changed = into.bytes.merge(from.bytes);
+  if (from.nullable && !into.nullable) {
+    into.nullable = true;
+    changed       = true;
+  }
+  return changed;
+}
+
+} // namespace jet::comp::peg
+
+export namespace jet::comp::peg
+{
+
+/// Finalization step.
+/// Computes the first sets of every rule and builds the `Sor` dispatch tables.
+/// @note All placeholders have to be replaced beforehand.
+[[nodiscard]]
+constexpr auto build_sor_dispatch(Grammar const& grammar) -> SorDispatchTable
+{
+  auto analysis = FirstSetAnalysis{grammar};
+  analysis.collect_structural_offsets();
+  analysis.compute();
+
+  auto result = SorDispatchTable();
+  result.index.assign(grammar.rule_registry.data.size(), SorDispatchTable::NO_DISPATCH);
+
+  for (auto offset : analysis.structural_offsets) {
+    auto rule = grammar.rule_registry.view_at(offset).as_structure();
+    if (!rule.kind().is_combinator() || rule.kind().as_combinator() != CombinatorRule::Sor) {
+      continue;
+    }
+
+    result.index[offset] = result.first_sets.size();
+    result.first_sets.push_back(analysis.sets[offset]);
+
+    auto child = rule.first_child();
+    for (auto c = usize(0); c < rule.num_children(); ++c) {
+      result.first_sets.push_back(analysis.first_set_of(child));
+      child = child.next_sibling();
+    }
+  }
+
+  return result;
+}
+
+} // namespace jet::comp::peg
@@ -1,14 +1,51 @@
+/// # Grammar builder module
+///
+/// The builder is usable in constant expressions, so a grammar can be built
+/// at compile time and embedded in the executable (see @c embed_grammar()).
 module;
 
+#include <algorithm>
 #include <variant>
-#include <cassert>
+#include <vector>
+#include <string>
+#include <utility>
+#include <type_traits>
 
 export module Jet.Comp.PEG.GrammarBuilder;
 
 export import Jet.Comp.PEG.Grammar;
+import Jet.Comp.PEG.FirstSets;
+import Jet.Comp.PEG.LiteralSets;
 
 using namespace jet::comp::foundation;
 
+namespace jet::comp::peg
+{
+
+/// Reports a failed requirement of the grammar construction and aborts.
+/// @note It is not @c constexpr on purpose: reaching it during constant evaluation
+/// fails the compilation, and the compiler reports the message.
+[[noreturn]]
+auto grammar_construction_failed(char const* message) -> void;
+
+/// Checks a requirement of the grammar construction.
+/// A grammar built at compile time is always checked, a grammar built at runtime
+/// only in debug builds.
+constexpr auto expect_grammar(bool condition, char const* message) -> void
+{
+  if (condition) {
+    return;
+  }
+#ifdef NDEBUG
+  if (!std::is_constant_evaluated()) {
+    return;
+  }
+#endif
+  grammar_construction_failed(message);
+}
+
+} // namespace jet::comp::peg
+
 export namespace jet::comp::peg
 {
 
@@ -22,12 +59,12 @@ struct GrammarCaptureListBuilder
   using RuleRef = CustomOrPlaceholder;
   Array<RuleRef, ListLen> content;
 
-  auto operator[](T index) const -> RuleRef
+  constexpr auto operator[](T index) const -> RuleRef
   {
     return content[static_cast<usize>(index)];
   }
 
-  auto operator[](T index) -> RuleRef&
+  constexpr auto operator[](T index) -> RuleRef&
   {
     return content[static_cast<usize>(index)];
   }
@@ -38,7 +75,7 @@ struct GrammarCaptureList
 {
   Array<CustomRuleRef, ListLen> content;
 
-  auto operator[](T index) const -> CustomRuleRef
+  constexpr auto operator[](T index) const -> CustomRuleRef
   {
     return content[static_cast<usize>(index)];
   }
@@ -81,28 +118,28 @@ class GrammarBuilder
 
 
   /// Increases the number of children of the last pending rule if there is one.
-  auto try_increase_children() -> void;
+  constexpr auto try_increase_children() -> void;
 
   /// Registers a new structural rule within the registry.
   [[nodiscard]]
-  auto begin_raw_rule(EncodedRule raw, StringView name = "") -> CustomRuleRef;
+  constexpr auto begin_raw_rule(EncodedRule raw, StringView name = "") -> CustomRuleRef;
 
   /// Registers a new raw rule as a child of the last pending rule.
   /// It simply appends the passed value to the rule registry, increases
   /// the number of children of the last pending rule and returns a reference
   /// to the newly created rule.
   [[nodiscard]]
-  auto push_custom_child(usize value) -> CustomRuleRef;
+  constexpr auto push_custom_child(usize value) -> CustomRuleRef;
 
   /// Finalization step.
   /// Replaces all placeholder rules with real rule references.
   /// @note Before finalization every placeholder rule must have
   /// a replacement rule assigned.
-  auto replace_placeholders() -> void;
+  constexpr auto replace_placeholders() -> void;
 
   /// Creates a capture list using the capture list builder.
   template <typename T, usize N>
-  auto finalize_capture_list(GrammarCaptureListBuilder<T, N>&& b) -> GrammarCaptureList<T, N>
+  constexpr auto finalize_capture_list(GrammarCaptureListBuilder<T, N>&& b) -> GrammarCaptureList<T, N>
   {
     auto result = GrammarCaptureList<T, N>{};
     for (auto i = usize(0); i < N; ++i) {
@@ -110,7 +147,7 @@ class GrammarBuilder
 
       if (auto placeholder = std::get_if<PlaceholderRuleRef>(&ref)) {
         auto& replacement = placeholder_replacements[placeholder->id];
-        assert(replacement.has_value() && "Placeholder rule has no replacement");
+        expect_grammar(replacement.has_value(), "Placeholder rule has no replacement");
         result.content[i] = *replacement;
       }
       else if (auto rule = std::get_if<CustomRuleRef>(&ref)) {
@@ -134,12 +171,12 @@ public:
   };
 
   /// Constructs an instance of the @c GrammarBuilder
-  GrammarBuilder();
+  constexpr GrammarBuilder();
 
   /// Registers a text within the registry.
   /// @returns the slice of the text within the registry.
   [[nodiscard]]
-  auto register_text(StringView text) -> RegisteredText;
+  constexpr auto register_text(StringView text) -> RegisteredText;
 
   /// Begins registration of a combinator rule within the registry.
   /// The rule will be considered a child of the last rule that was
@@ -149,7 +186,7 @@ public:
   /// Every call to @c begin_rule() must be followed by a call to @c end_rule().
   /// Use @c view_at() to access the rule.
   [[nodiscard]]
-  auto begin_rule(CombinatorRule kind, bool capture = false, StringView name = "") -> CustomRuleRef;
+  constexpr auto begin_rule(CombinatorRule kind, bool capture = false, StringView name = "") -> CustomRuleRef;
 
   /// Begins registration of a structural rule within the registry.
   /// The rule will be considered a child of the last rule that was
@@ -159,7 +196,19 @@ public:
   /// Every call to @c begin_rule() must be followed by a call to @c end_rule().
   /// Use @c view_at() to access the rule.
   [[nodiscard]]
-  auto begin_rule(StructureRule kind, bool capture = false, StringView name = "") -> CustomRuleRef;
+  constexpr auto begin_rule(StructureRule kind, bool capture = false, StringView name = "") -> CustomRuleRef;
+
+  /// Begins registration of an infix operator of the last pending `Precedence` rule.
+  /// The subrules of the operator match its token, e.g. the text and the whitespace that follows it.
+  /// @param binding_power Operators with a higher binding power bind tighter.
+  /// @param capture Capture the binary expression created by the operator (it spans both operands).
+  /// @returns A @c CustomRuleRef that represents index of the rule within the registry.
+  /// @note
+  /// Every call to @c begin_operator() must be followed by a call to @c end_rule().
+  [[nodiscard]]
+  constexpr auto begin_operator(
+    usize binding_power, Associativity associativity, bool capture = false, StringView name = ""
+  ) -> CustomRuleRef;
 
   /// Begins registration of a rule within the registry with respect to the placeholder
   /// passed as the first argument. The function will automatically replace the placeholder argument.
@@ -172,9 +221,9 @@ public:
   /// Every call to @c begin_rule_and_assign() must be followed by a call to @c end_rule().
   /// Use @c view_at() to access the rule.
   template <typename TRule>
-  auto begin_rule_and_assign(CustomOrPlaceholder& place, TRule kind, bool capture = false, StringView name = "") -> void
+  constexpr auto begin_rule_and_assign(CustomOrPlaceholder& place, TRule kind, bool capture = false, StringView name = "") -> void
   {
-    assert(!std::holds_alternative<CustomRuleRef>(place) && "Rule was already created.");
+    expect_grammar(!std::holds_alternative<CustomRuleRef>(place), "Rule was already created.");
 
     if (auto placeholder = std::get_if<PlaceholderRuleRef>(&place)) {
       auto rule_id = begin_rule(kind, capture, name);
@@ -188,20 +237,20 @@ public:
   }
 
   /// Ends registration of a rule within the registry.
-  auto end_rule() -> void;
+  constexpr auto end_rule() -> void;
 
   /// Adds a rule reference as a child to the last rule that was started with @c begin_rule().
   /// @returns A @c CustomRuleRef that represents index of the new rule within the registry.
-  auto add_rule_ref(CustomRuleRef ref_id) -> CustomRuleRef;
+  constexpr auto add_rule_ref(CustomRuleRef ref_id) -> CustomRuleRef;
 
   /// Adds a placeholder rule reference as a child to the last rule that was started with @c begin_rule().
   /// @returns A @c CustomRuleRef that represents index of the new rule within the registry.
   /// @note every placeholder will be replaced with a real rule reference during finalization.
-  auto add_rule_ref(PlaceholderRuleRef placeholder_rule) -> CustomRuleRef;
+  constexpr auto add_rule_ref(PlaceholderRuleRef placeholder_rule) -> CustomRuleRef;
 
   /// Adds a builtin rule reference as a child to the last rule that was started with @c begin_rule().
   /// @returns A @c CustomRuleRef that represents index of the new rule within the registry.
-  auto add_rule_ref(BuiltinRule rule) -> CustomRuleRef;
+  constexpr auto add_rule_ref(BuiltinRule rule) -> CustomRuleRef;
 
   /// Adds a rule reference (possibly a placeholder) as a child to the last rule that was
   /// started with @c begin_rule().
@@ -221,31 +270,33 @@ public:
   /// }
   /// b.end_rule();
   /// @endcode
-  auto add_rule_ref(CustomOrPlaceholder& ref) -> CustomRuleRef;
+  constexpr auto add_rule_ref(CustomOrPlaceholder& ref) -> CustomRuleRef;
 
   /// Adds a new text rule to the registry.
   /// The rule will be considered a child of the last rule that was
   /// started with @c begin_rule() (if there is one).
   /// @returns A @c CustomRuleRef that represents index of the new rule within the registry.
   [[nodiscard]]
-  auto add_text(StringView text, StringView rule_name = "") -> CustomRuleRef;
+  constexpr auto add_text(StringView text, StringView rule_name = "") -> CustomRuleRef;
 
   /// Creates a new, unique placeholder that can be used by calling @c add_rule_ref().
   /// @note The placeholder rule must be assigned a replacement rule before finalization.
   [[nodiscard]]
-  auto create_placeholder() -> PlaceholderRuleRef;
+  constexpr auto create_placeholder() -> PlaceholderRuleRef;
 
   /// Assigns a replacement rule for a placeholder rule.
   /// @note The placeholder rule must be created with @c create_placeholder() beforehand.
-  auto assign_replacement(PlaceholderRuleRef placeholder, CustomRuleRef replacement) -> void
+  constexpr auto assign_replacement(PlaceholderRuleRef placeholder, CustomRuleRef replacement) -> void
   {
     placeholder_replacements[placeholder.id] = replacement;
   }
 
-  friend auto finalize_grammar(CustomRuleRef, GrammarBuilder&&) -> Grammar;
+  friend constexpr auto finalize_grammar(CustomRuleRef, GrammarBuilder&&) -> Grammar;
 
   template <typename T, usize N>
-  friend auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder, GrammarCaptureListBuilder<T, N>&& capture_list)
+  friend constexpr auto finalize_grammar(
+    CustomRuleRef root_rule, GrammarBuilder&& builder, GrammarCaptureListBuilder<T, N>&& capture_list
+  )
     -> GrammarAndCaptureList<T, N>;
 };
 
@@ -254,7 +305,16 @@ public:
 /// @param builder The builder that was used to construct the grammar.
 /// @returns The finalized grammar, immutable version of a grammar.
 [[nodiscard]]
-auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder) -> Grammar;
+constexpr auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder) -> Grammar
+{
+  expect_grammar(builder.pending_rules.empty(), "Not all rules were ended");
+
+  builder.grammar.root_rule = root_rule;
+  builder.replace_placeholders();
+  builder.grammar.literal_sets = build_literal_sets(builder.grammar);
+  builder.grammar.sor_dispatch = build_sor_dispatch(builder.grammar);
+  return std::move(builder.grammar);
+}
 
 /// Finalizes the build of a grammar and a capture list.
 /// @param root_rule The root rule of the grammar.
@@ -263,8 +323,9 @@ auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder) -> Gram
 /// @returns The finalized, immutable versions of the grammar and capture list.
 template <typename T, usize N>
 [[nodiscard]]
-auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder, GrammarCaptureListBuilder<T, N>&& capture_list)
-  -> GrammarAndCaptureList<T, N>
+constexpr auto finalize_grammar(
+  CustomRuleRef root_rule, GrammarBuilder&& builder, GrammarCaptureListBuilder<T, N>&& capture_list
+) -> GrammarAndCaptureList<T, N>
 {
   auto result         = GrammarAndCaptureList<T, N>();
   result.capture_list = builder.finalize_capture_list(std::move(capture_list));
@@ -272,5 +333,321 @@ auto finalize_grammar(CustomRuleRef root_rule, GrammarBuilder&& builder, Grammar
   return result;
 }
 
+/// Sizes of the containers of a finalized grammar.
+struct EmbeddedGrammarSizes
+{
+  usize rule_registry      = 0;
+  usize text_registry      = 0;
+  usize sor_dispatch_index = 0;
+  usize sor_first_sets     = 0;
+  usize literal_set_index  = 0;
+  usize literal_trie_nodes = 0;
+  usize literal_trie_edges = 0;
+};
+
+/// @returns The grammar of a grammar build (see @c embed_grammar()).
+constexpr auto built_grammar(Grammar& built) -> Grammar&
+{
+  return built;
+}
+
+template <typename T, usize N>
+constexpr auto built_grammar(GrammarAndCaptureList<T, N>& built) -> Grammar&
+{
+  return built.grammar;
+}
+
+/// @returns The capture list of a grammar build or @c std::monostate if it has none.
+constexpr auto built_capture_list(Grammar const&) -> std::monostate
+{
+  return {};
+}
+
+template <typename T, usize N>
+constexpr auto built_capture_list(GrammarAndCaptureList<T, N> const& built) -> GrammarCaptureList<T, N>
+{
+  return built.capture_list;
+}
+
+/// A finalized grammar stored in fixed-size arrays, so that it can be
+/// a @c constexpr variable placed in the read-only data of the executable.
+/// Use @c embed_grammar() to create it.
+template <EmbeddedGrammarSizes Sizes, typename CaptureList = std::monostate>
+struct EmbeddedGrammar
+{
+  /// The capture list built together with the grammar (if any).
+  CaptureList capture_list = {};
+
+  Array<usize, Sizes.rule_registry>      rule_registry      = {};
+  Array<char, Sizes.text_registry>       text_registry      = {};
+  Array<usize, Sizes.sor_dispatch_index> sor_dispatch_index = {};
+  Array<FirstSet, Sizes.sor_first_sets>  sor_first_sets     = {};
+
+  Array<usize, Sizes.literal_set_index>            literal_set_index  = {};
+  Array<LiteralTrieNode, Sizes.literal_trie_nodes> literal_trie_nodes = {};
+  Array<LiteralTrieEdge, Sizes.literal_trie_edges> literal_trie_edges = {};
+
+  CustomRuleRef root_rule;
+
+  /// @returns A grammar with a copy of the embedded data. No rules are built.
+  [[nodiscard]]
+  auto to_grammar() const -> Grammar
+  {
+    auto result = Grammar();
+    result.rule_registry.data.assign(rule_registry.begin(), rule_registry.end());
+    result.text_registry.assign(text_registry.begin(), text_registry.end());
+    result.root_rule = root_rule;
+    result.sor_dispatch.index.assign(sor_dispatch_index.begin(), sor_dispatch_index.end());
+    result.sor_dispatch.first_sets.assign(sor_first_sets.begin(), sor_first_sets.end());
+    result.literal_sets.index.assign(literal_set_index.begin(), literal_set_index.end());
+    result.literal_sets.nodes.assign(literal_trie_nodes.begin(), literal_trie_nodes.end());
+    result.literal_sets.edges.assign(literal_trie_edges.begin(), literal_trie_edges.end());
+    return result;
+  }
+};
+
+/// Builds a grammar during compilation and stores it in an @c EmbeddedGrammar.
+/// Errors of the construction (e.g. rules that were not ended or placeholders
+/// without a replacement) fail the compilation.
+/// @tparam Build A @c constexpr function that builds and finalizes the grammar,
+/// with or without a capture list (a @c Grammar or a @c GrammarAndCaptureList).
+/// @example
+/// @code{.cpp}
+/// constexpr auto build_my_grammar() -> Grammar
+/// {
+///   auto b = GrammarBuilder();
+///   /* ... */
+///   return finalize_grammar(root, std::move(b));
+/// }
+///
+/// static constexpr auto MY_GRAMMAR = embed_grammar<build_my_grammar>();
+/// @endcode
+template <auto Build>
+consteval auto embed_grammar()
+{
+  constexpr auto sizes = [] {
+    auto  built   = Build();
+    auto& grammar = built_grammar(built);
+    return EmbeddedGrammarSizes{
+      .rule_registry      = grammar.rule_registry.data.size(),
+      .text_registry      = grammar.text_registry.size(),
+      .sor_dispatch_index = grammar.sor_dispatch.index.size(),
+      .sor_first_sets     = grammar.sor_dispatch.first_sets.size(),
+      .literal_set_index  = grammar.literal_sets.index.size(),
+      .literal_trie_nodes = grammar.literal_sets.nodes.size(),
+      .literal_trie_edges = grammar.literal_sets.edges.size(),
+    };
+  }();
+
+  auto  built         = Build();
+  auto& grammar       = built_grammar(built);
+  auto  result        = EmbeddedGrammar<sizes, decltype(built_capture_list(built))>();
+  result.capture_list = built_capture_list(built);
+  std::copy(grammar.rule_registry.data.begin(), grammar.rule_registry.data.end(), result.rule_registry.begin());
+  std::copy(grammar.text_registry.begin(), grammar.text_registry.end(), result.text_registry.begin());
+  std::copy(grammar.sor_dispatch.index.begin(), grammar.sor_dispatch.index.end(), result.sor_dispatch_index.begin());
+  std::copy(
+    grammar.sor_dispatch.first_sets.begin(), grammar.sor_dispatch.first_sets.end(), result.sor_first_sets.begin()
+  );
+
+  auto& literal_sets = grammar.literal_sets;
+  std::copy(literal_sets.index.begin(), literal_sets.index.end(), result.literal_set_index.begin());
+  std::copy(literal_sets.nodes.begin(), literal_sets.nodes.end(), result.literal_trie_nodes.begin());
+  std::copy(literal_sets.edges.begin(), literal_sets.edges.end(), result.literal_trie_edges.begin());
+  result.root_rule = grammar.root_rule;
+  return result;
+}
+
+} // namespace jet::comp::peg
+
+namespace jet::comp::peg
+{
+
+constexpr GrammarBuilder::GrammarBuilder()
+{
+  grammar.rule_registry.data.reserve(16 * 1024);
+  grammar.text_registry.reserve(16 * 1024);
+
+  pending_placeholders.reserve(256);
+  placeholder_replacements.reserve(256);
+  pending_rules.reserve(256);
+}
+
+constexpr auto GrammarBuilder::try_increase_children() -> void
+{
+  if (pending_rules.empty()) {
+    return;
+  }
+
+  auto& last = pending_rules.back();
+  ++last.num_children;
+}
+
+constexpr auto GrammarBuilder::register_text(StringView text) -> RegisteredText
+{
+  auto offset = usize(grammar.text_registry.size());
+  auto len    = text.size();
+  grammar.text_registry.append(text);
+  return RegisteredText{offset, len};
+}
+
+constexpr auto GrammarBuilder::begin_rule(CombinatorRule rule, bool capture, StringView name) -> CustomRuleRef
+{
+  auto kind = EncodedRule(usize(rule));
+  if (capture) {
+    kind = kind.make_captured();
+  }
+  return this->begin_raw_rule(kind, name);
+}
+
+constexpr auto GrammarBuilder::begin_rule(StructureRule rule, bool capture, StringView name) -> CustomRuleRef
+{
+  auto kind = EncodedRule(usize(rule));
+  if (capture) {
+    kind = kind.make_captured();
+  }
+  return this->begin_raw_rule(kind, name);
+}
+
+constexpr auto GrammarBuilder::begin_operator(
+  usize binding_power, Associativity associativity, bool capture, StringView name
+) -> CustomRuleRef
+{
+  expect_grammar(
+    !pending_rules.empty() && grammar.rule_registry.view_at(pending_rules.back().rule.offset).as_structure().kind()
+                                .as_combinator() == CombinatorRule::Precedence,
+    "An operator must be a direct child of a Precedence rule"
+  );
+
+  auto kind = EncodedRule(usize(StructureRule::Operator));
+  if (capture) {
+    kind = kind.make_captured();
+  }
+  auto rule_ref = this->begin_raw_rule(kind, name);
+
+  // The payload is not counted as children, the subrules follow it.
+  grammar.rule_registry.data.push_back(binding_power);
+  grammar.rule_registry.data.push_back(usize(associativity));
+
+  return rule_ref;
+}
+
+constexpr auto GrammarBuilder::begin_raw_rule(EncodedRule raw, StringView name) -> CustomRuleRef
+{
+  this->try_increase_children();
+
+  auto& rules_data = grammar.rule_registry.data;
+  auto& text_reg   = grammar.text_registry;
+
+  auto name_text = RegisteredText();
+  if (!name.empty()) {
+    name_text = this->register_text(name);
+  }
+
+  auto rule_ref = CustomRuleRef(rules_data.size());
+  pending_rules.push_back(PendingRule{rule_ref, 0});
+
+  // Add the method
+  {
+    rules_data.resize(rules_data.size() + StructuralView::WIDTH);
+
+    using SV = StructuralView;
+
+    rules_data[rule_ref.offset + SV::KIND_OFFSET]         = raw.value;
+    rules_data[rule_ref.offset + SV::NAME_START_OFFSET]   = name_text.offset;
+    rules_data[rule_ref.offset + SV::NAME_LENGTH_OFFSET]  = name_text.len;
+    rules_data[rule_ref.offset + SV::NUM_CHILDREN_OFFSET] = 0; // tbd. later in building process
+  }
+
+  return rule_ref;
+}
+
+constexpr auto GrammarBuilder::end_rule() -> void
+{
+  expect_grammar(!pending_rules.empty(), "end_rule() called but there are no pending rules");
+
+  auto& rules = grammar.rule_registry;
+  auto& ended = pending_rules.back();
+
+  auto rule_view = Span<usize>(rules.data).subspan(ended.rule.offset);
+
+  rule_view[StructuralView::NUM_CHILDREN_OFFSET]    = ended.num_children;
+  rule_view[StructuralView::NEXT_SIBLING_AT_OFFSET] = rules.data.size();
+  pending_rules.pop_back();
+}
+
+constexpr auto GrammarBuilder::push_custom_child(usize value) -> CustomRuleRef
+{
+  this->try_increase_children();
+
+  auto rule_id = usize(grammar.rule_registry.data.size());
+  grammar.rule_registry.data.push_back(value);
+  return CustomRuleRef(rule_id);
+}
+
+constexpr auto GrammarBuilder::add_rule_ref(CustomRuleRef ref_id) -> CustomRuleRef
+{
+  return this->push_custom_child(ref_id.to_encoded().value);
+}
+
+constexpr auto GrammarBuilder::add_rule_ref(PlaceholderRuleRef placeholder_rule) -> CustomRuleRef
+{
+  auto rule_id = this->push_custom_child(placeholder_rule.id);
+  pending_placeholders.push_back(rule_id);
+  return rule_id;
+}
+
+constexpr auto GrammarBuilder::add_rule_ref(BuiltinRule rule) -> CustomRuleRef
+{
+  return this->push_custom_child(usize(rule));
+}
+
+constexpr auto GrammarBuilder::add_rule_ref(CustomOrPlaceholder& ref) -> CustomRuleRef
+{
+  if (ref.index() == 1)
+    return add_rule_ref(std::get<1>(ref));
+  else if (ref.index() == 2)
+    return add_rule_ref(std::get<2>(ref));
+
+  auto placeholder = this->create_placeholder();
+  ref              = placeholder;
+  auto rule_id     = add_rule_ref(placeholder);
+  return rule_id;
+}
+
+constexpr auto GrammarBuilder::add_text(StringView text, StringView rule_name) -> CustomRuleRef
+{
+  auto rule_ref = this->begin_rule(StructureRule::Text, false, rule_name);
+
+  // Add two "rule refs" that in fact refer to a text.
+  {
+    auto text_reg = this->register_text(text);
+    (void)this->push_custom_child(text_reg.offset);
+    (void)this->push_custom_child(text_reg.len);
+  }
+
+  this->end_rule();
+  return rule_ref;
+}
+
+constexpr auto GrammarBuilder::create_placeholder() -> PlaceholderRuleRef
+{
+  auto id = PlaceholderRuleRef{num_unique_placeholders++};
+  placeholder_replacements.resize(num_unique_placeholders);
+  return id;
+}
+
+constexpr auto GrammarBuilder::replace_placeholders() -> void
+{
+  for (auto& rule_ref : pending_placeholders) {
+    auto& rule_value  = grammar.rule_registry.data[rule_ref.offset];
+    auto  replacement = placeholder_replacements[rule_value];
+    expect_grammar(
+      replacement.has_value(), "Grammar finalization: every placeholder has to be eventually replaced with a rule"
+    );
+
+    rule_value = replacement.value().to_encoded().value;
+  }
+}
 
-} // namespace jet::comp::peg
\ No newline at end of file
+} // namespace jet::comp::peg
@@ -0,0 +1,202 @@
+/// # Literal sets module
+///
+/// Builds the tries used to match a set of texts in a single pass over the input,
+/// instead of trying every text one by one. Usable in constant expressions, so that
+/// grammars can be built at compile time.
+module;
+
+#include <algorithm>
+#include <vector>
+
+export module Jet.Comp.PEG.LiteralSets;
+
+export import Jet.Comp.PEG.Grammar;
+
+using namespace jet::comp::foundation;
+
+namespace jet::comp::peg
+{
+
+/// A trie under construction (the edges of a node are not yet stored next to each other).
+struct LiteralTrieBuilder
+{
+  struct Node
+  {
+    DynArray<LiteralTrieEdge> edges;
+    usize                     literal = LiteralTrieNode::NO_LITERAL;
+  };
+
+  DynArray<Node> nodes = DynArray<Node>(1);
+
+  /// Adds a literal. If the same literal was already added, the first one is kept.
+  constexpr auto add(StringView literal, usize index) -> void
+  {
+    auto node = usize(0);
+    for (auto c : literal) {
+      auto& edges = nodes[node].edges;
+      auto  it    = std::find_if(edges.begin(), edges.end(), [&](auto const& edge) { return edge.byte == u8(c); });
+      if (it != edges.end()) {
+        node = it->target;
+        continue;
+      }
+
+      edges.push_back(LiteralTrieEdge{u8(c), nodes.size()});
+      node = nodes.size();
+      nodes.emplace_back();
+    }
+
+    if (nodes[node].literal == LiteralTrieNode::NO_LITERAL) {
+      nodes[node].literal = index;
+    }
+  }
+
+  /// Appends the trie to the table.
+  /// @returns The root node.
+  constexpr auto store(LiteralSetTable& table) -> usize
+  {
+    auto const base = table.nodes.size();
+    for (auto& node : nodes) {
+      std::sort(node.edges.begin(), node.edges.end(), [](auto const& a, auto const& b) { return a.byte < b.byte; });
+
+      table.nodes.push_back(LiteralTrieNode{table.edges.size(), node.edges.size(), node.literal});
+      for (auto edge : node.edges) {
+        edge.target += base;
+        table.edges.push_back(edge);
+      }
+    }
+    return base;
+  }
+};
+
+/// @returns The text of a rule, if it is a text that is not captured.
+constexpr auto plain_text_of(Grammar const& grammar, RuleRegistryView rule) -> Opt<StringView>
+{
+  if (rule.at_end() || !rule.at_structural()) {
+    return std::nullopt;
+  }
+
+  auto structure = rule.as_structure();
+  if (!structure.is_text() || structure.kind().is_captured()) {
+    return std::nullopt;
+  }
+  return structure.get_text(grammar.text_registry);
+}
+
+/// @returns @c true if an ordered choice between the literals always picks the longest one
+/// that the input starts with, i.e. no literal is a proper prefix of a later one.
+constexpr auto longest_match_is_ordered_choice(Span<StringView const> literals) -> bool
+{
+  for (auto i = usize(0); i < literals.size(); ++i) {
+    for (auto j = i + 1; j < literals.size(); ++j) {
+      if (literals[i].size() < literals[j].size() && literals[j].starts_with(literals[i])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// @returns The texts of the alternatives of a `Sor`, if all of them are plain texts.
+constexpr auto literals_of_sor(Grammar const& grammar, StructuralView rule) -> Opt<DynArray<StringView>>
+{
+  auto result = DynArray<StringView>();
+  auto child  = rule.first_child();
+  for (auto c = usize(0); c < rule.num_children(); ++c) {
+    auto text = plain_text_of(grammar, child);
+    if (!text) {
+      return std::nullopt;
+    }
+    result.push_back(*text);
+    child = child.next_sibling();
+  }
+  return result;
+}
+
+/// @returns The leading texts of the operators of a `Precedence`, if every operator starts with a plain text.
+constexpr auto literals_of_precedence(Grammar const& grammar, StructuralView rule) -> Opt<DynArray<StringView>>
+{
+  auto result = DynArray<StringView>();
+  auto op     = rule.first_child().next_sibling();
+  for (auto c = usize(1); c < rule.num_children(); ++c) {
+    if (!op.at_structural() || !op.as_structure().is_operator() || op.as_structure().num_children() == 0) {
+      return std::nullopt;
+    }
+
+    auto text = plain_text_of(grammar, op.as_structure().first_child());
+    if (!text) {
+      return std::nullopt;
+    }
+    result.push_back(*text);
+    op = op.next_sibling();
+  }
+  return result;
+}
+
+} // namespace jet::comp::peg
+
+export namespace jet::comp::peg
+{
+
+/// Finalization step.
+/// Turns every `Sor` of (at least two) plain texts, for which the longest match is the one picked
+/// by the `Sor`, into a `LiteralSet`, and builds the tries of the literal sets and of the operators
+/// of the `Precedence` rules.
+/// @note All placeholders have to be replaced beforehand.
+[[nodiscard]]
+constexpr auto build_literal_sets(Grammar& grammar) -> LiteralSetTable
+{
+  using SV = StructuralView;
+
+  auto result = LiteralSetTable();
+  result.index.assign(grammar.rule_registry.data.size(), LiteralSetTable::NO_SET);
+
+  // Rules are laid out in pre-order, so a linear walk over the registry visits every structural rule.
+  auto registry = grammar.rule_registry.view();
+  while (!registry.at_end()) {
+    if (!registry.at_structural()) {
+      registry = registry.offset(1);
+      continue;
+    }
+
+    auto rule = registry.as_structure();
+    registry  = registry.offset(rule.width());
+
+    if (!rule.kind().is_combinator()) {
+      continue;
+    }
+
+    auto literals = Opt<DynArray<StringView>>();
+    switch (rule.kind().as_combinator()) {
+    case CombinatorRule::Sor: {
+      if (rule.num_children() >= 2) {
+        literals = literals_of_sor(grammar, rule);
+      }
+      break;
+    }
+    case CombinatorRule::Precedence: literals = literals_of_precedence(grammar, rule); break;
+    default: break;
+    }
+
+    if (!literals || literals->empty() || !longest_match_is_ordered_choice(*literals)) {
+      continue;
+    }
+
+    auto trie = LiteralTrieBuilder();
+    for (auto i = usize(0); i < literals->size(); ++i) {
+      trie.add((*literals)[i], i);
+    }
+    result.index[rule.current_offset] = trie.store(result);
+
+    if (rule.kind().as_combinator() == CombinatorRule::Sor) {
+      auto kind = EncodedRule(usize(StructureRule::LiteralSet));
+      if (rule.kind().is_captured()) {
+        kind = kind.make_captured();
+      }
+      grammar.rule_registry.data[rule.current_offset + SV::KIND_OFFSET] = kind.value;
+    }
+  }
+
+  return result;
+}
+
+} // namespace jet::comp::peg
@@ -55,6 +55,15 @@ enum class CombinatorRule : i32
   /// Matches if the sequence inside fails.
   OneIfNotAt,
 
+  /// Operator-precedence expression: `operand (operator operand)*`.
+  /// The first subrule is the operand, every other subrule is an infix `Operator` structure
+  /// (tried in order, like the alternatives of a `Sor`).
+  /// Operands and operators are nested according to the binding power and associativity
+  /// of the operators, so every captured operator creates an entry spanning both of its operands.
+  /// Equivalent (except for the nesting) to:
+  /// Seq(Operand, Star(Sor(Op1, Op2, ...), Operand))
+  Precedence,
+
   MAX,
 };
 
@@ -63,9 +72,29 @@ enum class StructureRule : i32
   /// Matches an entry in the text table.
   Text = i32(CombinatorRule::MAX),
 
+  /// An infix operator of a `Precedence` rule. Matches the sequence of its subrules (the token).
+  /// Stores the binding power and associativity of the operator.
+  /// The capture flag applies to the created binary expression, not to the token.
+  Operator,
+
+  /// A set of texts (the subrules), matched at once by the longest text that the input starts with.
+  /// Produced by the grammar finalization from a `Sor` of texts, where the longest match
+  /// is always the one picked by the `Sor`. See @c LiteralSetTable.
+  LiteralSet,
+
   MAX,
 };
 
+/// Describes how a sequence of operators with the same binding power is nested.
+enum class Associativity : i32
+{
+  /// `a - b - c` is `(a - b) - c`
+  Left,
+
+  /// `a = b = c` is `a = (b = c)`
+  Right,
+};
+
 // For faster evaluation and space efficiency
 enum class BuiltinRule : i32
 {
@@ -150,7 +179,7 @@ struct CustomRuleRef final
   usize offset = 0;
 
   [[nodiscard]]
-  auto to_encoded() const -> EncodedRule;
+  constexpr auto to_encoded() const -> EncodedRule;
 
   auto operator==(CustomRuleRef const& other) const -> bool = default;
 };
@@ -177,98 +206,98 @@ struct EncodedRule final
 
   /// @returns @c true if this instance describes the kind of a combinator rule.
   [[nodiscard]]
-  auto is_combinator() const -> bool
+  constexpr auto is_combinator() const -> bool
   {
     return within(Boundaries::COMBINATORS, Boundaries::STRUCTURE);
   }
 
   /// @returns @c true if this instance describes the kind of a structure rule.
   [[nodiscard]]
-  auto is_structure() const -> bool
+  constexpr auto is_structure() const -> bool
   {
     return within(Boundaries::STRUCTURE, Boundaries::BUILTIN);
   }
 
   /// @returns @c true if this instance describes the kind of a combinator or structure rule.
   [[nodiscard]]
-  auto is_structural() const -> bool
+  constexpr auto is_structural() const -> bool
   {
     return this->is_structure() || this->is_combinator();
   }
 
   /// @returns @c true if this instance is a reference to a builtin rule.
   [[nodiscard]]
-  auto is_builtin() const -> bool
+  constexpr auto is_builtin() const -> bool
   {
     return within(Boundaries::BUILTIN, Boundaries::CUSTOM);
   }
 
   /// @returns @c true if this instance is a reference to a custom rule (within the RuleRegistry).
   [[nodiscard]]
-  auto is_custom() const -> bool
+  constexpr auto is_custom() const -> bool
   {
     return this->drop_flags() >= Boundaries::CUSTOM;
   }
 
   /// @returns The kind of combinator that this rule encodes.
   [[nodiscard]]
-  auto as_combinator() const -> CombinatorRule
+  constexpr auto as_combinator() const -> CombinatorRule
   {
     return static_cast<CombinatorRule>(this->drop_flags());
   }
 
   /// @returns The kind of a structure that this rule encodes.
   [[nodiscard]]
-  auto as_structure() const -> StructureRule
+  constexpr auto as_structure() const -> StructureRule
   {
     return static_cast<StructureRule>(this->drop_flags());
   }
 
   /// @returns The builtin rule referenced by the instance.
   [[nodiscard]]
-  auto as_builtin() const -> BuiltinRule
+  constexpr auto as_builtin() const -> BuiltinRule
   {
     return static_cast<BuiltinRule>(this->drop_flags());
   }
 
   /// @returns The decoded custom rule references (offset in a RuleRegistry).
   [[nodiscard]]
-  auto to_custom() const -> CustomRuleRef
+  constexpr auto to_custom() const -> CustomRuleRef
   {
     return CustomRuleRef(this->drop_flags() - Boundaries::CUSTOM);
   }
 
   /// @returns @c true if the rule is captured during analysis.
   [[nodiscard]]
-  auto is_captured() const -> bool
+  constexpr auto is_captured() const -> bool
   {
     return value & CAPTURE_FLAG;
   }
 
   /// @returns A copy of the instance with the capture flag set.
   [[nodiscard]]
-  auto make_captured() const -> EncodedRule
+  constexpr auto make_captured() const -> EncodedRule
   {
     return EncodedRule{value | CAPTURE_FLAG};
   }
 
   /// @returns A copy of the instance with the flags cleared.
   [[nodiscard]]
-  auto drop_flags() const -> usize
+  constexpr auto drop_flags() const -> usize
   {
     return value & ~(CAPTURE_FLAG);
   }
 
 private:
   [[nodiscard]]
-  auto within(usize inc_min, usize ex_max) const -> bool
+  constexpr auto within(usize inc_min, usize ex_max) const -> bool
   {
     auto no_flags = this->drop_flags();
     return inc_min <= no_flags && no_flags < ex_max;
   }
 };
 
-auto CustomRuleRef::to_encoded() const -> EncodedRule
+constexpr auto CustomRuleRef::to_encoded() const -> EncodedRule
 {
   return EncodedRule{offset + Boundaries::CUSTOM};
 }
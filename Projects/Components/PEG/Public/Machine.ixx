@@ -0,0 +1,186 @@
+/// # PEG parsing machine module
+///
+/// Lowers a finalized grammar into a flat instruction stream and executes it
+/// with a non-recursive virtual machine (in the style of LPeg's parsing machine).
+///
+/// The machine produces exactly the same AST as @c analyze() does for the source grammar.
+module;
+
+#include <vector>
+
+export module Jet.Comp.PEG.Machine;
+
+export import Jet.Comp.PEG.Grammar;
+export import Jet.Comp.PEG.Analysis;
+
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+export namespace jet::comp::peg
+{
+
+/// Describes the operation of a single instruction.
+/// Operands @c a and @c b are described next to each operation.
+enum class OpCode : u32
+{
+  /// Stops the machine. a: 1 if the match succeeded, 0 otherwise.
+  Halt,
+
+  /// Continues at a different instruction. a: target.
+  Jump,
+
+  /// Pushes a call frame and continues at the rule's code. a: target.
+  Call,
+
+  /// Pops a call frame and continues after the matching @c Call.
+  Return,
+
+  /// Fails the current match: pops call frames and continues at the handler of the top-most frame.
+  Fail,
+
+  /// Consumes a text from the text registry or fails. a: text offset, b: text length.
+  Text,
+
+  /// Consumes a builtin rule or fails. a: @c BuiltinRule.
+  Builtin,
+
+  /// Consumes the longest literal of a trie or fails. a: root node.
+  Literal,
+
+  /// Jumps to the alternative that starts with the longest literal of a trie.
+  /// a: root node, b: index of the jump table (the target if no literal matched, then one per literal).
+  DispatchLiteral,
+
+  /// Pushes a backtrack frame that stores a restore point. a: failure handler.
+  PushFrame,
+
+  /// Changes the failure handler of the top-most frame. a: failure handler.
+  SetHandler,
+
+  /// Begins an AST entry and binds it to the top-most frame. a: index of the entry info.
+  BeginEntry,
+
+  /// Succeeds the top-most frame (finalizing its entry if captured), pops it and jumps.
+  /// a: flags, b: target.
+  Commit,
+
+  /// Fails the top-most frame (failing its entry if captured), restores the state, pops it and fails.
+  /// a: flags, b: offset of the rule reported if the frame is a `Must`.
+  Unwind,
+
+  /// Fails if no alternative of a `Sor` can start with the next byte. a: first set index.
+  TestFirst,
+
+  /// Jumps if a `Sor` alternative cannot start with the next byte. a: first set index, b: target.
+  SkipUnlessFirst,
+
+  /// Jumps if the analysis was aborted by a `Must`. a: target.
+  JumpIfAborted,
+
+  /// Jumps if the top-most repetition frame reached its maximum. a: maximum (0 - unbounded), b: target.
+  RepeatCheckMax,
+
+  /// Pops a successful iteration frame and counts the match in the repetition frame. a: target.
+  RepeatNext,
+
+  /// Restores the state of a failed iteration, pops its frame and jumps. a: target.
+  RepeatStop,
+
+  /// Succeeds or unwinds the repetition frame, depending on the number of matches.
+  /// a: flags, b: minimal number of matches.
+  RepeatEnd,
+
+  /// Consumes a run of a character class, each byte counting as a match of the repetition frame.
+  /// a: @c CharClass.
+  ScanRun,
+
+  /// Fails if the whole input was consumed.
+  FailIfAtEnd,
+
+  /// Restores the state of a lookahead frame, pops it and fails (the lookahead matched).
+  PeekMatched,
+
+  /// Restores the state of a lookahead frame, pops it and consumes a single byte.
+  PeekFailed,
+
+  /// Binds the operators matched from now on to the `Precedence` frame.
+  PrecedenceBegin,
+
+  /// Records the operator matched by the top-most iteration frame. a: index of the operator info.
+  OperatorMatched,
+
+  /// Drops the last recorded operator (it was not followed by an operand).
+  OperatorDrop,
+
+  /// Nests the operands and the recorded operators, then succeeds the `Precedence` frame and jumps,
+  /// or unwinds it if the analysis was aborted. a: flags, b: target.
+  PrecedenceEnd,
+};
+
+/// Flags of the frame-related instructions.
+struct InstructionFlags final
+{
+  /// The frame has an AST entry.
+  inline static auto constexpr CAPTURED = u32(1) << 0;
+
+  /// A failure of the frame aborts the analysis.
+  inline static auto constexpr MUST = u32(1) << 1;
+
+  /// The AST entry is kept when the analysis was aborted (`Sor` semantics).
+  inline static auto constexpr KEEP_ENTRY_ON_ABORT = u32(1) << 2;
+};
+
+/// A single instruction of a compiled grammar.
+struct Instruction
+{
+  OpCode op;
+  u32    a = 0;
+  u32    b = 0;
+};
+
+/// Describes an AST entry created by the @c BeginEntry instruction.
+struct EntryInfo
+{
+  CustomRuleRef rule;
+
+  usize name_start  = 0;
+  usize name_length = 0;
+};
+
+/// A grammar lowered into an instruction stream.
+/// Use @c compile_grammar() to create a program.
+struct Program
+{
+  DynArray<Instruction> code;
+
+  /// Entries created by the @c BeginEntry instructions.
+  DynArray<EntryInfo> entries;
+
+  /// First sets used by the `Sor` dispatch instructions.
+  DynArray<FirstSet> first_sets;
+
+  /// Operators recorded by the @c OperatorMatched instructions.
+  DynArray<OperatorInfo> operators;
+
+  /// Tries used by the @c Literal and @c DispatchLiteral instructions.
+  LiteralSetTable literal_sets;
+
+  /// Jump tables of the @c DispatchLiteral instructions.
+  DynArray<u32> jump_targets;
+
+  /// A copy of the grammar's text registry.
+  String text_registry;
+};
+
+/// Lowers the grammar into a program for the parsing machine.
+/// @note The grammar must be finalized.
+[[nodiscard]]
+auto compile_grammar(Grammar const& grammar) -> Program;
+
+/// Analyzes the given document by executing the compiled grammar.
+/// Produces the same result as @c analyze() called with the source grammar.
+[[nodiscard]]
+auto analyze(Program const& program, StringView document) -> ASTAnalysisResult;
+
+} // namespace jet::comp::peg
@@ -2,7 +2,11 @@ export module Jet.Comp.PEG;
 export import Jet.Comp.PEG.Rule;
 export import Jet.Comp.PEG.Grammar;
 export import Jet.Comp.PEG.GrammarBuilder;
+export import Jet.Comp.PEG.CharScan;
 export import Jet.Comp.PEG.Analysis;
+export import Jet.Comp.PEG.Profiling;
+export import Jet.Comp.PEG.Machine;
+export import Jet.Comp.PEG.Stream;
 
 export namespace jet::comp::peg
 {
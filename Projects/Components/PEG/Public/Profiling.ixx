@@ -0,0 +1,115 @@
+/// # PEG profiling module
+///
+/// Per-rule counters collected by the analyzer, to find the rules that dominate the analysis time.
+/// Profiling is compiled in only with the `JET_PEG_PROFILING` CMake option,
+/// otherwise the analyzer has no profiling code at all.
+module;
+
+#include <chrono>
+#include <vector>
+
+export module Jet.Comp.PEG.Profiling;
+
+export import Jet.Comp.PEG.Grammar;
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+export namespace jet::comp::peg
+{
+
+/// Whether the analyzer was built with the profiling hooks (the `JET_PEG_PROFILING` CMake option).
+#ifdef JET_PEG_PROFILING
+inline constexpr auto PROFILING_ENABLED = true;
+#else
+inline constexpr auto PROFILING_ENABLED = false;
+#endif
+
+/// Counters of a single (named) rule.
+struct RuleStats
+{
+  CustomRuleRef rule;
+
+  /// The name of the rule, from the text registry of the grammar.
+  StringView name;
+
+  /// Number of times the rule was tried.
+  usize calls     = 0;
+  usize successes = 0;
+  usize failures  = 0;
+
+  /// Bytes consumed by the successful matches.
+  usize consumed_bytes = 0;
+
+  /// Bytes consumed by the failed matches before they backtracked (how far they got).
+  usize backtracked_bytes = 0;
+
+  /// Time spent in the rule, including the rules it tried.
+  /// A recursive rule counts the time of the nested calls again.
+  std::chrono::nanoseconds cumulative_time{0};
+
+  /// Time spent in the rule, excluding the named rules it tried.
+  std::chrono::nanoseconds self_time{0};
+};
+
+/// Counters of every named rule tried during the profiled analyses.
+/// Pass it to @c AnalysisOptions::profile. The counters of consecutive analyses add up.
+/// @note Rules without a name are attributed to the closest named rule that tried them.
+struct RuleProfile
+{
+  inline static auto constexpr NO_STATS = ~usize(0);
+
+  /// Counters in order of the first call.
+  DynArray<RuleStats> rules;
+
+  /// Maps an offset of a rule in the registry to its counters in @c rules (or @c NO_STATS).
+  DynArray<usize> index;
+
+  /// @returns The counters of the given rule, created on the first call.
+  auto stats_of(CustomRuleRef rule, StringView name) -> usize
+  {
+    if (rule.offset >= index.size()) {
+      index.resize(rule.offset + 1, NO_STATS);
+    }
+
+    auto& slot = index[rule.offset];
+    if (slot == NO_STATS) {
+      slot = rules.size();
+      rules.push_back(RuleStats{.rule = rule, .name = name});
+    }
+    return slot;
+  }
+
+  /// Removes every counter.
+  auto clear() -> void
+  {
+    rules.clear();
+    index.clear();
+  }
+};
+
+/// How the rules of a profile report are ordered (descending).
+enum class ProfileOrder
+{
+  CumulativeTime,
+  SelfTime,
+  Calls,
+  BacktrackedBytes,
+};
+
+/// @returns The counters sorted by the given key (descending).
+[[nodiscard]]
+auto sorted_rule_stats(RuleProfile const& profile, ProfileOrder order) -> DynArray<RuleStats>;
+
+/// @returns A human-readable table of the rules, sorted by the given key.
+/// @param max_rules Maximal number of the listed rules (0 - all of them).
+[[nodiscard]]
+auto format_profile_report(RuleProfile const& profile, ProfileOrder order = ProfileOrder::CumulativeTime, usize max_rules = 0)
+  -> String;
+
+/// @returns The profile as a JSON array of objects (one per rule, sorted by the cumulative time).
+/// Times are given in nanoseconds.
+[[nodiscard]]
+auto format_profile_json(RuleProfile const& profile) -> String;
+
+} // namespace jet::comp::peg
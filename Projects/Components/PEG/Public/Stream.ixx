@@ -0,0 +1,174 @@
+/// # PEG stream module
+///
+/// Analyzes a document that is read in chunks, without keeping the whole of it in memory.
+module;
+
+#include <istream>
+#include <vector>
+
+export module Jet.Comp.PEG.Stream;
+
+export import Jet.Comp.PEG.Grammar;
+export import Jet.Comp.PEG.Analysis;
+
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+export namespace jet::comp::peg
+{
+
+/// Supplies a document in chunks.
+struct InputReader
+{
+  virtual ~InputReader() = default;
+
+  /// Reads the next bytes of the document into the buffer.
+  /// @returns The number of bytes read, 0 at the end of the document.
+  virtual auto read(Span<char> buffer) -> usize = 0;
+};
+
+/// Reads a document from a standard stream (e.g. a @c std::ifstream).
+struct StdStreamReader final : InputReader
+{
+  std::istream& stream;
+
+  explicit StdStreamReader(std::istream& stream)
+    : stream(stream)
+  {
+  }
+
+  auto read(Span<char> buffer) -> usize override
+  {
+    stream.read(buffer.data(), std::streamsize(buffer.size()));
+    return usize(stream.gcount());
+  }
+};
+
+/// A window over a document read in chunks.
+/// Positions are absolute (counted from the start of the document). The bytes before
+/// the lowest live restore point are released, so the memory is bounded by the lookahead
+/// of the analysis rather than by the size of the document.
+struct SlidingBuffer
+{
+  InputReader& reader;
+
+  /// Number of bytes requested from the reader at once.
+  usize chunk_size = 256 * 1024;
+
+  SlidingBuffer(InputReader& reader, usize chunk_size)
+    : reader(reader)
+    , chunk_size(chunk_size)
+  {
+  }
+
+  /// Reads until the buffer holds the bytes before the given position or the document ended.
+  auto fill_to(usize pos) -> void;
+
+  /// Reads at least as many bytes as the window holds (and at least a chunk), so that
+  /// repeated growth of the window takes an amortized linear time.
+  /// @returns @c false if the document had already ended.
+  auto grow() -> bool;
+
+  /// Releases the bytes before the given position. No restore point can go back before it.
+  auto release(usize pos) -> void;
+
+  /// @returns The bytes that were read and not released yet.
+  [[nodiscard]]
+  auto window() const -> StringView
+  {
+    return StringView(data).substr(start);
+  }
+
+  /// @returns The position of the first byte of the window.
+  [[nodiscard]]
+  auto base_pos() const -> usize
+  {
+    return released;
+  }
+
+  /// @returns The position after the last byte that was read.
+  [[nodiscard]]
+  auto end_pos() const -> usize
+  {
+    return released + data.size() - start;
+  }
+
+  /// @returns @c true if the reader reached the end of the document.
+  [[nodiscard]]
+  auto at_eof() const -> bool
+  {
+    return eof;
+  }
+
+  /// @returns The largest number of bytes held at once.
+  [[nodiscard]]
+  auto peak_size() const -> usize
+  {
+    return peak;
+  }
+
+private:
+  /// Reads a single chunk of the given size.
+  auto read_chunk(usize size) -> usize;
+
+  String data;
+
+  /// Offset of the window within @c data (the released bytes are compacted lazily).
+  usize start = 0;
+
+  /// Number of bytes released before the window.
+  usize released = 0;
+
+  usize peak = 0;
+  bool  eof  = false;
+};
+
+/// Describes a document made of items and the separators between them:
+/// `separator (item separator)*`, e.g. the top-level declarations of a module and the whitespace around them.
+/// The root rule of the grammar must be equivalent (the root entry of the AST is created for it).
+struct StreamRules
+{
+  CustomRuleRef item;
+  CustomRuleRef separator;
+
+  /// The analysis fails if the document has fewer items.
+  usize min_items = 0;
+};
+
+/// Receives the items of a streamed document, while their text is still in the buffer.
+struct StreamItemHandler
+{
+  virtual ~StreamItemHandler() = default;
+
+  /// @param ast The AST built so far. The entries of the item are at its end, from @p first_entry.
+  /// @param text The text of the item. The positions in the AST are absolute, @p text starts at @p text_pos.
+  virtual auto on_item(AST const& ast, usize first_entry, StringView text, usize text_pos) -> void = 0;
+};
+
+/// Configures @c analyze_stream().
+struct StreamOptions
+{
+  /// Number of bytes requested from the reader at once.
+  usize chunk_size = 256 * 1024;
+
+  /// Number of bytes after the end of an item (or separator) that have to be in the buffer
+  /// before its match is accepted. The grammar must not look further than this past the end of an item.
+  usize lookahead = 4 * 1024;
+
+  /// Receives every analyzed item. Optional.
+  StreamItemHandler* handler = nullptr;
+};
+
+/// Analyzes a document read in chunks, as a sequence of items (see @c StreamRules).
+/// Every item (and separator) is analyzed once the buffer holds @c StreamOptions::lookahead bytes
+/// past its end. Once matched, the input before it is released, as the items are never backtracked into.
+/// The AST is the same as the one of @c analyze() called with the whole document, but
+/// @c ASTAnalysis::document is empty: the text is only available to the @c StreamItemHandler.
+/// @note A syntax error makes the analysis read the rest of the document, as the failing item
+/// could match with more input.
+[[nodiscard]]
+auto analyze_stream(Grammar const& grammar, StreamRules const& rules, InputReader& reader, StreamOptions const& options = {})
+  -> ASTAnalysisResult;
+
+} // namespace jet::comp::peg
@@ -1,37 +1,268 @@
 module;
 
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <optional>
+#include <utility>
+
+#include <Jet/Comp/Foundation/Windows.hpp>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 module Jet.Core.File;
 
 namespace jet::core
 {
 
+/// Maps the whole regular file.
+/// @returns The mapped memory or @c nullptr if the file cannot be mapped.
+static auto map_file(Path const& file_path, usize size) -> char const*
+{
+#ifdef WIN32
+  auto file = CreateFileW(
+    file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+  );
+  if (file == INVALID_HANDLE_VALUE) {
+    return nullptr;
+  }
+
+  auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return nullptr;
+  }
+
+  // The view keeps the mapping alive.
+  auto view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+  CloseHandle(mapping);
+  return static_cast<char const*>(view);
+#else
+  auto fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  auto view = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // Sources are analyzed front to back.
+  ::madvise(view, size, MADV_SEQUENTIAL);
+  return static_cast<char const*>(view);
+#endif
+}
+
+auto MappedFile::open(Path const& file_path) -> Opt<MappedFile>
+{
+  auto result = MappedFile();
+
+  // Empty files cannot be mapped, and the size of the other files is not known up front.
+  auto error = std::error_code();
+  if (std::filesystem::is_regular_file(file_path, error)) {
+    auto const size = usize(std::filesystem::file_size(file_path, error));
+    if (!error && size > 0) {
+      if (auto mapping = map_file(file_path, size)) {
+        result.mapping      = mapping;
+        result.mapping_size = size;
+        return result;
+      }
+    }
+  }
+
+  auto content = read_file(file_path);
+  if (!content) {
+    return std::nullopt;
+  }
+  result.buffer = std::move(*content);
+  return result;
+}
+
+MappedFile::~MappedFile()
+{
+  unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : mapping(std::exchange(other.mapping, nullptr))
+  , mapping_size(std::exchange(other.mapping_size, 0))
+  , buffer(std::move(other.buffer))
+{
+}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+{
+  if (this != &other) {
+    unmap();
+    mapping      = std::exchange(other.mapping, nullptr);
+    mapping_size = std::exchange(other.mapping_size, 0);
+    buffer       = std::move(other.buffer);
+  }
+  return *this;
+}
+
+auto MappedFile::prefault() const -> void
+{
+  static auto constexpr PAGE_SIZE = usize(4096);
+
+  if (!mapping) {
+    return;
+  }
+
+#ifndef WIN32
+  ::madvise(const_cast<char*>(mapping), mapping_size, MADV_WILLNEED);
+#endif
+
+  auto volatile sink = char(0);
+  for (auto pos = usize(0); pos < mapping_size; pos += PAGE_SIZE) {
+    sink = mapping[pos];
+  }
+}
+
+auto MappedFile::unmap() -> void
+{
+  if (!mapping) {
+    return;
+  }
+
+#ifdef WIN32
+  UnmapViewOfFile(mapping);
+#else
+  ::munmap(const_cast<char*>(mapping), mapping_size);
+#endif
+  mapping      = nullptr;
+  mapping_size = 0;
+}
+
 auto read_file(Path const& file_path) -> Opt<String>
 {
-  auto file = std::ifstream(file_path);
+  auto file = std::ifstream(file_path, std::ios::binary);
 
   if (!file.is_open()) {
     return std::nullopt;
   }
 
-  auto buf = Array<char, 256 * 1024>();
-
+  // Reads straight into the string, without an intermediate buffer.
   auto content = String();
-  content.reserve(4 * 1024 * 1024);
-
-  while (file.read(buf.data(), buf.size())) {
-    content.append(StringView(buf.data(), file.gcount()));
+  auto error   = std::error_code();
+  if (auto const size = std::filesystem::file_size(file_path, error); !error) {
+    content.resize(size);
+    file.read(content.data(), std::streamsize(size));
+    content.resize(usize(file.gcount()));
   }
-  content.append(StringView(buf.data(), file.gcount()));
 
+  // Files of an unknown size (e.g. pipes) or the ones that grew in the meantime.
+  content.append(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
   return content;
 }
 
+auto FileWriter::create(Path const& file_path, usize buffer_size) -> Opt<FileWriter>
+{
+#ifdef WIN32
+  auto file = _wfopen(file_path.c_str(), L"wb");
+#else
+  auto file = std::fopen(file_path.c_str(), "wb");
+#endif
+  if (file == nullptr) {
+    return std::nullopt;
+  }
+
+  // The writer buffers the content itself.
+  std::setvbuf(file, nullptr, _IONBF, 0);
+
+  auto result        = FileWriter();
+  result.file        = file;
+  result.buffer_size = std::max(buffer_size, usize(1));
+  result.buffer.reserve(result.buffer_size);
+  return result;
+}
+
+FileWriter::~FileWriter()
+{
+  (void)this->close();
+}
+
+FileWriter::FileWriter(FileWriter&& other) noexcept
+  : file(std::exchange(other.file, nullptr))
+  , buffer(std::move(other.buffer))
+  , buffer_size(other.buffer_size)
+  , bytes_written(std::exchange(other.bytes_written, 0))
+  , failed(std::exchange(other.failed, false))
+{
+}
+
+auto FileWriter::operator=(FileWriter&& other) noexcept -> FileWriter&
+{
+  if (this != &other) {
+    (void)this->close();
+    file          = std::exchange(other.file, nullptr);
+    buffer        = std::move(other.buffer);
+    buffer_size   = other.buffer_size;
+    bytes_written = std::exchange(other.bytes_written, 0);
+    failed        = std::exchange(other.failed, false);
+  }
+  return *this;
+}
+
+auto FileWriter::write(StringView text) -> void
+{
+  if (text.size() < buffer_size) {
+    buffer.append(text);
+    this->commit();
+    return;
+  }
+
+  this->flush();
+  this->write_to_file(text);
+}
+
+auto FileWriter::flush() -> bool
+{
+  this->write_to_file(buffer);
+
+  // Keeps the capacity for the next chunk.
+  buffer.clear();
+  return !failed;
+}
+
+auto FileWriter::write_to_file(StringView text) -> void
+{
+  if (file == nullptr || text.empty()) {
+    return;
+  }
+
+  auto const written = std::fwrite(text.data(), 1, text.size(), file);
+  failed             = failed || written != text.size();
+  bytes_written     += written;
+}
+
+auto FileWriter::close() -> bool
+{
+  if (file == nullptr) {
+    return !failed;
+  }
+
+  this->flush();
+  failed = std::fclose(file) != 0 || failed;
+  file   = nullptr;
+  return !failed;
+}
+
 auto overwrite_file(Path const& file_path, StringView content) -> void
 {
-  std::ofstream(file_path) << content;
+  // The content is larger than the buffer, so it is written at once, without a copy.
+  if (auto writer = FileWriter::create(file_path, 1)) {
+    writer->write(content);
+  }
 }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,84 @@
+module;
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+module Jet.Core.File;
+
+namespace jet::core
+{
+
+SourceLoader::SourceLoader(usize num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = std::max(usize(std::thread::hardware_concurrency()), usize(1));
+  }
+
+  workers.reserve(num_threads);
+  for (auto t = usize(0); t < num_threads; ++t) {
+    workers.emplace_back([this](std::stop_token stop) { work(stop); });
+  }
+}
+
+auto SourceLoader::load(Span<Path const> paths) -> usize
+{
+  auto const first = num_queued;
+  {
+    auto lock = std::scoped_lock(mutex);
+    for (auto& path : paths) {
+      requests.push_back(LoadedSource{num_queued++, path});
+    }
+  }
+  queued.notify_all();
+  return first;
+}
+
+auto SourceLoader::next() -> Opt<LoadedSource>
+{
+  if (num_taken == num_queued) {
+    return std::nullopt;
+  }
+
+  auto lock = std::unique_lock(mutex);
+  loaded.wait(lock, [&] { return !completed.empty(); });
+
+  auto source = std::move(completed.front());
+  completed.pop_front();
+  ++num_taken;
+  return source;
+}
+
+auto SourceLoader::work(std::stop_token const& stop) -> void
+{
+  while (true) {
+    auto source = LoadedSource();
+    {
+      auto lock = std::unique_lock(mutex);
+      if (!queued.wait(lock, stop, [&] { return !requests.empty(); })) {
+        return;
+      }
+      source = std::move(requests.front());
+      requests.pop_front();
+    }
+
+    source.file = MappedFile::open(source.path);
+    if (source.file) {
+      source.file->prefault();
+    }
+
+    {
+      auto lock = std::scoped_lock(mutex);
+      completed.push_back(std::move(source));
+    }
+    loaded.notify_one();
+  }
+}
+
+} // namespace jet::core
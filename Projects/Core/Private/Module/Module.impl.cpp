@@ -1,7 +1,13 @@
 module;
 
+#include <algorithm>
 #include <filesystem>
 #include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 module Jet.Core.Module;
 
@@ -25,4 +31,138 @@ auto find_module(Path module_path) -> Opt<Path>
   return find_module(module_path);
 }
 
-}
\ No newline at end of file
+ModuleResolver::ModuleResolver(Span<Path const> roots)
+  : base(std::filesystem::current_path())
+{
+  for (auto& root : roots) {
+    auto key = key_of(root);
+    if (std::find(root_keys.begin(), root_keys.end(), key) != root_keys.end()) {
+      continue;
+    }
+
+    auto error = std::error_code();
+    if (!std::filesystem::is_directory(root, error)) {
+      continue;
+    }
+
+    indexed.insert(key);
+    root_keys.push_back(key);
+    index_directory(Path(key));
+  }
+}
+
+auto ModuleResolver::find(Path const& module_path) const -> Opt<Path>
+{
+  auto key = key_of(module_path);
+  if (!is_within_roots(key)) {
+    return find_module(module_path);
+  }
+
+  if (indexed.contains(key)) {
+    return module_path;
+  }
+
+  // Forbid replacement of extension
+  if (module_path.has_extension()) {
+    return std::nullopt;
+  }
+
+  if (indexed.contains(key + ".jet")) {
+    return Path(module_path).replace_extension(".jet");
+  }
+  return std::nullopt;
+}
+
+auto ModuleResolver::refresh() -> usize
+{
+  namespace fs = std::filesystem;
+
+  auto modified = DynArray<String>();
+  for (auto& [key, directory] : directories) {
+    auto error           = std::error_code();
+    auto last_write_time = fs::last_write_time(directory.path, error);
+    if (error || last_write_time != directory.last_write_time) {
+      modified.push_back(key);
+    }
+  }
+
+  for (auto& key : modified) {
+    auto it = directories.find(key);
+    if (it == directories.end()) {
+      // Already listed again with its parent.
+      continue;
+    }
+
+    auto path = it->second.path;
+    forget_directory(key);
+
+    auto error = std::error_code();
+    if (fs::is_directory(path, error)) {
+      index_directory(path);
+    }
+  }
+  return modified.size();
+}
+
+auto ModuleResolver::index_directory(Path const& path) -> void
+{
+  namespace fs = std::filesystem;
+
+  auto error     = std::error_code();
+  auto directory = Directory{path, fs::last_write_time(path, error)};
+
+  // The type of an entry comes from the listing itself, so the subdirectories cost no extra queries.
+  auto subdirectories = DynArray<Path>();
+  for (auto it = fs::directory_iterator(path, error); !error && it != fs::directory_iterator(); it.increment(error)) {
+    auto key = key_of(it->path());
+    indexed.insert(key);
+    directory.entries.push_back(std::move(key));
+
+    auto entry_error = std::error_code();
+    if (it->is_directory(entry_error)) {
+      subdirectories.push_back(it->path());
+    }
+  }
+
+  directories.insert_or_assign(key_of(path), std::move(directory));
+  for (auto& subdirectory : subdirectories) {
+    index_directory(subdirectory);
+  }
+}
+
+auto ModuleResolver::forget_directory(String const& key) -> void
+{
+  auto it = directories.find(key);
+  if (it == directories.end()) {
+    return;
+  }
+
+  auto entries = std::move(it->second.entries);
+  directories.erase(it);
+
+  for (auto& entry : entries) {
+    indexed.erase(entry);
+    forget_directory(entry);
+  }
+}
+
+auto ModuleResolver::key_of(Path const& path) const -> String
+{
+  auto key = (path.is_absolute() ? path : base / path).lexically_normal().generic_string();
+  if (key.size() > 1 && key.back() == '/') {
+    key.pop_back();
+  }
+  return key;
+}
+
+auto ModuleResolver::is_within_roots(StringView key) const -> bool
+{
+  return std::any_of(root_keys.begin(), root_keys.end(), [&](String const& root) {
+    if (!key.starts_with(root)) {
+      return false;
+    }
+    return key.size() == root.size() || root.back() == '/' || key[root.size()] == '/';
+  });
+}
+
+}
@@ -0,0 +1,398 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <Jet/Comp/Foundation/Windows.hpp>
+
+#ifndef WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+module Jet.Core.Process;
+
+namespace jet::core
+{
+
+/// Held while the pipes of a child are created and the child is spawned.
+/// Otherwise a child spawned by another thread in the meantime could inherit the pipes of this one,
+/// and their readers would not see the end of the output until that other child exits.
+static auto spawn_mutex = std::mutex();
+
+#ifdef WIN32
+
+/// @returns The UTF-16 form of the UTF-8 text.
+static auto widen(StringView text) -> std::wstring
+{
+  if (text.empty()) {
+    return {};
+  }
+
+  auto const size   = MultiByteToWideChar(CP_UTF8, 0, text.data(), int(text.size()), nullptr, 0);
+  auto       result = std::wstring(usize(size), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, text.data(), int(text.size()), result.data(), size);
+  return result;
+}
+
+/// Appends the argument to the command line, quoted the way the C runtime splits it again.
+static auto append_argument(std::wstring& command_line, StringView argument) -> void
+{
+  auto const arg = widen(argument);
+  if (!command_line.empty()) {
+    command_line += L' ';
+  }
+  if (!arg.empty() && arg.find_first_of(L" \t\n\v\"") == std::wstring::npos) {
+    command_line += arg;
+    return;
+  }
+
+  command_line += L'"';
+  auto num_backslashes = usize(0);
+  for (auto c : arg) {
+    if (c == L'\\') {
+      ++num_backslashes;
+      continue;
+    }
+    // Backslashes are only special in front of a quote.
+    command_line.append(c == L'"' ? num_backslashes * 2 + 1 : num_backslashes, L'\\');
+    command_line += c;
+    num_backslashes = 0;
+  }
+  command_line.append(num_backslashes * 2, L'\\');
+  command_line += L'"';
+}
+
+/// @returns The details of the last error of the calling thread.
+static auto last_error_details(StringView what) -> ProcessError
+{
+  return ProcessError{String(what) + ": " + std::system_category().message(int(GetLastError()))};
+}
+
+/// Reads the pipe until it is closed.
+static auto read_all(HANDLE pipe, String& into) -> void
+{
+  char  chunk[4096];
+  DWORD num_read = 0;
+  while (ReadFile(pipe, chunk, sizeof(chunk), &num_read, nullptr) && num_read > 0) {
+    into.append(chunk, num_read);
+  }
+}
+
+auto run_process(Command const& command) -> ProcessResult
+{
+  auto command_line = std::wstring();
+  append_argument(command_line, command.program);
+  for (auto& arg : command.args) {
+    append_argument(command_line, arg);
+  }
+
+  auto inherited = SECURITY_ATTRIBUTES{sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+  auto out_read = HANDLE(), out_write = HANDLE(), err_read = HANDLE(), err_write = HANDLE();
+  auto process = PROCESS_INFORMATION();
+  {
+    auto lock = std::scoped_lock(spawn_mutex);
+    if (!CreatePipe(&out_read, &out_write, &inherited, 0)) {
+      return error(last_error_details("cannot create a pipe"));
+    }
+    if (!CreatePipe(&err_read, &err_write, &inherited, 0)) {
+      auto details = last_error_details("cannot create a pipe");
+      CloseHandle(out_read);
+      CloseHandle(out_write);
+      return error(std::move(details));
+    }
+    SetHandleInformation(out_read, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(err_read, HANDLE_FLAG_INHERIT, 0);
+
+    auto input = CreateFileW(L"NUL", GENERIC_READ, FILE_SHARE_READ, &inherited, OPEN_EXISTING, 0, nullptr);
+
+    auto startup       = STARTUPINFOW();
+    startup.cb         = sizeof(startup);
+    startup.dwFlags    = STARTF_USESTDHANDLES;
+    startup.hStdInput  = input;
+    startup.hStdOutput = out_write;
+    startup.hStdError  = err_write;
+
+    auto const created = CreateProcessW(
+      nullptr, command_line.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &startup, &process
+    );
+    auto details = created ? ProcessError() : last_error_details("cannot start " + command.program);
+
+    // Only the child writes to the pipes, so the reads end once it exits.
+    CloseHandle(out_write);
+    CloseHandle(err_write);
+    if (input != INVALID_HANDLE_VALUE) {
+      CloseHandle(input);
+    }
+    if (!created) {
+      CloseHandle(out_read);
+      CloseHandle(err_read);
+      return error(std::move(details));
+    }
+  }
+  CloseHandle(process.hThread);
+
+  auto output = ProcessOutput();
+  {
+    // Both pipes are read at once, so that the child never blocks on a full one.
+    auto out_reader = std::jthread([&] { read_all(out_read, output.out); });
+    auto err_reader = std::jthread([&] { read_all(err_read, output.err); });
+
+    auto const timeout = command.timeout.count() > 0 ? DWORD(command.timeout.count()) : INFINITE;
+    if (WaitForSingleObject(process.hProcess, timeout) == WAIT_TIMEOUT) {
+      TerminateProcess(process.hProcess, 1);
+      WaitForSingleObject(process.hProcess, INFINITE);
+      output.timed_out = true;
+    }
+  }
+  CloseHandle(out_read);
+  CloseHandle(err_read);
+
+  auto exit_code = DWORD(0);
+  GetExitCodeProcess(process.hProcess, &exit_code);
+  CloseHandle(process.hProcess);
+
+  output.exit_code = int(exit_code);
+  return success(std::move(output));
+}
+
+#else
+
+using Clock = std::chrono::steady_clock;
+
+/// The time at which the child is killed (none - no limit).
+using Deadline = Opt<Clock::time_point>;
+
+/// Creates a pipe that is closed in the children (besides the copies that the child is given explicitly).
+/// @note Call with @c spawn_mutex held (only needed where the pipe cannot be created with `O_CLOEXEC` at once).
+static auto make_pipe(int (&fds)[2]) -> bool
+{
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+  return pipe2(fds, O_CLOEXEC) == 0;
+#else
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+  return true;
+#endif
+}
+
+/// @returns The details of the error code.
+static auto error_details(StringView what, int code) -> ProcessError
+{
+  return ProcessError{String(what) + ": " + std::generic_category().message(code)};
+}
+
+/// Starts the child with the pipes as its standard output and error, and an empty standard input.
+/// @returns The process id or the error.
+static auto spawn(Command const& command, int out_fd, int err_fd) -> Result<pid_t, ProcessError>
+{
+  auto argv = DynArray<char*>();
+  argv.reserve(command.args.size() + 2);
+  argv.push_back(const_cast<char*>(command.program.c_str()));
+  for (auto& arg : command.args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  auto actions = posix_spawn_file_actions_t();
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, err_fd, STDERR_FILENO);
+
+  auto       pid  = pid_t();
+  auto const code = posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+
+  if (code != 0) {
+    return error(error_details("cannot start " + command.program, code));
+  }
+  return success(pid);
+}
+
+/// Reads the standard output and error of the child until both are closed or the deadline passes.
+/// @returns @c false if the deadline passed.
+static auto read_output(int out_fd, int err_fd, Deadline deadline, ProcessOutput& output) -> bool
+{
+  pollfd fds[2]   = {{out_fd, POLLIN, 0}, {err_fd, POLLIN, 0}};
+  String* into[2] = {&output.out, &output.err};
+  auto num_open   = 2;
+
+  char chunk[4096];
+  while (num_open > 0) {
+    auto wait_ms = -1;
+    if (deadline) {
+      auto const remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now());
+      if (remaining.count() <= 0) {
+        return false;
+      }
+      wait_ms = int(remaining.count());
+    }
+
+    if (poll(fds, 2, wait_ms) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return true;
+    }
+
+    for (auto i = 0; i < 2; ++i) {
+      if (fds[i].fd < 0 || fds[i].revents == 0) {
+        continue;
+      }
+
+      auto const num_read = read(fds[i].fd, chunk, sizeof(chunk));
+      if (num_read > 0) {
+        into[i]->append(chunk, usize(num_read));
+      }
+      else if (num_read == 0 || errno != EINTR) {
+        // Negative descriptors are skipped by `poll`.
+        fds[i].fd = -1;
+        --num_open;
+      }
+    }
+  }
+  return true;
+}
+
+/// Waits until the child exits or the deadline passes.
+/// A child can close its standard output and error and still run, so the deadline applies after the reads too.
+/// @returns @c false if the deadline passed.
+static auto wait_for_exit(pid_t pid, Deadline deadline, int& status) -> bool
+{
+  if (!deadline) {
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return true;
+  }
+
+  // There is no portable way to wait for a child with a timeout, so it is polled, less often the longer it runs.
+  auto interval = std::chrono::milliseconds(1);
+  while (true) {
+    auto const waited = waitpid(pid, &status, WNOHANG);
+    if (waited == pid || (waited < 0 && errno != EINTR)) {
+      return true;
+    }
+
+    auto const now = Clock::now();
+    if (now >= *deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::min<Clock::duration>(interval, *deadline - now));
+    interval = std::min(interval * 2, std::chrono::milliseconds(50));
+  }
+}
+
+auto run_process(Command const& command) -> ProcessResult
+{
+  auto const deadline = command.timeout.count() > 0 ? Deadline(Clock::now() + command.timeout) : Deadline();
+
+  int  out[2] = {-1, -1};
+  int  err[2] = {-1, -1};
+  auto pid    = pid_t();
+  {
+    auto lock = std::scoped_lock(spawn_mutex);
+    if (!make_pipe(out)) {
+      return error(error_details("cannot create a pipe", errno));
+    }
+    if (!make_pipe(err)) {
+      auto details = error_details("cannot create a pipe", errno);
+      close(out[0]);
+      close(out[1]);
+      return error(std::move(details));
+    }
+
+    auto spawned = spawn(command, out[1], err[1]);
+
+    // Only the child writes to the pipes, so the reads end once it exits.
+    close(out[1]);
+    close(err[1]);
+    if (auto details = spawned.err()) {
+      close(out[0]);
+      close(err[0]);
+      return error(std::move(*details));
+    }
+    pid = spawned.get_unchecked();
+  }
+
+  auto output = ProcessOutput();
+  auto status = 0;
+  if (!read_output(out[0], err[0], deadline, output) || !wait_for_exit(pid, deadline, status)) {
+    kill(pid, SIGKILL);
+    output.timed_out = true;
+    (void)wait_for_exit(pid, Deadline(), status);
+  }
+  close(out[0]);
+  close(err[0]);
+
+  if (WIFEXITED(status)) {
+    output.exit_code = WEXITSTATUS(status);
+  }
+  else if (WIFSIGNALED(status)) {
+    output.exit_code = 128 + WTERMSIG(status);
+  }
+  return success(std::move(output));
+}
+
+#endif
+
+JobQueue::JobQueue(usize num_jobs)
+{
+  if (num_jobs == 0) {
+    num_jobs = std::max(usize(std::thread::hardware_concurrency()), usize(1));
+  }
+  max_jobs = num_jobs;
+}
+
+auto JobQueue::push(Command command) -> usize
+{
+  commands.push_back(std::move(command));
+  return commands.size() - 1;
+}
+
+auto JobQueue::run() -> DynArray<ProcessResult>
+{
+  auto results = DynArray<Opt<ProcessResult>>(commands.size());
+  {
+    // Every worker waits for a single process at a time, so at most `max_jobs` of them run at once.
+    auto const num_workers = std::min(max_jobs, commands.size());
+    auto       next        = std::atomic<usize>(0);
+    auto       workers     = DynArray<std::jthread>();
+    workers.reserve(num_workers);
+    for (auto w = usize(0); w < num_workers; ++w) {
+      workers.emplace_back([&] {
+        for (auto i = next.fetch_add(1); i < commands.size(); i = next.fetch_add(1)) {
+          results[i].emplace(run_process(commands[i]));
+        }
+      });
+    }
+  }
+
+  auto ordered = DynArray<ProcessResult>();
+  ordered.reserve(results.size());
+  for (auto& result : results) {
+    ordered.push_back(std::move(*result));
+  }
+  commands.clear();
+  return ordered;
+}
+
+} // namespace jet::core
@@ -0,0 +1,115 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+module Jet.Core.Task;
+
+namespace jet::core
+{
+
+/// The pool and the index of the worker that runs on this thread (if any).
+static thread_local TaskPool const* current_pool   = nullptr;
+static thread_local usize           current_worker = 0;
+
+TaskPool::TaskPool(usize num_threads)
+{
+  if (num_threads == 0) {
+    num_threads = std::max(usize(std::thread::hardware_concurrency()), usize(1));
+  }
+
+  queues.reserve(num_threads);
+  for (auto t = usize(0); t < num_threads; ++t) {
+    queues.push_back(std::make_unique<Queue>());
+  }
+
+  workers.reserve(num_threads);
+  for (auto t = usize(0); t < num_threads; ++t) {
+    workers.emplace_back([this, t](std::stop_token stop) { work(t, stop); });
+  }
+}
+
+auto TaskPool::submit(Task task) -> void
+{
+  auto const index = current_pool == this ? current_worker : next_queue++ % queues.size();
+
+  // Counted before it is queued, so that a worker that takes it right away never sees a count below zero.
+  ++num_pending;
+  ++num_queued;
+  {
+    auto& queue = *queues[index];
+    auto  lock  = std::scoped_lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+
+  // Taking the lock orders the wake-up after the check of a worker that is about to sleep.
+  {
+    auto lock = std::scoped_lock(sleep_mutex);
+  }
+  queued.notify_one();
+}
+
+auto TaskPool::wait() -> void
+{
+  auto lock = std::unique_lock(sleep_mutex);
+  finished.wait(lock, [&] { return num_pending == 0; });
+}
+
+auto TaskPool::work(usize index, std::stop_token const& stop) -> void
+{
+  current_pool   = this;
+  current_worker = index;
+
+  while (true) {
+    if (auto task = this->take(index)) {
+      (*task)();
+      if (--num_pending == 0) {
+        auto lock = std::scoped_lock(sleep_mutex);
+        finished.notify_all();
+      }
+      continue;
+    }
+
+    auto lock = std::unique_lock(sleep_mutex);
+    if (!queued.wait(lock, stop, [&] { return num_queued != 0; })) {
+      return;
+    }
+  }
+}
+
+auto TaskPool::take(usize index) -> Opt<Task>
+{
+  for (auto i = usize(0); i < queues.size(); ++i) {
+    auto& queue = *queues[(index + i) % queues.size()];
+    auto  lock  = std::scoped_lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+
+    // The own queue is used as a stack, the others are robbed of their oldest tasks.
+    auto task = Task();
+    if (i == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    --num_queued;
+    return task;
+  }
+  return std::nullopt;
+}
+
+} // namespace jet::core
@@ -1,3 +1,15 @@
+module;
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
 export module Jet.Core.File;
 
 export import Jet.Comp.Foundation;
@@ -6,8 +18,184 @@ using namespace jet::comp::foundation;
 export namespace jet::core
 {
 
+/// The read-only content of a file, mapped into memory.
+/// Regular files are mapped straight from the page cache, so the content is never copied.
+/// Other files (e.g. pipes) and the files that cannot be mapped are read into a buffer instead.
+/// The content stays valid as long as the object lives.
+class MappedFile
+{
+public:
+  /// Opens and maps the file.
+  /// @returns The mapped file or @c std::nullopt if the file cannot be opened.
+  [[nodiscard]]
+  static auto open(Path const& file_path) -> Opt<MappedFile>;
+
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(MappedFile&& other) noexcept;
+  auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+  MappedFile(MappedFile const&)                    = delete;
+  auto operator=(MappedFile const&) -> MappedFile& = delete;
+
+  /// @returns The content of the file.
+  [[nodiscard]]
+  auto content() const -> StringView
+  {
+    return mapping ? StringView(mapping, mapping_size) : StringView(buffer);
+  }
+
+  /// @returns @c true if the content is mapped (not read into a buffer).
+  [[nodiscard]]
+  auto is_mapped() const -> bool
+  {
+    return mapping != nullptr;
+  }
+
+  /// Reads every page of the mapping, so that the later reads of the content do not wait for the disk.
+  auto prefault() const -> void;
+
+private:
+  /// Unmaps the content.
+  auto unmap() -> void;
+
+  char const* mapping      = nullptr;
+  usize       mapping_size = 0;
+
+  /// The content of a file that was not mapped.
+  String buffer;
+};
+
+/// A file loaded by @c SourceLoader.
+struct LoadedSource
+{
+  /// The position of the file among every file queued in the loader.
+  usize index = 0;
+
+  Path path;
+
+  /// The content or @c std::nullopt if the file cannot be opened.
+  Opt<MappedFile> file;
+};
+
+/// Loads batches of source files on worker threads and hands them back in completion order,
+/// so that the loaded files can be parsed while the rest of them are still read.
+/// Mapped files are prefaulted by the workers, so reading their content does not wait for the disk.
+/// @note Queue and take the files from a single thread.
+class SourceLoader
+{
+public:
+  /// Starts the workers.
+  /// @param num_threads Number of workers (0 - one per hardware thread).
+  explicit SourceLoader(usize num_threads = 0);
+
+  SourceLoader(SourceLoader const&)                    = delete;
+  auto operator=(SourceLoader const&) -> SourceLoader& = delete;
+
+  /// Queues the files (e.g. the paths returned by @c find_module()).
+  /// @returns The index of the first of them.
+  auto load(Span<Path const> paths) -> usize;
+
+  /// Waits until another file is loaded.
+  /// @returns The file or @c std::nullopt if every queued file was already taken.
+  [[nodiscard]]
+  auto next() -> Opt<LoadedSource>;
+
+private:
+  auto work(std::stop_token const& stop) -> void;
+
+  std::mutex                  mutex;
+  std::condition_variable_any queued;
+  std::condition_variable     loaded;
+
+  std::deque<LoadedSource> requests;
+  std::deque<LoadedSource> completed;
+
+  usize num_queued = 0;
+  usize num_taken  = 0;
+
+  /// Declared last, so the workers are stopped and joined before the queues are destroyed.
+  DynArray<std::jthread> workers;
+};
+
+/// Writes a file through a fixed-size buffer that is written to the disk whenever it fills,
+/// so large outputs never have to be held in memory at once.
+/// Format straight into the buffer with `fmt::format_to(writer.out(), ...)`, then call @c commit().
+/// The buffer is reused for the whole file.
+class FileWriter
+{
+public:
+  static constexpr auto DEFAULT_BUFFER_SIZE = usize(64 * 1024);
+
+  /// Creates (or truncates) the file.
+  /// @returns The writer or @c std::nullopt if the file cannot be created.
+  [[nodiscard]]
+  static auto create(Path const& file_path, usize buffer_size = DEFAULT_BUFFER_SIZE) -> Opt<FileWriter>;
+
+  FileWriter() = default;
+
+  /// Writes the rest of the buffer and closes the file.
+  ~FileWriter();
+
+  FileWriter(FileWriter&& other) noexcept;
+  auto operator=(FileWriter&& other) noexcept -> FileWriter&;
+
+  FileWriter(FileWriter const&)                    = delete;
+  auto operator=(FileWriter const&) -> FileWriter& = delete;
+
+  /// Appends the text to the buffer. Writes the buffer to the disk if it is full.
+  /// Texts larger than the buffer are written to the disk directly.
+  auto write(StringView text) -> void;
+
+  /// @returns The iterator that appends to the buffer (e.g. for `fmt::format_to`).
+  /// @note Call @c commit() after appending.
+  [[nodiscard]]
+  auto out() -> std::back_insert_iterator<String>
+  {
+    return std::back_inserter(buffer);
+  }
+
+  /// Writes the buffer to the disk if it is full.
+  auto commit() -> void
+  {
+    if (buffer.size() >= buffer_size) {
+      this->flush();
+    }
+  }
+
+  /// Writes the buffer to the disk.
+  /// @returns @c false if any write to the file failed.
+  auto flush() -> bool;
+
+  /// Writes the buffer to the disk and closes the file.
+  /// @returns @c false if any write to the file failed.
+  auto close() -> bool;
+
+  /// @returns The number of bytes written to the disk so far.
+  [[nodiscard]]
+  auto num_bytes_written() const -> usize
+  {
+    return bytes_written;
+  }
+
+private:
+  /// Writes the text to the disk, bypassing the buffer.
+  auto write_to_file(StringView text) -> void;
+
+  std::FILE* file = nullptr;
+
+  String buffer;
+  usize  buffer_size   = DEFAULT_BUFFER_SIZE;
+  usize  bytes_written = 0;
+  bool   failed        = false;
+};
+
+/// Reads the whole file into a string.
+/// @note Prefer @c MappedFile::open() for sources that only have to be read.
 auto read_file(Path const& file_path) -> Opt<String>;
 
+/// Writes the content to the file, replacing the previous content.
 auto overwrite_file(Path const& file_path, StringView content) -> void;
 
 }
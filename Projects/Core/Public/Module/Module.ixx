@@ -1,3 +1,11 @@
+module;
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 export module Jet.Core.Module;
 
 export import Jet.Comp.Foundation;
@@ -6,6 +14,73 @@ using namespace jet::comp::foundation;
 export namespace jet::core
 {
 
+/// Finds the module file at the given path, trying the `.jet` extension if the path has none.
+/// @note Queries the filesystem on every call. Use @c ModuleResolver to resolve many modules.
 auto find_module(Path module_path) -> Opt<Path>;
 
-}
\ No newline at end of file
+/// Resolves module paths like @c find_module(), from an index of the source roots built once,
+/// instead of querying the filesystem on every lookup.
+/// The index is updated by @c refresh(), which lists again only the directories modified since they were indexed.
+class ModuleResolver
+{
+public:
+  /// Indexes everything under the roots (recursively).
+  /// Relative roots (and module paths) are relative to the current directory at the time of the construction.
+  explicit ModuleResolver(Span<Path const> roots);
+
+  /// Finds the module file at the given path, trying the `.jet` extension if the path has none.
+  /// Paths within the roots are resolved from the index (without touching the filesystem),
+  /// others with @c find_module().
+  [[nodiscard]]
+  auto find(Path const& module_path) const -> Opt<Path>;
+
+  /// Lists again the directories whose modification time changed since they were indexed
+  /// (a file was added, removed or renamed in them).
+  /// @returns The number of modified directories.
+  auto refresh() -> usize;
+
+  /// @returns The number of indexed files and directories.
+  [[nodiscard]]
+  auto num_indexed() const -> usize
+  {
+    return indexed.size();
+  }
+
+private:
+  struct Directory
+  {
+    Path                            path;
+    std::filesystem::file_time_type last_write_time;
+
+    /// The keys of the entries listed in the directory.
+    DynArray<String> entries;
+  };
+
+  /// Lists the directory and its subdirectories into the index.
+  auto index_directory(Path const& path) -> void;
+
+  /// Removes the directory and its subdirectories from the index.
+  auto forget_directory(String const& key) -> void;
+
+  /// @returns The key of the path in the index.
+  [[nodiscard]]
+  auto key_of(Path const& path) const -> String;
+
+  /// @returns @c true if the key belongs to one of the roots.
+  [[nodiscard]]
+  auto is_within_roots(StringView key) const -> bool;
+
+  /// The current directory at the time of the construction.
+  Path base;
+
+  /// The keys of the roots.
+  DynArray<String> root_keys;
+
+  /// The keys of the indexed files and directories.
+  std::unordered_set<String> indexed;
+
+  /// Maps the keys of the indexed directories to their listings.
+  UMap<String, Directory> directories;
+};
+
+}
@@ -0,0 +1,90 @@
+module;
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+export module Jet.Core.Process;
+
+export import Jet.Comp.Foundation;
+using namespace jet::comp::foundation;
+
+export namespace jet::core
+{
+
+/// A program to run with its arguments.
+/// @note The working directory of the child is the one of the compiler, which is never changed,
+///       so pass absolute paths to the files that the program reads or writes.
+struct Command
+{
+  /// The name or the path of the program. A name without a directory is searched for in `PATH`.
+  String program;
+
+  DynArray<String> args;
+
+  /// The process is killed once it runs longer than that (0 - no limit).
+  std::chrono::milliseconds timeout{0};
+};
+
+/// The outcome of a process that was started.
+struct ProcessOutput
+{
+  /// The exit code (128 + the signal number if the process was killed by a signal).
+  int  exit_code = 0;
+  bool timed_out = false;
+
+  /// The captured standard output and error.
+  String out;
+  String err;
+
+  /// @returns @c true if the process ended on its own with the exit code 0.
+  [[nodiscard]]
+  auto succeeded() const -> bool
+  {
+    return !timed_out && exit_code == 0;
+  }
+};
+
+/// Describes why a process could not be started.
+struct ProcessError
+{
+  String details;
+};
+
+using ProcessResult = Result<ProcessOutput, ProcessError>;
+
+/// Runs the command and waits until it ends or times out.
+/// The standard input of the child is empty, its standard output and error are captured.
+[[nodiscard]]
+auto run_process(Command const& command) -> ProcessResult;
+
+/// Runs the queued commands, up to a given number at once (e.g. the compilation of every unit of a program).
+/// @note Queue the commands and run them from a single thread.
+class JobQueue
+{
+public:
+  /// @param num_jobs The maximum number of processes running at once (0 - one per hardware thread).
+  explicit JobQueue(usize num_jobs = 0);
+
+  /// Queues the command.
+  /// @returns The index of its result.
+  auto push(Command command) -> usize;
+
+  /// Runs every queued command and waits until all of them end. The queue is empty afterwards.
+  /// @returns The results in the order of the commands.
+  [[nodiscard]]
+  auto run() -> DynArray<ProcessResult>;
+
+  /// @returns The maximum number of processes running at once.
+  [[nodiscard]]
+  auto num_jobs() const -> usize
+  {
+    return max_jobs;
+  }
+
+private:
+  DynArray<Command> commands;
+  usize             max_jobs = 1;
+};
+
+} // namespace jet::core
@@ -0,0 +1,83 @@
+module;
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+export module Jet.Core.Task;
+
+export import Jet.Comp.Foundation;
+using namespace jet::comp::foundation;
+
+export namespace jet::core
+{
+
+/// Runs tasks on worker threads, each with its own queue.
+/// A task submitted from a worker goes to the queue of that worker (and runs there first, while it is hot in the cache),
+/// the others are spread evenly. Idle workers steal the oldest tasks of the other queues.
+/// Tasks may submit further tasks (e.g. a parsed module submits the parsing of the modules it uses).
+class TaskPool
+{
+public:
+  using Task = std::function<void()>;
+
+  /// Starts the workers.
+  /// @param num_threads Number of workers (0 - one per hardware thread).
+  explicit TaskPool(usize num_threads = 0);
+
+  TaskPool(TaskPool const&)                    = delete;
+  auto operator=(TaskPool const&) -> TaskPool& = delete;
+
+  /// Queues the task. Can be called from any thread, including the workers.
+  auto submit(Task task) -> void;
+
+  /// Waits until every submitted task (and every task that they submitted) is finished.
+  /// @note Do not call from the workers.
+  auto wait() -> void;
+
+  /// @returns The number of workers.
+  [[nodiscard]]
+  auto num_threads() const -> usize
+  {
+    return queues.size();
+  }
+
+private:
+  struct Queue
+  {
+    std::mutex       mutex;
+    std::deque<Task> tasks;
+  };
+
+  auto work(usize index, std::stop_token const& stop) -> void;
+
+  /// Takes the newest task of the queue of the worker or steals the oldest one of another queue.
+  [[nodiscard]]
+  auto take(usize index) -> Opt<Task>;
+
+  DynArray<std::unique_ptr<Queue>> queues;
+
+  /// The number of tasks in the queues.
+  std::atomic<usize> num_queued = 0;
+
+  /// The number of tasks that were submitted but are not finished.
+  std::atomic<usize> num_pending = 0;
+
+  /// The queue that receives the next task submitted from outside of the workers.
+  std::atomic<usize> next_queue = 0;
+
+  std::mutex                  sleep_mutex;
+  std::condition_variable_any queued;
+  std::condition_variable     finished;
+
+  /// Declared last, so the workers are stopped and joined before the queues are destroyed.
+  DynArray<std::jthread> workers;
+};
+
+} // namespace jet::core
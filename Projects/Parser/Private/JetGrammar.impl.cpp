@@ -15,17 +15,29 @@ struct GrammarBuildingCommon
   GrammarBuilder&            builder;
 };
 
-static auto add_base_rules(GrammarBuildingCommon grammar_common) -> void;
-static auto add_literals(GrammarBuildingCommon grammar_common) -> void;
-static auto add_blocks(GrammarBuildingCommon grammar_common) -> void;
-static auto add_keywords(GrammarBuildingCommon grammar_common) -> void;
-static auto add_identifiers(GrammarBuildingCommon grammar_common) -> void;
-static auto add_declarations(GrammarBuildingCommon grammar_common) -> void;
-static auto add_expressions(GrammarBuildingCommon grammar_common) -> void;
-static auto add_control_flow(GrammarBuildingCommon grammar_common) -> void;
-static auto add_module_level_statements(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_base_rules(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_literals(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_blocks(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_keywords(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_identifiers(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_declarations(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_expressions(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_control_flow(GrammarBuildingCommon grammar_common) -> void;
+static constexpr auto add_module_level_statements(GrammarBuildingCommon grammar_common) -> void;
+
+using JetGrammarAndRules = GrammarAndCaptureList<JetGrammarRuleType, usize(JetGrammarRuleType::MAX)>;
+
+/// Builds the grammar and its rules. The only definition of the grammar,
+/// used both at runtime (@c build_grammar()) and at compile time (@c use_grammar()).
+static constexpr auto build_jet_grammar() -> JetGrammarAndRules;
 
 auto build_grammar() -> JetGrammar
+{
+  auto built = build_jet_grammar();
+  return JetGrammar(std::move(built.capture_list), std::move(built.grammar));
+}
+
+static constexpr auto build_jet_grammar() -> JetGrammarAndRules
 {
   using RT = JetGrammarRuleType;
 
@@ -47,11 +59,10 @@ auto build_grammar() -> JetGrammar
 
   auto root = std::get<CustomRuleRef>(r[RT::ModuleLevelStatements]);
 
-  auto finalized = finalize_grammar(root, std::move(b), std::move(r));
-  return JetGrammar(std::move(finalized.capture_list), std::move(finalized.grammar));
+  return finalize_grammar(root, std::move(b), std::move(r));
 }
 
-static auto add_base_rules(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_base_rules(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -85,7 +96,7 @@ static auto add_base_rules(GrammarBuildingCommon grammar_common) -> void
   }
 }
 
-static auto add_literals(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_literals(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -156,7 +167,7 @@ static auto add_literals(GrammarBuildingCommon grammar_common) -> void
   }
 }
 
-static auto add_blocks(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_blocks(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -177,7 +188,7 @@ static auto add_blocks(GrammarBuildingCommon grammar_common) -> void
   }
 }
 
-static auto add_keywords(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_keywords(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -219,7 +230,7 @@ static auto add_keywords(GrammarBuildingCommon grammar_common) -> void
   r[RT::KwContinue] = add_keyword("continue");
 }
 
-static auto add_identifiers(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_identifiers(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -274,7 +285,7 @@ b.begin_rule_and_assign(r[RT::Type], CombinatorRule::Seq, true, "Type");
 }
 }
 
-static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_expressions(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -295,7 +306,7 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
 
   // Prefix operator
   {
-    b.begin_rule_and_assign(r[RT::PrefixOperator], CombinatorRule::Sor, false, "PrefixOperator");
+    b.begin_rule_and_assign(r[RT::PrefixOperator], CombinatorRule::Sor, true, "Prefix operator");
     {
       (void)b.add_text("not");
       (void)b.add_text("&");
@@ -306,51 +317,6 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
     b.end_rule();
   }
 
-  // Infix operator
-  {
-    b.begin_rule_and_assign(r[RT::InfixOperator], CombinatorRule::Sor, false, "InfixOperator");
-    {
-      // !!!NOTE!!!:
-      // The order in this section is very important.
-      // Longer operators must be before shorter ones.
-      // Example: the string "a == b"
-      // If the infix operator `=` will be checked first then it will succeed.
-      // But we want the infix operator `==` to succeed.
-
-      (void)b.add_text(".");
-      (void)b.add_text("::"); // scope-resolution
-
-      // Relational
-      {
-        (void)b.add_text("==");
-        (void)b.add_text("!=");
-        (void)b.add_text("<=");
-        (void)b.add_text(">=");
-        (void)b.add_text("<");
-        (void)b.add_text(">");
-      }
-
-      // Math
-      {
-        (void)b.add_text("+=");
-        (void)b.add_text("-=");
-        (void)b.add_text("*=");
-        (void)b.add_text("/=");
-        (void)b.add_text("%=");
-
-        // assignment
-        (void)b.add_text("=");
-
-        (void)b.add_text("+");
-        (void)b.add_text("-");
-        (void)b.add_text("*");
-        (void)b.add_text("/");
-        (void)b.add_text("%");
-      }
-    }
-    b.end_rule();
-  }
-
   // Postfix operators
   {
     auto const comma = b.add_text(",");
@@ -407,7 +373,7 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
 
     // Combined
     {
-      b.begin_rule_and_assign(r[RT::PostfixOperator], CombinatorRule::Sor, false, "PrefixOperator");
+      b.begin_rule_and_assign(r[RT::PostfixOperator], CombinatorRule::Sor, true, "Postfix operator");
       {
         (void)b.add_text("++");
         (void)b.add_text("--");
@@ -421,11 +387,12 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
   // Expression
   {
     //  prefix* ~ primary ~ postfix* ~ (infix ~ prefix* ~ primary ~ postfix*)*
+    // The infix operators are nested by their binding power (see `CombinatorRule::Precedence`).
 
-    b.begin_rule_and_assign(r[RT::Expression], CombinatorRule::Seq, true, "Expression");
+    b.begin_rule_and_assign(r[RT::Expression], CombinatorRule::Precedence, true, "Expression");
     {
       // prefix* ~ primary ~ postfix* sequence
-      auto const primary_seq = b.begin_rule(CombinatorRule::Seq);
+      (void)b.begin_rule(CombinatorRule::Seq);
       {
         // prefix*
         {
@@ -450,20 +417,60 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
         b.end_rule(); // primary_seq
       }
 
-      // (infix ~ prefix* ~ primary ~ postfix*)*
+      // infix
       {
-        (void)b.begin_rule(CombinatorRule::Star);
-
-        // infix
+        struct InfixOperator
         {
-          b.add_rule_ref(r[RT::InfixOperator]);
+          RT            rule;
+          StringView    text;
+          usize         binding_power;
+          Associativity associativity;
+        };
+
+        constexpr auto L = Associativity::Left;
+        constexpr auto R = Associativity::Right;
+
+        // !!!NOTE!!!:
+        // The order in this section is very important.
+        // Longer operators must be before shorter ones.
+        // Example: the string "a == b"
+        // If the infix operator `=` will be checked first then it will succeed.
+        // But we want the infix operator `==` to succeed.
+        constexpr InfixOperator infix_operators[] = {
+          {RT::MemberAccess, ".", 7, L},
+          {RT::ScopeResolution, "::", 7, L},
+
+          // Relational
+          {RT::Equal, "==", 3, L},
+          {RT::NotEqual, "!=", 3, L},
+          {RT::LessEqual, "<=", 4, L},
+          {RT::GreaterEqual, ">=", 4, L},
+          {RT::Less, "<", 4, L},
+          {RT::Greater, ">", 4, L},
+
+          // Math
+          {RT::AddAssign, "+=", 1, R},
+          {RT::SubAssign, "-=", 1, R},
+          {RT::MulAssign, "*=", 1, R},
+          {RT::DivAssign, "/=", 1, R},
+          {RT::ModAssign, "%=", 1, R},
+
+          // assignment
+          {RT::Assign, "=", 1, R},
+
+          {RT::Add, "+", 5, L},
+          {RT::Sub, "-", 5, L},
+          {RT::Mul, "*", 6, L},
+          {RT::Div, "/", 6, L},
+          {RT::Mod, "%", 6, L},
+        };
+
+        for (auto const& op : infix_operators) {
+          r[op.rule] = b.begin_operator(op.binding_power, op.associativity, true, "Binary expression");
+          (void)b.add_text(op.text);
           b.add_rule_ref(r[RT::OptWs]);
+          b.end_rule();
         }
-
-        // primary_seq
-        b.add_rule_ref(primary_seq);
-
-        b.end_rule(); // infix_seq
       }
     }
     b.end_rule();
@@ -505,7 +512,7 @@ static auto add_expressions(GrammarBuildingCommon grammar_common) -> void
   }
 }
 
-static auto add_declarations(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_declarations(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -617,7 +624,7 @@ static auto add_declarations(GrammarBuildingCommon grammar_common) -> void
   }
 }
 
-static auto add_control_flow(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_control_flow(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -742,7 +749,7 @@ static auto add_control_flow(GrammarBuildingCommon grammar_common) -> void
 
 }
 
-static auto add_module_level_statements(GrammarBuildingCommon grammar_common) -> void
+static constexpr auto add_module_level_statements(GrammarBuildingCommon grammar_common) -> void
 {
   using RT     = JetGrammarRuleType;
   auto& [r, b] = grammar_common;
@@ -872,7 +879,7 @@ static auto add_module_level_statements(GrammarBuildingCommon grammar_common) ->
     // std::fs::read_file as other_name
     // std::fs::{use-identifier-seq-list}
     {
-      b.begin_rule_and_assign(r[RT::UseIdentifierSeq], CombinatorRule::Seq);
+      b.begin_rule_and_assign(r[RT::UseIdentifierSeq], CombinatorRule::Seq, true, "Use identifier sequence");
       b.add_rule_ref(scoped_name_seq);
       {
         // Aliased single or partial import
@@ -949,4 +956,15 @@ static auto add_module_level_statements(GrammarBuildingCommon grammar_common) ->
   }
 }
 
-} // namespace jet::parser
\ No newline at end of file
+/// The grammar and its rules, built at compile time.
+static constexpr auto EMBEDDED_GRAMMAR = embed_grammar<build_jet_grammar>();
+
+auto use_grammar() -> JetGrammar const&
+{
+  // Initialization of a function-local static is thread-safe.
+  // No rules are built here, the embedded data is only copied.
+  static auto const grammar = JetGrammar(EMBEDDED_GRAMMAR.capture_list, EMBEDDED_GRAMMAR.to_grammar());
+  return grammar;
+}
+
+} // namespace jet::parser
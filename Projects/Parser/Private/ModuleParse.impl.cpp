@@ -7,21 +7,58 @@ module Jet.Parser.ModuleParse;
 namespace jet::parser
 {
 
+static auto line_index_at(FileLines const& lines, usize byte_index) -> usize;
+static auto column_in_line(FileLines const& lines, usize line_index, usize byte_index) -> usize;
+static auto count_code_points(StringView content, usize begin, usize end) -> usize;
+
 auto FileLines::line_at(usize byte_index) const -> usize
 {
-  auto it = std::upper_bound(line_starts.begin(), line_starts.end(), byte_index);
-  return std::distance(line_starts.begin(), it);
+  if (line_starts.empty()) {
+    return 0;
+  }
+  return line_index_at(*this, byte_index) + 1;
 }
 
 auto FileLines::column_at(usize byte_index) const -> usize
 {
-  auto col = usize(0);
-  auto curr = line_starts[line_at(byte_index)];
-  while (curr != byte_index) {
-    curr = next_utf8_pos(content, curr);
-    ++col;
+  if (line_starts.empty()) {
+    return count_code_points(content, 0, std::min(byte_index, content.size()));
   }
-  return col;
+  return column_in_line(*this, line_index_at(*this, byte_index), byte_index);
+}
+
+auto FileLines::positions_at(Span<usize const> byte_indices) const -> DynArray<FilePosition>
+{
+  auto positions = DynArray<FilePosition>();
+  if (line_starts.empty()) {
+    return positions;
+  }
+  positions.reserve(byte_indices.size());
+
+  // Without the index, the columns are counted from the previous byte of the same line.
+  auto line       = usize(0);
+  auto column     = usize(0);
+  auto column_pos = usize(0);
+  for (auto byte_index : byte_indices) {
+    while (line + 1 < line_starts.size() && line_starts[line + 1] <= byte_index) {
+      ++line;
+    }
+
+    if (!line_checkpoints.empty()) {
+      column = column_in_line(*this, line, byte_index);
+    }
+    else {
+      if (column_pos < line_starts[line]) {
+        column_pos = line_starts[line];
+        column     = 0;
+      }
+      column += count_code_points(content, column_pos, std::min(byte_index, content.size()));
+      column_pos = std::max(column_pos, byte_index);
+    }
+
+    positions.push_back(FilePosition{line + 1, column});
+  }
+  return positions;
 }
 
 auto FileLines::push_line_start(usize byte_index) -> void
@@ -34,4 +71,94 @@ auto FileLines::push_line_start(usize byte_index) -> void
   line_starts.push_back(byte_index);
 }
 
-}
\ No newline at end of file
+auto FileLines::build_index() -> void
+{
+  block_lines.clear();
+  line_checkpoints.clear();
+  checkpoints.clear();
+  if (line_starts.empty()) {
+    return;
+  }
+
+  block_lines.reserve(num_bytes / LINE_BLOCK_SIZE + 1);
+  line_checkpoints.reserve(line_starts.size());
+
+  auto bytes = reinterpret_cast<u8 const*>(content.data());
+  for (auto line = usize(0); line < line_starts.size(); ++line) {
+    auto start = line_starts[line];
+    auto end   = line + 1 < line_starts.size() ? line_starts[line + 1] : num_bytes;
+
+    while (block_lines.size() * LINE_BLOCK_SIZE < end) {
+      block_lines.push_back(u32(line));
+    }
+
+    auto high_bits = u8(0);
+    for (auto i = start; i < end; ++i) {
+      high_bits |= bytes[i];
+    }
+    if (high_bits < 0x80) {
+      line_checkpoints.push_back(ASCII_LINE);
+      continue;
+    }
+
+    // The checkpoints cover every byte of the line, including the end of the last line.
+    line_checkpoints.push_back(u32(checkpoints.size()));
+    auto column = u32(0);
+    for (auto pos = start; pos <= end; pos += CHECKPOINT_STRIDE) {
+      checkpoints.push_back(column);
+      column += u32(count_code_points(content, pos, std::min(pos + CHECKPOINT_STRIDE, end)));
+    }
+  }
+
+  // The blocks at the end of the content belong to the last line.
+  block_lines.resize(num_bytes / LINE_BLOCK_SIZE + 1, u32(line_starts.size() - 1));
+}
+
+/// @returns The index of the line that contains the byte.
+static auto line_index_at(FileLines const& lines, usize byte_index) -> usize
+{
+  auto& line_starts = lines.line_starts;
+  if (lines.block_lines.empty()) {
+    auto it = std::upper_bound(line_starts.begin(), line_starts.end(), byte_index);
+    return usize(std::max(std::distance(line_starts.begin(), it), std::ptrdiff_t(1)) - 1);
+  }
+
+  // At most one step per line that starts in the block.
+  auto line = usize(lines.block_lines[std::min(byte_index, lines.num_bytes) / FileLines::LINE_BLOCK_SIZE]);
+  while (line + 1 < line_starts.size() && line_starts[line + 1] <= byte_index) {
+    ++line;
+  }
+  return line;
+}
+
+/// @returns The column of the byte in the line at the given index.
+static auto column_in_line(FileLines const& lines, usize line_index, usize byte_index) -> usize
+{
+  auto start = lines.line_starts[line_index];
+  byte_index = std::clamp(byte_index, start, std::max(start, lines.content.size()));
+
+  if (line_index >= lines.line_checkpoints.size()) {
+    return count_code_points(lines.content, start, byte_index);
+  }
+
+  auto first_checkpoint = lines.line_checkpoints[line_index];
+  if (first_checkpoint == FileLines::ASCII_LINE) {
+    return byte_index - start;
+  }
+
+  auto checkpoint = (byte_index - start) / FileLines::CHECKPOINT_STRIDE;
+  auto column     = usize(lines.checkpoints[first_checkpoint + checkpoint]);
+  return column + count_code_points(lines.content, start + checkpoint * FileLines::CHECKPOINT_STRIDE, byte_index);
+}
+
+/// @returns The number of code points that start in the range (the bytes that are not continuation bytes).
+static auto count_code_points(StringView content, usize begin, usize end) -> usize
+{
+  auto count = usize(0);
+  for (auto i = begin; i < end; ++i) {
+    count += (u8(content[i]) & 0b1100'0000) != 0b1000'0000 ? 1 : 0;
+  }
+  return count;
+}
+
+}
@@ -1,54 +1,234 @@
 module;
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
 #include <string_view>
+#include <thread>
 
 module Jet.Parser;
 
 import Jet.Parser.JetGrammar;
+import Jet.Parser.TopLevelScan;
 import Jet.Comp.PEG;
 import Jet.Comp.Format;
 
 using namespace jet::comp::peg;
+using jet::comp::log::Log;
 
 namespace jet::parser
 {
 
-static auto traverse_file(ModuleParse& module_parse) -> void;
-static auto dump_module(ModuleParse const& module_parse) -> void;
-static auto dump_analysis(JetGrammar const& grammar, ASTAnalysis const& analysis) -> void;
+static auto analyze_in_parallel(
+  JetGrammar const& grammar, StringView module_content, ParseOptions const& options, ParseStats& stats
+) -> Opt<CompletedASTAnalysis>;
+static auto finish_parse(
+  StringView          module_content,
+  ASTAnalysisResult   analysis_result,
+  JetGrammar const&   grammar,
+  ParseOptions const& options,
+  ParseStats const&   stats = {}
+) -> Result<ModuleParse, FailedParse>;
+static auto traverse_file(ModuleParse& module_parse) -> Opt<UTF8Error>;
+static auto dump_module(Log& log, ModuleParse const& module_parse) -> void;
+static auto dump_analysis(Log& log, JetGrammar const& grammar, ASTAnalysis const& analysis) -> void;
+
+static auto print_tabs(Log& log, usize count) -> void;
+
+/// Average number of AST entries per byte of a Jet module (measured on the test cases),
+/// used to reserve the entries before the analysis.
+static auto constexpr AST_ENTRIES_PER_BYTE = 0.25;
+
+auto parse(StringView module_content, ParseOptions const& options) -> Result<ModuleParse, FailedParse>
+{
+  auto& grammar = use_grammar();
+
+  if (options.num_threads != 1 && !options.profile) {
+    auto stats = ParseStats();
+    if (auto analysis = analyze_in_parallel(grammar, module_content, options, stats)) {
+      return finish_parse(module_content, success(std::move(*analysis)), grammar, options, stats);
+    }
+  }
+
+  auto analysis_options             = AnalysisOptions();
+  analysis_options.workspace        = options.workspace;
+  analysis_options.entries_per_byte = AST_ENTRIES_PER_BYTE;
+  analysis_options.profile          = options.profile;
+
+  auto analysis_result = analyze(grammar.peg, module_content, analysis_options);
+  return finish_parse(module_content, std::move(analysis_result), grammar, options);
+}
 
-static auto print_tabs(usize count) -> void;
+auto reparse(ModuleParse const& previous, StringView module_content, TextEdit const& edit, ParseOptions const& options)
+  -> Result<ModuleParse, FailedParse>
+{
+  using RT = JetGrammarRuleType;
+
+  auto& grammar = use_grammar();
 
-auto parse(StringView module_content) -> Result<ModuleParse, FailedParse>
+  auto const anchors = Array<CustomRuleRef, 2>{
+    grammar.rules[RT::CodeBlock],
+    grammar.rules[RT::DeclFunction],
+  };
+
+  auto analysis_result = reanalyze(grammar.peg, previous.ast, module_content, edit, {anchors});
+  return finish_parse(module_content, std::move(analysis_result), grammar, options);
+}
+
+auto analyze_module_stream(InputReader& reader, StreamOptions const& options) -> ASTAnalysisResult
 {
-  auto grammar = build_grammar();
+  using RT = JetGrammarRuleType;
 
-  auto module_parse    = ModuleParse();
-  module_parse.content = module_content;
-  traverse_file(module_parse);
+  auto& grammar = use_grammar();
 
-  auto analysis_result = analyze(grammar.peg, module_content);
+  // The root rule is `(OptWs SingleModuleLevelStatement)+ OptWs`.
+  auto const rules = StreamRules{
+    .item      = grammar.rules[RT::SingleModuleLevelStatement],
+    .separator = grammar.rules[RT::OptWs],
+    .min_items = 1,
+  };
+  return analyze_stream(grammar.peg, rules, reader, options);
+}
+
+/// Analyzes every top-level item on its own, starting with the `SingleModuleLevelStatement` rule,
+/// and stitches the entries into a single AST under the root entry.
+/// Every item is analyzed within the whole module, so it matches exactly as in the sequential analysis.
+/// @param stats Receives the number of items and threads of a successful analysis.
+/// @returns The analysis or @c std::nullopt if the items could not be found or any of them
+/// did not match its range (the sequential analysis reports the failure then).
+static auto analyze_in_parallel(
+  JetGrammar const& grammar, StringView module_content, ParseOptions const& options, ParseStats& stats
+) -> Opt<CompletedASTAnalysis>
+{
+  using RT = JetGrammarRuleType;
+
+  auto num_threads = options.num_threads;
+
+  auto items = scan_top_level_items(module_content);
+  if (!items || items->size() < 2) {
+    return std::nullopt;
+  }
+
+  if (num_threads == 0) {
+    num_threads = std::max(usize(std::thread::hardware_concurrency()), usize(1));
+  }
+  num_threads = std::min(num_threads, items->size());
+
+  auto item_asts = DynArray<Opt<AST>>(items->size());
+  auto next_item = std::atomic<usize>(0);
+  auto failed    = std::atomic<bool>(false);
+
+  auto const item_rule = grammar.rules[RT::SingleModuleLevelStatement];
+
+  auto analyze_items = [&] {
+    for (auto i = next_item++; i < items->size() && !failed; i = next_item++) {
+      auto& item   = (*items)[i];
+      auto  result = analyze_rule(grammar.peg, item_rule, module_content, item.start);
+      if (!result.is_ok() || result.get_unchecked().ast.current_pos != item.end) {
+        failed = true;
+        return;
+      }
+      item_asts[i] = std::move(result.get_unchecked().ast);
+    }
+  };
+
+  {
+    auto workers = DynArray<std::jthread>();
+    for (auto t = usize(1); t < num_threads; ++t) {
+      workers.emplace_back(analyze_items);
+    }
+    analyze_items();
+  }
+
+  if (failed) {
+    return std::nullopt;
+  }
+
+  auto num_entries = usize(1);
+  for (auto& item_ast : item_asts) {
+    num_entries += item_ast->entries.size();
+  }
+
+  // Only the stitched AST is allocated from the workspace, as it cannot be shared by the workers.
+  auto allocator = options.workspace ? AST::EntryList::allocator_type(options.workspace->arena.resource())
+                                     : AST::EntryList::allocator_type();
+
+  auto ast = AST{AST::EntryList(allocator)};
+  ast.entries.reserve(num_entries);
+  ast.current_pos = module_content.size();
+
+  auto& root                   = ast.entries.emplace_back(AST::Entry{AST::Index(grammar.peg.root_rule.offset)});
+  root.next_id_same_nesting.id = AST::Index(num_entries);
+  root.end_pos                 = AST::Index(module_content.size());
+#ifndef NDEBUG
+  auto root_rule = grammar.peg.rule_registry.view_at(root.rule_offset).as_structure();
+  root.rule_name = root_rule.get_name(grammar.peg.text_registry);
+#endif
+
+  for (auto& item_ast : item_asts) {
+    auto const base = AST::Index(ast.entries.size());
+
+    // Top-level entries of the item become children of the root.
+    for (auto e = usize(0); e < item_ast->entries.size(); e = item_ast->entries[e].next_id_same_nesting.id) {
+      ++ast.entries.front().num_children;
+    }
+
+    for (auto& entry : item_ast->entries) {
+      auto& copied = ast.entries.emplace_back(entry);
+      copied.next_id_same_nesting.id += base;
+    }
+  }
+
+  stats.num_parallel_items = items->size();
+  stats.num_threads        = num_threads;
+  return CompletedASTAnalysis{{module_content, std::move(ast)}};
+}
+
+static auto finish_parse(
+  StringView          module_content,
+  ASTAnalysisResult   analysis_result,
+  JetGrammar const&   grammar,
+  ParseOptions const& options,
+  ParseStats const&   stats
+) -> Result<ModuleParse, FailedParse>
+{
+  using PV = ParseVerbosity;
 
   if (auto failed_analysis = analysis_result.err()) {
-    comp::fmt::println("Failed analysis state:");
-    dump_analysis(grammar, *failed_analysis);
+    if (options.should_dump(PV::AST)) {
+      options.diagnostics->writeln("Failed analysis state:");
+      dump_analysis(*options.diagnostics, grammar, *failed_analysis);
+    }
+
+    auto module_parse = ModuleParse{module_content, std::move(failed_analysis->ast)};
+    traverse_file(module_parse);
 
-    module_parse.ast = std::move(failed_analysis->ast);
     // TODO: provide details about parsing failure
-    return error(FailedParse{module_parse, 0, "AST building failed."});
+    return error(FailedParse{std::move(module_parse), 0, "AST building failed."});
   }
 
   auto& analysis = analysis_result.get_unchecked();
-  dump_analysis(grammar, analysis);
+  if (options.should_dump(PV::AST)) {
+    dump_analysis(*options.diagnostics, grammar, analysis);
+  }
+
+  // The AST is moved (not assigned), so it keeps the memory of the workspace.
+  auto module_parse  = ModuleParse{module_content, std::move(analysis.ast)};
+  module_parse.stats = stats;
+  if (auto invalid = traverse_file(module_parse)) {
+    auto details = comp::fmt::format("invalid UTF-8 sequence at byte {}", invalid->pos);
+    return error(FailedParse{std::move(module_parse), invalid->pos, std::move(details)});
+  }
 
-  module_parse.ast = std::move(analysis.ast);
-  dump_module(module_parse);
+  if (options.should_dump(PV::All)) {
+    dump_module(*options.diagnostics, module_parse);
+  }
 
   return success(std::move(module_parse));
 }
 
-static auto traverse_file(ModuleParse& module_parse) -> void
+/// Validates the content and indexes its lines (in a single pass) and their columns.
+/// @returns The first invalid UTF-8 sequence.
+static auto traverse_file(ModuleParse& module_parse) -> Opt<UTF8Error>
 {
   auto& content = module_parse.content;
   auto& lines   = module_parse.lines;
@@ -56,16 +236,13 @@ static auto traverse_file(ModuleParse& module_parse) -> void
   lines.line_starts.reserve(1000);
   lines.push_line_start(0);
 
-  for (auto entry : utf8_chars(content)) {
-    auto ch = entry.decode().get_unchecked();
-    if (ch == U'\n') {
-      lines.push_line_start(next_utf8_pos(content, entry.pos));
-    }
-  }
+  auto invalid    = index_utf8_lines(content, lines.line_starts);
   lines.num_bytes = content.size();
+  lines.build_index();
+  return invalid;
 }
 
-static auto dump_module(ModuleParse const& module_parse) -> void
+static auto dump_module(Log& log, ModuleParse const& module_parse) -> void
 {
   auto& content = module_parse.content;
   auto& lines   = module_parse.lines;
@@ -89,47 +266,46 @@ static auto dump_module(ModuleParse const& module_parse) -> void
       }
     }
 
-    std::cout << i << ": " << line_content << '\n';
+    log.writeln("{}: {}", i, line_content);
   }
 }
 
-static auto print_tabs(usize count) -> void
+static auto print_tabs(Log& log, usize count) -> void
 {
-  namespace fmt = comp::fmt;
   for (usize i = 0; i < count; ++i) {
-    fmt::print("  ");
+    log.write("  ");
   }
 }
 
-static auto dump_parse_entry(JetGrammar const& grammar, ASTAnalysis const& analysis, AST::EntryID entry_id, usize tabs = 0)
-  -> void
+static auto dump_parse_entry(
+  Log& log, JetGrammar const& grammar, ASTAnalysis const& analysis, AST::EntryID entry_id, usize tabs = 0
+) -> void
 {
-  using RT      = JetGrammarRuleType;
-  namespace fmt = comp::fmt;
-  auto& entry   = analysis.ast.get_entry(entry_id);
+  using RT    = JetGrammarRuleType;
+  auto& entry = analysis.ast.get_entry(entry_id);
 
-  print_tabs(tabs);
-  fmt::println("Rule: {}", entry.rule_id.offset);
-  print_tabs(tabs);
-  fmt::println(" - range: [{}, {})", entry.start_pos, entry.end_pos);
+  print_tabs(log, tabs);
+  log.writeln("Rule: {}", entry.rule_offset);
+  print_tabs(log, tabs);
+  log.writeln(" - range: [{}, {})", entry.start_pos, entry.end_pos);
 
-  auto is_rule = [&](RT rt) -> bool { return entry.rule_id == grammar.rules[rt]; };
+  auto is_rule = [&](RT rt) -> bool { return entry.rule_id() == grammar.rules[rt]; };
 
   if (is_rule(RT::Name) || is_rule(RT::Expression)) {
-    print_tabs(tabs);
-    fmt::println(" - content: \"{}\"", analysis.document.substr(entry.start_pos, entry.end_pos - entry.start_pos));
+    print_tabs(log, tabs);
+    log.writeln(" - content: \"{}\"", analysis.document.substr(entry.start_pos, entry.end_pos - entry.start_pos));
   }
 
   if (entry.num_children == 0) {
     return;
   }
 
-  print_tabs(tabs);
-  fmt::println(" - children ({}): ", entry.num_children);
+  print_tabs(log, tabs);
+  log.writeln(" - children ({}): ", entry.num_children);
 
   auto current_entry_id = AST::EntryID(entry_id.id + 1);
   for (auto i = usize(0); i < entry.num_children; ++i) {
-    dump_parse_entry(grammar, analysis, current_entry_id, tabs + 1);
+    dump_parse_entry(log, grammar, analysis, current_entry_id, tabs + 1);
     auto& child_entry = analysis.ast.get_entry(current_entry_id);
     if (child_entry.num_children == 0) {
       current_entry_id.id += 1;
@@ -140,11 +316,11 @@ static auto dump_parse_entry(JetGrammar const& grammar, ASTAnalysis const& analy
   }
 }
 
-static auto dump_analysis(JetGrammar const& grammar, ASTAnalysis const& analysis) -> void
+static auto dump_analysis(Log& log, JetGrammar const& grammar, ASTAnalysis const& analysis) -> void
 {
   auto& ast = analysis.ast;
   for (auto e = AST::EntryID(0); e.id < ast.entries.size();) {
-    dump_parse_entry(grammar, analysis, e);
+    dump_parse_entry(log, grammar, analysis, e);
     if (ast.get_entry(e).num_children == 0) {
       e.id += 1;
     }
@@ -0,0 +1,120 @@
+module;
+
+#include <optional>
+#include <vector>
+
+module Jet.Parser.TopLevelScan;
+
+namespace jet::parser
+{
+
+static auto is_ident_char(char c) -> bool
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static auto is_whitespace(char c) -> bool
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static auto is_item_keyword(StringView word) -> bool
+{
+  return word == "fn" || word == "use" || word == "mod";
+}
+
+auto scan_top_level_items(StringView content) -> Opt<DynArray<TopLevelItem>>
+{
+  auto items = DynArray<TopLevelItem>();
+  auto depth = usize(0);
+
+  // Position right after the last `}` or `;` at the top level,
+  // or @c std::nullopt if there were other tokens after it.
+  auto item_end = Opt<usize>(0);
+
+  auto pos = usize(0);
+  while (pos < content.size()) {
+    auto c = content[pos];
+
+    if (is_whitespace(c)) {
+      ++pos;
+      continue;
+    }
+
+    if (content.substr(pos).starts_with("//")) {
+      auto eol = content.find('\n', pos);
+      pos      = eol == StringView::npos ? content.size() : eol + 1;
+      continue;
+    }
+
+    if (c == '"') {
+      for (++pos; pos < content.size() && content[pos] != '"'; ++pos) {
+        if (content[pos] == '\n') {
+          return std::nullopt;
+        }
+        if (content[pos] == '\\') {
+          ++pos;
+        }
+      }
+      if (pos >= content.size()) {
+        return std::nullopt;
+      }
+      ++pos;
+      item_end.reset();
+      continue;
+    }
+
+    if (c == '\'') {
+      return std::nullopt;
+    }
+
+    if (is_ident_char(c)) {
+      auto word_start = pos;
+      while (pos < content.size() && is_ident_char(content[pos])) {
+        ++pos;
+      }
+
+      if (depth == 0 && item_end && is_item_keyword(content.substr(word_start, pos - word_start))) {
+        if (!items.empty()) {
+          items.back().end = *item_end;
+        }
+        items.push_back({word_start, 0});
+      }
+      else if (items.empty()) {
+        return std::nullopt;
+      }
+
+      item_end.reset();
+      continue;
+    }
+
+    if (items.empty()) {
+      return std::nullopt;
+    }
+
+    if (c == '{') {
+      ++depth;
+    }
+    else if (c == '}') {
+      if (depth == 0) {
+        return std::nullopt;
+      }
+      --depth;
+    }
+
+    ++pos;
+    item_end.reset();
+    if (depth == 0 && (c == '}' || c == ';')) {
+      item_end = pos;
+    }
+  }
+
+  if (items.empty() || depth != 0 || !item_end) {
+    return std::nullopt;
+  }
+
+  items.back().end = *item_end;
+  return items;
+}
+
+} // namespace jet::parser
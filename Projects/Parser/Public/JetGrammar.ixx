@@ -16,8 +16,15 @@ export namespace jet::parser
 
 struct JetGrammar;
 
+/// Builds the grammar at runtime.
+/// Prefer @c use_grammar(), which uses the grammar built at compile time.
 auto build_grammar() -> JetGrammar;
 
+/// @returns The grammar shared by every parse. It is built at compile time
+/// and embedded in the executable.
+/// @note The grammar is immutable, so it can be used from multiple threads at once.
+auto use_grammar() -> JetGrammar const&;
+
 enum class JetGrammarRuleType
 {
   // Root:
@@ -46,9 +53,29 @@ enum class JetGrammarRuleType
   SubscriptOperator,
 
   PrefixOperator,
-  InfixOperator,
   PostfixOperator,
 
+  // Binary expressions (infix operators nested by `Expression`)
+  MemberAccess,    // "."
+  ScopeResolution, // "::"
+  Equal,           // "=="
+  NotEqual,        // "!="
+  LessEqual,       // "<="
+  GreaterEqual,    // ">="
+  Less,            // "<"
+  Greater,         // ">"
+  AddAssign,       // "+="
+  SubAssign,       // "-="
+  MulAssign,       // "*="
+  DivAssign,       // "/="
+  ModAssign,       // "%="
+  Assign,          // "="
+  Add,             // "+"
+  Sub,             // "-"
+  Mul,             // "*"
+  Div,             // "/"
+  Mod,             // "%"
+
   // Expressions
   ExprAtomic, // an atomic expression fragment
   Expression,
@@ -10,18 +10,69 @@ using namespace jet::comp::peg;
 export namespace jet::parser
 {
 
+/// A line and a column in a file.
+struct FilePosition
+{
+  /// The line number (starting at 1).
+  usize line = 0;
+
+  /// The column in code points (starting at 0).
+  usize column = 0;
+};
+
 struct FileLines {
+  /// Size of the blocks of the content that remember the line they start in.
+  static constexpr usize LINE_BLOCK_SIZE = 64;
+
+  /// Distance in bytes between the column checkpoints of the lines that are not ASCII-only.
+  static constexpr usize CHECKPOINT_STRIDE = 64;
+
+  /// Marks the lines without checkpoints (ASCII-only, the column is the byte offset in the line).
+  static constexpr u32 ASCII_LINE = ~u32(0);
+
   StringView content;
   DynArray<usize> line_starts;
   usize num_bytes = 0;
 
+  /// The line index of the start of every block of the content.
+  DynArray<u32> block_lines;
+
+  /// For every line, the index of its first checkpoint or @c ASCII_LINE.
+  DynArray<u32> line_checkpoints;
+
+  /// The columns of the bytes at every @c CHECKPOINT_STRIDE bytes of the lines that are not ASCII-only.
+  DynArray<u32> checkpoints;
+
+  /// @returns The line number (starting at 1) of the byte.
+  /// @note Constant time once the index is built, logarithmic otherwise.
   [[nodiscard]]
   auto line_at(usize byte_index) const -> usize;
 
+  /// @returns The column (in code points, starting at 0) of the byte.
+  /// @note Constant time once the index is built, linear in the length of the line otherwise.
   [[nodiscard]]
   auto column_at(usize byte_index) const -> usize;
 
+  /// Maps the bytes to their positions in one pass through the lines.
+  /// @param byte_indices Positions of the bytes, sorted in ascending order.
+  [[nodiscard]]
+  auto positions_at(Span<usize const> byte_indices) const -> DynArray<FilePosition>;
+
   auto push_line_start(usize byte_index) -> void;
+
+  /// Builds the index behind the constant time lookups. Must be called after all the line starts are pushed.
+  auto build_index() -> void;
+};
+
+/// Describes how a module was analyzed by @c parse().
+struct ParseStats
+{
+  /// Number of top-level items that were analyzed on their own, in parallel.
+  /// 0 - the module was analyzed as a whole (see @c ParseOptions::num_threads).
+  usize num_parallel_items = 0;
+
+  /// Number of threads that analyzed the items.
+  usize num_threads = 0;
 };
 
 struct ModuleParse
@@ -30,6 +81,8 @@ struct ModuleParse
   AST ast;
 
   FileLines lines;
+
+  ParseStats stats;
 };
 
 } // namespace jet::parser
\ No newline at end of file
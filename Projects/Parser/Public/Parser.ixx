@@ -4,7 +4,9 @@ module;
 
 export module Jet.Parser;
 export import Jet.Parser.ModuleParse;
+export import Jet.Comp.PEG.Stream;
 export import Jet.Comp.Foundation;
+export import Jet.Comp.Log;
 
 using namespace jet::comp::foundation;
 
@@ -19,6 +21,61 @@ struct FailedParse
   String details;
 };
 
-auto parse(StringView module_content) -> Result<ModuleParse, FailedParse>;
+/// Controls how much debugging output is produced by @c parse().
+enum class ParseVerbosity
+{
+  /// No output.
+  Silent,
+
+  /// Dumps the AST (or the state of a failed analysis).
+  AST,
+
+  /// Dumps the AST and every line of the source.
+  All,
+};
+
+struct ParseOptions
+{
+  ParseVerbosity verbosity = ParseVerbosity::Silent;
+
+  /// Receives the debugging output. Nothing is dumped if not set.
+  comp::log::Log* diagnostics = nullptr;
+
+  /// Number of threads that analyze the top-level items of the module.
+  /// 1 - sequential analysis, 0 - one thread per hardware thread.
+  /// The sequential analysis is used whenever the items cannot be found reliably.
+  usize num_threads = 1;
+
+  /// Reuses the memory of the previous parses. The AST of the module is allocated from the workspace,
+  /// so it stays valid only until the workspace is reset. Not set - the AST is allocated from the heap.
+  comp::peg::AnalysisWorkspace* workspace = nullptr;
+
+  /// Collects the counters of the grammar rules (see @c comp::peg::AnalysisOptions::profile).
+  /// A profiled parse is always sequential.
+  comp::peg::RuleProfile* profile = nullptr;
+
+  [[nodiscard]]
+  auto should_dump(ParseVerbosity level) const -> bool
+  {
+    return diagnostics != nullptr && verbosity >= level;
+  }
+};
+
+auto parse(StringView module_content, ParseOptions const& options = {}) -> Result<ModuleParse, FailedParse>;
+
+/// Parses an edited module, reusing the AST of its previous (successful) parse.
+/// Only the innermost code block or function declaration that encloses the edit is parsed again.
+auto reparse(
+  ModuleParse const&         previous,
+  StringView                 module_content,
+  comp::peg::TextEdit const& edit,
+  ParseOptions const&        options = {}
+) -> Result<ModuleParse, FailedParse>;
+
+/// Analyzes a module read in chunks, without holding the whole of it in memory (e.g. a large generated module).
+/// Unlike @c parse(), the result is the bare AST: the text of the top-level items is only available
+/// to @c comp::peg::StreamOptions::handler, while they are in the buffer.
+auto analyze_module_stream(comp::peg::InputReader& reader, comp::peg::StreamOptions const& options = {})
+  -> comp::peg::ASTAnalysisResult;
 
 } // namespace jet::parser
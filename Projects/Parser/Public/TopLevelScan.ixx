@@ -0,0 +1,34 @@
+/// # Top-level scan module
+///
+/// A cheap pre-scan of a module that finds the boundaries of its top-level items
+/// (functions, `use` statements and submodules) without analyzing them.
+module;
+
+#include <vector>
+
+export module Jet.Parser.TopLevelScan;
+
+export import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+export namespace jet::parser
+{
+
+/// Range of a top-level item: `[start, end)`.
+/// The bytes between two items are whitespace or comments.
+struct TopLevelItem
+{
+  usize start = 0;
+  usize end   = 0;
+};
+
+/// Finds the top-level items of the module by matching braces, skipping string literals and comments.
+/// An item starts with the `fn`, `use` or `mod` keyword and ends with a `}` or `;` at the top level.
+/// @returns The items in order or @c std::nullopt if the boundaries are ambiguous
+/// (unbalanced braces, unterminated string literals, unknown content at the top level).
+/// @note The boundaries are only a guess, the analysis of every item has to confirm them.
+[[nodiscard]]
+auto scan_top_level_items(StringView module_content) -> Opt<DynArray<TopLevelItem>>;
+
+} // namespace jet::parser
@@ -0,0 +1,90 @@
+#include "./Common.hpp"
+
+#include <memory_resource>
+#include <vector>
+
+import Jet.Parser;
+import Jet.Comp.PEG;
+import Jet.Core.File;
+import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+/// Fills a vector allocated from the arena with the given number of elements.
+static auto fill_from_arena(Arena& arena, usize num_elements) -> usize
+{
+  auto values = std::pmr::vector<usize>(arena.resource());
+  for (auto i = usize(0); i < num_elements; ++i) {
+    values.push_back(i);
+  }
+  return values.size();
+}
+
+TEST(Arena, reset_keeps_memory)
+{
+  auto arena = Arena(1024);
+  EXPECT_EQ(arena.num_heap_allocations(), 1u);
+
+  // Grows beyond the initial buffer.
+  EXPECT_EQ(fill_from_arena(arena, 10'000), 10'000u);
+  auto const after_growth = arena.num_heap_allocations();
+  EXPECT_GT(after_growth, 1u);
+
+  // The blocks are merged into a single buffer...
+  arena.reset();
+  EXPECT_EQ(arena.num_heap_allocations(), after_growth + 1);
+  EXPECT_GE(arena.capacity(), 10'000 * sizeof(usize));
+
+  // ...so the next cycles of the same size do not allocate.
+  for (auto cycle = 0; cycle < 3; ++cycle) {
+    EXPECT_EQ(fill_from_arena(arena, 10'000), 10'000u);
+    arena.reset();
+  }
+  EXPECT_EQ(arena.num_heap_allocations(), after_growth + 1);
+}
+
+TEST(Arena, empty_arena_grows)
+{
+  auto arena = Arena(0);
+  EXPECT_EQ(arena.num_heap_allocations(), 0u);
+  EXPECT_EQ(fill_from_arena(arena, 100), 100u);
+  EXPECT_GT(arena.num_heap_allocations(), 0u);
+}
+
+TEST(Parse_Workspace, reused_workspace_does_not_allocate_entries)
+{
+  auto module_content = jet::core::read_file(Path("Projects/Test/cases/modules/Submodule-WithFunction-WithGlobalAlias.jet"));
+  ASSERT_TRUE(module_content.has_value());
+
+  auto expected = jet::parser::parse(*module_content);
+  ASSERT_TRUE(expected.is_ok());
+
+  auto workspace = peg::AnalysisWorkspace();
+  auto options   = jet::parser::ParseOptions();
+  options.workspace = &workspace;
+
+  auto arena_allocations = usize(0);
+  for (auto cycle = 0; cycle < 3; ++cycle) {
+    {
+      auto parsed = jet::parser::parse(*module_content, options);
+      ASSERT_TRUE(parsed.is_ok());
+
+      auto& entries = parsed.get_unchecked().ast.entries;
+      EXPECT_EQ(entries.get_allocator().resource(), workspace.arena.resource());
+      ASSERT_EQ(entries.size(), expected.get_unchecked().ast.entries.size());
+      for (auto i = usize(0); i < entries.size(); ++i) {
+        EXPECT_EQ(entries[i].start_pos, expected.get_unchecked().ast.entries[i].start_pos);
+        EXPECT_EQ(entries[i].end_pos, expected.get_unchecked().ast.entries[i].end_pos);
+      }
+    }
+    workspace.reset();
+
+    if (cycle == 0) {
+      arena_allocations = workspace.arena.num_heap_allocations();
+    }
+  }
+
+  // Only the first cycle could allocate.
+  EXPECT_EQ(workspace.arena.num_heap_allocations(), arena_allocations);
+}
@@ -0,0 +1,211 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+import Jet.Compiler.BuildProcess;
+import Jet.Compiler.Compile;
+import Jet.Core.File;
+import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+namespace fs = std::filesystem;
+using jet::compiler::BuildState;
+using jet::compiler::ModuleGraph;
+
+/// @returns The index of the module of the file or the size of the graph if there is none.
+static auto index_of(ModuleGraph const& graph, Path const& file) -> usize
+{
+  for (auto i = usize(0); i < graph.size(); ++i) {
+    if (graph[i].path == file.lexically_normal()) {
+      return i;
+    }
+  }
+  return graph.size();
+}
+
+/// Writes the files of a project to a fresh temporary directory.
+static auto make_project(StringView name, std::initializer_list<std::pair<StringView, StringView>> files) -> Path
+{
+  auto const root = fs::temp_directory_path() / name;
+  fs::remove_all(root);
+  for (auto const& [file, content] : files) {
+    fs::create_directories((root / file).parent_path());
+    jet::core::overwrite_file(root / file, content);
+  }
+  return root;
+}
+
+TEST(ModuleGraph, adds_each_file_once)
+{
+  auto graph = ModuleGraph();
+  EXPECT_EQ(graph.add("project/main.jet"), std::pair(usize(0), true));
+  EXPECT_EQ(graph.add("project/util.jet"), std::pair(usize(1), true));
+  EXPECT_EQ(graph.add("project/./sub/../main.jet"), std::pair(usize(0), false));
+  EXPECT_EQ(graph.add(fs::absolute("project/util.jet")), std::pair(usize(1), false));
+  EXPECT_EQ(graph.size(), 2u);
+  EXPECT_EQ(graph[0].path, Path("project/main.jet"));
+}
+
+TEST(ModuleGraph, sorts_dependencies_first)
+{
+  auto graph = ModuleGraph();
+  for (auto name : {"main.jet", "util.jet", "math.jet", "io.jet"}) {
+    (void)graph.add(name);
+  }
+  graph[0].dependencies = {1, 3};
+  graph[1].dependencies = {2};
+  graph[3].dependencies = {1, 2};
+
+  auto const sorted = graph.sort();
+  ASSERT_TRUE(sorted.is_ok());
+  EXPECT_EQ(sorted.get_unchecked(), (DynArray<usize>{2, 1, 3, 0}));
+  EXPECT_EQ(graph[2].dependents, (DynArray<usize>{1, 3}));
+  EXPECT_EQ(graph[1].dependents, (DynArray<usize>{0, 3}));
+  EXPECT_TRUE(graph[0].dependents.empty());
+}
+
+TEST(ModuleGraph, reports_cycles)
+{
+  auto graph = ModuleGraph();
+  for (auto name : {"main.jet", "util.jet", "math.jet", "io.jet"}) {
+    (void)graph.add(name);
+  }
+  graph[0].dependencies = {1};
+  graph[1].dependencies = {2};
+  graph[2].dependencies = {3};
+  graph[3].dependencies = {1};
+
+  auto const sorted = graph.sort();
+  ASSERT_TRUE(sorted.err());
+  auto cycle = *sorted.err();
+  std::ranges::rotate(cycle, std::ranges::min_element(cycle));
+  EXPECT_EQ(cycle, (DynArray<usize>{1, 2, 3}));
+}
+
+TEST(BuildProcess, discovers_used_modules)
+{
+  auto const root = make_project("jet_test_build_discovery",
+                                 {
+                                   {"main.jet",
+                                    "use util::math::add;\nuse util::*;\n\nfn main {\n  println(\"{}\", 1 + 2);\n}\n"},
+                                   {"util.jet", "use util::math::{add, sub};\n\nfn util_fn(a: i32): i32 {\n  ret a;\n}\n"},
+                                   {"util/math.jet", "fn add(a: i32, b: i32): i32 {\n  ret a + b;\n}\n"},
+                                 });
+
+  // Without a binary to output, the units are emitted but not linked.
+  auto state                      = BuildState();
+  state.settings.root_module_name = (root / "main").string();
+  state.settings.num_jobs         = 4;
+
+  auto const built = jet::compiler::begin_build(state);
+  ASSERT_TRUE(built.is_ok()) << built.err()->details;
+
+  auto const& graph = state.graph;
+  ASSERT_EQ(graph.size(), 3u);
+  EXPECT_EQ(graph[0].path, root / "main.jet");
+
+  auto const util = index_of(graph, root / "util.jet");
+  auto const math = index_of(graph, root / "util" / "math.jet");
+  ASSERT_LT(util, graph.size());
+  ASSERT_LT(math, graph.size());
+
+  auto main_dependencies = graph[0].dependencies;
+  std::ranges::sort(main_dependencies);
+  EXPECT_EQ(main_dependencies, (DynArray<usize>{std::min(util, math), std::max(util, math)}));
+  EXPECT_EQ(graph[util].dependencies, DynArray<usize>{math});
+  EXPECT_TRUE(graph[math].dependencies.empty());
+
+  for (auto i = usize(0); i < graph.size(); ++i) {
+    EXPECT_TRUE(graph[i].hir.has_value()) << graph[i].path;
+  }
+
+  auto const& timings = state.timings;
+  ASSERT_FALSE(timings.empty());
+  EXPECT_EQ(timings.front().name, "read");
+  EXPECT_EQ(timings.front().num_modules, 3u);
+
+  fs::remove_all(root);
+}
+
+TEST(BuildProcess, reports_dependency_cycles)
+{
+  auto const root = make_project("jet_test_build_cycle",
+                                 {
+                                   {"main.jet", "use util::*;\n\nfn main {\n}\n"},
+                                   {"util.jet", "use main::*;\n\nfn util_fn {\n}\n"},
+                                 });
+
+  auto state                      = BuildState();
+  state.settings.root_module_name = (root / "main").string();
+
+  auto const built = jet::compiler::begin_build(state);
+  ASSERT_TRUE(built.err());
+  EXPECT_NE(built.err()->details.find("depend on each other"), String::npos) << built.err()->details;
+
+  fs::remove_all(root);
+}
+
+TEST(BuildProcess, reports_parse_errors_of_used_modules)
+{
+  auto const root = make_project("jet_test_build_parse_error",
+                                 {
+                                   {"main.jet", "use util::*;\n\nfn main {\n}\n"},
+                                   {"util.jet", "fn util_fn {\n"},
+                                 });
+
+  auto state                      = BuildState();
+  state.settings.root_module_name = (root / "main").string();
+
+  auto const built = jet::compiler::begin_build(state);
+  ASSERT_TRUE(built.err());
+  EXPECT_EQ(state.graph.size(), 2u);
+
+  fs::remove_all(root);
+}
+
+TEST(BuildProcess, reports_invalid_number_of_jobs)
+{
+  char program[] = "jetc";
+  char module[]  = "main";
+  char jobs[]    = "-j";
+  char invalid[] = "8x";
+  char* argv[]   = {program, module, jobs, invalid};
+
+  auto const built = jet::compiler::run_build(ProgramArgs(4, argv));
+  ASSERT_TRUE(built.err());
+  EXPECT_NE(built.err()->details.find("invalid number of jobs \"8x\""), String::npos) << built.err()->details;
+}
+
+TEST(BuildProcess, calls_functions_of_used_modules)
+{
+  auto const root = make_project("jet_test_build_calls",
+                                 {
+                                   {"main.jet",
+                                    "use util::math::add;\n\nfn main {\n  println(\"{}\", add(1, 2));\n}\n"},
+                                   {"util/math.jet", "fn add(a: i32, b: i32): i32 {\n  ret a + b;\n}\n"},
+                                 });
+
+  // The units are kept, so that their IR can be checked.
+  auto state                          = BuildState();
+  state.settings.root_module_name     = (root / "main").string();
+  state.settings.cleanup_intermediate = false;
+
+  auto const built = jet::compiler::begin_build(state);
+  ASSERT_TRUE(built.is_ok()) << built.err()->details;
+  ASSERT_EQ(state.graph.size(), 2u);
+  EXPECT_EQ(state.graph[0].name, "");
+  EXPECT_EQ(state.graph[1].name, "util::math");
+
+  auto const directory = jet::compiler::prepare_intermediate_directory(state.settings);
+  auto const main_ir   = jet::core::read_file(directory / "0_main.ll").value_or("");
+  auto const math_ir   = jet::core::read_file(directory / "1_math.ll").value_or("");
+  jet::compiler::cleanup_intermediate_directory(state.settings);
+
+  // The function is declared in the unit of `main` by the name that its own unit defines.
+  EXPECT_NE(main_ir.find("declare i32 @util.math.add(i32, i32)"), String::npos) << main_ir;
+  EXPECT_NE(main_ir.find("call i32 @util.math.add(i32 noundef 1, i32 noundef 2)"), String::npos) << main_ir;
+  EXPECT_NE(math_ir.find("define i32 @util.math.add(i32 %p0, i32 %p1) {"), String::npos) << math_ir;
+
+  fs::remove_all(root);
+}
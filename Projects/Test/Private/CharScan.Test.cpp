@@ -0,0 +1,89 @@
+#include "./Common.hpp"
+
+#include <cctype>
+#include <string>
+
+import Jet.Comp.PEG.CharScan;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using namespace jet::comp::peg;
+
+/// @returns Kernels supported by the CPU.
+static auto supported_kernels() -> DynArray<ScanKernel>
+{
+  auto result = DynArray<ScanKernel>{ScanKernel::Scalar};
+  if (best_scan_kernel() == ScanKernel::SSE2 || best_scan_kernel() == ScanKernel::AVX2) {
+    result.push_back(ScanKernel::SSE2);
+  }
+  if (best_scan_kernel() == ScanKernel::AVX2) {
+    result.push_back(ScanKernel::AVX2);
+  }
+  return result;
+}
+
+/// A text that mixes every class, including non-ASCII bytes and long runs
+/// that cross the block boundaries of the vectorized kernels.
+static auto make_mixed_text() -> String
+{
+  auto text = String();
+  for (auto i = usize(0); i < 200; ++i) {
+    text += String(i % 37, ' ');
+    text += "ident_" + std::to_string(i * 7919);
+    text += String(i % 41, 'x');
+    text += "\t\r\n// comment \xC5\xBC\xC3\xB3\xC5\x82w\n";
+    text += String(i % 53, '9');
+    text += "\x80\xFF{}_";
+  }
+  return text;
+}
+
+TEST(CharScan, classes_match_c_locale)
+{
+  for (auto b = 0; b < 256; ++b) {
+    auto c = char(b);
+    auto ascii = b < 128;
+    EXPECT_EQ(is_in_class(CharClass::Whitespace, c), ascii && std::isspace(b) != 0) << b;
+    EXPECT_EQ(is_in_class(CharClass::Digit, c), ascii && std::isdigit(b) != 0) << b;
+    EXPECT_EQ(is_in_class(CharClass::Alpha, c), ascii && std::isalpha(b) != 0) << b;
+    EXPECT_EQ(is_in_class(CharClass::Alnum, c), ascii && std::isalnum(b) != 0) << b;
+    EXPECT_EQ(is_in_class(CharClass::IdentChar, c), ascii && (b == '_' || std::isalnum(b) != 0)) << b;
+    EXPECT_EQ(is_in_class(CharClass::IdentFirstChar, c), ascii && (b == '_' || std::isalpha(b) != 0)) << b;
+  }
+}
+
+TEST(CharScan, kernels_agree_on_class_runs)
+{
+  auto const text = make_mixed_text();
+
+  for (auto kernel : supported_kernels()) {
+    for (auto cls = usize(0); cls < usize(CharClass::MAX); ++cls) {
+      auto char_class = CharClass(cls);
+      for (auto pos = usize(0); pos <= text.size(); ++pos) {
+        auto expected = usize(0);
+        while (pos + expected < text.size() && is_in_class(char_class, text[pos + expected])) {
+          ++expected;
+        }
+        ASSERT_EQ(scan_class_run(kernel, char_class, text, pos), expected)
+          << "kernel: " << to_string(kernel) << ", class: " << cls << ", pos: " << pos;
+      }
+    }
+  }
+}
+
+TEST(CharScan, kernels_agree_on_find_char)
+{
+  auto const text = make_mixed_text();
+
+  for (auto kernel : supported_kernels()) {
+    for (auto c : {'\n', '/', '\xC5', '#'}) {
+      for (auto pos = usize(0); pos <= text.size(); ++pos) {
+        auto expected = text.find(c, pos);
+        if (expected == String::npos) {
+          expected = text.size();
+        }
+        ASSERT_EQ(find_char(kernel, text, pos, c), expected) << "kernel: " << to_string(kernel) << ", pos: " << pos;
+      }
+    }
+  }
+}
@@ -1,4 +1,18 @@
 #include <filesystem>
 #include <gtest/gtest.h>
 
-auto test_module_parse(std::filesystem::path const& rel_path, bool expect_success = true) -> void;
\ No newline at end of file
+auto test_module_parse(std::filesystem::path const& rel_path, bool expect_success = true) -> void;
+
+/// Parses the test case with and without packrat memoization and expects identical ASTs.
+auto test_packrat_equivalence(std::filesystem::path const& rel_path) -> void;
+
+/// Parses the test case concurrently with the shared grammar and expects identical ASTs.
+auto test_shared_grammar_parse(std::filesystem::path const& rel_path, std::size_t num_threads = 4) -> void;
+
+/// Parses the test case sequentially and with parallel analysis of top-level items and expects identical ASTs.
+/// @param num_items The number of top-level items analyzed in parallel (0 - the module is analyzed as a whole).
+auto test_parallel_parse(std::filesystem::path const& rel_path, std::size_t num_items, std::size_t num_threads = 4)
+  -> void;
+
+/// Parses the test case from memory and streamed in small chunks and expects identical ASTs.
+auto test_stream_parse(std::filesystem::path const& rel_path) -> void;
@@ -0,0 +1,101 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+
+import Jet.Core.File;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using jet::core::MappedFile;
+
+TEST(File, mapped_file_matches_read_file)
+{
+  auto const path = Path("Projects/Test/cases/HelloWorld.jet");
+
+  auto mapped = MappedFile::open(path);
+  auto read   = jet::core::read_file(path);
+  ASSERT_TRUE(mapped.has_value());
+  ASSERT_TRUE(read.has_value());
+
+  EXPECT_TRUE(mapped->is_mapped());
+  EXPECT_EQ(mapped->content(), *read);
+
+  // The mapping is moved, not copied.
+  auto const content = mapped->content();
+  auto       moved   = std::move(*mapped);
+  EXPECT_EQ(moved.content().data(), content.data());
+  EXPECT_TRUE(mapped->content().empty());
+}
+
+TEST(File, mapped_file_falls_back_for_empty_and_missing_files)
+{
+  auto const empty = MappedFile::open(Path("Projects/Test/cases/Empty.jet"));
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_EQ(empty->content(), jet::core::read_file(Path("Projects/Test/cases/Empty.jet")).value_or("?"));
+
+  EXPECT_FALSE(MappedFile::open(Path("Projects/Test/cases/DoesNotExist.jet")).has_value());
+}
+
+TEST(File, source_loader_hands_back_every_file)
+{
+  auto const paths = DynArray<Path>{
+    Path("Projects/Test/cases/HelloWorld.jet"),
+    Path("Projects/Test/cases/DoesNotExist.jet"),
+    Path("Projects/Test/cases/expressions/CompoundExpr.jet"),
+    Path("Projects/Test/cases/modules/Submodule-Empty.jet"),
+  };
+
+  auto loader = jet::core::SourceLoader(2);
+  EXPECT_EQ(loader.load(Span<Path const>(paths).subspan(0, 2)), 0u);
+  EXPECT_EQ(loader.load(Span<Path const>(paths).subspan(2)), 2u);
+
+  auto seen = DynArray<bool>(paths.size());
+  while (auto source = loader.next()) {
+    ASSERT_LT(source->index, paths.size());
+    EXPECT_FALSE(seen[source->index]);
+    seen[source->index] = true;
+
+    EXPECT_EQ(source->path, paths[source->index]);
+    EXPECT_EQ(source->file.has_value(), source->index != 1);
+    if (source->file) {
+      EXPECT_EQ(source->file->content(), jet::core::read_file(source->path).value_or("?"));
+    }
+  }
+
+  EXPECT_EQ(std::count(seen.begin(), seen.end(), true), 4);
+  EXPECT_FALSE(loader.next().has_value());
+}
+
+TEST(File, file_writer_streams_chunks)
+{
+  auto const path = std::filesystem::temp_directory_path() / "jet_test_file_writer.txt";
+
+  auto expected = String();
+  {
+    auto writer = jet::core::FileWriter::create(path, 64);
+    ASSERT_TRUE(writer.has_value());
+
+    for (auto i = 0; i < 100; ++i) {
+      auto const line = "line " + std::to_string(i) + "\n";
+      writer->write(line);
+      expected += line;
+
+      // Nothing is written until the buffer fills.
+      if (i == 0) {
+        EXPECT_EQ(writer->num_bytes_written(), 0u);
+      }
+    }
+    EXPECT_GT(writer->num_bytes_written(), 0u);
+
+    // Larger texts bypass the buffer.
+    auto const large = String(1000, 'x');
+    writer->write(large);
+    expected += large;
+  }
+  EXPECT_EQ(jet::core::read_file(path).value_or("?"), expected);
+
+  std::filesystem::remove(path);
+}
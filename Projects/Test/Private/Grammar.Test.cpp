@@ -0,0 +1,103 @@
+#include "./Common.hpp"
+
+#include <initializer_list>
+
+import Jet.Parser.JetGrammar;
+import Jet.Comp.PEG;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+TEST(Grammar_Embedded, same_as_built_at_runtime)
+{
+  auto const  built    = jet::parser::build_grammar();
+  auto const& embedded = jet::parser::use_grammar();
+
+  EXPECT_EQ(built.peg.rule_registry.data, embedded.peg.rule_registry.data);
+  EXPECT_EQ(built.peg.text_registry, embedded.peg.text_registry);
+  EXPECT_EQ(built.peg.root_rule, embedded.peg.root_rule);
+  EXPECT_TRUE(built.rules.content == embedded.rules.content);
+
+  auto& built_dispatch    = built.peg.sor_dispatch;
+  auto& embedded_dispatch = embedded.peg.sor_dispatch;
+  EXPECT_EQ(built_dispatch.index, embedded_dispatch.index);
+  ASSERT_EQ(built_dispatch.first_sets.size(), embedded_dispatch.first_sets.size());
+  for (auto i = usize(0); i < built_dispatch.first_sets.size(); ++i) {
+    auto& b = built_dispatch.first_sets[i];
+    auto& e = embedded_dispatch.first_sets[i];
+    EXPECT_TRUE(b.bytes.bits == e.bytes.bits) << "first set " << i;
+    EXPECT_EQ(b.nullable, e.nullable) << "first set " << i;
+  }
+
+  auto& built_literals    = built.peg.literal_sets;
+  auto& embedded_literals = embedded.peg.literal_sets;
+  EXPECT_EQ(built_literals.index, embedded_literals.index);
+  ASSERT_EQ(built_literals.nodes.size(), embedded_literals.nodes.size());
+  for (auto i = usize(0); i < built_literals.nodes.size(); ++i) {
+    EXPECT_EQ(built_literals.nodes[i].first_edge, embedded_literals.nodes[i].first_edge) << "node " << i;
+    EXPECT_EQ(built_literals.nodes[i].num_edges, embedded_literals.nodes[i].num_edges) << "node " << i;
+    EXPECT_EQ(built_literals.nodes[i].literal, embedded_literals.nodes[i].literal) << "node " << i;
+  }
+  ASSERT_EQ(built_literals.edges.size(), embedded_literals.edges.size());
+  for (auto i = usize(0); i < built_literals.edges.size(); ++i) {
+    EXPECT_EQ(built_literals.edges[i].byte, embedded_literals.edges[i].byte) << "edge " << i;
+    EXPECT_EQ(built_literals.edges[i].target, embedded_literals.edges[i].target) << "edge " << i;
+  }
+}
+
+/// Builds a grammar with a single `Sor` of the given texts.
+static auto build_text_choice(std::initializer_list<StringView> texts) -> peg::Grammar
+{
+  auto b    = peg::GrammarBuilder();
+  auto root = b.begin_rule(peg::CombinatorRule::Sor, true, "Choice");
+  for (auto text : texts) {
+    (void)b.add_text(text);
+  }
+  b.end_rule();
+  return peg::finalize_grammar(root, std::move(b));
+}
+
+TEST(Grammar_LiteralSet, sor_of_texts_matches_longest_literal)
+{
+  auto grammar = build_text_choice({"<<=", "<=", "<", "==", "=", "not"});
+  auto root    = grammar.rule_registry.view_at(grammar.root_rule.offset).as_structure();
+  ASSERT_TRUE(root.is_literal_set());
+  EXPECT_TRUE(root.kind().is_captured());
+
+  auto program = peg::compile_grammar(grammar);
+  for (auto input : {"<<=", "<=", "<", "==", "=", "not"}) {
+    auto analysis = peg::analyze(grammar, StringView(input));
+    auto machine  = peg::analyze(program, StringView(input));
+    ASSERT_TRUE(analysis.is_ok()) << input;
+    ASSERT_TRUE(machine.is_ok()) << input;
+    EXPECT_EQ(analysis.get_unchecked().ast.entries.size(), 1u) << input;
+    EXPECT_EQ(machine.get_unchecked().ast.entries.size(), 1u) << input;
+  }
+
+  for (auto input : {"<<", "no", "!", ""}) {
+    EXPECT_FALSE(peg::analyze(grammar, StringView(input)).is_ok()) << input;
+    EXPECT_FALSE(peg::analyze(program, StringView(input)).is_ok()) << input;
+  }
+}
+
+TEST(Grammar_LiteralSet, shorter_literal_first_stays_sor)
+{
+  // The `Sor` picks "<" for "<=", which is not the longest match.
+  auto grammar = build_text_choice({"<", "<="});
+  auto root    = grammar.rule_registry.view_at(grammar.root_rule.offset).as_structure();
+  EXPECT_FALSE(root.is_literal_set());
+  EXPECT_FALSE(grammar.literal_sets.find(root).has_value());
+}
+
+TEST(Grammar_LiteralSet, jet_operators_use_tries)
+{
+  using RT      = jet::parser::JetGrammarRuleType;
+  auto& grammar = jet::parser::use_grammar();
+
+  auto prefix = grammar.peg.rule_registry.view_at(grammar.rules[RT::PrefixOperator].offset).as_structure();
+  EXPECT_TRUE(prefix.is_literal_set());
+
+  auto expression = grammar.peg.rule_registry.view_at(grammar.rules[RT::Expression].offset).as_structure();
+  EXPECT_TRUE(grammar.peg.literal_sets.find(expression).has_value());
+}
@@ -0,0 +1,334 @@
+#include "./Common.hpp"
+
+#include <filesystem>
+#include <string>
+
+import Jet.Parser;
+import Jet.Compiler.HIR;
+import Jet.Core.File;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace hir = jet::compiler::hir;
+
+/// Parses and lowers the source. The HIR is allocated from the arena.
+static auto lower(StringView source, Arena& arena) -> hir::Module
+{
+  auto parsed = jet::parser::parse(source);
+  EXPECT_TRUE(parsed.is_ok()) << source;
+  if (!parsed.is_ok()) {
+    return hir::Module(arena);
+  }
+
+  auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+  EXPECT_TRUE(lowered.is_ok()) << source;
+  if (!lowered.is_ok()) {
+    return hir::Module(arena);
+  }
+  return std::move(lowered.get_unchecked());
+}
+
+/// @returns The expression as an S-expression, e.g. `(+ a (* b c))`.
+static auto to_sexpr(hir::Module const& module, hir::ExprID id) -> String
+{
+  using hir::ExprKind;
+
+  static auto constexpr BINARY = Array<StringView, 19>{
+    ".", "::", "==", "!=", "<=", ">=", "<", ">", "+=", "-=", "*=", "/=", "%=", "=", "+", "-", "*", "/", "%",
+  };
+  static auto constexpr UNARY = Array<StringView, 7>{"not", "&", "*", "++", "--", "post++", "post--"};
+
+  auto const& expr = module.get(id);
+  switch (expr.kind) {
+  case ExprKind::Name: return String(module.get(expr.symbol));
+  case ExprKind::Integer: return std::to_string(expr.integer);
+  case ExprKind::Real: return std::to_string(expr.real);
+  case ExprKind::String: return "\"" + String(module.get(expr.symbol)) + "\"";
+  case ExprKind::Block: return "{" + std::to_string(expr.statements.count) + "}";
+  case ExprKind::Binary:
+    return "(" + String(BINARY[usize(expr.binary_op)]) + " " + to_sexpr(module, expr.lhs) + " " +
+           to_sexpr(module, expr.rhs) + ")";
+  case ExprKind::Unary: return "(" + String(UNARY[usize(expr.unary_op)]) + " " + to_sexpr(module, expr.lhs) + ")";
+  case ExprKind::Call:
+  case ExprKind::Subscript: {
+    auto result = String(expr.kind == ExprKind::Call ? "(call " : "(index ") + to_sexpr(module, expr.lhs);
+    for (auto argument : module.get(expr.arguments)) {
+      result += " " + to_sexpr(module, argument);
+    }
+    return result + ")";
+  }
+  }
+  return "?";
+}
+
+/// @returns The expression of the single statement of the only function.
+static auto lower_expression(StringView expression) -> String
+{
+  auto arena  = Arena();
+  auto source = "fn main {\n  " + String(expression) + ";\n}\n";
+  auto module = lower(source, arena);
+  if (module.functions.size() != 1 || module.functions[0].body.count != 1) {
+    return "<not lowered>";
+  }
+
+  auto const& stmt = module.get(module.get(module.functions[0].body)[0]);
+  return stmt.kind == hir::StmtKind::Expression ? to_sexpr(module, stmt.expr) : "<not an expression>";
+}
+
+TEST(HIR, functions)
+{
+  auto arena  = Arena();
+  auto module = lower("fn add(a: i32, b: i32 = 2): i32 {\n  ret a + b;\n}\n\nfn main {\n  add(10, 15);\n}\n", arena);
+
+  ASSERT_EQ(module.items.count, 2u);
+  ASSERT_EQ(module.functions.size(), 2u);
+
+  auto const& add = module.functions[0];
+  EXPECT_EQ(module.get(add.name), "add");
+  EXPECT_EQ(module.get(add.return_type), "i32");
+
+  auto params = module.get(add.parameters);
+  ASSERT_EQ(params.size(), 2u);
+  EXPECT_EQ(module.get(params[0].name), "a");
+  EXPECT_EQ(module.get(params[0].type), "i32");
+  EXPECT_FALSE(params[0].initializer.is_valid());
+  EXPECT_EQ(module.get(params[1].name), "b");
+  EXPECT_EQ(to_sexpr(module, params[1].initializer), "2");
+
+  // Equal names share the symbol.
+  EXPECT_EQ(params[0].type, add.return_type);
+
+  auto body = module.get(add.body);
+  ASSERT_EQ(body.size(), 1u);
+  EXPECT_EQ(module.get(body[0]).kind, hir::StmtKind::Return);
+  EXPECT_EQ(to_sexpr(module, module.get(body[0]).expr), "(+ a b)");
+
+  auto const& main = module.functions[1];
+  EXPECT_EQ(module.get(main.name), "main");
+  EXPECT_EQ(main.parameters.count, 0u);
+  EXPECT_FALSE(main.return_type.is_valid());
+  ASSERT_EQ(main.body.count, 1u);
+  EXPECT_EQ(to_sexpr(module, module.get(module.get(main.body)[0]).expr), "(call add 10 15)");
+}
+
+TEST(HIR, expressions)
+{
+  EXPECT_EQ(lower_expression("a + b * c"), "(+ a (* b c))");
+  EXPECT_EQ(lower_expression("(a + b) * c"), "(* (+ a b) c)");
+  EXPECT_EQ(lower_expression("a - b - c"), "(- (- a b) c)");
+  EXPECT_EQ(lower_expression("a = b = c"), "(= a (= b c))");
+  EXPECT_EQ(lower_expression("a.b.c(1)"), "(. (. a b) (call c 1))");
+  EXPECT_EQ(lower_expression("not a == b"), "(== (not a) b)");
+  EXPECT_EQ(lower_expression("*p++"), "(* (post++ p))");
+  EXPECT_EQ(lower_expression("f(1)(2, x)[3]"), "(index (call (call f 1) 2 x) 3)");
+  EXPECT_EQ(lower_expression("f()"), "(call f)");
+  EXPECT_EQ(lower_expression("println(\"Hello\")"), "(call println \"Hello\")");
+}
+
+TEST(HIR, statements)
+{
+  auto arena  = Arena();
+  auto module = lower(
+    "fn main {\n"
+    "  var x: i32 = 10;\n"
+    "  for (let a = 10; a >= 0; a--) {\n"
+    "    x -= 1;\n"
+    "  }\n"
+    "  if (x < 0) { ret; } else if (x == 0) { ret 0; } else { loop { } }\n"
+    "  while (x) x--;\n"
+    "}\n",
+    arena
+  );
+
+  ASSERT_EQ(module.functions.size(), 1u);
+  auto body = module.get(module.functions[0].body);
+  ASSERT_EQ(body.size(), 4u);
+
+  using hir::StmtKind;
+  auto const& var = module.get(body[0]);
+  ASSERT_EQ(var.kind, StmtKind::Variable);
+  EXPECT_TRUE(module.variables[var.index].is_mutable);
+  EXPECT_EQ(module.get(module.variables[var.index].type), "i32");
+  EXPECT_EQ(to_sexpr(module, module.variables[var.index].initializer), "10");
+
+  auto const& for_loop = module.get(body[1]);
+  ASSERT_EQ(for_loop.kind, StmtKind::For);
+  EXPECT_EQ(module.get(for_loop.init).kind, StmtKind::Variable);
+  EXPECT_FALSE(module.variables[module.get(for_loop.init).index].is_mutable);
+  EXPECT_EQ(to_sexpr(module, for_loop.expr), "(>= a 0)");
+  EXPECT_EQ(to_sexpr(module, for_loop.step), "(post-- a)");
+  EXPECT_EQ(module.get(for_loop.body).kind, StmtKind::Block);
+  EXPECT_EQ(module.get(for_loop.body).statements.count, 1u);
+
+  auto const& if_stmt = module.get(body[2]);
+  ASSERT_EQ(if_stmt.kind, StmtKind::If);
+  EXPECT_EQ(to_sexpr(module, if_stmt.expr), "(< x 0)");
+  auto const& else_if = module.get(if_stmt.else_body);
+  ASSERT_EQ(else_if.kind, StmtKind::If);
+  EXPECT_EQ(to_sexpr(module, else_if.expr), "(== x 0)");
+  auto const& ret = module.get(module.get(module.get(else_if.body).statements)[0]);
+  EXPECT_EQ(ret.kind, StmtKind::Return);
+  EXPECT_EQ(to_sexpr(module, ret.expr), "0");
+  auto const& else_block = module.get(else_if.else_body);
+  ASSERT_EQ(else_block.kind, StmtKind::Block);
+  EXPECT_EQ(module.get(module.get(else_block.statements)[0]).kind, StmtKind::Loop);
+
+  auto const& while_loop = module.get(body[3]);
+  ASSERT_EQ(while_loop.kind, StmtKind::While);
+  EXPECT_EQ(to_sexpr(module, while_loop.expr), "x");
+  EXPECT_EQ(to_sexpr(module, module.get(while_loop.body).expr), "(post-- x)");
+}
+
+TEST(HIR, modules)
+{
+  auto arena  = Arena();
+  auto module = lower(
+    "use foo::bar as baz;\n"
+    "use foo::{qux as alpha, quux::*};\n"
+    "mod math::ops {\n"
+    "  fn add(a: i32): i32 { ret a; }\n"
+    "}\n"
+    "fn main { use math::ops::add; }\n",
+    arena
+  );
+
+  using hir::StmtKind;
+  auto items = module.get(module.items);
+  ASSERT_EQ(items.size(), 4u);
+
+  auto const path_of = [&](hir::UseItem const& item) {
+    auto result = String();
+    for (auto symbol : module.get(item.path)) {
+      result += (result.empty() ? "" : "::") + String(module.get(symbol));
+    }
+    return result;
+  };
+
+  auto const& first_use = module.get(items[0]);
+  ASSERT_EQ(first_use.kind, StmtKind::Use);
+  ASSERT_EQ(first_use.count, 1u);
+  EXPECT_EQ(path_of(module.use_items[first_use.index]), "foo::bar");
+  EXPECT_EQ(module.get(module.use_items[first_use.index].alias), "baz");
+
+  auto const& second_use = module.get(items[1]);
+  ASSERT_EQ(second_use.count, 1u);
+  auto const& grouped = module.use_items[second_use.index];
+  EXPECT_EQ(path_of(grouped), "foo");
+  auto group = module.get(grouped.group);
+  ASSERT_EQ(group.size(), 2u);
+  EXPECT_EQ(path_of(group[0]), "qux");
+  EXPECT_EQ(module.get(group[0].alias), "alpha");
+  EXPECT_EQ(path_of(group[1]), "quux");
+  EXPECT_TRUE(group[1].is_glob);
+
+  auto const& submodule = module.get(items[2]);
+  ASSERT_EQ(submodule.kind, StmtKind::Submodule);
+  auto const& math = module.submodules[submodule.index];
+  EXPECT_EQ(math.path.count, 2u);
+  ASSERT_EQ(math.items.count, 1u);
+  EXPECT_EQ(module.get(module.get(math.items)[0]).kind, StmtKind::Function);
+
+  auto const& main = module.get(items[3]);
+  ASSERT_EQ(main.kind, StmtKind::Function);
+  auto const& local_use = module.get(module.get(module.functions[main.index].body)[0]);
+  ASSERT_EQ(local_use.kind, StmtKind::Use);
+  EXPECT_EQ(path_of(module.use_items[local_use.index]), "math::ops::add");
+}
+
+TEST(HIR, modules_share_symbols)
+{
+  auto arena  = Arena();
+  auto first  = lower("fn add(a: i32): i32 {\n  ret a;\n}\n", arena);
+  auto second = lower("fn main {\n  print(\"i32\");\n  add(1);\n}\n", arena);
+  ASSERT_EQ(first.functions.size(), 1u);
+  ASSERT_EQ(second.functions.size(), 1u);
+
+  // Names, types and string literals are interned in the same table.
+  auto const& add  = first.functions[0];
+  auto const  body = second.get(second.functions[0].body);
+  ASSERT_EQ(body.size(), 2u);
+
+  auto const& print_call = second.get(second.get(body[0]).expr);
+  auto const& add_call   = second.get(second.get(body[1]).expr);
+  EXPECT_EQ(second.get(add_call.lhs).symbol, add.name);
+  EXPECT_EQ(second.get(second.get(print_call.arguments)[0]).symbol, add.return_type);
+  EXPECT_EQ(add.return_type, jet::comp::foundation::use_interner().intern("i32"));
+}
+
+TEST(HIR, reports_invalid_literals)
+{
+  auto parsed = jet::parser::parse("fn main {\n  let x = 99999999999999999999;\n}\n");
+  ASSERT_TRUE(parsed.is_ok());
+
+  auto arena   = Arena();
+  auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+  ASSERT_FALSE(lowered.is_ok());
+  EXPECT_NE(lowered.err_unchecked().details.find("invalid literal `99999999999999999999`"), String::npos)
+    << lowered.err_unchecked().details;
+
+  // Above the largest `i64`.
+  parsed = jet::parser::parse("fn main {\n  let x = 9223372036854775808;\n}\n");
+  ASSERT_TRUE(parsed.is_ok());
+
+  lowered = hir::lower_module(parsed.get_unchecked(), arena);
+  ASSERT_FALSE(lowered.is_ok());
+  EXPECT_NE(
+    lowered.err_unchecked().details.find("integer literal out of range `9223372036854775808`"), String::npos
+  ) << lowered.err_unchecked().details;
+
+  // The largest `i64` fits.
+  parsed = jet::parser::parse("fn main {\n  let x = 9223372036854775807;\n}\n");
+  ASSERT_TRUE(parsed.is_ok());
+  EXPECT_TRUE(hir::lower_module(parsed.get_unchecked(), arena).is_ok());
+}
+
+TEST(HIR, every_parsed_test_case_lowers)
+{
+  namespace fs = std::filesystem;
+
+  auto num_lowered = usize(0);
+  for (auto& entry : fs::recursive_directory_iterator("Projects/Test/cases")) {
+    if (entry.path().extension() != ".jet") {
+      continue;
+    }
+
+    auto file   = jet::core::MappedFile::open(entry.path());
+    auto parsed = jet::parser::parse(file->content());
+    if (!parsed.is_ok()) {
+      continue;
+    }
+
+    auto arena   = Arena();
+    auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+    EXPECT_TRUE(lowered.is_ok()) << entry.path() << ": " << (lowered.is_ok() ? "" : lowered.err_unchecked().details);
+    ++num_lowered;
+  }
+  EXPECT_GT(num_lowered, 10u);
+}
+
+TEST(HIR, reused_arena_does_not_allocate)
+{
+  auto source = String();
+  for (auto i = 0; i < 200; ++i) {
+    source += "fn function_" + std::to_string(i) + "(x: i32) {\n  let y = x * 2 + f(x, 3);\n  if (y > 2) { y--; }\n}\n";
+  }
+  auto parsed = jet::parser::parse(source);
+  ASSERT_TRUE(parsed.is_ok());
+
+  auto arena = Arena(1024);
+  for (auto cycle = 0; cycle < 3; ++cycle) {
+    auto const before = arena.num_heap_allocations();
+    {
+      auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+      ASSERT_TRUE(lowered.is_ok());
+      EXPECT_EQ(lowered.get_unchecked().functions.size(), 200u);
+    }
+    arena.reset();
+
+    // The first cycle grows the arena, the next ones reuse its memory.
+    if (cycle > 0) {
+      EXPECT_EQ(arena.num_heap_allocations(), before);
+    }
+  }
+}
@@ -0,0 +1,320 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+
+import Jet.Parser;
+import Jet.Compiler.HIR;
+import Jet.Compiler.IR;
+import Jet.Core.File;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace hir = jet::compiler::hir;
+namespace ir  = jet::compiler::ir;
+namespace fs  = std::filesystem;
+
+/// Parses, lowers and emits the source with the given buffer size.
+/// @returns The IR or the details of the error.
+static auto emit(
+  StringView              source,
+  usize                   buffer_size = jet::core::FileWriter::DEFAULT_BUFFER_SIZE,
+  ir::EmitContext const&  context     = {}
+) -> String
+{
+  auto parsed = jet::parser::parse(source);
+  EXPECT_TRUE(parsed.is_ok()) << source;
+  if (!parsed.is_ok()) {
+    return {};
+  }
+
+  auto arena   = Arena();
+  auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+  EXPECT_TRUE(lowered.is_ok()) << source;
+  if (!lowered.is_ok()) {
+    return {};
+  }
+
+  auto const path = fs::temp_directory_path() / "jet_test_ir.ll";
+  {
+    auto writer = jet::core::FileWriter::create(path, buffer_size);
+    EXPECT_TRUE(writer.has_value());
+    if (!writer) {
+      return {};
+    }
+
+    auto emitted = ir::emit_llvm_ir(lowered.get_unchecked(), *writer, context);
+    if (auto err = emitted.err()) {
+      return "error: " + err->details;
+    }
+  }
+
+  auto content = jet::core::read_file(path).value_or("?");
+  fs::remove(path);
+  return content;
+}
+
+/// Parses and lowers the source of a used module. The HIR is allocated from the arena.
+static auto lower(StringView source, Arena& arena) -> hir::Module
+{
+  auto parsed = jet::parser::parse(source);
+  EXPECT_TRUE(parsed.is_ok()) << source;
+  if (!parsed.is_ok()) {
+    return hir::Module(arena);
+  }
+
+  auto lowered = hir::lower_module(parsed.get_unchecked(), arena);
+  EXPECT_TRUE(lowered.is_ok()) << source;
+  if (!lowered.is_ok()) {
+    return hir::Module(arena);
+  }
+  return std::move(lowered.get_unchecked());
+}
+
+/// Checks that every block ends with a terminator and that every branch targets a block of the function.
+static auto expect_well_formed(String const& ir) -> void
+{
+  auto labels    = DynArray<String>();
+  auto targets   = DynArray<String>();
+  auto prev_line = String();
+  auto pos       = usize(0);
+  while (pos < ir.size()) {
+    auto const end  = std::min(ir.find('\n', pos), ir.size());
+    auto const line = ir.substr(pos, end - pos);
+    pos             = end + 1;
+
+    auto const is_label = line.starts_with("bb") && line.ends_with(':');
+    if (is_label || line == "}") {
+      EXPECT_TRUE(prev_line.starts_with("  br ") || prev_line.starts_with("  ret ")) << prev_line;
+    }
+    if (is_label) {
+      labels.push_back("%" + line.substr(0, line.size() - 1));
+    }
+    for (auto target = line.find("label %"); target != String::npos; target = line.find("label %", target + 1)) {
+      auto const name_end = line.find_first_of(",\n", target);
+      targets.push_back(line.substr(target + 6, name_end - target - 6));
+    }
+
+    // Every branch targets a block of its function.
+    if (line == "}") {
+      for (auto& target : targets) {
+        EXPECT_NE(std::find(labels.begin(), labels.end(), target), labels.end()) << target;
+      }
+      labels.clear();
+      targets.clear();
+    }
+    prev_line = line;
+  }
+}
+
+TEST(IR, hello_world)
+{
+  auto const ir = emit("fn main {\n  println(\"Hello, World!\");\n}\n");
+
+  EXPECT_NE(ir.find("define i32 @main() {"), String::npos) << ir;
+  EXPECT_NE(ir.find("c\"Hello, World!\\0A\\00\""), String::npos) << ir;
+  EXPECT_NE(ir.find("call i32 (ptr, ...) @printf(ptr noundef @.str.0)"), String::npos) << ir;
+  EXPECT_NE(ir.find("ret i32 0"), String::npos) << ir;
+  EXPECT_NE(ir.find("declare i32 @printf(ptr noundef, ...)"), String::npos) << ir;
+  expect_well_formed(ir);
+}
+
+TEST(IR, functions_and_arithmetic)
+{
+  auto const ir = emit(
+    "fn add(a: i32, b: i32 = 2): i32 {\n"
+    "  ret a + b * 3;\n"
+    "}\n"
+    "\n"
+    "fn main {\n"
+    "  var x: i64 = add(10);\n"
+    "  x -= 4;\n"
+    "  println(\"{} {}\", x, x > 5);\n"
+    "}\n"
+  );
+
+  EXPECT_NE(ir.find("define i32 @add(i32 %p0, i32 %p1) {"), String::npos) << ir;
+  EXPECT_NE(ir.find(" = mul i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = add i32 "), String::npos) << ir;
+
+  // The default value is passed by the caller, the result is extended to the type of the variable.
+  EXPECT_NE(ir.find("call i32 @add(i32 noundef 10, i32 noundef 2)"), String::npos) << ir;
+  EXPECT_NE(ir.find(" = sext i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = sub i64 "), String::npos) << ir;
+  EXPECT_NE(ir.find("c\"%lld %d\\0A\\00\""), String::npos) << ir;
+  expect_well_formed(ir);
+}
+
+TEST(IR, unsigned_types)
+{
+  auto const ir = emit(
+    "fn half(x: u32): u32 {\n"
+    "  ret x / 2;\n"
+    "}\n"
+    "\n"
+    "fn main {\n"
+    "  let x: u32 = 3000000000;\n"
+    "  let small: u8 = 300;\n"
+    "  let signed: i32 = 5;\n"
+    "  let same: u32 = signed;\n"
+    "  let wide: u64 = x;\n"
+    "  let real: f64 = small;\n"
+    "  let back: u32 = real;\n"
+    "  println(\"{} {} {} {}\", half(x), x % 7, wide, x > same);\n"
+    "}\n"
+  );
+
+  // The constants are wrapped to the width of the type, and printed as unsigned.
+  EXPECT_NE(ir.find("store i32 3000000000, ptr "), String::npos) << ir;
+  EXPECT_NE(ir.find("store i8 44, ptr "), String::npos) << ir;
+
+  EXPECT_NE(ir.find(" = udiv i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = urem i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = icmp ugt i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = zext i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = uitofp i8 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = fptoui double "), String::npos) << ir;
+  EXPECT_NE(ir.find("c\"%u %u %llu %d\\0A\\00\""), String::npos) << ir;
+
+  // None of the signed instructions are used, and the integers of the same width are not converted.
+  static auto constexpr SIGNED = Array<StringView, 7>{
+    " = sdiv ", " = srem ", " = icmp sgt ", " = sext ", " = sitofp ", " = fptosi ", " = trunc ",
+  };
+  for (auto instruction : SIGNED) {
+    EXPECT_EQ(ir.find(instruction), String::npos) << instruction << '\n' << ir;
+  }
+  expect_well_formed(ir);
+}
+
+TEST(IR, control_flow)
+{
+  auto const ir = emit(
+    "fn main {\n"
+    "  var a = 10;\n"
+    "  for (let i = 0; i < 3; i++) {\n"
+    "    a += i;\n"
+    "  }\n"
+    "  while (a >= 0) {\n"
+    "    a--;\n"
+    "  }\n"
+    "  loop {\n"
+    "    a++;\n"
+    "    if (a > 5) {\n"
+    "      break;\n"
+    "    }\n"
+    "    else {\n"
+    "      continue;\n"
+    "    }\n"
+    "  }\n"
+    "  ret;\n"
+    "}\n"
+  );
+
+  EXPECT_EQ(ir.find("error"), String::npos) << ir;
+  EXPECT_NE(ir.find(" = icmp slt i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = icmp sge i32 "), String::npos) << ir;
+  EXPECT_NE(ir.find(" = icmp sgt i32 "), String::npos) << ir;
+  expect_well_formed(ir);
+}
+
+TEST(IR, control_flow_test_cases)
+{
+  for (auto& entry : fs::directory_iterator("Projects/Test/cases/control_flow")) {
+    auto const source = jet::core::read_file(entry.path()).value_or("");
+    auto const ir     = emit(source);
+    EXPECT_FALSE(ir.starts_with("error")) << entry.path() << ": " << ir;
+    expect_well_formed(ir);
+  }
+}
+
+TEST(IR, output_does_not_depend_on_buffer_size)
+{
+  auto source = String();
+  for (auto i = 0; i < 100; ++i) {
+    source += "fn function_" + std::to_string(i) + "(x: i32): i32 {\n  if (x > 2) { ret x * 2; }\n  ret x;\n}\n";
+  }
+  source += "fn main {\n  println(\"{}\", function_99(5));\n}\n";
+
+  auto const buffered = emit(source);
+  EXPECT_GT(buffered.size(), 1000u);
+  EXPECT_EQ(emit(source, 16), buffered);
+}
+
+TEST(IR, calls_functions_of_used_modules)
+{
+  static auto constexpr BUFFER_SIZE = jet::core::FileWriter::DEFAULT_BUFFER_SIZE;
+
+  auto       arena = Arena();
+  auto const math  = lower("fn add(a: i32, b: i32 = 2): i32 {\n  ret a + b;\n}\n\nfn unused {\n}\n", arena);
+  auto const other = lower("fn add(a: i64): i64 {\n  ret a;\n}\n", arena);
+  auto const used  = Array<ir::UsedModule, 2>{{{"util::math", &math}, {"other", &other}}};
+
+  auto const ir = emit(
+    "fn main {\n  math::add(1);\n  util::math::add(1, 3);\n  other::add(4);\n}\n",
+    BUFFER_SIZE,
+    {.used_modules = used}
+  );
+
+  // Only the called functions are declared, once, by the names that their own units define.
+  auto const declaration = StringView("declare i32 @util.math.add(i32, i32)");
+  EXPECT_NE(ir.find(declaration), String::npos) << ir;
+  EXPECT_EQ(ir.find(declaration), ir.rfind(declaration)) << ir;
+  EXPECT_NE(ir.find("declare i64 @other.add(i64)"), String::npos) << ir;
+  EXPECT_EQ(ir.find("unused"), String::npos) << ir;
+
+  // The literal default values are passed by the caller.
+  EXPECT_NE(ir.find("call i32 @util.math.add(i32 noundef 1, i32 noundef 2)"), String::npos) << ir;
+  EXPECT_NE(ir.find("call i32 @util.math.add(i32 noundef 1, i32 noundef 3)"), String::npos) << ir;
+  EXPECT_NE(ir.find("call i64 @other.add(i64 noundef 4)"), String::npos) << ir;
+  expect_well_formed(ir);
+
+  // The functions of the modules other than the root one are qualified by the paths of the modules.
+  auto const math_ir = emit("fn add(a: i32): i32 {\n  ret a;\n}\n", BUFFER_SIZE, {.module_name = "util::math"});
+  EXPECT_NE(math_ir.find("define i32 @util.math.add(i32 %p0) {"), String::npos) << math_ir;
+
+  // A function of the module itself comes before those of the used modules.
+  auto const local_ir = emit("fn add(a: i32) {\n}\n\nfn main {\n  add(1);\n}\n", BUFFER_SIZE, {.used_modules = used});
+  EXPECT_NE(local_ir.find("call void @add(i32 noundef 1)"), String::npos) << local_ir;
+  EXPECT_EQ(local_ir.find("declare"), String::npos) << local_ir;
+
+  // A path comes to a used module first.
+  auto const path_ir =
+    emit("fn add(a: i64) {\n}\n\nfn main {\n  other::add(1);\n}\n", BUFFER_SIZE, {.used_modules = used});
+  EXPECT_NE(path_ir.find("call i64 @other.add(i64 noundef 1)"), String::npos) << path_ir;
+}
+
+TEST(IR, errors_of_calls_to_used_modules)
+{
+  static auto constexpr BUFFER_SIZE = jet::core::FileWriter::DEFAULT_BUFFER_SIZE;
+
+  auto       arena = Arena();
+  auto const math  = lower("fn add(a: i32, b: i32 = 1 + 1): i32 {\n  ret a + b;\n}\n", arena);
+  auto const other = lower("fn add(a: i64): i64 {\n  ret a;\n}\n", arena);
+  auto const used  = Array<ir::UsedModule, 2>{{{"util::math", &math}, {"other", &other}}};
+
+  EXPECT_EQ(
+    emit("fn main {\n  add(1, 2);\n}\n", BUFFER_SIZE, {.used_modules = used}),
+    "error: `add` is defined in `other` and in `util::math`"
+  );
+  EXPECT_EQ(
+    emit("fn main {\n  math::add(1);\n}\n", BUFFER_SIZE, {.used_modules = used}),
+    "error: the default value of `b` of `add` is not a literal, pass the argument"
+  );
+  EXPECT_EQ(
+    emit("fn main {\n  ath::add(1, 2);\n}\n", BUFFER_SIZE, {.used_modules = used}), "error: unknown function `add`"
+  );
+}
+
+TEST(IR, errors)
+{
+  EXPECT_EQ(emit("fn main {\n  let y = x;\n}\n"), "error: unknown variable `x`");
+  EXPECT_EQ(emit("fn main {\n  foo();\n}\n"), "error: unknown function `foo`");
+  EXPECT_EQ(emit("fn main {\n  break;\n}\n"), "error: `break` outside of a loop");
+  EXPECT_EQ(emit("fn f(a: i32) {\n}\nfn main {\n  f(1, 2);\n}\n"), "error: `f` takes 1 arguments, 2 given");
+  EXPECT_EQ(
+    emit("fn f(a: i32, b: i32 = a) {\n}\n\nfn main {\n  let a = 2;\n  f(1);\n}\n"),
+    "error: the default value of `b` of `f` is not a literal, pass the argument"
+  );
+}
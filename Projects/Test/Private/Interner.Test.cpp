@@ -0,0 +1,77 @@
+#include "./Common.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+
+TEST(Interner, equal_strings_share_the_symbol)
+{
+  auto interner = Interner();
+
+  auto const main  = interner.intern("main");
+  auto const i32   = interner.intern("i32");
+  auto const empty = interner.intern("");
+  EXPECT_NE(main, i32);
+  EXPECT_NE(main, empty);
+  EXPECT_EQ(interner.size(), 3u);
+
+  // The bytes are copied, the source may go away.
+  auto text = String("main");
+  EXPECT_EQ(interner.intern(text), main);
+  text = "other";
+  EXPECT_EQ(interner.get(main), "main");
+  EXPECT_EQ(interner.get(i32), "i32");
+  EXPECT_EQ(interner.get(empty), "");
+  EXPECT_EQ(interner.size(), 3u);
+}
+
+TEST(Interner, symbols_are_stable)
+{
+  auto interner = Interner();
+
+  auto symbols = DynArray<Symbol>();
+  for (auto i = 0; i < 100'000; ++i) {
+    symbols.push_back(interner.intern("name_" + std::to_string(i)));
+  }
+
+  // The strings did not move while the shards grew.
+  for (auto i = 0; i < 100'000; ++i) {
+    ASSERT_EQ(interner.get(symbols[usize(i)]), "name_" + std::to_string(i));
+    ASSERT_EQ(interner.intern("name_" + std::to_string(i)), symbols[usize(i)]);
+  }
+  EXPECT_EQ(interner.size(), 100'000u);
+}
+
+TEST(Interner, concurrent_interning)
+{
+  auto const num_threads = 8;
+  auto const num_names   = 20'000;
+
+  auto interner = Interner();
+  auto results  = DynArray<DynArray<Symbol>>(num_threads);
+  auto threads  = DynArray<std::thread>();
+  for (auto t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      // Every thread interns the same names, in a different order.
+      for (auto i = 0; i < num_names; ++i) {
+        auto const name = (i * 7 + t * 1'000) % num_names;
+        results[usize(t)].push_back(interner.intern("name_" + std::to_string(name)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.size(), usize(num_names));
+  for (auto t = 0; t < num_threads; ++t) {
+    for (auto i = 0; i < num_names; ++i) {
+      auto const name = (i * 7 + t * 1'000) % num_names;
+      ASSERT_EQ(interner.get(results[usize(t)][usize(i)]), "name_" + std::to_string(name));
+    }
+  }
+}
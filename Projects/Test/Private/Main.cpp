@@ -1,14 +1,19 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
+#include <thread>
 #include <string_view>
 
 import Jet.Parser;
 import Jet.Parser.JetGrammar;
+import Jet.Parser.TopLevelScan;
 
 import Jet.Core.File;
 import Jet.Comp.PEG;
 import Jet.Comp.PEG.Analysis;
+import Jet.Comp.PEG.Machine;
 import Jet.Comp.Format;
 import Jet.Comp.Log;
 import Jet.Comp.Foundation.StdTypes;
@@ -32,8 +37,13 @@ using jet::parser::JetGrammar;
 
 auto use_grammar() -> JetGrammar const&
 {
-  static auto const grammar = jet::parser::build_grammar();
-  return grammar;
+  return jet::parser::use_grammar();
+}
+
+auto use_program() -> peg::Program const&
+{
+  static auto const program = peg::compile_grammar(use_grammar().peg);
+  return program;
 }
 
 auto test_parse(StringView module_content) -> peg::ASTAnalysisResult
@@ -42,6 +52,27 @@ auto test_parse(StringView module_content) -> peg::ASTAnalysisResult
   return peg::analyze(use_grammar().peg, module_content);
 }
 
+auto test_parse(StringView module_content, peg::AnalysisOptions const& options) -> peg::ASTAnalysisResult
+{
+  return peg::analyze(use_grammar().peg, module_content, options);
+}
+
+auto expect_same_entries(peg::AST const& expected, peg::AST const& actual) -> void
+{
+  ASSERT_EQ(expected.entries.size(), actual.entries.size());
+  EXPECT_EQ(expected.current_pos, actual.current_pos);
+
+  for (auto i = usize(0); i < expected.entries.size(); ++i) {
+    auto& e = expected.entries[i];
+    auto& a = actual.entries[i];
+    EXPECT_EQ(e.rule_offset, a.rule_offset) << "entry " << i;
+    EXPECT_EQ(e.next_id_same_nesting.id, a.next_id_same_nesting.id) << "entry " << i;
+    EXPECT_EQ(e.num_children, a.num_children) << "entry " << i;
+    EXPECT_EQ(e.start_pos, a.start_pos) << "entry " << i;
+    EXPECT_EQ(e.end_pos, a.end_pos) << "entry " << i;
+  }
+}
+
 auto get_parse_error_msg(peg::FailedASTAnalysis const& analysis) -> String
 {
   namespace fmt = jet::comp::fmt;
@@ -54,7 +85,7 @@ auto get_parse_error_msg(peg::FailedASTAnalysis const& analysis) -> String
   if (ast.entries.empty()) {
     return "couldn't parse input (no entries in AST)";
   }
-  auto rule_id = ast.entries.back().rule_id;
+  auto rule_id = ast.entries.back().rule_id();
 
   auto const reg_view = rule_registry.view_at(rule_id.offset);
   auto const rule_view = reg_view.as_structure();
@@ -63,9 +94,9 @@ auto get_parse_error_msg(peg::FailedASTAnalysis const& analysis) -> String
   return fmt::format("couldn't parse \"{}\" at pos {}", rule_name, ast.current_pos);
 }
 
-auto read_test_module(Path const& rel_path) -> Opt<String>
+auto read_test_module(Path const& rel_path) -> Opt<jet::core::MappedFile>
 {
-  return jet::core::read_file(Path("Projects/Test/cases") / rel_path);
+  return jet::core::MappedFile::open(Path("Projects/Test/cases") / rel_path);
 }
 
 auto test_module_parse(Path const& rel_path, bool expect_success) -> void
@@ -73,8 +104,15 @@ auto test_module_parse(Path const& rel_path, bool expect_success) -> void
   auto module_content = read_test_module(rel_path);
   ASSERT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
 
-  auto const analysis_result = test_parse(*module_content);
+  auto const analysis_result = test_parse(module_content->content());
   auto successfully_parsed = analysis_result.is_ok();
+
+  // The parsing machine must agree with the recursive analyzer on every test case.
+  auto const machine_result = peg::analyze(use_program(), module_content->content());
+  EXPECT_EQ(successfully_parsed, machine_result.is_ok()) << "Parsing machine changed the outcome of: " << rel_path.string();
+  if (successfully_parsed && machine_result.is_ok()) {
+    expect_same_entries(analysis_result.get_unchecked().ast, machine_result.get_unchecked().ast);
+  }
   if (expect_success)
   {
     EXPECT_TRUE(successfully_parsed) << "Unexpected failure parsing test case file: " << rel_path.string();
@@ -88,4 +126,90 @@ auto test_module_parse(Path const& rel_path, bool expect_success) -> void
   }
 
   ASSERT_FALSE(successfully_parsed) << "Unexpected success parsing test case file: " << rel_path.string();
-}
\ No newline at end of file
+}
+
+auto test_packrat_equivalence(Path const& rel_path) -> void
+{
+  auto module_content = read_test_module(rel_path);
+  ASSERT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
+
+  auto const plain   = test_parse(module_content->content());
+  auto const packrat = test_parse(module_content->content(), peg::AnalysisOptions{.packrat = true});
+  ASSERT_EQ(plain.is_ok(), packrat.is_ok()) << "Packrat mode changed the outcome of: " << rel_path.string();
+
+  if (plain.is_ok()) {
+    expect_same_entries(plain.get_unchecked().ast, packrat.get_unchecked().ast);
+    EXPECT_GT(packrat.get_unchecked().packrat_stats.misses, 0u);
+  }
+}
+
+auto test_shared_grammar_parse(Path const& rel_path, usize num_threads) -> void
+{
+  auto module_content = read_test_module(rel_path);
+  ASSERT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
+
+  auto const expected = test_parse(module_content->content());
+  ASSERT_TRUE(expected.is_ok()) << "Unexpected failure parsing test case file: " << rel_path.string();
+
+  auto results = DynArray<Opt<peg::ASTAnalysisResult>>(num_threads);
+  auto grammars = DynArray<JetGrammar const*>(num_threads);
+  {
+    auto threads = DynArray<std::jthread>();
+    for (auto t = usize(0); t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        grammars[t] = &jet::parser::use_grammar();
+        results[t].emplace(peg::analyze(grammars[t]->peg, module_content->content()));
+      });
+    }
+  }
+
+  for (auto t = usize(0); t < num_threads; ++t) {
+    EXPECT_EQ(grammars[t], &use_grammar());
+    ASSERT_TRUE(results[t]->is_ok());
+    expect_same_entries(expected.get_unchecked().ast, results[t]->get_unchecked().ast);
+  }
+}
+
+auto test_parallel_parse(Path const& rel_path, usize num_items, usize num_threads) -> void
+{
+  auto module_content = read_test_module(rel_path);
+  ASSERT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
+
+  // Otherwise both parses would be sequential and the comparison would prove nothing.
+  auto const items = jet::parser::scan_top_level_items(module_content->content());
+  ASSERT_EQ(items ? items->size() : 0, std::max(num_items, usize(1))) << "Unexpected split of: " << rel_path.string();
+
+  auto const sequential = jet::parser::parse(module_content->content());
+  auto const parallel   = jet::parser::parse(module_content->content(), {.num_threads = num_threads});
+  ASSERT_EQ(sequential.is_ok(), parallel.is_ok()) << "Parallel parse changed the outcome of: " << rel_path.string();
+
+  if (sequential.is_ok()) {
+    expect_same_entries(sequential.get_unchecked().ast, parallel.get_unchecked().ast);
+
+    auto const& stats = parallel.get_unchecked().stats;
+    EXPECT_EQ(stats.num_parallel_items, num_items) << "The items were not analyzed in parallel: " << rel_path.string();
+    if (num_items != 0) {
+      EXPECT_EQ(stats.num_threads, std::min(num_threads, num_items));
+    }
+    EXPECT_EQ(sequential.get_unchecked().stats.num_parallel_items, 0u);
+  }
+}
+
+auto test_stream_parse(Path const& rel_path) -> void
+{
+  auto module_content = read_test_module(rel_path);
+  ASSERT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
+
+  // Tiny chunks and lookahead make the buffer grow and slide within every item.
+  auto file   = std::istringstream(String(module_content->content()));
+  auto reader = peg::StdStreamReader(file);
+
+  auto const sequential = jet::parser::parse(module_content->content());
+  auto const streamed   = jet::parser::analyze_module_stream(reader, {.chunk_size = 7, .lookahead = 3});
+  ASSERT_EQ(sequential.is_ok(), streamed.is_ok()) << "Streaming changed the outcome of: " << rel_path.string();
+
+  if (sequential.is_ok()) {
+    expect_same_entries(sequential.get_unchecked().ast, streamed.get_unchecked().ast);
+    EXPECT_EQ(streamed.get_unchecked().stream_stats.bytes_read, module_content->content().size());
+  }
+}
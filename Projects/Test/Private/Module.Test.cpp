@@ -0,0 +1,61 @@
+#include "./Common.hpp"
+
+#include <chrono>
+#include <filesystem>
+
+import Jet.Core.Module;
+import Jet.Core.File;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace fs = std::filesystem;
+
+TEST(ModuleResolver, resolves_like_find_module)
+{
+  auto const roots    = Array<Path, 1>{Path("Projects/Test/cases")};
+  auto const resolver = jet::core::ModuleResolver(roots);
+  EXPECT_GT(resolver.num_indexed(), 10u);
+
+  for (auto path : {
+         "Projects/Test/cases/HelloWorld.jet",
+         "Projects/Test/cases/HelloWorld",
+         "Projects/Test/cases/./modules/../HelloWorld",
+         "Projects/Test/cases/modules",
+         "Projects/Test/cases/modules/Submodule-Empty",
+         "Projects/Test/cases/HelloWorld.txt",
+         "Projects/Test/cases/DoesNotExist",
+         "Projects/Test/cases",
+         "Projects/Test/Private/Main.cpp",
+       }) {
+    EXPECT_EQ(resolver.find(Path(path)), jet::core::find_module(Path(path))) << path;
+  }
+
+  auto const absolute = fs::absolute(Path("Projects/Test/cases/HelloWorld"));
+  EXPECT_EQ(resolver.find(absolute), jet::core::find_module(absolute));
+}
+
+TEST(ModuleResolver, refresh_lists_modified_directories)
+{
+  auto const root = fs::temp_directory_path() / "jet_test_module_resolver";
+  fs::remove_all(root);
+  fs::create_directories(root / "sub");
+  jet::core::overwrite_file(root / "sub" / "first.jet", "fn main {}");
+
+  auto const roots    = Array<Path, 1>{root};
+  auto       resolver = jet::core::ModuleResolver(roots);
+  EXPECT_TRUE(resolver.find(root / "sub" / "first").has_value());
+  EXPECT_FALSE(resolver.find(root / "sub" / "second").has_value());
+  EXPECT_EQ(resolver.refresh(), 0u);
+
+  // Changes are not seen until the refresh.
+  jet::core::overwrite_file(root / "sub" / "second.jet", "fn main {}");
+  fs::remove(root / "sub" / "first.jet");
+  fs::last_write_time(root / "sub", fs::last_write_time(root / "sub") + std::chrono::seconds(1));
+  EXPECT_TRUE(resolver.find(root / "sub" / "first").has_value());
+
+  EXPECT_EQ(resolver.refresh(), 1u);
+  EXPECT_FALSE(resolver.find(root / "sub" / "first").has_value());
+  EXPECT_EQ(resolver.find(root / "sub" / "second"), root / "sub" / "second.jet");
+
+  fs::remove_all(root);
+}
@@ -0,0 +1,96 @@
+#include "./Common.hpp"
+
+import Jet.Parser;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using jet::parser::FileLines;
+
+/// @returns The lines of the text, with or without the column index.
+static auto make_lines(StringView text, bool indexed) -> FileLines
+{
+  auto lines = FileLines{text};
+  lines.push_line_start(0);
+  (void)index_utf8_lines(text, lines.line_starts);
+  lines.num_bytes = text.size();
+  if (indexed) {
+    lines.build_index();
+  }
+  return lines;
+}
+
+/// A text with ASCII and non-ASCII lines, some longer than the checkpoint stride.
+static auto make_text() -> String
+{
+  auto text = String("fn main {\n");
+  for (auto i = 0; i < 20; ++i) {
+    text += String(usize(i * 13), ' ') + "// Za\xC5\xBC\xC3\xB3\xC5\x82\xC4\x87 \xE2\x82\xAC \xF0\x9F\x98\x80 " + String(usize(i), 'x');
+    text += "\n" + String(usize(i * 7), ' ') + "println(\"Hello\");\n";
+  }
+  return text + "}";
+}
+
+TEST(FileLines, lookups_match_a_linear_walk)
+{
+  auto const text = make_text();
+  for (auto indexed : {false, true}) {
+    auto const lines = make_lines(text, indexed);
+
+    auto offsets  = DynArray<usize>();
+    auto expected = DynArray<jet::parser::FilePosition>();
+    auto line     = usize(1);
+    auto column   = usize(0);
+    for (auto pos = usize(0); pos <= text.size(); ++pos) {
+      if (pos < text.size() && (u8(text[pos]) & 0xC0) == 0x80) {
+        continue;
+      }
+
+      EXPECT_EQ(lines.line_at(pos), line) << pos;
+      EXPECT_EQ(lines.column_at(pos), column) << pos;
+      offsets.push_back(pos);
+      expected.push_back({line, column});
+
+      if (pos < text.size() && text[pos] == '\n') {
+        ++line;
+        column = 0;
+      }
+      else {
+        ++column;
+      }
+    }
+
+    auto positions = lines.positions_at(offsets);
+    ASSERT_EQ(positions.size(), expected.size());
+    for (auto i = usize(0); i < positions.size(); ++i) {
+      EXPECT_EQ(positions[i].line, expected[i].line) << offsets[i];
+      EXPECT_EQ(positions[i].column, expected[i].column) << offsets[i];
+    }
+  }
+}
+
+TEST(FileLines, ascii_lines_have_no_checkpoints)
+{
+  auto const lines = make_lines("fn main {\n  // \xC3\xA9\n}\n", true);
+  EXPECT_EQ(lines.line_checkpoints.size(), 4u);
+  EXPECT_EQ(lines.line_checkpoints[0], FileLines::ASCII_LINE);
+  EXPECT_NE(lines.line_checkpoints[1], FileLines::ASCII_LINE);
+  EXPECT_EQ(lines.line_checkpoints[2], FileLines::ASCII_LINE);
+  EXPECT_EQ(lines.line_checkpoints[3], FileLines::ASCII_LINE);
+  EXPECT_EQ(lines.checkpoints.size(), 1u);
+
+  // The end of the text.
+  EXPECT_EQ(lines.line_at(20), 4u);
+  EXPECT_EQ(lines.column_at(20), 0u);
+}
+
+TEST(FileLines, parse_builds_the_index)
+{
+  auto parsed = jet::parser::parse("fn main {\n  // \xC3\xA9\xC3\xA9\n}\n");
+  ASSERT_TRUE(parsed.is_ok());
+
+  auto& lines = parsed.get_unchecked().lines;
+  EXPECT_FALSE(lines.block_lines.empty());
+  EXPECT_EQ(lines.line_at(19), 2u);
+  EXPECT_EQ(lines.column_at(19), 7u);
+}
@@ -0,0 +1,50 @@
+#include "./Common.hpp"
+
+#include <string_view>
+
+import Jet.Parser;
+import Jet.Core.File;
+import Jet.Comp.Log;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using jet::parser::ParseOptions;
+using jet::parser::ParseVerbosity;
+
+static auto parse_with_dump(Path const& rel_path, ParseVerbosity verbosity) -> String
+{
+  auto module_content = jet::core::read_file(Path("Projects/Test/cases") / rel_path);
+  EXPECT_TRUE(module_content.has_value()) << "Failed to read test case file: " << rel_path.string();
+
+  auto dump = String();
+  auto log  = jet::comp::log::Log(dump);
+
+  auto options        = ParseOptions();
+  options.verbosity   = verbosity;
+  options.diagnostics = &log;
+
+  auto parsed = jet::parser::parse(module_content.value_or(""), options);
+  EXPECT_TRUE(parsed.is_ok()) << "Unexpected failure parsing test case file: " << rel_path.string();
+
+  return dump;
+}
+
+TEST(Parse_Options, silent_by_default)
+{
+  EXPECT_EQ(ParseOptions().verbosity, ParseVerbosity::Silent);
+  EXPECT_TRUE(parse_with_dump("HelloWorld.jet", ParseVerbosity::Silent).empty());
+}
+
+TEST(Parse_Options, ast_dump_has_no_source_lines)
+{
+  auto dump = parse_with_dump("HelloWorld.jet", ParseVerbosity::AST);
+  EXPECT_NE(dump.find("Rule: "), String::npos);
+  EXPECT_EQ(dump.find("0: fn main"), String::npos);
+}
+
+TEST(Parse_Options, full_dump_has_source_lines)
+{
+  auto dump = parse_with_dump("HelloWorld.jet", ParseVerbosity::All);
+  EXPECT_NE(dump.find("Rule: "), String::npos);
+  EXPECT_NE(dump.find("0: fn main"), String::npos);
+}
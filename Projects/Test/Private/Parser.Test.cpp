@@ -193,3 +193,77 @@ TEST(Parse_Modules, submodule_with_function_with_global_alias_succeeds)
 {
   test_module_parse("modules/Submodule-WithFunction-WithGlobalAlias.jet");
 }
+
+// Packrat memoization
+
+TEST(Parse_Packrat, hello_world_same_ast)
+{
+  test_packrat_equivalence("HelloWorld.jet");
+}
+
+TEST(Parse_Packrat, compound_expression_same_ast)
+{
+  test_packrat_equivalence("expressions/CompoundExpr.jet");
+}
+
+TEST(Parse_Packrat, if_else_if_else_same_ast)
+{
+  test_packrat_equivalence("control_flow/if_else_if_else.jet");
+}
+
+TEST(Parse_Packrat, submodule_with_function_with_global_alias_same_ast)
+{
+  test_packrat_equivalence("modules/Submodule-WithFunction-WithGlobalAlias.jet");
+}
+
+// Shared grammar
+
+TEST(Parse_SharedGrammar, concurrent_parses_same_ast)
+{
+  test_shared_grammar_parse("modules/Submodule-WithFunction-WithGlobalAlias.jet");
+}
+
+// Parallel analysis of top-level items
+
+TEST(Parse_Parallel, hello_world_same_ast)
+{
+  // A single item is analyzed as a whole.
+  test_parallel_parse("HelloWorld.jet", 0);
+}
+
+TEST(Parse_Parallel, multiple_combined_use_same_ast)
+{
+  test_parallel_parse("modules/Multiple-Combined-Use.jet", 3);
+}
+
+TEST(Parse_Parallel, submodule_with_function_with_global_alias_same_ast)
+{
+  test_parallel_parse("modules/Submodule-WithFunction-WithGlobalAlias.jet", 3);
+}
+
+TEST(Parse_Parallel, submodule_empty_same_outcome)
+{
+  test_parallel_parse("modules/Submodule-Empty.jet", 2);
+}
+
+// Streaming analysis of top-level items
+
+TEST(Parse_Stream, hello_world_same_ast)
+{
+  test_stream_parse("HelloWorld.jet");
+}
+
+TEST(Parse_Stream, multiple_combined_use_same_ast)
+{
+  test_stream_parse("modules/Multiple-Combined-Use.jet");
+}
+
+TEST(Parse_Stream, submodule_with_function_with_global_alias_same_ast)
+{
+  test_stream_parse("modules/Submodule-WithFunction-WithGlobalAlias.jet");
+}
+
+TEST(Parse_Stream, submodule_empty_same_outcome)
+{
+  test_stream_parse("modules/Submodule-Empty.jet");
+}
@@ -0,0 +1,162 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+import Jet.Comp.PEG;
+import Jet.Comp.PEG.Machine;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using namespace jet::comp::peg;
+
+struct CalcGrammar
+{
+  Grammar peg;
+
+  /// Symbols of the captured operators, by the offset of their rule.
+  std::unordered_map<usize, StringView> symbols;
+};
+
+/// Numbers with `=` (right), `+` (left), `-` (left, not captured), `*` (left) and `^` (right).
+static auto build_calc_grammar() -> CalcGrammar
+{
+  struct Op
+  {
+    StringView    text;
+    usize         binding_power;
+    Associativity associativity;
+    bool          capture;
+  };
+
+  constexpr Op ops[] = {
+    {"=", 1, Associativity::Right, true},
+    {"+", 2, Associativity::Left, true},
+    {"-", 2, Associativity::Left, false},
+    {"*", 3, Associativity::Left, true},
+    {"^", 4, Associativity::Right, true},
+  };
+
+  auto result = CalcGrammar();
+  auto b      = GrammarBuilder();
+
+  auto root = b.begin_rule(CombinatorRule::Precedence, true, "Expr");
+  {
+    (void)b.begin_rule(CombinatorRule::Plus, true, "Number");
+    b.add_rule_ref(BuiltinRule::Digit);
+    b.end_rule();
+
+    for (auto const& op : ops) {
+      auto rule = b.begin_operator(op.binding_power, op.associativity, op.capture, "Binary");
+      (void)b.add_text(op.text);
+      b.end_rule();
+
+      result.symbols[rule.offset] = op.text;
+    }
+  }
+  b.end_rule();
+
+  result.peg = finalize_grammar(root, std::move(b));
+  return result;
+}
+
+/// @returns The subtree of the entry as an S-expression, e.g. `(+ 1 (* 2 3))`.
+static auto to_sexpr(CalcGrammar const& grammar, ASTAnalysis const& analysis, usize entry_id) -> String
+{
+  auto& entry = analysis.ast.entries[entry_id];
+  if (entry.num_children == 0) {
+    return String(analysis.document.substr(entry.start_pos, entry.end_pos - entry.start_pos));
+  }
+
+  auto children = String();
+  auto child    = entry_id + 1;
+  for (auto i = usize(0); i < entry.num_children; ++i) {
+    if (i > 0) {
+      children += " ";
+    }
+    children += to_sexpr(grammar, analysis, child);
+    child = analysis.ast.entries[child].next_id_same_nesting.id;
+  }
+
+  if (auto it = grammar.symbols.find(entry.rule_offset); it != grammar.symbols.end()) {
+    return "(" + String(it->second) + " " + children + ")";
+  }
+  return children;
+}
+
+/// Parses the expression with both the analyzer and the parsing machine.
+/// @returns The expression tree.
+static auto parse_calc(StringView expression) -> String
+{
+  static auto const grammar = build_calc_grammar();
+  static auto const program = compile_grammar(grammar.peg);
+
+  auto analysis = analyze(grammar.peg, expression);
+  auto machine  = analyze(program, expression);
+  EXPECT_EQ(analysis.is_ok(), machine.is_ok()) << expression;
+  if (!analysis.is_ok() || !machine.is_ok()) {
+    return "<failed>";
+  }
+
+  auto& expected = analysis.get_unchecked().ast.entries;
+  auto& actual   = machine.get_unchecked().ast.entries;
+  EXPECT_EQ(expected.size(), actual.size()) << expression;
+  for (auto i = usize(0); i < std::min(expected.size(), actual.size()); ++i) {
+    EXPECT_EQ(expected[i].rule_offset, actual[i].rule_offset) << expression << ", entry " << i;
+    EXPECT_EQ(expected[i].next_id_same_nesting.id, actual[i].next_id_same_nesting.id) << expression << ", entry " << i;
+    EXPECT_EQ(expected[i].num_children, actual[i].num_children) << expression << ", entry " << i;
+    EXPECT_EQ(expected[i].start_pos, actual[i].start_pos) << expression << ", entry " << i;
+    EXPECT_EQ(expected[i].end_pos, actual[i].end_pos) << expression << ", entry " << i;
+  }
+
+  return to_sexpr(grammar, analysis.get_unchecked(), 0);
+}
+
+TEST(Precedence, single_operand)
+{
+  EXPECT_EQ(parse_calc("42"), "42");
+}
+
+TEST(Precedence, binding_power)
+{
+  EXPECT_EQ(parse_calc("1+2*3"), "(+ 1 (* 2 3))");
+  EXPECT_EQ(parse_calc("1*2+3"), "(+ (* 1 2) 3)");
+  EXPECT_EQ(parse_calc("1*2^3+4"), "(+ (* 1 (^ 2 3)) 4)");
+}
+
+TEST(Precedence, associativity)
+{
+  EXPECT_EQ(parse_calc("1+2+3"), "(+ (+ 1 2) 3)");
+  EXPECT_EQ(parse_calc("2^3^4"), "(^ 2 (^ 3 4))");
+  EXPECT_EQ(parse_calc("1=2=3+4"), "(= 1 (= 2 (+ 3 4)))");
+}
+
+TEST(Precedence, non_captured_operator_flattens)
+{
+  // `-` is not captured: its operands become children of the enclosing entry.
+  EXPECT_EQ(parse_calc("1-2*3"), "1 (* 2 3)");
+  EXPECT_EQ(parse_calc("1+2-3"), "(+ 1 2) 3");
+}
+
+TEST(Precedence, ranges_of_binary_entries)
+{
+  static auto const grammar = build_calc_grammar();
+
+  auto analysis = analyze(grammar.peg, StringView("12+34*5"));
+  ASSERT_TRUE(analysis.is_ok());
+
+  // Expr, (+ 12 (* 34 5)), 12, (* 34 5), 34, 5
+  auto& entries = analysis.get_unchecked().ast.entries;
+  ASSERT_EQ(entries.size(), 6u);
+  EXPECT_EQ(entries[1].start_pos, 0u);
+  EXPECT_EQ(entries[1].end_pos, 7u);
+  EXPECT_EQ(entries[3].start_pos, 3u);
+  EXPECT_EQ(entries[3].end_pos, 7u);
+  EXPECT_EQ(entries[0].num_children, 1u);
+  EXPECT_EQ(entries[0].next_id_same_nesting.id, 6u);
+}
+
+TEST(Precedence, dangling_operator_is_not_consumed)
+{
+  EXPECT_EQ(parse_calc("1+2*"), "<failed>");
+}
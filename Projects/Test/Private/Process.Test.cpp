@@ -0,0 +1,103 @@
+#include "./Common.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+import Jet.Core.Process;
+import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+using namespace std::chrono_literals;
+namespace core = jet::core;
+
+// The commands run through the POSIX shell.
+#ifndef WIN32
+
+TEST(Process, captures_output_and_exit_code)
+{
+  auto const result = core::run_process({"sh", {"-c", "echo out; echo err >&2; exit 3"}});
+  ASSERT_TRUE(result.is_ok()) << result.err()->details;
+
+  auto& output = result.get_unchecked();
+  EXPECT_EQ(output.exit_code, 3);
+  EXPECT_FALSE(output.timed_out);
+  EXPECT_FALSE(output.succeeded());
+  EXPECT_EQ(output.out, "out\n");
+  EXPECT_EQ(output.err, "err\n");
+}
+
+TEST(Process, captures_large_output_of_both_streams)
+{
+  // Each stream is larger than a pipe, so the child blocks unless both are read at once.
+  auto const result =
+    core::run_process({"sh", {"-c", "head -c 1000000 /dev/zero; head -c 500000 /dev/zero >&2; exit 0"}});
+  ASSERT_TRUE(result.is_ok()) << result.err()->details;
+  EXPECT_TRUE(result.get_unchecked().succeeded());
+  EXPECT_EQ(result.get_unchecked().out.size(), 1'000'000u);
+  EXPECT_EQ(result.get_unchecked().err.size(), 500'000u);
+}
+
+TEST(Process, passes_arguments_verbatim)
+{
+  auto const result = core::run_process({"sh", {"-c", "printf '%s|' \"$@\"", "sh", "a b", "\"c\"", ""}});
+  ASSERT_TRUE(result.is_ok()) << result.err()->details;
+  EXPECT_EQ(result.get_unchecked().out, "a b|\"c\"||");
+}
+
+TEST(Process, kills_on_timeout)
+{
+  auto const start  = std::chrono::steady_clock::now();
+  auto const result = core::run_process({"sleep", {"10"}, 100ms});
+  ASSERT_TRUE(result.is_ok()) << result.err()->details;
+  EXPECT_TRUE(result.get_unchecked().timed_out);
+  EXPECT_FALSE(result.get_unchecked().succeeded());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(Process, kills_on_timeout_after_the_output_is_closed)
+{
+  auto const start  = std::chrono::steady_clock::now();
+  auto const result = core::run_process({"sh", {"-c", "echo out; exec >/dev/null 2>&1; sleep 10"}, 100ms});
+  ASSERT_TRUE(result.is_ok()) << result.err()->details;
+  EXPECT_TRUE(result.get_unchecked().timed_out);
+  EXPECT_EQ(result.get_unchecked().out, "out\n");
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(Process, reports_missing_programs)
+{
+  auto const result = core::run_process({"jet-test-no-such-program", {}});
+  ASSERT_TRUE(result.is_err());
+  EXPECT_NE(result.err()->details.find("jet-test-no-such-program"), String::npos) << result.err()->details;
+}
+
+TEST(Process, job_queue_runs_in_parallel_and_keeps_the_order)
+{
+  auto const cwd = std::filesystem::current_path();
+
+  auto queue = core::JobQueue(4);
+  EXPECT_EQ(queue.num_jobs(), 4u);
+  for (auto i = 0; i < 8; ++i) {
+    EXPECT_EQ(queue.push({"sh", {"-c", "sleep 0.2; echo " + std::to_string(i)}}), usize(i));
+  }
+
+  auto const start   = std::chrono::steady_clock::now();
+  auto const results = queue.run();
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+
+  ASSERT_EQ(results.size(), 8u);
+  for (auto i = 0; i < 8; ++i) {
+    ASSERT_TRUE(results[usize(i)].is_ok());
+    EXPECT_EQ(results[usize(i)].get_unchecked().out, std::to_string(i) + "\n");
+  }
+
+  // Two rounds of four jobs, instead of eight one after another.
+  EXPECT_LT(elapsed, 1400ms);
+  EXPECT_EQ(std::filesystem::current_path(), cwd);
+
+  // The queue is empty afterwards.
+  EXPECT_TRUE(queue.run().empty());
+}
+
+#endif
@@ -0,0 +1,79 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+import Jet.Parser;
+import Jet.Comp.PEG;
+import Jet.Core.File;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+/// @returns The counters of the rule with the given name (or @c nullptr).
+static auto find_stats(peg::RuleProfile const& profile, StringView name) -> peg::RuleStats const*
+{
+  auto it = std::find_if(profile.rules.begin(), profile.rules.end(), [&](auto const& stats) {
+    return stats.name == name;
+  });
+  return it == profile.rules.end() ? nullptr : &*it;
+}
+
+TEST(Profiling, parse_collects_rule_counters)
+{
+  auto module_content = jet::core::read_file(Path("Projects/Test/cases/expressions/CompoundExpr.jet"));
+  ASSERT_TRUE(module_content.has_value());
+
+  auto profile = peg::RuleProfile();
+  auto options = jet::parser::ParseOptions();
+  options.profile = &profile;
+
+  auto parsed = jet::parser::parse(*module_content, options);
+  ASSERT_TRUE(parsed.is_ok());
+
+  if constexpr (!peg::PROFILING_ENABLED) {
+    EXPECT_TRUE(profile.rules.empty());
+    return;
+  }
+
+  auto expression = find_stats(profile, "Expression");
+  ASSERT_NE(expression, nullptr);
+  EXPECT_GT(expression->calls, 0u);
+  EXPECT_EQ(expression->calls, expression->successes + expression->failures);
+  EXPECT_GT(expression->consumed_bytes, 0u);
+  EXPECT_GE(expression->cumulative_time, expression->self_time);
+
+  // Counters of consecutive analyses add up.
+  auto const calls = expression->calls;
+  ASSERT_TRUE(jet::parser::parse(*module_content, options).is_ok());
+  EXPECT_EQ(find_stats(profile, "Expression")->calls, 2 * calls);
+}
+
+TEST(Profiling, report_and_json_are_sorted)
+{
+  using namespace std::chrono_literals;
+
+  auto profile = peg::RuleProfile();
+  profile.rules.push_back({.rule = {10}, .name = "Fast", .calls = 5, .successes = 5, .cumulative_time = 10ns});
+  profile.rules.push_back({.rule = {20}, .name = "Slow \"quoted\"", .calls = 1, .failures = 1, .cumulative_time = 1ms});
+
+  auto by_calls = peg::sorted_rule_stats(profile, peg::ProfileOrder::Calls);
+  EXPECT_EQ(by_calls.front().name, "Fast");
+
+  auto report = peg::format_profile_report(profile);
+  EXPECT_LT(report.find("Slow"), report.find("Fast"));
+
+  auto limited = peg::format_profile_report(profile, peg::ProfileOrder::CumulativeTime, 1);
+  EXPECT_EQ(limited.find("Fast"), String::npos);
+  EXPECT_NE(limited.find("1 more rules"), String::npos);
+
+  auto json = peg::format_profile_json(profile);
+  EXPECT_EQ(json.front(), '[');
+  EXPECT_EQ(json.back(), ']');
+  EXPECT_NE(json.find(R"("rule": "Slow \"quoted\"")"), String::npos);
+  EXPECT_NE(json.find(R"("cumulative_ns": 1000000)"), String::npos);
+  EXPECT_LT(json.find("Slow"), json.find("Fast"));
+
+  EXPECT_EQ(peg::format_profile_json(peg::RuleProfile()), "[]");
+}
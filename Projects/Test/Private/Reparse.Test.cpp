@@ -0,0 +1,179 @@
+#include "./Common.hpp"
+
+#include <string_view>
+
+import Jet.Parser;
+import Jet.Parser.JetGrammar;
+import Jet.Comp.PEG;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+using RT = jet::parser::JetGrammarRuleType;
+
+static auto const SOURCE = StringView(
+  "fn first {\n"
+  "  println(\"Hello, World!\");\n"
+  "}\n"
+  "\n"
+  "fn second {\n"
+  "  let x = 1 + 2;\n"
+  "  if (x > 2) {\n"
+  "    println(\"Greater\");\n"
+  "  }\n"
+  "}\n"
+);
+
+/// Replaces @p old_text (first occurrence) with @p new_text.
+/// @returns The edited document and the edit.
+static auto replace_text(StringView document, StringView old_text, StringView new_text) -> std::pair<String, peg::TextEdit>
+{
+  auto start = document.find(old_text);
+  EXPECT_NE(start, StringView::npos) << "Text not found: " << old_text;
+
+  auto edited = String(document);
+  edited.replace(start, old_text.size(), new_text);
+  return {edited, peg::TextEdit{start, start + old_text.size(), start + new_text.size()}};
+}
+
+static auto reanalyze(peg::AST const& previous, StringView document, peg::TextEdit const& edit) -> peg::ASTAnalysisResult
+{
+  auto& grammar = jet::parser::use_grammar();
+
+  auto const anchors = Array<peg::CustomRuleRef, 2>{grammar.rules[RT::CodeBlock], grammar.rules[RT::DeclFunction]};
+  return peg::reanalyze(grammar.peg, previous, document, edit, {anchors});
+}
+
+static auto expect_same_ast(peg::AST const& expected, peg::AST const& actual) -> void
+{
+  ASSERT_EQ(expected.entries.size(), actual.entries.size());
+  EXPECT_EQ(expected.current_pos, actual.current_pos);
+
+  for (auto i = usize(0); i < expected.entries.size(); ++i) {
+    auto& e = expected.entries[i];
+    auto& a = actual.entries[i];
+    EXPECT_EQ(e.rule_offset, a.rule_offset) << "entry " << i;
+    EXPECT_EQ(e.next_id_same_nesting.id, a.next_id_same_nesting.id) << "entry " << i;
+    EXPECT_EQ(e.num_children, a.num_children) << "entry " << i;
+    EXPECT_EQ(e.start_pos, a.start_pos) << "entry " << i;
+    EXPECT_EQ(e.end_pos, a.end_pos) << "entry " << i;
+  }
+}
+
+/// Reanalyzes the edited document and expects the same outcome as a full analysis.
+static auto expect_same_as_full(peg::AST const& previous, StringView document, peg::TextEdit const& edit)
+  -> peg::ASTAnalysisResult
+{
+  auto& grammar = jet::parser::use_grammar();
+
+  auto full        = peg::analyze(grammar.peg, document);
+  auto incremental = reanalyze(previous, document, edit);
+
+  EXPECT_EQ(full.is_ok(), incremental.is_ok()) << "Reanalysis changed the outcome of:\n" << document;
+  if (full.is_ok() && incremental.is_ok()) {
+    expect_same_ast(full.get_unchecked().ast, incremental.get_unchecked().ast);
+  }
+  return incremental;
+}
+
+TEST(Reparse, edit_in_code_block_reanalyzes_only_the_block)
+{
+  auto& grammar  = jet::parser::use_grammar();
+  auto  previous = peg::analyze(grammar.peg, SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  auto [document, edit] = replace_text(SOURCE, "\"Greater\"", "\"Greater than two\"");
+  auto result           = expect_same_as_full(previous.get_unchecked().ast, document, edit);
+  ASSERT_TRUE(result.is_ok());
+
+  auto& stats = result.get_unchecked().reanalysis_stats;
+  EXPECT_FALSE(stats.full_reanalysis);
+  EXPECT_GT(stats.reused_entries, 0u);
+
+  // Only the body of the `if` statement was analyzed again.
+  auto block_start = document.find("{\n    println");
+  EXPECT_EQ(stats.reanalyzed_from, block_start);
+  EXPECT_EQ(stats.reanalyzed_to, document.find('}', block_start) + 1);
+}
+
+TEST(Reparse, edit_moving_block_end_falls_back_to_enclosing_anchor)
+{
+  auto& grammar  = jet::parser::use_grammar();
+  auto  previous = peg::analyze(grammar.peg, SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  // The inner block now ends earlier, so the body of the function is reanalyzed.
+  auto [document, edit] = replace_text(SOURCE, "println(\"Greater\");", "}\n  {\n    println(\"Greater\");");
+  auto result           = expect_same_as_full(previous.get_unchecked().ast, document, edit);
+  ASSERT_TRUE(result.is_ok());
+
+  auto& stats = result.get_unchecked().reanalysis_stats;
+  EXPECT_FALSE(stats.full_reanalysis);
+  EXPECT_EQ(stats.reanalyzed_from, document.find("{\n  let"));
+}
+
+TEST(Reparse, edit_outside_anchors_reanalyzes_everything)
+{
+  auto& grammar  = jet::parser::use_grammar();
+  auto  previous = peg::analyze(grammar.peg, SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  auto [document, edit] = replace_text(SOURCE, "fn second", "fn third");
+  auto result           = expect_same_as_full(previous.get_unchecked().ast, document, edit);
+  ASSERT_TRUE(result.is_ok());
+  EXPECT_TRUE(result.get_unchecked().reanalysis_stats.full_reanalysis);
+}
+
+TEST(Reparse, edit_in_function_signature_reanalyzes_only_the_declaration)
+{
+  auto& grammar  = jet::parser::use_grammar();
+  auto  previous = peg::analyze(grammar.peg, SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  // No code block encloses the edit, the declaration is analyzed again from its `fn` keyword.
+  auto [document, edit] = replace_text(SOURCE, "first", "first(a: i32)");
+  auto result           = expect_same_as_full(previous.get_unchecked().ast, document, edit);
+  ASSERT_TRUE(result.is_ok());
+
+  auto& stats = result.get_unchecked().reanalysis_stats;
+  EXPECT_FALSE(stats.full_reanalysis);
+  EXPECT_GT(stats.reused_entries, 0u);
+  EXPECT_EQ(stats.reanalyzed_from, document.find("fn first"));
+  EXPECT_EQ(stats.reanalyzed_to, document.find("}\n") + 1);
+}
+
+TEST(Reparse, single_byte_edits_match_full_parse)
+{
+  auto& grammar  = jet::parser::use_grammar();
+  auto  previous = peg::analyze(grammar.peg, SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  auto const& previous_ast = previous.get_unchecked().ast;
+  for (auto pos = usize(0); pos < SOURCE.size(); ++pos) {
+    // Insertion, removal and replacement of a single byte.
+    auto const edits = {
+      std::pair{StringView(), StringView(" ")},
+      std::pair{SOURCE.substr(pos, 1), StringView()},
+      std::pair{SOURCE.substr(pos, 1), StringView("}")},
+    };
+    for (auto [removed, inserted] : edits) {
+      auto document = String(SOURCE.substr(0, pos)) + String(inserted) + String(SOURCE.substr(pos + removed.size()));
+      auto edit     = peg::TextEdit{pos, pos + removed.size(), pos + inserted.size()};
+      (void)expect_same_as_full(previous_ast, document, edit);
+    }
+  }
+}
+
+TEST(Reparse, parser_reparse_matches_parse)
+{
+  auto previous = jet::parser::parse(SOURCE);
+  ASSERT_TRUE(previous.is_ok());
+
+  auto [document, edit] = replace_text(SOURCE, "1 + 2", "1 + 2 * 3");
+  auto full             = jet::parser::parse(document);
+  auto reparsed         = jet::parser::reparse(previous.get_unchecked(), document, edit);
+  ASSERT_TRUE(full.is_ok());
+  ASSERT_TRUE(reparsed.is_ok());
+  expect_same_ast(full.get_unchecked().ast, reparsed.get_unchecked().ast);
+}
@@ -0,0 +1,62 @@
+#include "./Common.hpp"
+
+#include <sstream>
+#include <string>
+
+import Jet.Parser;
+import Jet.Comp.PEG;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+namespace peg = jet::comp::peg;
+
+/// Collects the text of every item.
+struct ItemCollector final : peg::StreamItemHandler
+{
+  DynArray<String> texts;
+  DynArray<usize>  positions;
+
+  auto on_item(peg::AST const& ast, usize first_entry, StringView text, usize text_pos) -> void override
+  {
+    EXPECT_LT(first_entry, ast.entries.size());
+    EXPECT_EQ(ast.entries[first_entry].start_pos, text_pos);
+    texts.emplace_back(text);
+    positions.push_back(text_pos);
+  }
+};
+
+TEST(Stream, buffer_is_bounded_by_item_size)
+{
+  auto module_content = String();
+  for (auto i = 0; i < 2000; ++i) {
+    module_content += "fn f" + std::to_string(i) + " {\n  let x = " + std::to_string(i) + " + 1;\n}\n\n";
+  }
+
+  auto file    = std::istringstream(module_content);
+  auto reader  = peg::StdStreamReader(file);
+  auto handler = ItemCollector();
+  auto options = peg::StreamOptions{.chunk_size = 1024, .lookahead = 64, .handler = &handler};
+
+  auto const streamed = jet::parser::analyze_module_stream(reader, options);
+  ASSERT_TRUE(streamed.is_ok());
+
+  auto& stats = streamed.get_unchecked().stream_stats;
+  EXPECT_EQ(stats.num_items, 2000u);
+  EXPECT_EQ(stats.bytes_read, module_content.size());
+  EXPECT_LT(stats.peak_buffer_size, 8 * 1024u);
+
+  ASSERT_EQ(handler.texts.size(), 2000u);
+  EXPECT_EQ(handler.texts[3], "fn f3 {\n  let x = 3 + 1;\n}");
+  EXPECT_EQ(module_content.substr(handler.positions[1500], handler.texts[1500].size()), handler.texts[1500]);
+}
+
+TEST(Stream, syntax_error_fails)
+{
+  auto file   = std::istringstream("fn a {}\n\nfn b( {}\n");
+  auto reader = peg::StdStreamReader(file);
+
+  auto const streamed = jet::parser::analyze_module_stream(reader, {.chunk_size = 4, .lookahead = 2});
+  ASSERT_FALSE(streamed.is_ok());
+  EXPECT_EQ(streamed.err_unchecked().ast.current_pos, 9u);
+  EXPECT_EQ(streamed.err_unchecked().stream_stats.num_items, 1u);
+}
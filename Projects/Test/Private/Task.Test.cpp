@@ -0,0 +1,55 @@
+#include "./Common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+import Jet.Core.Task;
+import Jet.Comp.Foundation;
+
+using namespace jet::comp::foundation;
+namespace core = jet::core;
+
+TEST(TaskPool, runs_every_task)
+{
+  auto pool = core::TaskPool(4);
+  EXPECT_EQ(pool.num_threads(), 4u);
+
+  auto sum = std::atomic<usize>(0);
+  for (auto i = usize(1); i <= 1000; ++i) {
+    pool.submit([&sum, i] { sum += i; });
+  }
+  pool.wait();
+  EXPECT_EQ(sum, 500'500u);
+}
+
+TEST(TaskPool, waits_for_tasks_submitted_by_tasks)
+{
+  auto pool     = core::TaskPool(4);
+  auto num_runs = std::atomic<usize>(0);
+
+  // A binary tree of tasks, each of them submits its children.
+  auto spawn = std::function<void(usize)>();
+  spawn      = [&](usize depth) {
+    ++num_runs;
+    if (depth != 0) {
+      pool.submit([&, depth] { spawn(depth - 1); });
+      pool.submit([&, depth] { spawn(depth - 1); });
+    }
+  };
+  pool.submit([&] { spawn(12); });
+  pool.wait();
+  EXPECT_EQ(num_runs, (usize(1) << 13) - 1);
+
+  // The pool can be reused once it is idle.
+  pool.submit([&] { spawn(0); });
+  pool.wait();
+  EXPECT_EQ(num_runs, usize(1) << 13);
+}
+
+TEST(TaskPool, defaults_to_one_thread_per_hardware_thread)
+{
+  auto pool = core::TaskPool();
+  EXPECT_EQ(pool.num_threads(), std::max(usize(std::thread::hardware_concurrency()), usize(1)));
+}
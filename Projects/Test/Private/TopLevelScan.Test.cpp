@@ -0,0 +1,58 @@
+#include "./Common.hpp"
+
+#include <string_view>
+
+import Jet.Parser.TopLevelScan;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+using jet::parser::scan_top_level_items;
+
+/// @returns The content of every item found in the module (empty if the scan was ambiguous).
+static auto scan_items(StringView module_content) -> DynArray<StringView>
+{
+  auto items = scan_top_level_items(module_content);
+  if (!items) {
+    return {};
+  }
+
+  auto contents = DynArray<StringView>();
+  for (auto item : *items) {
+    contents.push_back(module_content.substr(item.start, item.end - item.start));
+  }
+  return contents;
+}
+
+TEST(TopLevelScan, finds_every_item)
+{
+  auto items = scan_items("use a::b;\n\nfn main {\n  foo();\n}\n// comment\nmod m {\n  fn f {}\n}\n");
+  ASSERT_EQ(items.size(), 3u);
+  EXPECT_EQ(items[0], "use a::b;");
+  EXPECT_EQ(items[1], "fn main {\n  foo();\n}");
+  EXPECT_EQ(items[2], "mod m {\n  fn f {}\n}");
+}
+
+TEST(TopLevelScan, braces_in_strings_and_comments_are_skipped)
+{
+  auto items = scan_items("fn a {\n  println(\"}\\\"{\"); // }\n}\nfn b {}");
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[1], "fn b {}");
+}
+
+TEST(TopLevelScan, item_continues_after_closing_brace)
+{
+  auto items = scan_items("use a::{b, c}, d;\nuse e;");
+  ASSERT_EQ(items.size(), 2u);
+  EXPECT_EQ(items[0], "use a::{b, c}, d;");
+}
+
+TEST(TopLevelScan, ambiguous_content_is_rejected)
+{
+  EXPECT_FALSE(scan_top_level_items("fn a {").has_value());
+  EXPECT_FALSE(scan_top_level_items("fn a {}}").has_value());
+  EXPECT_FALSE(scan_top_level_items("fn a { \"unterminated }").has_value());
+  EXPECT_FALSE(scan_top_level_items("fn a { 'c' }").has_value());
+  EXPECT_FALSE(scan_top_level_items("let x = 5;").has_value());
+  EXPECT_FALSE(scan_top_level_items("fn a {} trailing").has_value());
+  EXPECT_FALSE(scan_top_level_items("").has_value());
+}
@@ -0,0 +1,109 @@
+#include "./Common.hpp"
+
+#include <string>
+
+import Jet.Parser;
+import Jet.Comp.Foundation;
+import Jet.Comp.Foundation.StdTypes;
+
+using namespace jet::comp::foundation;
+
+/// @returns Kernels supported by the CPU.
+static auto supported_kernels() -> DynArray<UTF8Kernel>
+{
+  auto result = DynArray<UTF8Kernel>{UTF8Kernel::Scalar};
+  if (best_utf8_kernel() != UTF8Kernel::Scalar) {
+    result.push_back(UTF8Kernel::SSE2);
+  }
+  if (best_utf8_kernel() == UTF8Kernel::AVX2) {
+    result.push_back(UTF8Kernel::AVX2);
+  }
+  return result;
+}
+
+/// @returns The position of the first invalid sequence (or -1) found by every kernel.
+/// Expects the same result and the same lines from every kernel.
+static auto first_invalid(StringView text) -> isize
+{
+  auto expected_lines = DynArray<usize>();
+  for (auto i = usize(0); i < text.size(); ++i) {
+    if (text[i] == '\n') {
+      expected_lines.push_back(i + 1);
+    }
+  }
+
+  auto result = isize(-2);
+  for (auto kernel : supported_kernels()) {
+    auto lines   = DynArray<usize>();
+    auto invalid = index_utf8_lines(kernel, text, lines);
+    EXPECT_EQ(lines, expected_lines) << to_string(kernel);
+
+    auto pos = invalid ? isize(invalid->pos) : isize(-1);
+    if (result != -2) {
+      EXPECT_EQ(pos, result) << to_string(kernel);
+    }
+    result = pos;
+  }
+  return result;
+}
+
+TEST(UTF8, valid_text_indexes_lines)
+{
+  EXPECT_EQ(first_invalid(""), -1);
+  EXPECT_EQ(first_invalid("\n"), -1);
+  EXPECT_EQ(first_invalid("fn main {\n  // Za\xC5\xBC\xC3\xB3\xC5\x82\xC4\x87 \xE2\x82\xAC \xF0\x9F\x98\x80\n}\n"), -1);
+
+  // Sequences that cross the blocks of the vectorized kernels.
+  for (auto offset = usize(0); offset < 40; ++offset) {
+    auto text = String(offset, 'x') + "\xF0\x9F\x98\x80\n\xE2\x82\xAC" + String(40, '\n') + "\xF4\x8F\xBF\xBF";
+    EXPECT_EQ(first_invalid(text), -1) << offset;
+  }
+}
+
+TEST(UTF8, invalid_sequences_are_rejected)
+{
+  auto const invalid = {
+    "\x80",             // Lone continuation
+    "\xC0\x80",         // Overlong NUL
+    "\xC1\xBF",         // Overlong 2-byte
+    "\xE0\x9F\xBF",     // Overlong 3-byte
+    "\xF0\x8F\xBF\xBF", // Overlong 4-byte
+    "\xED\xA0\x80",     // Surrogate
+    "\xF4\x90\x80\x80", // Above U+10FFFF
+    "\xF5\x80\x80\x80", // Invalid lead
+    "\xFF",             // Invalid lead
+    "\xE2\x82",         // Truncated
+    "\xE2\x82x",        // Incomplete
+  };
+
+  for (auto sequence : invalid) {
+    for (auto offset = usize(0); offset < 40; ++offset) {
+      auto text = String(offset, 'a') + sequence + String(offset % 7, '\n') + "\xC3\xA9";
+      EXPECT_EQ(first_invalid(text), isize(offset)) << offset;
+    }
+    EXPECT_TRUE(decode_utf8_char(sequence).is_err());
+  }
+}
+
+TEST(UTF8, decode_is_strict)
+{
+  EXPECT_EQ(decode_utf8_char("a").get_unchecked(), U'a');
+  EXPECT_EQ(decode_utf8_char("\xC3\xA9").get_unchecked(), U'é');
+  EXPECT_EQ(decode_utf8_char("\xE2\x82\xAC").get_unchecked(), U'€');
+  EXPECT_EQ(decode_utf8_char("\xF0\x9F\x98\x80").get_unchecked(), U'\U0001F600');
+
+  EXPECT_EQ(decode_utf8_char("\xC0\x80").err_unchecked(), UTF8DecodeError::OverlongSequence);
+  EXPECT_EQ(decode_utf8_char("\xED\xA0\x80").err_unchecked(), UTF8DecodeError::InvalidCodePoint);
+  EXPECT_EQ(decode_utf8_char("\xE2\x82").err_unchecked(), UTF8DecodeError::NotEnoughRoom);
+}
+
+TEST(UTF8, parse_rejects_invalid_module)
+{
+  auto parsed = jet::parser::parse("fn main {\n  // \xC0\x80\n}\n");
+  ASSERT_FALSE(parsed.is_ok());
+  EXPECT_EQ(parsed.err_unchecked().pos, 15u);
+
+  auto valid = jet::parser::parse("fn main {\n  // \xC3\xA9\n}\n");
+  ASSERT_TRUE(valid.is_ok());
+  EXPECT_EQ(valid.get_unchecked().lines.line_starts, (DynArray<usize>{0, 10, 18, 20}));
+}